@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+
+import argparse
+import json
+import logging
+import struct
+import zlib
+
+import requests
+
+logger: logging.Logger = logging.getLogger(__name__)
+
+PIXELS = 16 * 16
+
+FRAME_RLE = 0x01
+FRAME_DELTA = 0x02
+
+UPLOAD_MAGIC = 0xA5
+UPLOAD_BEGIN = 1
+UPLOAD_CHUNK = 2
+UPLOAD_END = 3
+
+
+def pack_plane(pixels: list[int], bpp: int) -> bytes:
+    """Quantise 256 grey values into a packed plane (MSB first)"""
+    if bpp == 8:
+        return bytes(pixels)
+
+    if bpp == 4:
+        return bytes(
+            (pixels[i] & 0xF0) | (pixels[i + 1] >> 4) for i in range(0, PIXELS, 2)
+        )
+
+    plane = bytearray(PIXELS // 8)
+    for i, value in enumerate(pixels):
+        if value >= 0x80:
+            plane[i >> 3] |= 0x80 >> (i & 7)
+    return bytes(plane)
+
+
+def packbits(data: bytes) -> bytes:
+    """PackBits RLE, same encoder as the firmware"""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+
+        if run >= 2:
+            out += bytes([(1 - run) & 0xFF, data[i]])
+            i += run
+            continue
+
+        start = i
+        while i < len(data) and i - start < 128:
+            if i + 1 < len(data) and data[i] == data[i + 1]:
+                break
+            i += 1
+
+        out.append(i - start - 1)
+        out += data[start:i]
+    return bytes(out)
+
+
+def encode_container(
+    frames: list[list[int]],
+    delays: list[int],
+    bpp: int,
+    default_delay: int,
+    loop_start: int = 0,
+    keyframe_interval: int = 32,
+) -> bytes:
+    """Encode frames into the firmware's OBA1 container (see include/animationstore.h)"""
+    if loop_start >= len(frames):
+        loop_start = 0
+
+    out = bytearray(b"OBA1")
+    out += struct.pack("<BBHHH4x", 1, bpp, len(frames), loop_start, default_delay)
+
+    previous: bytes | None = None
+    since_key = 0
+    for index, pixels in enumerate(frames):
+        plane = pack_plane(pixels, bpp)
+        delay = delays[index] if index < len(delays) else 0
+        record: tuple[int, bytes] | None = None
+
+        keyframe = index == 0 or index == loop_start or since_key >= keyframe_interval
+        if not keyframe and previous is not None:
+            delta = packbits(bytes(a ^ b for a, b in zip(previous, plane)))
+            if len(delta) < len(plane):
+                record = (FRAME_DELTA | FRAME_RLE, delta)
+                since_key += 1
+
+        if record is None:
+            rle = packbits(plane)
+            record = (FRAME_RLE, rle) if len(rle) < len(plane) else (0, plane)
+            since_key = 1
+
+        frame_type, payload = record
+        out += struct.pack("<BHH", frame_type, delay, len(payload)) + payload
+        previous = plane
+
+    return bytes(out)
+
+
+def upload_message(opcode: int, seq: int, payload: bytes = b"") -> bytes:
+    return struct.pack("<BBH", UPLOAD_MAGIC, opcode, seq) + payload
+
+
+def upload(ip: str, container: bytes, chunk_size: int = 4096, retries: int = 5) -> dict:
+    """Upload a container with the chunked protocol over HTTP, resuming on errors"""
+    url = f"http://{ip}/api/animation/upload"
+    session = requests.Session()
+
+    def send(message: bytes) -> dict:
+        response = session.post(
+            url,
+            data=message,
+            headers={"Content-Type": "application/octet-stream"},
+            timeout=10,
+        )
+        reply = response.json()
+        if reply.get("status") == "error":
+            raise RuntimeError(reply.get("message", "upload error"))
+        return reply
+
+    total_crc = zlib.crc32(container)
+    reply = send(
+        upload_message(UPLOAD_BEGIN, 0, struct.pack("<II", len(container), total_crc))
+    )
+    offset, seq = reply["offset"], reply["seq"]
+    failures = 0
+
+    while offset < len(container):
+        data = container[offset : offset + chunk_size]
+        message = upload_message(
+            UPLOAD_CHUNK, seq, struct.pack("<II", offset, zlib.crc32(data)) + data
+        )
+        try:
+            reply = send(message)
+        except requests.RequestException as e:
+            failures += 1
+            if failures > retries:
+                raise
+            logger.warning(f"Chunk at {offset} failed ({e}), resuming")
+            reply = send(
+                upload_message(
+                    UPLOAD_BEGIN, seq, struct.pack("<II", len(container), total_crc)
+                )
+            )
+
+        offset, seq = reply["offset"], reply["seq"]
+        logger.info(f"{offset}/{len(container)} bytes")
+
+    return send(upload_message(UPLOAD_END, seq))
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="Encode an animation and upload it into the lamp's flash"
+    )
+    parser.add_argument("file", help="JSON export of the web creator ({frames: [...]})")
+    parser.add_argument("--ip", type=str, default="192.168.178.50")
+    parser.add_argument("--bpp", type=int, choices=(1, 4, 8), default=1)
+    parser.add_argument("--delay", type=int, default=400, help="Default delay in ms")
+    parser.add_argument("--loop-start", type=int, default=0)
+    parser.add_argument("--chunk", type=int, default=4096, help="Chunk size in bytes")
+    parser.add_argument("-o", "--output", type=str, help="Only write the container")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO if args.verbose else logging.WARNING)
+
+    with open(args.file) as f:
+        data = json.load(f)
+
+    # the creator stores 0/1 per pixel, scale those up to full brightness
+    frames = [
+        [255 if v == 1 else max(0, min(255, int(v))) for v in frame]
+        for frame in data["frames"]
+    ]
+    delays = data.get("delays", [])
+
+    container = encode_container(frames, delays, args.bpp, args.delay, args.loop_start)
+    logger.info(f"{len(frames)} frames encoded into {len(container)} bytes")
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(container)
+        return
+
+    result = upload(args.ip, container, min(args.chunk, 4096))
+    print(f"Uploaded {result.get('frames')} frames")
+
+
+if __name__ == "__main__":
+    main()
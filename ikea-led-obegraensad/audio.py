@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+
+import argparse
+import array
+import logging
+import socket
+import struct
+import sys
+import time
+import wave
+from typing import Callable
+
+logger: logging.Logger = logging.getLogger(__name__)
+
+HEADER = struct.Struct("<2sBBII")
+
+
+def create_packet(samples: array.array, sample_rate: int, sequence: int) -> bytes:
+    """Create a Spectrum audio packet: 12 byte header + 16 bit little endian mono samples"""
+    if sys.byteorder != "little":
+        samples = array.array("h", samples)
+        samples.byteswap()
+    return HEADER.pack(b"AU", 1, 1, sample_rate, sequence & 0xFFFFFFFF) + samples.tobytes()
+
+
+def to_mono(frames: bytes, channels: int) -> array.array:
+    """Average interleaved 16 bit frames down to one channel"""
+    samples = array.array("h", frames)
+    if sys.byteorder != "little":
+        samples.byteswap()
+    if channels == 1:
+        return samples
+    return array.array(
+        "h",
+        (
+            sum(samples[i : i + channels]) // channels
+            for i in range(0, len(samples) - channels + 1, channels)
+        ),
+    )
+
+
+def stream(
+    read_frames: Callable[[int], bytes],
+    ip: str,
+    port: int,
+    sample_rate: int,
+    channels: int,
+    chunk: int,
+) -> int:
+    """Send chunk sized packets paced to the sample rate, returns the packets sent"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sequence = 0
+    period = chunk / sample_rate
+    next_send = time.monotonic()
+    try:
+        while True:
+            frames: bytes = read_frames(chunk)
+            frames = frames[: len(frames) - len(frames) % (2 * channels)]
+            if not frames:
+                break
+            samples = to_mono(frames, channels)
+
+            # real time pacing; a sender that falls behind skips ahead instead of bursting
+            delay = next_send - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            elif delay < -0.1:
+                next_send = time.monotonic()
+            next_send += period
+
+            sock.sendto(create_packet(samples, sample_rate, sequence), (ip, port))
+            sequence += 1
+            logger.debug(f"Sent packet {sequence} with {len(samples)} samples")
+    finally:
+        sock.close()
+    return sequence
+
+
+def create_arg_parser() -> argparse.ArgumentParser:
+    parser = argparse.ArgumentParser(
+        description="Stream audio to the Spectrum plugin",
+        epilog="Live input: ffmpeg -f pulse -i default -ac 1 -ar 16000 -f s16le - "
+        "| python3 audio.py --ip 192.168.178.50 -",
+    )
+    parser.add_argument(
+        "source",
+        type=str,
+        help="WAV file (16 bit PCM), or - for raw 16 bit little endian PCM on stdin",
+    )
+    parser.add_argument(
+        "--ip", type=str, default="192.168.178.50", help="IP address of the display"
+    )
+    parser.add_argument("--port", type=int, default=4049, help="UDP port")
+    parser.add_argument(
+        "--rate",
+        type=int,
+        default=16000,
+        help="Sample rate of raw stdin input (16000-22050 recommended)",
+    )
+    parser.add_argument(
+        "--channels", type=int, default=1, help="Channels of raw stdin input"
+    )
+    parser.add_argument(
+        "--chunk",
+        type=int,
+        default=128,
+        help="Samples per packet; smaller means less latency (128 = 8 ms at 16 kHz)",
+    )
+    parser.add_argument(
+        "--loop", action="store_true", help="Repeat the WAV file until interrupted"
+    )
+    parser.add_argument(
+        "-d", "--debug", action="store_true", help="Enable debug logging"
+    )
+    parser.add_argument(
+        "-v", "--verbose", action="store_true", help="Enable verbose logging"
+    )
+    return parser
+
+
+def main() -> None:
+    parser: argparse.ArgumentParser = create_arg_parser()
+    args: argparse.Namespace = parser.parse_args()
+
+    logging.basicConfig(
+        level=logging.DEBUG
+        if args.debug
+        else logging.INFO
+        if args.verbose
+        else logging.WARNING
+    )
+
+    if not 1 <= args.chunk <= 512:
+        parser.error("Chunk must be between 1 and 512 samples")
+
+    try:
+        if args.source == "-":
+            channels: int = args.channels
+            logger.info(f"Streaming stdin at {args.rate} Hz to {args.ip}:{args.port}")
+            stream(
+                lambda frames: sys.stdin.buffer.read(frames * 2 * channels),
+                args.ip,
+                args.port,
+                args.rate,
+                channels,
+                args.chunk,
+            )
+            return
+
+        while True:
+            with wave.open(args.source, "rb") as wav:
+                if wav.getsampwidth() != 2:
+                    parser.error("Only 16 bit PCM WAV files are supported")
+                rate: int = wav.getframerate()
+                if not 8000 <= rate <= 48000:
+                    parser.error(f"Unsupported sample rate {rate} Hz")
+                if rate > 22050:
+                    logger.warning(
+                        f"{rate} Hz works, but 16000-22050 Hz gives finer bass bands"
+                    )
+                logger.info(f"Streaming {args.source} at {rate} Hz to {args.ip}:{args.port}")
+                stream(
+                    wav.readframes,
+                    args.ip,
+                    args.port,
+                    rate,
+                    wav.getnchannels(),
+                    args.chunk,
+                )
+            if not args.loop:
+                break
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
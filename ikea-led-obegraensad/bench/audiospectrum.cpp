@@ -0,0 +1,125 @@
+/**
+ * Host benchmark and sanity check for the Spectrum plugin's FFT (src/audiospectrum.cpp).
+ *
+ *   g++ -O2 -Iinclude bench/audiospectrum.cpp src/audiospectrum.cpp -o /tmp/spectrum-bench
+ *   /tmp/spectrum-bench
+ *
+ * Prints the time per transform() and per analyze(), the FFT error against a double precision
+ * DFT, and which band a sweep of test tones lands in.
+ */
+
+#include "audiospectrum.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+static double elapsedNs(std::chrono::steady_clock::time_point start, int runs)
+{
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 start);
+  return (double)ns.count() / runs;
+}
+
+static void pushTone(AudioSpectrum &audio, float hz, float amplitude, int samples)
+{
+  static uint32_t phase = 0;
+  int16_t block[64];
+  for (int done = 0; done < samples; done += 64)
+  {
+    for (int i = 0; i < 64; i++, phase++)
+    {
+      block[i] = (int16_t)(amplitude * 32767 * sinf(2 * (float)M_PI * hz * phase /
+                                                    audio.getSampleRate()));
+    }
+    audio.push(block, 64);
+  }
+}
+
+int main()
+{
+  static AudioSpectrum audio;
+  int16_t re[AUDIO_FFT_SIZE];
+  int16_t im[AUDIO_FFT_SIZE];
+  uint8_t levels[AUDIO_BANDS];
+
+  // accuracy: random input against a float DFT of the same data
+  uint32_t seed = 12345;
+  double input[AUDIO_FFT_SIZE];
+  for (int i = 0; i < AUDIO_FFT_SIZE; i++)
+  {
+    seed = seed * 1664525 + 1013904223;
+    re[i] = (int16_t)(seed >> 16) / 2;
+    im[i] = 0;
+    input[i] = re[i];
+  }
+  audio.transform(re, im);
+  double worst = 0;
+  for (int k = 0; k < AUDIO_FFT_SIZE / 2; k++)
+  {
+    double sr = 0;
+    double si = 0;
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+      sr += input[n] * cos(2 * M_PI * k * n / AUDIO_FFT_SIZE);
+      si -= input[n] * sin(2 * M_PI * k * n / AUDIO_FFT_SIZE);
+    }
+    double error = hypot(re[k] - sr / AUDIO_FFT_SIZE, im[k] - si / AUDIO_FFT_SIZE);
+    worst = error > worst ? error : worst;
+  }
+  printf("transform: worst bin error %.2f LSB\n", worst);
+
+  const int runs = 20000;
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; run++)
+  {
+    re[run & (AUDIO_FFT_SIZE - 1)] ^= 1;
+    audio.transform(re, im);
+  }
+  printf("transform: %.2f us per %u point FFT\n", elapsedNs(start, runs) / 1000, AUDIO_FFT_SIZE);
+
+  pushTone(audio, 1000, 0.5f, AUDIO_RING_SIZE);
+  start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; run++)
+  {
+    audio.analyze(levels);
+  }
+  printf("analyze:   %.2f us per frame\n\n", elapsedNs(start, runs) / 1000);
+
+  const uint32_t rates[] = {16000, 22050};
+  for (uint32_t rate : rates)
+  {
+    audio.setSampleRate(rate);
+    printf("%u Hz, band edges in bins:", rate);
+    for (int band = 0; band <= AUDIO_BANDS; band++)
+    {
+      printf(" %u", audio.getBandStart(band));
+    }
+    printf("\n");
+
+    const float tones[] = {80, 250, 1000, 4000, 7000};
+    const float amplitudes[] = {1.0f, 0.01f};
+    for (float amplitude : amplitudes)
+    {
+      for (float tone : tones)
+      {
+        audio.reset();
+        pushTone(audio, tone, amplitude, AUDIO_RING_SIZE);
+        audio.analyze(levels);
+        int loudest = 0;
+        for (int band = 1; band < AUDIO_BANDS; band++)
+        {
+          loudest = levels[band] > levels[loudest] ? band : loudest;
+        }
+        printf("  %5.0f Hz at %5.1f dBFS: band %2d, ceiling %5.2f, levels", tone,
+               20 * log10f(amplitude), loudest, audio.getCeiling() / 256.0f);
+        for (int band = 0; band < AUDIO_BANDS; band++)
+        {
+          printf(" %3u", levels[band]);
+        }
+        printf("\n");
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,687 @@
+#!/usr/bin/env python3
+
+import argparse
+import hashlib
+import json
+import logging
+import math
+import random
+import socket
+import struct
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from typing import Any, Callable
+
+import requests
+from requests.auth import HTTPDigestAuth
+
+logger: logging.Logger = logging.getLogger(__name__)
+
+ROWS = 16
+COLS = 16
+
+MDNS_GROUP = "224.0.0.251"
+MDNS_PORT = 5353
+MDNS_SERVICE = "_http._tcp.local"
+DNS_PTR = 12
+DNS_A = 1
+DNS_SRV = 33
+
+DDP_PORT = 4048
+DDP_HEADER = bytes([0x41, 0x00] + [0x00] * 8)
+
+
+@dataclass
+class Lamp:
+    host: str
+    name: str = ""
+    groups: list[str] = field(default_factory=list)
+
+
+@dataclass
+class Result:
+    lamp: Lamp
+    ok: bool
+    attempts: int
+    elapsed: float
+    detail: Any = None
+    error: str = ""
+
+
+# mDNS discovery (plain sockets, no zeroconf dependency)
+
+
+def encode_name(name: str) -> bytes:
+    out = b""
+    for label in name.rstrip(".").split("."):
+        out += bytes([len(label)]) + label.encode()
+    return out + b"\x00"
+
+
+def decode_name(packet: bytes, offset: int) -> tuple[str, int]:
+    """Read a possibly compressed DNS name, returns the name and the offset behind it"""
+    labels: list[str] = []
+    end = -1
+    for _ in range(128):
+        length = packet[offset]
+        if length & 0xC0 == 0xC0:
+            if end < 0:
+                end = offset + 2
+            offset = ((length & 0x3F) << 8) | packet[offset + 1]
+            continue
+        offset += 1
+        if length == 0:
+            break
+        labels.append(packet[offset : offset + length].decode(errors="replace"))
+        offset += length
+    return ".".join(labels), end if end >= 0 else offset
+
+
+def parse_records(packet: bytes) -> list[tuple[str, int, bytes, int]]:
+    """All answer/authority/additional records as (name, type, packet, rdata offset)"""
+    _, _, questions, *counts = struct.unpack("!6H", packet[:12])
+    offset = 12
+    for _ in range(questions):
+        _, offset = decode_name(packet, offset)
+        offset += 4
+
+    records = []
+    for _ in range(sum(counts)):
+        name, offset = decode_name(packet, offset)
+        rtype, _, _, length = struct.unpack("!HHIH", packet[offset : offset + 10])
+        offset += 10
+        records.append((name.lower(), rtype, packet, offset))
+        offset += length
+    return records
+
+
+def discover(timeout: float) -> list[Lamp]:
+    """Browse _http._tcp with a legacy unicast mDNS query, answers come to our port"""
+    query = struct.pack("!6H", 0, 0, 1, 0, 0, 0) + encode_name(MDNS_SERVICE)
+    query += struct.pack("!HH", DNS_PTR, 1)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 255)
+    sock.settimeout(0.2)
+
+    instances: dict[str, str] = {}
+    targets: dict[str, str] = {}
+    addresses: dict[str, str] = {}
+    senders: dict[str, str] = {}
+
+    deadline = time.monotonic() + timeout
+    next_query = 0.0
+    try:
+        while time.monotonic() < deadline:
+            # repeat the query, a single datagram gets lost on busy WiFi
+            if time.monotonic() >= next_query:
+                sock.sendto(query, (MDNS_GROUP, MDNS_PORT))
+                next_query = time.monotonic() + 1.0
+            try:
+                packet, (sender, _) = sock.recvfrom(9000)
+            except socket.timeout:
+                continue
+
+            try:
+                for name, rtype, data, offset in parse_records(packet):
+                    if rtype == DNS_PTR and name == MDNS_SERVICE:
+                        instance, _ = decode_name(data, offset)
+                        instances[instance.lower()] = instance.split(".")[0]
+                        senders[instance.lower()] = sender
+                    elif rtype == DNS_SRV:
+                        target, _ = decode_name(data, offset + 6)
+                        targets[name] = target.lower()
+                    elif rtype == DNS_A:
+                        addresses[name] = socket.inet_ntoa(data[offset : offset + 4])
+            except (IndexError, struct.error, OSError) as e:
+                logger.debug(f"Malformed mDNS answer from {sender}: {e}")
+    finally:
+        sock.close()
+
+    lamps: dict[str, Lamp] = {}
+    for instance, name in instances.items():
+        host = addresses.get(targets.get(instance, ""), senders[instance])
+        lamps.setdefault(host, Lamp(host, name))
+    logger.info(f"mDNS: {len(lamps)} HTTP services answered")
+    return list(lamps.values())
+
+
+def load_hosts(path: str) -> list[Lamp]:
+    """One lamp per line: host [group ...], # starts a comment"""
+    lamps = []
+    with open(path) as f:
+        for line in f:
+            parts = line.split("#", 1)[0].split()
+            if parts:
+                lamps.append(Lamp(parts[0], groups=parts[1:]))
+    return lamps
+
+
+# Fan-out
+
+
+def run_all(
+    lamps: list[Lamp],
+    action: Callable[[Lamp], Any],
+    parallel: int,
+    retries: int,
+) -> list[Result]:
+    """Run action for every lamp with bounded parallelism, retrying with backoff"""
+
+    def run(lamp: Lamp) -> Result:
+        start = time.monotonic()
+        attempt = 0
+        while True:
+            attempt += 1
+            try:
+                detail = action(lamp)
+                return Result(lamp, True, attempt, time.monotonic() - start, detail)
+            except Exception as e:
+                # invalid requests do not get better by repeating them
+                permanent = isinstance(e, ValueError) or (
+                    isinstance(e, requests.HTTPError) and e.response.status_code < 500
+                )
+                if permanent or attempt > retries:
+                    elapsed = time.monotonic() - start
+                    return Result(lamp, False, attempt, elapsed, error=str(e))
+                delay = min(8.0, 0.5 * 2 ** (attempt - 1)) * random.uniform(0.5, 1.0)
+                logger.info(f"{lamp.host}: {e}, retrying in {delay:.1f}s")
+                time.sleep(delay)
+
+    with ThreadPoolExecutor(max_workers=max(1, min(parallel, len(lamps)))) as pool:
+        return list(pool.map(run, lamps))
+
+
+def check(response: requests.Response) -> Any:
+    """Raise on HTTP errors and on {"status": "error"} replies, returns the JSON body"""
+    try:
+        body = response.json()
+    except ValueError:
+        body = response.text
+    if isinstance(body, dict) and body.get("status") == "error":
+        raise requests.HTTPError(
+            f"{response.status_code}: {body.get('message', 'error')}", response=response
+        )
+    response.raise_for_status()
+    return body
+
+
+class Api:
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.timeout = args.timeout
+        self.user = args.user
+        self.password = args.password
+
+    def url(self, lamp: Lamp, path: str) -> str:
+        return f"http://{lamp.host}{path}"
+
+    def call(self, method: str, lamp: Lamp, path: str, **kwargs: Any) -> Any:
+        response = requests.request(
+            method, self.url(lamp, path), timeout=self.timeout, **kwargs
+        )
+        return check(response)
+
+    def info(self, lamp: Lamp) -> dict:
+        return self.call("GET", lamp, "/api/info")
+
+    def plugin_id(self, lamp: Lamp, plugin: str) -> int:
+        """Numeric ids pass through, names are looked up on the lamp"""
+        if plugin.isdigit():
+            return int(plugin)
+        for item in self.info(lamp)["plugins"]:
+            if item["name"].lower() == plugin.lower():
+                return item["id"]
+        raise ValueError(f"no plugin named {plugin!r}")
+
+    def set_plugin(self, lamp: Lamp, plugin: str) -> Any:
+        params = {"id": self.plugin_id(lamp, plugin)}
+        return self.call("PATCH", lamp, "/api/plugin", params=params)
+
+    def set_brightness(self, lamp: Lamp, value: int) -> Any:
+        return self.call("PATCH", lamp, "/api/brightness", params={"value": value})
+
+    def set_schedule(self, lamp: Lamp, schedule: list) -> Any:
+        data = {"schedule": json.dumps(schedule)}
+        return self.call("POST", lamp, "/api/schedule", data=data)
+
+    def set_config(self, lamp: Lamp, config: dict) -> Any:
+        return self.call("POST", lamp, "/api/config", json=config)
+
+    def batch(self, lamp: Lamp, ops: list) -> Any:
+        return self.call("POST", lamp, "/api/batch", json=ops)
+
+    def ota(self, lamp: Lamp, firmware: bytes, filesystem: bool, wait: float) -> Any:
+        """The ElegantOTA flow of upload.py: /ota/start with the MD5, then the upload"""
+        md5 = hashlib.md5(firmware).hexdigest()
+        uptime = self.info(lamp).get("uptime", 0)
+
+        auth = None
+        check_auth = requests.get(self.url(lamp, "/update"), timeout=self.timeout)
+        if check_auth.status_code == 401:
+            auth = HTTPDigestAuth(self.user, self.password)
+
+        mode = "fs" if filesystem else "fr"
+        start = requests.get(
+            self.url(lamp, "/ota/start"),
+            params={"mode": mode, "hash": md5},
+            auth=auth,
+            timeout=self.timeout,
+        )
+        start.raise_for_status()
+
+        upload = requests.post(
+            self.url(lamp, "/ota/upload"),
+            data={"MD5": md5},
+            files={"firmware": ("firmware", firmware, "application/octet-stream")},
+            auth=auth,
+            timeout=max(self.timeout, 120),
+        )
+        upload.raise_for_status()
+
+        if wait <= 0:
+            return {"md5": md5}
+
+        # the lamp reboots after the upload, it is done once it answers again after
+        # being unreachable or with a lower uptime
+        deadline = time.monotonic() + wait
+        offline = False
+        while time.monotonic() < deadline:
+            time.sleep(1)
+            try:
+                info = self.info(lamp)
+                if offline or info.get("uptime", 0) < uptime:
+                    return {"md5": md5, "uptime": info.get("uptime")}
+            except requests.RequestException:
+                offline = True
+        raise TimeoutError(f"did not come back within {wait:.0f}s")
+
+
+# DDP group streaming
+
+
+def pattern_frame(pattern: str, t: float, width: int, height: int) -> list[list[int]]:
+    """A grey frame for the whole wall (width x height pixels) at time t"""
+    if pattern == "wave":
+        return [
+            [
+                int(127.5 + 127.5 * math.sin(x * 0.35 + y * 0.2 - t * 4))
+                for x in range(width)
+            ]
+            for y in range(height)
+        ]
+    if pattern == "sweep":
+        column = int(t * 20) % width
+        return [
+            [255 if abs(x - column) < 2 else 0 for x in range(width)]
+            for _ in range(height)
+        ]
+    if pattern == "pulse":
+        value = int(127.5 + 127.5 * math.sin(t * 3))
+        return [[value] * width for _ in range(height)]
+    return [[random.randrange(256) for _ in range(width)] for _ in range(height)]
+
+
+def image_frames(
+    path: str, width: int, height: int
+) -> list[tuple[list[list[int]], float]]:
+    """Scaled grey frames and their durations of an image or GIF, needs Pillow"""
+    try:
+        from PIL import Image, ImageSequence
+    except ImportError:
+        sys.exit("Streaming images needs Pillow (pip install pillow)")
+
+    frames = []
+    with Image.open(path) as image:
+        for frame in ImageSequence.Iterator(image):
+            grey = frame.convert("L").resize((width, height), Image.Resampling.BOX)
+            rows = [
+                [grey.getpixel((x, y)) for x in range(width)] for y in range(height)
+            ]
+            frames.append((rows, frame.info.get("duration", 100) / 1000))
+    return frames
+
+
+def ddp_packet(wall: list[list[int]], tile_x: int, tile_y: int) -> bytes:
+    pixels = bytearray(ROWS * COLS * 3)
+    for y in range(ROWS):
+        row = wall[tile_y * ROWS + y]
+        for x in range(COLS):
+            value = row[tile_x * COLS + x]
+            index = (y * COLS + x) * 3
+            pixels[index : index + 3] = bytes((value, value, value))
+    return DDP_HEADER + pixels
+
+
+def stream(lamps: list[Lamp], args: argparse.Namespace) -> None:
+    """Send every frame to all lamps back to back, paced against one clock"""
+    tiled = args.tile is not None
+    columns, rows = (int(v) for v in args.tile.lower().split("x")) if tiled else (1, 1)
+    if tiled and len(lamps) != columns * rows:
+        sys.exit(f"--tile {args.tile} needs {columns * rows} lamps, got {len(lamps)}")
+    width, height = COLS * columns, ROWS * rows
+
+    # the HTTP port of a host:port entry does not apply to DDP
+    hosts = [lamp.host.split(":")[0] for lamp in lamps]
+    addresses = [(socket.gethostbyname(host), args.port) for host in hosts]
+    # without a wall layout every lamp shows the same frame
+    tiles = [(i % columns, i // columns) for i in range(len(lamps))]
+    if not tiled:
+        tiles = [(0, 0)] * len(lamps)
+
+    frames = image_frames(args.image, width, height) if args.image else None
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    period = 1.0 / args.fps
+    start = time.monotonic()
+    next_frame = start
+    index = 0
+    sent = 0
+
+    try:
+        while args.duration <= 0 or time.monotonic() - start < args.duration:
+            t = time.monotonic() - start
+            if frames:
+                wall, hold = frames[index % len(frames)]
+                index += 1
+            else:
+                wall, hold = pattern_frame(args.pattern, t, width, height), period
+
+            packets: dict[tuple[int, int], bytes] = {}
+            for address, tile in zip(addresses, tiles):
+                if tile not in packets:
+                    packets[tile] = ddp_packet(wall, *tile)
+                sock.sendto(packets[tile], address)
+            sent += 1
+
+            next_frame += max(hold, period)
+            delay = next_frame - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            else:
+                # we fell behind, do not try to catch up with a burst
+                next_frame = time.monotonic()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+
+    logger.warning(f"Sent {sent} frames to {len(lamps)} lamps")
+
+
+# Reporting
+
+
+def summarize(result: Result, command: str) -> str:
+    if not result.ok:
+        return result.error
+    detail = result.detail
+    if command in ("info", "discover") and isinstance(detail, dict):
+        plugins = {p["id"]: p["name"] for p in detail.get("plugins", [])}
+        return (
+            f"plugin={plugins.get(detail.get('plugin'), detail.get('plugin'))} "
+            f"brightness={detail.get('brightness')} uptime={detail.get('uptime')}s"
+        )
+    if isinstance(detail, dict):
+        return detail.get("message") or detail.get("status") or json.dumps(detail)
+    return str(detail)[:60]
+
+
+def report(results: list[Result], command: str, as_json: bool) -> None:
+    if as_json:
+        out = [
+            {
+                "host": r.lamp.host,
+                "name": r.lamp.name,
+                "ok": r.ok,
+                "attempts": r.attempts,
+                "elapsed": round(r.elapsed, 3),
+                "result": r.detail,
+                "error": r.error or None,
+            }
+            for r in results
+        ]
+        print(json.dumps(out, indent=2))
+        return
+
+    width = max([len(r.lamp.host) for r in results] + [4])
+    for r in sorted(results, key=lambda r: (r.ok, r.lamp.host)):
+        status = "ok" if r.ok else "FAILED"
+        tries = f" ({r.attempts} tries)" if r.attempts > 1 else ""
+        print(
+            f"{r.lamp.host:<{width}}  {status:<6} {r.elapsed:6.2f}s  "
+            f"{summarize(r, command)}{tries}"
+        )
+    failed = sum(not r.ok for r in results)
+    print(f"\n{len(results) - failed}/{len(results)} ok, {failed} failed")
+
+
+def create_arg_parser() -> argparse.ArgumentParser:
+    # Use parent parser for common arguments
+    parent_parser = argparse.ArgumentParser(add_help=False)
+    parent_parser.add_argument(
+        "--host",
+        action="append",
+        default=[],
+        help="Lamp address (can be used multiple times)",
+    )
+    parent_parser.add_argument(
+        "--hosts", type=str, help="File with one 'host [group ...]' per line"
+    )
+    parent_parser.add_argument(
+        "-g", "--group", type=str, help="Only lamps of this group"
+    )
+    parent_parser.add_argument(
+        "--discover", action="store_true", help="Add lamps found via mDNS"
+    )
+    parent_parser.add_argument(
+        "--discover-time",
+        type=float,
+        default=3.0,
+        help="How long to listen for mDNS answers",
+    )
+    parent_parser.add_argument(
+        "-p", "--parallel", type=int, default=32, help="Concurrent requests"
+    )
+    parent_parser.add_argument(
+        "-r", "--retries", type=int, default=2, help="Retries per lamp"
+    )
+    parent_parser.add_argument(
+        "--timeout", type=float, default=5.0, help="HTTP timeout in seconds"
+    )
+    parent_parser.add_argument(
+        "--json", action="store_true", help="Print the report as JSON"
+    )
+    parent_parser.add_argument(
+        "-d", "--debug", action="store_true", help="Enable debug logging"
+    )
+    parent_parser.add_argument(
+        "-v", "--verbose", action="store_true", help="Enable verbose logging"
+    )
+
+    # Main parser with subcommands
+    parser = argparse.ArgumentParser(
+        description="Run API calls, OTA updates and DDP streams on many lamps at once"
+    )
+    subparsers = parser.add_subparsers(dest="subcommand", required=True)
+
+    subparsers.add_parser(
+        "discover",
+        help="Find lamps via mDNS and show their state",
+        parents=[parent_parser],
+    )
+    subparsers.add_parser(
+        "info", help="Show the state of every lamp", parents=[parent_parser]
+    )
+
+    plugin_parser: argparse.ArgumentParser = subparsers.add_parser(
+        "plugin", help="Activate a plugin", parents=[parent_parser]
+    )
+    plugin_parser.add_argument("plugin", help="Plugin id or name")
+
+    brightness_parser: argparse.ArgumentParser = subparsers.add_parser(
+        "brightness", help="Set the brightness", parents=[parent_parser]
+    )
+    brightness_parser.add_argument(
+        "value", type=int, choices=range(0, 256), metavar="BRIGHTNESS"
+    )
+
+    schedule_parser: argparse.ArgumentParser = subparsers.add_parser(
+        "schedule", help="Replace the schedule", parents=[parent_parser]
+    )
+    schedule_parser.add_argument(
+        "schedule", help='JSON list like [{"pluginId": 1, "duration": 30}] or @file'
+    )
+
+    config_parser: argparse.ArgumentParser = subparsers.add_parser(
+        "config", help="Apply a configuration", parents=[parent_parser]
+    )
+    config_parser.add_argument("config", help="JSON object or @file")
+
+    batch_parser: argparse.ArgumentParser = subparsers.add_parser(
+        "batch",
+        help="Apply a list of operations at once (POST /api/batch)",
+        parents=[parent_parser],
+    )
+    batch_parser.add_argument("ops", help="JSON list of operations or @file")
+
+    ota_parser: argparse.ArgumentParser = subparsers.add_parser(
+        "ota", help="Upload a firmware image", parents=[parent_parser]
+    )
+    ota_parser.add_argument("firmware", help="firmware.bin (littlefs.bin with --fs)")
+    ota_parser.add_argument(
+        "--fs", action="store_true", help="Upload a filesystem image"
+    )
+    ota_parser.add_argument("--user", type=str, default="admin", help="OTA_USERNAME")
+    ota_parser.add_argument(
+        "--password", type=str, default="ikea-led-wall", help="OTA_PASSWORD"
+    )
+    ota_parser.add_argument(
+        "--wait",
+        type=float,
+        default=90,
+        help="Seconds to wait for the reboot (0: do not wait)",
+    )
+
+    ddp_parser: argparse.ArgumentParser = subparsers.add_parser(
+        "ddp",
+        help="Stream synchronized DDP frames to all lamps",
+        parents=[parent_parser],
+    )
+    ddp_parser.add_argument(
+        "--pattern", choices=("wave", "sweep", "pulse", "noise"), default="wave"
+    )
+    ddp_parser.add_argument(
+        "--image", type=str, help="Image or GIF to stream instead (needs Pillow)"
+    )
+    ddp_parser.add_argument(
+        "--tile", type=str, help="Treat the lamps as a COLSxROWS wall, in host order"
+    )
+    ddp_parser.add_argument("--fps", type=float, default=30.0)
+    ddp_parser.add_argument(
+        "--duration", type=float, default=0, help="Seconds (0: until Ctrl+C)"
+    )
+    ddp_parser.add_argument("--port", type=int, default=DDP_PORT, help="UDP port")
+    ddp_parser.add_argument(
+        "--no-activate",
+        action="store_true",
+        help="Do not switch the lamps to the DDP plugin first",
+    )
+
+    return parser
+
+
+def load_json(value: str) -> Any:
+    if value.startswith("@"):
+        with open(value[1:]) as f:
+            return json.load(f)
+    return json.loads(value)
+
+
+def select_lamps(args: argparse.Namespace) -> list[Lamp]:
+    lamps = [Lamp(host) for host in args.host]
+    if args.hosts:
+        lamps += load_hosts(args.hosts)
+    if args.group:
+        lamps = [lamp for lamp in lamps if args.group in lamp.groups]
+    if args.discover or args.subcommand == "discover":
+        lamps += discover(args.discover_time)
+
+    unique: dict[str, Lamp] = {}
+    for lamp in lamps:
+        unique.setdefault(lamp.host, lamp)
+    return list(unique.values())
+
+
+def main() -> None:
+    parser: argparse.ArgumentParser = create_arg_parser()
+    args: argparse.Namespace = parser.parse_args()
+
+    logging.basicConfig(
+        level=logging.DEBUG
+        if args.debug
+        else logging.INFO
+        if args.verbose
+        else logging.WARNING
+    )
+
+    lamps = select_lamps(args)
+    if not lamps:
+        parser.error("No lamps, use --host, --hosts or --discover")
+
+    if not hasattr(args, "user"):
+        args.user, args.password = None, None
+    api = Api(args)
+
+    actions: dict[str, Callable[[Lamp], Any]] = {
+        "discover": api.info,
+        "info": api.info,
+    }
+    if args.subcommand == "plugin":
+        actions["plugin"] = lambda lamp: api.set_plugin(lamp, args.plugin)
+    elif args.subcommand == "brightness":
+        actions["brightness"] = lambda lamp: api.set_brightness(lamp, args.value)
+    elif args.subcommand == "schedule":
+        schedule = load_json(args.schedule)
+        actions["schedule"] = lambda lamp: api.set_schedule(lamp, schedule)
+    elif args.subcommand == "config":
+        config = load_json(args.config)
+        actions["config"] = lambda lamp: api.set_config(lamp, config)
+    elif args.subcommand == "batch":
+        ops = load_json(args.ops)
+        actions["batch"] = lambda lamp: api.batch(lamp, ops)
+    elif args.subcommand == "ota":
+        with open(args.firmware, "rb") as f:
+            firmware = f.read()
+        actions["ota"] = lambda lamp: api.ota(lamp, firmware, args.fs, args.wait)
+    elif args.subcommand == "ddp":
+        if not args.no_activate:
+            results = run_all(
+                lamps,
+                lambda lamp: api.set_plugin(lamp, "DDP"),
+                args.parallel,
+                args.retries,
+            )
+            if not all(r.ok for r in results):
+                report(results, "plugin", args.json)
+                sys.exit(1)
+        stream(lamps, args)
+        return
+
+    logger.info(f"Running {args.subcommand} on {len(lamps)} lamps")
+    results = run_all(lamps, actions[args.subcommand], args.parallel, args.retries)
+
+    # mDNS finds every HTTP service, only keep the ones that answer like a lamp
+    if args.subcommand == "discover":
+        results = [
+            r
+            for r in results
+            if r.ok and isinstance(r.detail, dict) and "plugins" in r.detail
+        ]
+
+    report(results, args.subcommand, args.json)
+    sys.exit(0 if all(r.ok for r in results) else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -5,14 +5,44 @@
 #include <string>
 #include <vector>
 
+#include "canvas.h"
 #include "screen.h"
 #include "signs.h"
 #include "websocket.h"
+#include "wsframe.h"
+
+// Execution budget bookkeeping of one plugin, maintained by PluginManager
+struct PluginHealth
+{
+  uint32_t overruns = 0;
+  uint32_t worstMs = 0;
+  // overruns since windowStart, PLUGIN_DEMOTE_STRIKES of them within PLUGIN_STRIKE_WINDOW_MS
+  // demote the plugin for PLUGIN_DEMOTION_MS
+  uint8_t strikes = 0;
+  unsigned long windowStart = 0;
+  bool demoted = false;
+  unsigned long demotedAt = 0;
+  // last overrun, e.g. "loop() took 812 ms, budget 200 ms"
+  char reason[48] = "";
+};
+
+constexpr uint8_t PLUGIN_SETUP_BUDGET_FACTOR = 4;
+constexpr uint8_t PLUGIN_DEMOTE_STRIKES = 3;
+constexpr unsigned long PLUGIN_STRIKE_WINDOW_MS = 10UL * 60 * 1000;
+constexpr unsigned long PLUGIN_DEMOTION_MS = 60UL * 60 * 1000;
 
 class Plugin
 {
+  friend class PluginManager;
+
 private:
   int id;
+  PluginHealth health;
+
+protected:
+  // Where setup(), loop() and the hooks draw. The panel unless setCanvas() says otherwise;
+  // plugins never draw through Screen directly.
+  Canvas *canvas;
 
 public:
   Plugin();
@@ -22,13 +52,23 @@ public:
   }
 
   virtual void teardown();
+  // Optional warm-up before a scheduled slot, e.g. prefetching data. Runs on the main loop while
+  // another plugin owns the screen, so it must not draw, and setup() may never follow.
+  virtual void prepare();
   virtual void websocketHook(JsonDocument &request);
+  // Binary frame message from the WebSocket (see wsframe.h), ignored unless the plugin draws it
+  virtual void websocketFrameHook(const WsFrame &frame);
   virtual void setup() = 0;
   virtual void loop();
   virtual const char *getName() const = 0;
 
   void setId(int id);
   int getId() const;
+  const PluginHealth &getHealth() const;
+
+  // Renders the following calls into target, e.g. an OffscreenCanvas for a thumbnail
+  void setCanvas(Canvas &target);
+  Canvas &getCanvas() const;
 };
 
 class PluginManager
@@ -39,7 +79,23 @@ private:
   int nextPluginId;
   int persistedPluginId = 1;
 
-  void renderPluginId(int pluginId);
+  // how long the number of a newly selected plugin stays up before its setup() runs
+  static constexpr unsigned long PLUGIN_ID_DISPLAY_MS = 800;
+  volatile bool setupPending = false;
+  unsigned long setupRequestedAt = 0;
+  // set while init() starts the persisted plugin, nobody needs its number at power-on
+  bool booting = false;
+
+  // the setup()/loop() call in progress on the render task, watched by checkBudget()
+  Plugin *volatile runningPlugin = nullptr;
+  volatile bool runningSetup = false;
+  volatile unsigned long runStartedAt = 0;
+  volatile bool stallReported = false;
+
+  bool renderPluginId(int pluginId);
+  void startActivePlugin();
+  void runMeasured(Plugin *plugin, bool isSetup);
+  void recordOverrun(Plugin *plugin, const char *reason);
 
 public:
   PluginManager();
@@ -48,14 +104,21 @@ public:
   int addPlugin(Plugin *plugin);
   void setActivePlugin(const char *pluginName);
   void setActivePluginById(int pluginId);
-  void runActivePlugin();
+  // true when the active plugin's loop() ran, false while nothing can draw yet
+  bool runActivePlugin();
   void setupActivePlugin();
+  void preparePluginById(int pluginId);
   void activateNextPlugin();
   void persistActivePlugin();
   void init();
   void activatePersistedPlugin();
   int getPersistedPluginId();
   Plugin *getActivePlugin() const;
+  // Warns about a setup()/loop() that is still running far beyond its budget, from the other core
+  void checkBudget();
+  // Repeated budget overruns, the scheduler skips demoted plugins until the demotion expires
+  bool isDemoted(int pluginId) const;
+  void healthToJson(const Plugin *plugin, JsonObject object) const;
   std::vector<Plugin *> &getAllPlugins();
   size_t getNumPlugins();
 };
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "constants.h"
+#include <Arduino.h>
+
+#ifdef ENABLE_STORAGE
+#include <FS.h>
+#endif
+
+/**
+ * Binary animation container ("OBA1") kept on the LittleFS partition. Builds without storage
+ * (ESP8266) keep it in the heap instead, see RamAnimationFile.
+ *
+ * Header (16 bytes, little endian):
+ *   0  magic "OBA1"
+ *   4  version (1)
+ *   5  bits per pixel (1, 4 or 8)
+ *   6  frame count (uint16)
+ *   8  loop start frame (uint16) - playback jumps back here after the last frame
+ *   10 default frame delay in ms (uint16)
+ *   12 reserved (4 bytes)
+ *
+ * Every frame is a 5 byte record header followed by its payload:
+ *   0  type (ANIM_FRAME_*)
+ *   1  delay in ms (uint16, 0 = default delay)
+ *   3  payload length (uint16)
+ *
+ * A payload decodes to a packed plane of ROWS * COLS * bpp / 8 bytes (MSB first). Keyframes
+ * replace the plane, delta frames are XORed onto the previous one. Both may be PackBits RLE
+ * compressed. The frame at the loop start is always a keyframe so looping never needs history.
+ */
+
+#define ANIMATION_PATH "/anim.oba"
+#define ANIMATION_TMP_PATH "/anim.tmp"
+
+constexpr uint8_t ANIM_HEADER_SIZE = 16;
+constexpr uint8_t ANIM_FRAME_HEADER_SIZE = 5;
+constexpr uint8_t ANIM_VERSION = 1;
+
+constexpr uint8_t ANIM_FRAME_RLE = 0x01;
+constexpr uint8_t ANIM_FRAME_DELTA = 0x02;
+
+constexpr uint16_t ANIM_MAX_PLANE_SIZE = ROWS * COLS;
+// PackBits worst case: one control byte per 128 literals
+constexpr uint16_t ANIM_MAX_PAYLOAD_SIZE = ANIM_MAX_PLANE_SIZE + ANIM_MAX_PLANE_SIZE / 128 + 1;
+
+struct AnimationHeader
+{
+  uint8_t bitsPerPixel = 1;
+  uint16_t frameCount = 0;
+  uint16_t loopStart = 0;
+  uint16_t defaultDelay = 400;
+};
+
+inline uint16_t animationPlaneSize(uint8_t bitsPerPixel)
+{
+  return ROWS * COLS * bitsPerPixel / 8;
+}
+
+bool parseAnimationHeader(const uint8_t *raw, AnimationHeader &header);
+void writeAnimationHeader(uint8_t *raw, const AnimationHeader &header);
+
+// Quantise 256 grey values into a packed plane and back
+void packAnimationPlane(const uint8_t *pixels, uint8_t bitsPerPixel, uint8_t *plane);
+void unpackAnimationPlane(const uint8_t *plane, uint8_t bitsPerPixel, uint8_t *pixels);
+
+size_t packBitsEncode(const uint8_t *in, size_t len, uint8_t *out);
+// Returns the number of bytes written to out, 0 when the input is malformed or exceeds outLen
+size_t packBitsDecode(const uint8_t *in, size_t len, uint8_t *out, size_t outLen);
+
+#ifdef ENABLE_STORAGE
+typedef File AnimationFile;
+#else
+// Largest container a build without storage holds in RAM; the upload in progress gets its own
+// buffer, so an upload briefly needs twice this. Containers are gone after a reboot.
+constexpr size_t ANIMATION_RAM_BYTES = 4096;
+
+struct RamAnimationEntry;
+
+// The part of fs::File the animation code uses, over a heap buffer of at most
+// ANIMATION_RAM_BYTES; writes past it fail like a full flash
+class RamAnimationFile
+{
+private:
+  RamAnimationEntry *entry = nullptr;
+  size_t position = 0;
+
+public:
+  RamAnimationFile() = default;
+  explicit RamAnimationFile(RamAnimationEntry *entry) : entry(entry) {}
+
+  explicit operator bool() const { return entry != nullptr; }
+  size_t read(uint8_t *buffer, size_t length);
+  size_t write(const uint8_t *buffer, size_t length);
+  bool seek(uint32_t offset);
+  size_t size() const;
+  void close();
+};
+
+typedef RamAnimationFile AnimationFile;
+#endif
+
+class AnimationReader;
+
+class AnimationStore_
+{
+private:
+  AnimationStore_() = default;
+
+  bool mounted = false;
+  uint32_t generation = 0;
+  AnimationReader *activeReader = nullptr;
+#ifdef ESP32
+  SemaphoreHandle_t mutex = nullptr;
+#endif
+
+public:
+  static AnimationStore_ &getInstance();
+
+  AnimationStore_(const AnimationStore_ &) = delete;
+  AnimationStore_ &operator=(const AnimationStore_ &) = delete;
+
+  bool begin();
+  bool isAvailable() const;
+  bool hasAnimation();
+  bool remove();
+  size_t getFileSize();
+
+  void lock();
+  void unlock();
+
+  // Checks the header and every record length of a container written outside the writer
+  bool validate(const char *path, AnimationHeader &header);
+
+  // called with the lock held when a new container replaces the live one
+  void publish(const char *tmpPath);
+  uint32_t getGeneration() const;
+
+  void attachReader(AnimationReader *reader);
+  void detachReader(AnimationReader *reader);
+};
+
+/**
+ * Plays a container straight from flash. RAM use is one packed plane plus a small read buffer,
+ * independent of the number of frames.
+ */
+class AnimationReader
+{
+private:
+  AnimationHeader header;
+  uint16_t planeSize = 0;
+  uint16_t frameIndex = 0;
+  uint32_t loopOffset = ANIM_HEADER_SIZE;
+  uint32_t openedGeneration = 0;
+  bool wantOpen = false;
+  uint8_t plane[ANIM_MAX_PLANE_SIZE];
+
+  AnimationFile file;
+  uint8_t io[64];
+  uint8_t ioLength = 0;
+  uint8_t ioPosition = 0;
+  uint16_t payloadRemaining = 0;
+
+  bool openLocked();
+  void closeLocked();
+  bool readExact(uint8_t *dst, size_t len);
+  bool nextPayloadByte(uint8_t &value);
+  bool decodePayload(uint8_t type, uint16_t length);
+
+  friend class AnimationStore_;
+
+public:
+  ~AnimationReader();
+
+  bool open();
+  void close();
+  bool isOpen() const;
+
+  // Decodes the next frame into 256 grey values and returns its delay in ms
+  bool nextFrame(uint8_t *pixels, uint16_t &delayMs);
+
+  const AnimationHeader &getHeader() const;
+};
+
+/**
+ * Encodes frames into a temporary container and swaps it in on commit(), so a failed or
+ * aborted upload leaves the previous animation untouched. Writers that can be open at the same
+ * time need their own temporary path.
+ */
+class AnimationWriter
+{
+private:
+  AnimationHeader header;
+  uint16_t planeSize = 0;
+  uint16_t keyframeInterval = 32;
+  uint16_t framesSinceKey = 0;
+  bool active = false;
+  const char *tmpPath;
+  uint8_t previous[ANIM_MAX_PLANE_SIZE];
+  uint8_t current[ANIM_MAX_PLANE_SIZE];
+  uint8_t encoded[ANIM_MAX_PAYLOAD_SIZE];
+
+  AnimationFile file;
+
+  bool writeFrame(uint8_t type, uint16_t delayMs, const uint8_t *payload, uint16_t length);
+
+public:
+  explicit AnimationWriter(const char *tmpPath = ANIMATION_TMP_PATH);
+  ~AnimationWriter();
+
+  bool begin(uint8_t bitsPerPixel,
+             uint16_t defaultDelay,
+             uint16_t loopStart = 0,
+             uint16_t keyframeInterval = 32);
+  bool addFrame(const uint8_t *pixels, uint16_t delayMs = 0);
+  bool commit();
+  void abort();
+  bool isActive() const;
+  uint16_t getFrameCount() const;
+};
+
+extern AnimationStore_ &AnimationStore;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "constants.h"
+
+#ifdef ENABLE_SERVER
+
+#include <ArduinoJson.h>
+
+#include "animationstore.h"
+
+/**
+ * Resumable chunked upload of a binary animation container (see animationstore.h).
+ *
+ * Every message is binary and starts with a 4 byte header:
+ *   0  UPLOAD_MAGIC
+ *   1  opcode (UPLOAD_BEGIN, UPLOAD_CHUNK, UPLOAD_END, UPLOAD_ABORT)
+ *   2  sequence number (uint16, little endian)
+ *
+ * BEGIN carries the container size and CRC32 (uint32 each). Repeating BEGIN with the same size
+ * and CRC resumes an interrupted session at the acknowledged offset.
+ * CHUNK carries the file offset and CRC32 of its data (uint32 each) followed by up to
+ * UPLOAD_MAX_CHUNK data bytes. Chunks are written straight to flash, never buffered beyond one.
+ * END verifies size, CRC and container structure, then swaps the animation in.
+ *
+ * Every message is answered with {"event":"upload","status":...,"seq":...,"offset":...,"window":...}.
+ * "offset" is the number of bytes safely written and "window" the number of unacknowledged
+ * chunks the sender may have in flight. On "retry" the sender rewinds to "offset" / "seq".
+ */
+
+constexpr uint8_t UPLOAD_MAGIC = 0xA5;
+constexpr uint8_t UPLOAD_BEGIN = 1;
+constexpr uint8_t UPLOAD_CHUNK = 2;
+constexpr uint8_t UPLOAD_END = 3;
+constexpr uint8_t UPLOAD_ABORT = 4;
+
+constexpr uint8_t UPLOAD_HEADER_SIZE = 4;
+constexpr uint16_t UPLOAD_MAX_CHUNK = 4096;
+constexpr uint16_t UPLOAD_MAX_MESSAGE = UPLOAD_HEADER_SIZE + 8 + UPLOAD_MAX_CHUNK;
+constexpr unsigned long UPLOAD_SESSION_TIMEOUT_MS = 120000;
+
+#define ANIMATION_UPLOAD_PATH "/anim.up"
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len);
+
+class AnimationUpload_
+{
+private:
+  AnimationUpload_() = default;
+
+  bool active = false;
+  uint32_t totalSize = 0;
+  uint32_t totalCrc = 0;
+  uint32_t received = 0;
+  uint32_t runningCrc = 0;
+  uint16_t nextSeq = 0;
+  unsigned long lastActivity = 0;
+
+#ifdef ENABLE_STORAGE
+  File file;
+#endif
+
+  void begin(uint16_t seq, const uint8_t *payload, size_t len, JsonDocument &reply);
+  void chunk(uint16_t seq, const uint8_t *payload, size_t len, JsonDocument &reply);
+  void end(uint16_t seq, JsonDocument &reply);
+  void abort();
+  void fillReply(JsonDocument &reply, const char *status, uint16_t seq);
+
+public:
+  static AnimationUpload_ &getInstance();
+
+  AnimationUpload_(const AnimationUpload_ &) = delete;
+  AnimationUpload_ &operator=(const AnimationUpload_ &) = delete;
+
+  static bool isUploadMessage(const uint8_t *data, size_t len);
+
+  // Handles one complete protocol message and fills the acknowledgement
+  void handleMessage(const uint8_t *data, size_t len, JsonDocument &reply);
+
+  bool isActive() const;
+  uint32_t getReceived() const;
+  uint32_t getTotalSize() const;
+};
+
+extern AnimationUpload_ &AnimationUpload;
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "constants.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * Bounded memory for request-scoped work, so short-lived JSON documents and response strings do
+ * not leave holes between the long-lived allocations on the heap.
+ *
+ * A JsonArena borrows one of JSON_ARENA_COUNT static blocks for its scope and serves
+ * ArduinoJson as a bump allocator: allocating moves an offset, the most recent allocation grows
+ * and shrinks in place, everything is dropped at once when the arena goes out of scope. The
+ * serialized response is written into the rest of the same block. When a document outgrows the
+ * block, or every block is taken by another task, allocations spill to the heap and are counted
+ * (see /api/heap), so JSON_ARENA_SIZE can be tuned from real numbers.
+ *
+ * Declare the arena before the documents using it, they must be destroyed first:
+ *
+ *   JsonArena arena;
+ *   JsonDocument doc(&arena);
+ *   ...
+ *   request->send(200, "application/json", arena.serialize(doc));
+ */
+
+#ifdef ESP32
+constexpr uint8_t JSON_ARENA_COUNT = 3;
+constexpr size_t JSON_ARENA_SIZE = 8192;
+#else
+constexpr uint8_t JSON_ARENA_COUNT = 1;
+constexpr size_t JSON_ARENA_SIZE = 4096;
+#endif
+
+class JsonArena : public ArduinoJson::Allocator
+{
+private:
+  uint8_t *block = nullptr;
+  uint8_t index = 0;
+  size_t used = 0;
+  // offset of the most recent allocation, the only one that can grow or be freed in place
+  size_t last = SIZE_MAX;
+  size_t peak = 0;
+  uint32_t spills = 0;
+  // serialize() result when it does not fit into the block
+  String overflow;
+
+  bool owns(const void *pointer) const;
+
+public:
+  JsonArena();
+  ~JsonArena();
+
+  JsonArena(const JsonArena &) = delete;
+  JsonArena &operator=(const JsonArena &) = delete;
+
+  void *allocate(size_t size) override;
+  void deallocate(void *pointer) override;
+  void *reallocate(void *pointer, size_t newSize) override;
+
+  // Serializes into the unused rest of the block; the text lives as long as the arena
+  const char *serialize(JsonVariantConst json);
+
+  // {"blocks", "blockSize", "uses", "busy", "spills", "peak"} since boot
+  static void statsToJson(JsonObject object);
+};
+
+#ifdef ESP32
+
+/**
+ * Keeps TLS_RESERVE_BYTES of contiguous heap for mbedTLS while no TLS connection is open, when
+ * config.getTlsReserve() asks for it.
+ *
+ * mbedTLS allocates its ~40 KB of record buffers and contexts from the heap inside the
+ * precompiled framework, so it cannot be handed a private arena. Instead the block is taken at
+ * boot, while the heap is still in one piece, and released right before a handshake: the
+ * buffers then land in the hole it leaves, however fragmented the rest of the heap is. Nothing
+ * guarantees that they do, and the block is missing to WiFi, AsyncTCP and the image decoder the
+ * rest of the time, so it is off by default.
+ */
+constexpr size_t TLS_RESERVE_BYTES = 44 * 1024;
+
+class TlsReserve_
+{
+private:
+  TlsReserve_() = default;
+
+  void *block = nullptr;
+  uint32_t failures = 0;
+
+public:
+  static TlsReserve_ &getInstance();
+
+  TlsReserve_(const TlsReserve_ &) = delete;
+  TlsReserve_ &operator=(const TlsReserve_ &) = delete;
+
+  // Takes the block back after the TLS connection closed, false when the heap had no such block
+  // or the reserve is switched off (which hands back a block still held)
+  bool reserve();
+  // Frees the block for the handshake that follows
+  void release();
+
+  void toJson(JsonObject object) const;
+};
+
+extern TlsReserve_ &TlsReserve;
+
+#endif
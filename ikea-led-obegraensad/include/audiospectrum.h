@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Audio analysis behind the Spectrum plugin: a PCM ring buffer, a fixed-point FFT and 16
+ * log-spaced bands with automatic gain control.
+ *
+ * The network side pushes 16 bit mono samples into the ring buffer; the render task calls
+ * analyze() once per frame, which always looks at the newest AUDIO_FFT_SIZE samples, so old
+ * audio is never queued up behind new audio. At 16 kHz the window is 16 ms long.
+ *
+ * The FFT is an in-place radix-2 transform on Q15 integers that halves the values after every
+ * stage so nothing overflows. To keep quiet signals from drowning in that scaling, the
+ * windowed block is first shifted up to use the full 16 bit range and the shift is taken out
+ * again in the log domain (block floating point). Band powers are compared in log2 (8.8 fixed
+ * point, 1.0 = 3 dB); the AGC follows the loudest band with an instant attack and a slow
+ * release and maps the 42 dB below it to 0-255.
+ *
+ * push() may run on another core than analyze(); the write counter is published with release
+ * semantics after the samples, which is enough for one producer and one consumer.
+ */
+
+constexpr uint16_t AUDIO_FFT_SIZE = 256;
+constexpr uint8_t AUDIO_FFT_BITS = 8;
+constexpr uint16_t AUDIO_RING_SIZE = 1024; // power of two
+constexpr uint8_t AUDIO_BANDS = 16;
+constexpr uint32_t AUDIO_MIN_RATE = 8000;
+constexpr uint32_t AUDIO_MAX_RATE = 48000;
+
+class AudioSpectrum
+{
+private:
+  int16_t ring[AUDIO_RING_SIZE] = {0};
+  uint32_t written = 0;
+  uint32_t sampleRate = 0;
+
+  int16_t window[AUDIO_FFT_SIZE];
+  int32_t windowSum = 0;
+  int16_t cosTable[AUDIO_FFT_SIZE / 2];
+  int16_t sinTable[AUDIO_FFT_SIZE / 2];
+  uint8_t reversed[AUDIO_FFT_SIZE];
+  int16_t real[AUDIO_FFT_SIZE];
+  int16_t imag[AUDIO_FFT_SIZE];
+  uint8_t bandStart[AUDIO_BANDS + 1];
+
+  // log2 power, 8.8 fixed point
+  int32_t ceiling = 0;
+  int32_t bandLog[AUDIO_BANDS] = {0};
+
+public:
+  AudioSpectrum();
+
+  // Consumer side: recomputes the band edges for the new rate, clamped to the supported range
+  void setSampleRate(uint32_t hz);
+  uint32_t getSampleRate() const { return sampleRate; }
+  // Silence in the ring buffer, AGC back to its floor
+  void reset();
+
+  // Producer side: little endian 16 bit samples, no alignment needed
+  void push(const uint8_t *pcm, size_t samples);
+  void push(const int16_t *samples, size_t count);
+  // Samples pushed so far; wraps around
+  uint32_t getWritten() const;
+
+  // Forward FFT in place, Q15 in, result scaled by 1 / AUDIO_FFT_SIZE
+  void transform(int16_t *re, int16_t *im) const;
+
+  // Spectrum of the newest AUDIO_FFT_SIZE samples, 0-255 per band, bass first
+  void analyze(uint8_t *levels);
+
+  // First FFT bin of a band, AUDIO_BANDS gives the end of the last one
+  uint8_t getBandStart(uint8_t band) const { return bandStart[band]; }
+  // AGC reference in log2 power (8.8), for diagnostics
+  int32_t getCeiling() const { return ceiling; }
+};
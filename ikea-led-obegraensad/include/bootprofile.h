@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * Boot timeline: every stage records the time since the application started.
+ * Stages may be marked from any task; names must be string literals.
+ */
+
+constexpr uint8_t BOOT_PROFILE_MAX_STAGES = 16;
+
+void markBootStage(const char *stage);
+
+// Appends {"stage":..., "ms":...} objects in the order they were marked
+void bootProfileToJson(JsonArray stages);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "constants.h"
+#include <Arduino.h>
+#include <vector>
+
+/**
+ * A COLS × ROWS grid of brightness values and the drawing primitives plugins use.
+ *
+ * Screen_ is the canvas the panel shows. An OffscreenCanvas owns its pixels, so the same drawing
+ * code can render where nobody looks: plugin thumbnails, the outgoing plugin of a transition,
+ * zones of a layout, host tests. Plugins draw into Plugin::canvas, which is the panel unless
+ * PluginManager or a caller hands them another one.
+ *
+ * Every canvas has the panel's size: the plugins, sprites and particles are written against
+ * COLS and ROWS, and a fixed stride keeps setPixel() as cheap as writing the buffer directly.
+ */
+class Canvas
+{
+protected:
+  uint8_t *pixels_;
+
+public:
+  explicit Canvas(uint8_t *pixels) : pixels_(pixels) {}
+
+  Canvas(const Canvas &) = delete;
+  Canvas &operator=(const Canvas &) = delete;
+
+  static constexpr uint8_t width() { return COLS; }
+  static constexpr uint8_t height() { return ROWS; }
+
+  // Row-major, width() * height() values of 0 (off) to MAX_BRIGHTNESS
+  uint8_t *getRenderBuffer() { return pixels_; }
+  const uint8_t *getRenderBuffer() const { return pixels_; }
+  uint8_t getBufferIndex(int index) const { return pixels_[index]; }
+  // grays: values are brightness levels, otherwise 0/1 per pixel
+  void setRenderBuffer(const uint8_t *renderBuffer, bool grays = false);
+
+  void clear();
+  void clearRect(int x, int y, int width, int height);
+
+  void setPixel(uint8_t x, uint8_t y, uint8_t value, uint8_t brightness = MAX_BRIGHTNESS);
+  void setPixelAtIndex(uint8_t index, uint8_t value, uint8_t brightness = MAX_BRIGHTNESS);
+
+  void drawLine(int x1, int y1, int x2, int y2, int ledStatus, uint8_t brightness = MAX_BRIGHTNESS);
+  void drawRectangle(int x,
+                     int y,
+                     int width,
+                     int height,
+                     bool fill,
+                     int ledStatus,
+                     uint8_t brightness = MAX_BRIGHTNESS);
+  void drawCharacter(int x,
+                     int y,
+                     const std::vector<int> &bits,
+                     int bitCount,
+                     uint8_t brightness = MAX_BRIGHTNESS);
+  void drawNumbers(int x,
+                   int y,
+                   const std::vector<int> &numbers,
+                   uint8_t brightness = MAX_BRIGHTNESS);
+  void drawBigNumbers(int x,
+                      int y,
+                      const std::vector<int> &numbers,
+                      uint8_t brightness = MAX_BRIGHTNESS);
+  void drawWeather(int x, int y, int weather, uint8_t brightness = MAX_BRIGHTNESS);
+  // Bits of each byte, MSB first, as drawCharacter() takes them
+  static std::vector<int> readBytes(const std::vector<int> &bytes);
+};
+
+// A canvas with pixels of its own, not shown anywhere
+class OffscreenCanvas : public Canvas
+{
+private:
+  alignas(4) uint8_t buffer_[ROWS * COLS] = {0};
+
+public:
+  OffscreenCanvas() : Canvas(buffer_) {}
+};
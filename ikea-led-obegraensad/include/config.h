@@ -4,15 +4,14 @@
 #include <string>
 #include "constants.h"
 
-#ifdef ENABLE_STORAGE
-#include <Preferences.h>
-#endif
+// accepted range for the plugin execution budget
+constexpr uint16_t PLUGIN_BUDGET_MIN_MS = 20;
+constexpr uint16_t PLUGIN_BUDGET_MAX_MS = 10000;
 
 class Config
 {
 private:
 #ifdef ENABLE_STORAGE
-  Preferences preferences;
   bool storageAvailable;
 #endif
   
@@ -21,6 +20,8 @@ private:
   String ntpServer;
   String tzInfo;
   bool autoStartSchedule;
+  uint16_t pluginBudgetMs;
+  bool tlsReserve;
   bool initialized;
 
 public:
@@ -43,6 +44,9 @@ public:
   String getNtpServer() const;
   String getTzInfo() const;
   bool getAutoStartSchedule() const;
+  uint16_t getPluginBudgetMs() const;
+  // Hold a block for the TLS handshake between weather requests (ESP32, off by default)
+  bool getTlsReserve() const;
   bool isInitialized() const { return initialized; }
   
   // Setters with validation
@@ -50,6 +54,8 @@ public:
   void setNtpServer(const String& server);
   void setTzInfo(const String& tz);
   void setAutoStartSchedule(bool autoStart);
+  void setPluginBudgetMs(uint16_t budgetMs);
+  void setTlsReserve(bool reserve);
   
   // Export to JSON
   String toJson() const;
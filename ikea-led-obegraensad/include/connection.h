@@ -0,0 +1,86 @@
+#pragma once
+
+#include "constants.h"
+
+#ifdef ENABLE_SERVER
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * Non-blocking WiFi connection manager.
+ *
+ * update() is called from loop() and never waits: association and DHCP are reported by WiFi
+ * events, failed attempts are retried with exponential backoff, and the WiFiManager setup portal
+ * only opens when no credentials are stored, when requested through the API, or after
+ * WIFI_PORTAL_AFTER_OUTAGE_MS without a connection. The web server and mDNS are set up once and
+ * kept across reconnects.
+ */
+
+enum ConnectionState : uint8_t
+{
+  WIFI_STATE_IDLE,
+  WIFI_STATE_CONNECTING,
+  WIFI_STATE_CONNECTED,
+  WIFI_STATE_WAITING,
+  WIFI_STATE_PORTAL,
+};
+
+constexpr unsigned long WIFI_CONNECT_TIMEOUT_MS = 15000;
+constexpr unsigned long WIFI_MIN_BACKOFF_MS = 2000;
+constexpr unsigned long WIFI_MAX_BACKOFF_MS = 60000;
+constexpr unsigned long WIFI_PORTAL_TIMEOUT_S = 180;
+// lets the API response leave before the web server is stopped for the portal
+constexpr unsigned long WIFI_PORTAL_REQUEST_DELAY_MS = 500;
+
+class Connection_
+{
+private:
+  Connection_() = default;
+
+  ConnectionState state = WIFI_STATE_IDLE;
+  unsigned long stateSince = 0;
+  unsigned long retryAt = 0;
+  unsigned long backoff = WIFI_MIN_BACKOFF_MS;
+  unsigned long outageSince = 0;
+  unsigned long portalRequestedAt = 0;
+  bool everConnected = false;
+  bool mdnsStarted = false;
+  uint32_t reconnects = 0;
+  uint8_t lastDisconnectReason = 0;
+
+  // set from the WiFi event task and the web server, consumed by update()
+  volatile bool gotIp = false;
+  volatile bool linkLost = false;
+  volatile bool portalRequested = false;
+  volatile bool portalSaved = false;
+
+  void setState(ConnectionState newState);
+  void startAttempt();
+  void scheduleRetry();
+  void onConnected();
+  void openPortal();
+  void startMdns();
+
+public:
+  static Connection_ &getInstance();
+
+  Connection_(const Connection_ &) = delete;
+  Connection_ &operator=(const Connection_ &) = delete;
+
+  // Configures the station and registers the event handlers; the first attempt runs in update()
+  void begin();
+  void update();
+
+  // Opens the setup portal shortly after, from update()
+  void requestPortal();
+
+  bool isConnected() const;
+  ConnectionState getState() const;
+  const char *getStateName() const;
+  void toJson(JsonObject object) const;
+};
+
+extern Connection_ &Connection;
+
+#endif
@@ -46,9 +46,16 @@ constexpr uint16_t TOTAL_PIXELS = ROWS * COLS;
 // set your city or coords (https://github.com/chubin/wttr.in)
 #define WEATHER_LOCATION "Espoo"
 
+// a plugin's loop() running longer than this counts as an overrun (setup() gets 4 times as long),
+// repeat offenders are skipped by the scheduler; adjustable via /api/config "pluginBudgetMs"
+#define PLUGIN_BUDGET_MS 200
+
 // name of WiFi created by the device if no known WiFi is available
 #define WIFI_MANAGER_SSID "IKEA"
 
+// open the setup portal after the known WiFi has been unreachable this long (0 = only on request)
+#define WIFI_PORTAL_AFTER_OUTAGE_MS (10UL * 60 * 1000)
+
 // use ALL of the following to use static IP config
 /*
 #define IP_ADDRESS "192.168.0.250"
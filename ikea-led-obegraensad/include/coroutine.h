@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * Stackless coroutines (protothreads) for plugin code that should read top to bottom without
+ * blocking the render task.
+ *
+ * A coroutine body sits in a function that is called over and over, usually Plugin::loop().
+ * CO_SLEEP and CO_NEXT_FRAME return from that function and the next call continues right
+ * after them, so every plugin yields back to runActivePlugin() instead of sitting in delay().
+ *
+ * Usage:
+ *   Coroutine co;
+ *   uint8_t i; // state that lives across a yield must be a member, locals are lost
+ *
+ *   void loop() {
+ *     CO_BEGIN(co);
+ *     for (i = 0; i < 16; i++) {
+ *       canvas->setPixel(i, 0, 1);
+ *       CO_SLEEP(co, 25);
+ *     }
+ *     CO_END(co);
+ *   }
+ *
+ * The macros are built on a switch statement: do not yield from inside another switch in the
+ * same function, and keep declarations with initialisers after the last yield of their block.
+ * Each macro must be on its own line. C++20 coroutines would lift these limits, but they need
+ * a heap frame per call and the ESP8266 toolchain stops at C++17.
+ */
+class Coroutine
+{
+public:
+  static constexpr uint16_t DONE = 0xffff;
+
+  // resume point, managed by the macros below
+  uint16_t line = 0;
+
+  // Starts over from CO_BEGIN with the next call
+  void reset() { line = 0; }
+  bool isDone() const { return line == DONE; }
+
+  void startSleep(unsigned long ms)
+  {
+    sleepStart = millis();
+    sleepDuration = ms;
+  }
+  bool isSleeping() const { return millis() - sleepStart < sleepDuration; }
+
+private:
+  unsigned long sleepStart = 0;
+  unsigned long sleepDuration = 0;
+};
+
+#define CO_BEGIN(co)    \
+  switch ((co).line)    \
+  {                     \
+  case 0:
+
+// Returns now and continues here with the next call
+#define CO_NEXT_FRAME(co) \
+  do                      \
+  {                       \
+    (co).line = __LINE__; \
+    return;               \
+  case __LINE__:;         \
+  } while (0)
+
+// Returns until ms milliseconds have passed
+#define CO_SLEEP(co, ms)      \
+  do                          \
+  {                           \
+    (co).startSleep(ms);      \
+    (co).line = __LINE__;     \
+    [[fallthrough]];          \
+  case __LINE__:              \
+    if ((co).isSleeping())    \
+    {                         \
+      return;                 \
+    }                         \
+  } while (0)
+
+// Returns until condition is true
+#define CO_WAIT_UNTIL(co, condition) \
+  do                                 \
+  {                                  \
+    (co).line = __LINE__;            \
+    [[fallthrough]];                 \
+  case __LINE__:                     \
+    if (!(condition))                \
+    {                                \
+      return;                        \
+    }                                \
+  } while (0)
+
+// Code after CO_END runs on every call once the body has finished, until reset()
+#define CO_END(co)              \
+  (co).line = Coroutine::DONE; \
+  [[fallthrough]];             \
+  case Coroutine::DONE:;       \
+  }
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "constants.h"
+#include "settings.h"
+
+#ifdef ENABLE_SERVER
+
+#include <Arduino.h>
+
+/**
+ * Background HTTP fetcher shared by the weather plugins.
+ *
+ * Plugins call get() every frame if they like: it only copies the cached value out and, when the
+ * entry is due, flags it for the fetch task. Requests are keyed by URL, so two plugins asking for
+ * the same coordinates share one entry and one request. Failed requests back off exponentially,
+ * and the last good values of the FETCH_PERSIST_SLOTS most recently refreshed URLs are kept in
+ * settings blobs, so a reboot shows data right away instead of triggering a burst of requests.
+ */
+
+enum FetchKind : uint8_t
+{
+  FETCH_OPEN_METEO_CURRENT, // current=temperature_2m,weather_code,is_day
+  FETCH_OPEN_METEO_DAILY,   // daily=temperature_2m_max,temperature_2m_min,weather_code (tomorrow)
+  FETCH_WTTR_CURRENT,       // wttr.in ?format=j2
+};
+
+struct WeatherData
+{
+  float temperature = -99.0f;
+  float temperatureMin = -99.0f;
+  float temperatureMax = -99.0f;
+  int16_t code = 0;
+  bool isDay = true;
+};
+
+struct FetchStatus
+{
+  bool hasData = false;
+  bool pending = false;
+  int lastHttpCode = 0; // 0 = not tried yet, 200 = ok, negative = HTTPClient error
+};
+
+class FetchService_
+{
+private:
+  FetchService_() = default;
+
+  static constexpr uint8_t MAX_ENTRIES = 8;
+  static constexpr size_t MAX_URL_LENGTH = 224;
+  static constexpr unsigned long MIN_BACKOFF_MS = 30000;
+  static constexpr unsigned long MAX_BACKOFF_MS = 1800000;
+  // Hard cap for one parsed response; ArduinoJson allocates its slot pool in one piece,
+  // the filtered content itself is a few dozen bytes
+  static constexpr size_t MAX_JSON_BYTES = 2048;
+
+  struct Entry
+  {
+    uint32_t key = 0;
+    FetchKind kind = FETCH_OPEN_METEO_CURRENT;
+    char url[MAX_URL_LENGTH] = {0};
+    unsigned long ttl = 0;
+    unsigned long refreshAt = 0;
+    unsigned long lastUsed = 0;
+    WeatherData data;
+    bool used = false;
+    bool hasData = false;
+    bool queued = false;
+    bool inFlight = false;
+    uint8_t failures = 0;
+    int lastHttpCode = 0;
+  };
+
+  // one persisted value, as stored in a SETTING_FETCH_SLOT_* blob
+  struct StoredValue
+  {
+    uint32_t key = 0; // 0 = empty
+    uint32_t sequence = 0;
+    WeatherData data;
+  };
+  static_assert(sizeof(StoredValue) <= SETTINGS_BLOB_BYTES, "fetch value does not fit a blob");
+
+  Entry entries[MAX_ENTRIES];
+  // RAM copy of the persisted values, loaded by begin() so get() never touches NVS
+  StoredValue stored[FETCH_PERSIST_SLOTS];
+  uint32_t storedSequence = 0;
+  uint32_t requests = 0;
+  uint32_t failures = 0;
+  uint32_t peakJsonBytes = 0;
+
+#ifdef ESP32
+  SemaphoreHandle_t mutex = nullptr;
+  TaskHandle_t taskHandle = nullptr;
+  static void task(void *parameter);
+#endif
+
+  void lock();
+  void unlock();
+  Entry *findOrCreate(uint32_t key, FetchKind kind, const char *url, unsigned long ttl);
+  bool fetch(Entry &entry, WeatherData &data, int &httpCode);
+  void restore(Entry &entry);
+  void persist(const Entry &entry);
+
+public:
+  static FetchService_ &getInstance();
+
+  FetchService_(const FetchService_ &) = delete;
+  FetchService_ &operator=(const FetchService_ &) = delete;
+
+  void begin();
+
+  // Non-blocking: copies the cached value and schedules a refresh when it is due
+  FetchStatus get(FetchKind kind, const char *url, unsigned long ttlMs, WeatherData &out);
+
+  // Runs due requests; called by the fetch task (ESP32) or from loop() (ESP8266)
+  void processPending();
+
+  uint32_t getRequestCount() const;
+  uint32_t getFailureCount() const;
+  uint32_t getPeakJsonBytes() const;
+};
+
+extern FetchService_ &FetchService;
+
+#endif
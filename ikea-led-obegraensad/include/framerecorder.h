@@ -0,0 +1,156 @@
+#pragma once
+
+#include "constants.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * Always-on recorder of the last RECORDER_SECONDS the panel showed, downloadable from
+ * /api/recorder/capture to see what a reported glitch looked like.
+ *
+ * Screen_::commitFrame() hands every finished frame to capture(), at most one per
+ * RECORDER_MIN_FRAME_MS. A frame that differs from the previous one is stored as a delta in a
+ * ring of RECORDER_BYTES. Frames older than RECORDER_SECONDS, or in the way of a new one, are
+ * folded into the base frame the ring starts from, so the ring never needs keyframes.
+ *
+ * Frame record:
+ *   varint  milliseconds since the previous frame << 1 | toggle
+ *   runs    [unchanged pixels][changed pixels][values of the changed pixels] until all
+ *           TOTAL_PIXELS are covered; with toggle set every changed pixel goes from 0 to 255 or
+ *           back and the values are left out
+ *
+ * Binary capture (little endian):
+ *   "OBRC", version, cols, rows, 0, uint32 uptime of the base frame in ms, uint32 uptime at the
+ *   download, uint32 frame count, uint32 record bytes, the base frame, the records
+ */
+
+#ifdef ESP32
+constexpr size_t RECORDER_BYTES = 16384;
+#else
+constexpr size_t RECORDER_BYTES = 4096;
+#endif
+constexpr unsigned long RECORDER_SECONDS = 60;
+constexpr unsigned long RECORDER_MIN_FRAME_MS = 20;
+constexpr uint8_t RECORDER_VERSION = 1;
+constexpr size_t RECORDER_HEADER_BYTES = 24;
+// varint, every other pixel changed, and the run closing the frame
+constexpr size_t RECORDER_MAX_RECORD = 5 + 3 * (TOTAL_PIXELS / 2) + 2;
+
+class FrameRecorder_
+{
+private:
+  FrameRecorder_();
+
+#ifdef ESP32
+  // held for every change of the ring; the render task must not stall the PWM interrupt, so
+  // this is a mutex rather than a critical section
+  SemaphoreHandle_t mutex = nullptr;
+#endif
+
+  uint8_t ring[RECORDER_BYTES];
+  size_t head = 0;
+  size_t used = 0;
+  uint32_t frames = 0;
+  uint8_t base[TOTAL_PIXELS] = {0};
+  unsigned long baseAt = 0;
+
+  // render task only: the frame the newest record leads to
+  uint8_t last[TOTAL_PIXELS] = {0};
+  unsigned long lastAt = 0;
+  unsigned long lastCapture = 0;
+  bool started = false;
+
+  volatile bool exporting = false;
+  uint64_t busyMicros = 0;
+  unsigned long startedAt = 0;
+
+  void lock();
+  void unlock();
+  uint8_t readByte(size_t offset) const;
+  uint32_t readVarint(size_t &offset) const;
+  // Applies the record at offset to pixels, returns the offset of the next record
+  size_t applyRecord(size_t offset, uint8_t *pixels, uint32_t &elapsed) const;
+  size_t encode(const uint8_t *frame, uint32_t elapsed, uint8_t *out) const;
+  void append(const uint8_t *record, size_t length);
+  void dropOldest();
+
+  friend class FrameCapture;
+
+public:
+  static FrameRecorder_ &getInstance();
+
+  FrameRecorder_(const FrameRecorder_ &) = delete;
+  FrameRecorder_ &operator=(const FrameRecorder_ &) = delete;
+
+  // Called by the render task after each frame, cheap when nothing changed
+  void capture(const uint8_t *frame);
+
+  // Recording pauses between these so a download sees a consistent ring; false while another
+  // download runs
+  bool beginExport();
+  void endExport();
+
+  void toJson(JsonObject object) const;
+};
+
+extern FrameRecorder_ &FrameRecorder;
+
+/**
+ * One download of the recording, as binary capture or animated GIF. Recording pauses while the
+ * object exists; the web handler keeps it in the chunked response, so a dropped connection ends
+ * the pause as well.
+ */
+class FrameCapture
+{
+public:
+  enum Format
+  {
+    BINARY,
+    GIF,
+  };
+
+  explicit FrameCapture(Format format);
+  ~FrameCapture();
+
+  FrameCapture(const FrameCapture &) = delete;
+  FrameCapture &operator=(const FrameCapture &) = delete;
+
+  // false when another download holds the recorder
+  bool isOpen() const;
+  // Next bytes of the download, 0 once it is complete
+  size_t read(uint8_t *buffer, size_t maxLen);
+
+private:
+  enum Stage
+  {
+    HEADER,
+    BASE,
+    RECORDS,
+    FRAMES,
+    TRAILER,
+    DONE,
+  };
+
+  Format format;
+  bool open;
+  Stage stage = HEADER;
+  unsigned long exportAt;
+
+  size_t offset = 0;
+  uint32_t remaining = 0;
+  // GIF: the frame about to be written, what the viewer shows so far and when it was shown
+  uint8_t current[TOTAL_PIXELS];
+  uint8_t shown[TOTAL_PIXELS];
+  unsigned long currentAt = 0;
+  uint32_t delayCarry = 0;
+  bool first = true;
+
+  // the GIF header with its 256 entry palette is the largest piece
+  uint8_t staged[832];
+  size_t stagedLength = 0;
+  size_t stagedPosition = 0;
+
+  bool stageNext();
+  void stageGifHeader();
+  void stageGifFrame(uint32_t durationMs);
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * Heap fragmentation over time for /api/heap.
+ *
+ * update() samples free heap and the largest free block every HEAP_SAMPLE_MS from the main
+ * loop. The lowest values of each HEAP_HISTORY_INTERVAL_MS go into a ring of
+ * HEAP_HISTORY_LENGTH entries (a day), next to the lowest largest block since boot: headroom
+ * that keeps sinking over days means something still fragments the heap.
+ */
+
+constexpr unsigned long HEAP_SAMPLE_MS = 10000;
+constexpr unsigned long HEAP_HISTORY_INTERVAL_MS = 30UL * 60 * 1000;
+constexpr uint8_t HEAP_HISTORY_LENGTH = 48;
+
+class HeapStats_
+{
+private:
+  HeapStats_() = default;
+
+  struct Sample
+  {
+    uint32_t free;
+    uint32_t maxBlock;
+  };
+
+  Sample history[HEAP_HISTORY_LENGTH];
+  uint8_t historyCount = 0;
+  uint8_t historyNext = 0;
+
+  Sample interval = {UINT32_MAX, UINT32_MAX};
+  unsigned long intervalStart = 0;
+  unsigned long lastSample = 0;
+
+  uint32_t lowestMaxBlock = UINT32_MAX;
+  unsigned long lowestMaxBlockAt = 0;
+
+  Sample sample() const;
+
+public:
+  static HeapStats_ &getInstance();
+
+  HeapStats_(const HeapStats_ &) = delete;
+  HeapStats_ &operator=(const HeapStats_ &) = delete;
+
+  void update();
+
+  // Current free heap, largest block and fragmentation in percent
+  void summaryToJson(JsonObject object) const;
+  // Summary plus low-water marks and the history, oldest interval first
+  void toJson(JsonObject object) const;
+};
+
+extern HeapStats_ &HeapStats;
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Streaming GIF and PNG decoder that turns an image of any size into 16x16 grey frames.
+ *
+ * Bytes are pushed in with write() as they arrive from the network, in chunks of any size;
+ * nothing of the file is kept beyond what the formats need:
+ *   GIF  the LZW dictionary, 16 KB, and a composite canvas of at most 16 KB (twice that once a
+ *        frame asks for the previous one to be restored)
+ *   PNG  the deflate window (as announced in the zlib header, at most 32 KB) and two scanlines
+ *        of at most IMAGE_MAX_ROW_BYTES, so the width is limited but the height is not
+ * The decoder object itself is about 5 KB.
+ *
+ * Every source pixel is spread over the output cells it overlaps with weights proportional to
+ * the overlap (area averaging), so downscaling never drops pixels and upscaling stays exact.
+ * GIF frames are composited at full resolution up to GIF_CANVAS_PIXELS; larger images use a
+ * canvas of GIF_CANVAS_SIZE x GIF_CANVAS_SIZE blocks of source pixels, where transparent pixels
+ * keep the average of their block rather than their own value. PNG alpha is composited over
+ * black. Frames are then quantised to the requested number of levels, optionally with ordered
+ * (4x4 Bayer) or error diffusion (Floyd-Steinberg) dithering, and handed to an ImageFrameSink.
+ */
+
+constexpr uint16_t IMAGE_MAX_ROW_BYTES = 8192;
+constexpr uint8_t IMAGE_SIZE = 16;
+constexpr uint16_t GIF_CANVAS_PIXELS = 16384;
+constexpr uint8_t GIF_CANVAS_SIZE = 64;
+
+enum ImageDither : uint8_t
+{
+  DITHER_NONE,
+  DITHER_ORDERED,
+  DITHER_DIFFUSION,
+};
+
+enum ImageFormat : uint8_t
+{
+  IMAGE_UNKNOWN,
+  IMAGE_GIF,
+  IMAGE_PNG,
+};
+
+class ImageFrameSink
+{
+public:
+  virtual ~ImageFrameSink() = default;
+  // 256 grey values, row-major; returning false stops the decoder
+  virtual bool addImageFrame(const uint8_t *pixels, uint16_t delayMs) = 0;
+};
+
+/**
+ * Area-averaging accumulator from a width x height canvas onto IMAGE_SIZE x IMAGE_SIZE cells.
+ * A source pixel is 16 units wide and a cell is width units, so every cell has the same area
+ * of width * height square units.
+ */
+class ImageScaler
+{
+private:
+  uint16_t width = 0;
+  uint16_t height = 0;
+  uint64_t sum[IMAGE_SIZE * IMAGE_SIZE];
+  uint64_t cover[IMAGE_SIZE * IMAGE_SIZE];
+  uint64_t rowSum[IMAGE_SIZE];
+  uint32_t rowCover[IMAGE_SIZE];
+  uint16_t row = 0;
+  bool rowOpen = false;
+
+public:
+  uint8_t canvas[IMAGE_SIZE * IMAGE_SIZE];
+
+  void begin(uint16_t canvasWidth, uint16_t canvasHeight);
+  void beginFrame();
+  void beginRow(uint16_t y);
+  // alpha 255 replaces the canvas, 0 leaves it alone
+  void addPixel(uint16_t x, uint8_t grey, uint8_t alpha = 255);
+  // count opaque pixels of the same grey from x on
+  void addPixels(uint16_t x, uint16_t count, uint8_t grey);
+  void endRow();
+  // Blends what was added since beginFrame() into the canvas
+  void endFrame();
+};
+
+/**
+ * zlib stream inflater that can stop and resume at any bit. Huffman codes are decoded one bit
+ * at a time against canonical count tables, so no lookup tables are built; the window is a
+ * ring buffer sized from the zlib header.
+ */
+class Inflater
+{
+private:
+  enum State : uint8_t
+  {
+    ZLIB_HEADER,
+    BLOCK_HEADER,
+    STORED_LENGTH,
+    STORED_COPY,
+    DYNAMIC_COUNTS,
+    DYNAMIC_CODE_LENGTHS,
+    DYNAMIC_LENGTHS,
+    DYNAMIC_REPEAT,
+    SYMBOL,
+    LENGTH_EXTRA,
+    DISTANCE,
+    DISTANCE_EXTRA,
+    COPY,
+    FINISHED,
+    BROKEN,
+  };
+
+  struct Huffman
+  {
+    uint16_t count[16];
+    uint16_t *symbol;
+  };
+
+  State state = ZLIB_HEADER;
+  uint8_t *window = nullptr;
+  uint16_t windowMask = 0;
+  uint16_t windowPosition = 0;
+  uint32_t produced = 0;
+
+  const uint8_t *input = nullptr;
+  size_t inputLength = 0;
+  size_t inputPosition = 0;
+  uint32_t bits = 0;
+  uint8_t bitCount = 0;
+
+  bool finalBlock = false;
+  uint16_t remaining = 0;
+  uint16_t distance = 0;
+  uint16_t symbol = 0;
+
+  // resumable Huffman decode
+  uint16_t code = 0;
+  uint16_t first = 0;
+  uint16_t index = 0;
+  uint8_t length = 0;
+
+  uint16_t literalCount = 0;
+  uint16_t distanceCount = 0;
+  uint16_t codeLengthCount = 0;
+  uint16_t lengthIndex = 0;
+  uint8_t lengths[288 + 32];
+
+  uint16_t literalSymbols[288];
+  uint16_t distanceSymbols[32];
+  uint16_t codeLengthSymbols[19];
+  Huffman literals = {{0}, literalSymbols};
+  Huffman distances = {{0}, distanceSymbols};
+  Huffman codeLengths = {{0}, codeLengthSymbols};
+
+  bool need(uint8_t count);
+  uint16_t take(uint8_t count);
+  // true with symbol set once a whole code has been read
+  bool decode(const Huffman &table, bool &failed);
+  static bool build(Huffman &table, const uint8_t *lengths, uint16_t count);
+  void buildFixed();
+
+public:
+  ~Inflater();
+
+  void reset();
+  // Consumes input until it runs out or out is full; returns the bytes written to out
+  size_t inflate(const uint8_t *in, size_t inLength, size_t &consumed, uint8_t *out,
+                 size_t outLength);
+  bool isFinished() const { return state == FINISHED; }
+  bool isBroken() const { return state == BROKEN; }
+  uint32_t getWindowSize() const { return window ? windowMask + 1UL : 0; }
+};
+
+class ImageDecoder
+{
+private:
+  enum State : uint8_t
+  {
+    DETECT,
+    GIF_HEADER,
+    GIF_COLOR,
+    GIF_BLOCK,
+    GIF_EXTENSION,
+    GIF_SUB_BLOCK,
+    GIF_SUB_DATA,
+    GIF_DESCRIPTOR,
+    GIF_CODE_SIZE,
+    PNG_SIGNATURE,
+    PNG_CHUNK,
+    PNG_HEADER,
+    PNG_PALETTE,
+    PNG_DATA,
+    PNG_CRC,
+    FINISHED,
+    FAILED,
+  };
+
+  ImageFrameSink &sink;
+  ImageScaler scaler;
+  ImageFormat format = IMAGE_UNKNOWN;
+  State state = DETECT;
+  const char *error = nullptr;
+
+  uint16_t levels = 256;
+  ImageDither dither = DITHER_NONE;
+  uint16_t defaultDelay = 100;
+  uint16_t width = 0;
+  uint16_t height = 0;
+  uint16_t frames = 0;
+
+  // fixed size fields are collected here before they are parsed
+  uint8_t field[16];
+  uint8_t fieldLength = 0;
+  uint8_t fieldNeeded = 0;
+  uint32_t skip = 0;
+
+  uint8_t palette[256];
+  uint8_t alpha[256];
+  uint16_t colors = 0;
+  uint16_t color = 0;
+
+  // GIF
+  uint8_t globalPalette[256];
+  uint16_t globalColors = 0;
+  uint8_t extensionLabel = 0;
+  bool extensionFirst = false;
+  bool graphicControl = false;
+  uint8_t disposal = 0;
+  uint16_t frameDelay = 0;
+  int16_t transparent = -1;
+  uint16_t frameX = 0;
+  uint16_t frameY = 0;
+  uint16_t frameWidth = 0;
+  uint16_t frameHeight = 0;
+  bool interlaced = false;
+  bool localColors = false;
+  bool imageData = false;
+  uint16_t column = 0;
+  uint16_t frameRow = 0;
+  uint8_t pass = 0;
+
+  // composite canvas, one byte per block of blockWidth x blockHeight source pixels; with
+  // blocks larger than a pixel a frame is accumulated in 8.8 fixed point against the canvas it
+  // started from
+  uint8_t *composite = nullptr;
+  uint8_t *saved = nullptr;
+  uint16_t *accumulator = nullptr;
+  uint16_t blockWidth = 1;
+  uint16_t blockHeight = 1;
+  uint16_t compositeWidth = 0;
+  uint16_t compositeHeight = 0;
+  bool rowInside = false;     // the current source row lies on the canvas
+  uint16_t blockRow = 0;      // first block of the current source row
+  uint16_t blockRowHeight = 0; // source rows in that block row
+
+  uint16_t *prefix = nullptr; // LZW dictionary, also owns suffix and stack
+  uint8_t *suffix = nullptr;
+  uint8_t *stack = nullptr;
+  uint8_t minimumCodeSize = 0;
+  uint8_t codeSize = 0;
+  uint16_t nextCode = 0;
+  int16_t previousCode = -1;
+  uint8_t previousFirst = 0;
+  uint32_t codeBits = 0;
+  uint8_t codeBitCount = 0;
+  bool lzwEnded = false;
+
+  // PNG
+  Inflater *inflater = nullptr;
+  uint8_t *rows = nullptr;
+  uint8_t *current = nullptr;
+  uint8_t *prior = nullptr;
+  uint32_t chunkType = 0;
+  uint32_t chunkRemaining = 0;
+  uint8_t bitDepth = 0;
+  uint8_t colorType = 0;
+  uint8_t channels = 0;
+  uint8_t filterStride = 0;
+  bool adam7 = false;
+  bool hasKey = false;
+  uint16_t key[3];
+  uint16_t passWidth = 0;
+  uint16_t passHeight = 0;
+  uint16_t rowBytes = 0;
+  uint16_t rowPosition = 0;
+  uint8_t filter = 0;
+  bool imageComplete = false;
+
+  bool fail(const char *message);
+  void collect(uint8_t count, State next);
+  bool emitFrame(uint16_t delayMs);
+
+  void detect(uint8_t first);
+  bool parseField();
+  size_t stream(const uint8_t *data, size_t length);
+
+  bool gifHeader();
+  bool gifDescriptor();
+  bool gifStartImage();
+  bool gifCode(uint16_t code);
+  void gifPixel(uint8_t index);
+  void gifRow();
+  bool gifEndImage();
+  void gifClear();
+  void freeGif();
+
+  bool pngChunk();
+  bool pngHeader();
+  bool pngStartPass();
+  void pngByte(uint8_t value);
+  void pngRow();
+  bool pngEnd();
+  void freePng();
+
+public:
+  explicit ImageDecoder(ImageFrameSink &sink);
+  ~ImageDecoder();
+
+  ImageDecoder(const ImageDecoder &) = delete;
+  ImageDecoder &operator=(const ImageDecoder &) = delete;
+
+  // levels is 2, 16 or 256; defaultDelay is used for PNG and for GIF frames without a delay
+  void setOutput(uint16_t outputLevels, ImageDither mode, uint16_t delayMs);
+
+  // false once the stream is broken; getError() says why
+  bool write(const uint8_t *data, size_t length);
+  // true when a complete image with at least one frame was decoded
+  bool finish();
+
+  const char *getError() const { return error; }
+  ImageFormat getFormat() const { return format; }
+  uint16_t getWidth() const { return width; }
+  uint16_t getHeight() const { return height; }
+  uint16_t getFrameCount() const { return frames; }
+};
+
+// Quantises 256 grey values to levels evenly spaced values (2, 16 or 256)
+void ditherImage(const uint8_t *in, uint8_t *out, uint16_t levels, ImageDither mode);
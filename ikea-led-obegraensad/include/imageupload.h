@@ -0,0 +1,72 @@
+#pragma once
+
+#include "constants.h"
+
+#ifdef ENABLE_SERVER
+
+#include "animationstore.h"
+#include "imagedecoder.h"
+
+/**
+ * Turns a GIF or PNG request body into the stored animation while it arrives.
+ *
+ * The body is fed chunk by chunk through ImageDecoder, every decoded 16x16 frame goes straight
+ * into an AnimationWriter, and the new container replaces the old one only when the image
+ * decoded completely. One upload runs at a time; a session that saw no data for
+ * IMAGE_UPLOAD_TIMEOUT_MS is given up when the next one starts. RAM use is bounded by the
+ * decoder (see imagedecoder.h), independent of the image size.
+ */
+
+constexpr unsigned long IMAGE_UPLOAD_TIMEOUT_MS = 30000;
+
+// the session keeps its writer open across requests, so it must not share ANIMATION_TMP_PATH
+#define IMAGE_UPLOAD_PATH "/anim.img"
+
+class ImageUpload_ : public ImageFrameSink
+{
+private:
+  ImageUpload_() = default;
+
+  ImageDecoder *decoder = nullptr;
+  AnimationWriter *writer = nullptr;
+  const void *owner = nullptr;
+  const char *error = nullptr;
+  unsigned long lastActivity = 0;
+
+  uint16_t frames = 0;
+  uint16_t width = 0;
+  uint16_t height = 0;
+  ImageFormat format = IMAGE_UNKNOWN;
+
+  void release();
+
+public:
+  static ImageUpload_ &getInstance();
+
+  ImageUpload_(const ImageUpload_ &) = delete;
+  ImageUpload_ &operator=(const ImageUpload_ &) = delete;
+
+  // owner identifies the upload (the request); false when busy or out of memory/storage
+  bool begin(const void *owner, uint8_t bitsPerPixel, ImageDither dither, uint16_t delayMs);
+  bool write(const void *owner, const uint8_t *data, size_t len);
+  // Stores the animation when the image was complete
+  bool finish(const void *owner);
+  void abort(const void *owner);
+
+  bool isActive() const;
+  bool isOwner(const void *owner) const;
+  // why the last call failed
+  const char *getError() const;
+
+  // stats of the last finished upload
+  uint16_t getFrameCount() const;
+  uint16_t getWidth() const;
+  uint16_t getHeight() const;
+  const char *getFormat() const;
+
+  bool addImageFrame(const uint8_t *pixels, uint16_t delayMs) override;
+};
+
+extern ImageUpload_ &ImageUpload;
+
+#endif
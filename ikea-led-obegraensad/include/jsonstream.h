@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * Helpers to parse HTTP responses straight from the socket.
+ *
+ * HttpBodyStream hands ArduinoJson only the body bytes, undoing chunked transfer encoding on the
+ * fly so keep-alive connections can be parsed without buffering the response in a String.
+ * CappedAllocator puts a hard limit on what one JsonDocument may allocate; deserialization then
+ * fails with NoMemory instead of exhausting the heap when an API returns something unexpected.
+ */
+
+class CappedAllocator : public ArduinoJson::Allocator
+{
+private:
+  size_t limit;
+  size_t used = 0;
+  size_t peak = 0;
+
+public:
+  explicit CappedAllocator(size_t limit) : limit(limit) {}
+
+  void *allocate(size_t size) override;
+  void deallocate(void *pointer) override;
+  void *reallocate(void *pointer, size_t newSize) override;
+
+  size_t getUsed() const { return used; }
+  size_t getPeak() const { return peak; }
+};
+
+class HttpBodyStream : public Stream
+{
+private:
+  Stream &source;
+  bool chunked;
+  long remaining; // bytes left in the body (or current chunk), -1 = until the peer closes
+  bool finished = false;
+  int lookahead = -1;
+
+  int readRaw();
+  bool nextChunk();
+  int readBody();
+
+public:
+  // contentLength as reported by HTTPClient::getSize(), -1 if unknown
+  HttpBodyStream(Stream &source, bool chunked, long contentLength);
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override { return 0; }
+
+  // Consumes what is left of the body so the connection can be reused
+  void drain();
+};
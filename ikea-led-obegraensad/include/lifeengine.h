@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Bit-parallel engine for Life-like cellular automata on a torus.
+ *
+ * Each row of the universe is one 64 bit word (bit x = column x). A generation counts the eight
+ * neighbours of all cells of a row at once with bit-sliced full adders and applies the rule as a
+ * handful of masks, so a 64x64 universe costs a few hundred word operations per generation.
+ *
+ * Rules use B/S notation ("B3/S23" is Conway's Life). Cycles are detected with Brent's
+ * algorithm on a 32 bit hash of each generation: O(1) per step, finds any period without a
+ * history buffer.
+ */
+
+constexpr uint8_t LIFE_MAX_SIZE = 64;
+
+class LifeEngine
+{
+private:
+  uint64_t rows[LIFE_MAX_SIZE] = {0};
+  uint8_t size = 16;
+  uint64_t mask = 0xffff;
+
+  uint16_t birth = 1 << 3;
+  uint16_t survive = (1 << 2) | (1 << 3);
+
+  uint32_t generation = 0;
+  uint32_t currentHash = 0;
+
+  // Brent's cycle detection
+  uint32_t savedHash = 0;
+  uint32_t power = 1;
+  uint32_t lambda = 0;
+  uint32_t period = 0;
+
+  uint64_t rotateLeft(uint64_t row) const;
+  uint64_t rotateRight(uint64_t row) const;
+  uint32_t computeHash() const;
+  void resetCycle();
+
+public:
+  // Edge length of the square universe, 16 to 64; clears it
+  void setSize(uint8_t newSize);
+  uint8_t getSize() const { return size; }
+
+  // "B36/S23", "b3/s23" or one of conway, highlife, seeds, daynight; false leaves the rule as is
+  bool setRule(const char *rule);
+  // bit n set = born/survives with n neighbours
+  void setRule(uint16_t birthMask, uint16_t surviveMask);
+  void getRule(char *out, size_t length) const;
+  static bool parseRule(const char *rule, uint16_t &birthMask, uint16_t &surviveMask);
+
+  void clear();
+  void setRow(uint8_t y, uint64_t bits);
+  uint64_t getRow(uint8_t y) const { return rows[y]; }
+
+  // 16 cells of row y starting at column x, wrapping around; bit i = column x + i
+  uint16_t getWindowRow(uint8_t x, uint8_t y) const;
+  // Live cells in the 16x16 window at x, y
+  uint16_t countWindow(uint8_t x, uint8_t y) const;
+
+  void step();
+  void step(uint32_t generations);
+
+  uint32_t getGeneration() const { return generation; }
+  uint32_t getPopulation() const;
+  // Period of the cycle the universe is in (1 = still life), 0 while none was found
+  uint32_t getPeriod() const { return period; }
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "canvas.h"
+#include <Arduino.h>
+
+/**
+ * Fixed-capacity particle pool shared by the particle plugins (Rain, Matrix Rain, Firework,
+ * Comet, Fireflies, Meteor Shower, Sparkle Field, Bubbles, Droplets, Stars).
+ *
+ * Particles are stored as a structure of arrays and kept packed at the front (a dead particle
+ * is replaced by the last one), so update() and draw() are straight loops over the live ones
+ * and the cost per frame only depends on how many there are.
+ *
+ * Positions and velocities are 8.8 fixed point in pixels and pixels per frame; toFixed() turns
+ * constants into that format at compile time. Lifetime is a 16 bit phase that advances by
+ * 65536 / life frames per update, the fade curve is a function of that phase. draw() adds the
+ * particles to the render buffer with saturation, so overlapping particles get brighter;
+ * fadeScreen() and dimScreen() give plugins a persistent, decaying screen for trails.
+ *
+ * Storage lives in the Particles<CAPACITY> wrapper, the code in ParticleSystem, so every pool
+ * size shares one copy of it.
+ */
+
+constexpr int16_t PARTICLE_ONE = 256;
+
+constexpr int16_t toFixed(float value)
+{
+  return (int16_t)(value * PARTICLE_ONE);
+}
+
+// Marsaglia's xorshift32: three shifts per number instead of a call into the system RNG
+class Xorshift32
+{
+private:
+  uint32_t state = 2463534242UL;
+
+public:
+  void seed(uint32_t value) { state = value ? value : 2463534242UL; }
+
+  uint32_t next()
+  {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  // [0, n) by multiply and shift, no division
+  uint16_t below(uint16_t n) { return ((next() >> 16) * n) >> 16; }
+  // [low, high)
+  int16_t between(int16_t low, int16_t high) { return low + below(high - low); }
+};
+
+enum ParticleFade : uint8_t
+{
+  FADE_NONE,     // full brightness until it dies
+  FADE_LINEAR,   // full to dark over its life
+  FADE_EASE_OUT, // quadratic, dims quickly and lingers dark
+  FADE_TWINKLE,  // dark to full and back
+  FADE_PULSE,    // between 2/5 and full and back, for looping particles
+};
+
+enum ParticleEdge : uint8_t
+{
+  EDGE_NONE,   // nothing happens at the screen edge
+  EDGE_KILL,   // dies once it is past the margin and moving away from the screen
+  EDGE_BOUNCE, // reflects off the edge pixels
+  EDGE_WRAP,   // leaves on one side, comes back on the other
+};
+
+enum ParticleShape : uint8_t
+{
+  SHAPE_POINT,  // nearest pixel, plus a trail of size points spaced one frame of motion apart
+  SHAPE_SMOOTH, // like SHAPE_POINT but spread over the four pixels around the position
+  SHAPE_RING,   // ring around the position, growing to a radius of size pixels over its life
+};
+
+// Where and how new particles start; the defaults give a still, immortal, full bright point
+struct ParticleEmitter
+{
+  int16_t x = 0; // 8.8 fixed point
+  int16_t y = 0;
+  int16_t spreadX = 0; // random offset in [-spread, spread]
+  int16_t spreadY = 0;
+  int16_t vx = 0; // pixels per frame, 8.8 fixed point
+  int16_t vy = 0;
+  int16_t jitterX = 0; // random velocity offset in [-jitter, jitter]
+  int16_t jitterY = 0;
+  int16_t radialMin = 0; // extra speed in a random direction, for bursts
+  int16_t radialMax = 0;
+  uint16_t lifeMin = 0; // frames, 0 = until killed or off screen
+  uint16_t lifeMax = 0;
+  uint8_t brightnessMin = 255;
+  uint8_t brightnessMax = 255;
+  uint8_t sizeMin = 0; // trail length, or final ring radius
+  uint8_t sizeMax = 0;
+};
+
+class ParticleSystem
+{
+private:
+  int16_t *x;
+  int16_t *y;
+  int16_t *vx;
+  int16_t *vy;
+  uint16_t *phase;
+  uint16_t *rate;
+  uint8_t *brightness;
+  uint8_t *size;
+  uint16_t capacity;
+  uint16_t count = 0;
+
+  Xorshift32 rng;
+
+  int16_t gravityX = 0;
+  int16_t gravityY = 0;
+  uint8_t dragShift = 0;
+  int16_t wobble = 0;
+  ParticleEdge edge = EDGE_NONE;
+  int16_t margin = 0;
+  ParticleFade fade = FADE_NONE;
+  bool looping = false;
+  ParticleShape shape = SHAPE_POINT;
+  int16_t ringWidth = PARTICLE_ONE;
+
+  uint8_t getBrightness(uint16_t index) const;
+  bool applyEdge(uint16_t index);
+  void drawPoint(uint8_t *buffer, int16_t px, int16_t py, uint8_t value) const;
+  void drawRing(uint8_t *buffer, uint16_t index, uint8_t value) const;
+
+protected:
+  ParticleSystem(int16_t *x,
+                 int16_t *y,
+                 int16_t *vx,
+                 int16_t *vy,
+                 uint16_t *phase,
+                 uint16_t *rate,
+                 uint8_t *brightness,
+                 uint8_t *size,
+                 uint16_t capacity);
+
+public:
+  ParticleSystem(const ParticleSystem &) = delete;
+  ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+  // Added to the velocity every frame
+  void setGravity(int16_t gx, int16_t gy);
+  // Velocity loses 1 / 2^shift every frame, 0 = no drag
+  void setDrag(uint8_t shift);
+  // Random step in [-amount, amount] added to the position every frame
+  void setWobble(int16_t amount);
+  // marginPixels only matters for EDGE_KILL, so trails can leave the screen first
+  void setEdge(ParticleEdge mode, uint8_t marginPixels = 0);
+  // Looping particles start their life over instead of dying, and are emitted at a random
+  // point of it
+  void setFade(ParticleFade curve, bool loop = false);
+  // width is the ring thickness on each side of the radius, 8.8 fixed point
+  void setShape(ParticleShape newShape, int16_t width = PARTICLE_ONE);
+
+  // Empties the pool and reseeds the generator from micros()
+  void clear();
+  // false when the pool is full
+  bool emit(const ParticleEmitter &emitter);
+  uint16_t emit(const ParticleEmitter &emitter, uint16_t amount);
+  void kill(uint16_t index);
+
+  // Moves every particle one frame and removes the dead ones
+  void update();
+  // Adds the particles to what is already on the canvas
+  void draw(Canvas &canvas) const;
+
+  uint16_t getCount() const { return count; }
+  uint16_t getCapacity() const { return capacity; }
+  int16_t getX(uint16_t index) const { return x[index]; }
+  int16_t getY(uint16_t index) const { return y[index]; }
+  Xorshift32 &getRandom() { return rng; }
+};
+
+template <uint16_t CAPACITY>
+class Particles : public ParticleSystem
+{
+private:
+  int16_t xs[CAPACITY];
+  int16_t ys[CAPACITY];
+  int16_t vxs[CAPACITY];
+  int16_t vys[CAPACITY];
+  uint16_t phases[CAPACITY];
+  uint16_t rates[CAPACITY];
+  uint8_t brightnesses[CAPACITY];
+  uint8_t sizes[CAPACITY];
+
+public:
+  Particles() : ParticleSystem(xs, ys, vxs, vys, phases, rates, brightnesses, sizes, CAPACITY) {}
+};
+
+// Saturating subtract on the whole canvas
+void fadeScreen(Canvas &canvas, uint8_t amount);
+// Scales the whole canvas by scale / 256
+void dimScreen(Canvas &canvas, uint8_t scale);
@@ -1,17 +1,29 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "animationstore.h"
 
 class AnimationPlugin : public Plugin
 {
 private:
-  uint8_t step = 0;
-  std::vector<std::vector<int>> customAnimationFrames;
-  int frameDelay = 400;
+  AnimationReader reader;
+  unsigned long lastFrame = 0;
+  uint16_t frameDelay = 0;
+  uint8_t frame[ROWS * COLS];
+
+  // legacy JSON upload from the websocket, written to flash by loop() on the render task
+  uint8_t *pendingScreens = nullptr;
+  uint16_t pendingCount = 0;
+  uint16_t pendingDelay = 0;
+  volatile bool pendingUpload = false;
+
+  void showPlaceholder();
+  void storePendingUpload();
 
 public:
   void setup() override;
   void loop() override;
+  void teardown() override;
   const char *getName() const override;
   void websocketHook(JsonDocument &request) override;
 };
@@ -10,6 +10,8 @@ class ArtNetPlugin : public Plugin
 {
 private:
   ArtnetWifi artnet;
+  // the DMX callback is a plain function, it reaches the plugin's canvas through this
+  static ArtNetPlugin *instance;
 
 public:
   void setup() override;
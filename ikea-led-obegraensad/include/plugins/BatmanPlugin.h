@@ -12,7 +12,6 @@ private:
 
   void drawBatSignal(float pulse, float fade);
   void drawSkyline(uint8_t brightness);
-  void drawBatmanFrame(const uint8_t *frame, int yOff, uint8_t scale, bool mirror);
 
 public:
   void setup() override;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "coroutine.h"
 
 class BreakoutPlugin : public Plugin
 {
@@ -39,9 +40,12 @@ private:
   uint8_t score;
   unsigned long lastBallUpdate = 0;
 
+  Coroutine co;
+  unsigned char brickIndex;
+
   void resetLEDs();
   void initGame();
-  void initBricks();
+  void initBrick(unsigned char i);
   void newLevel();
   void updateBall();
   void hitBrick(unsigned char i);
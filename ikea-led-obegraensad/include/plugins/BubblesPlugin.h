@@ -1,25 +1,16 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
 #include "timing.h"
 
 class BubblesPlugin : public Plugin
 {
 private:
-  struct Bubble
-  {
-    float x;
-    float y;
-    float radius;
-    float speed;
-    uint8_t brightness;
-  };
-
   NonBlockingDelay timer;
   static constexpr uint8_t kBubbleCount = 6;
-  Bubble bubbles[kBubbleCount];
-
-  void resetBubble(Bubble &bubble);
+  Particles<kBubbleCount> bubbles;
+  ParticleEmitter source;
 
 public:
   void setup() override;
@@ -24,6 +24,7 @@ private:
 
   struct tm timeinfo;
   NonBlockingDelay secondTimer;
+  NonBlockingDelay weatherTimer;
 
   int currentCityIndex = 0;
   char savedTz[100] = {0};
@@ -31,7 +32,6 @@ private:
   int cachedTemperature = -99;
   int weatherIcon = -1;
   bool hasWeatherData = false;
-  unsigned long lastWeatherUpdate = 0;
 
   int displayMode = 0;
   unsigned long modeStartTime = 0;
@@ -39,7 +39,7 @@ private:
   int cityScrollX = -16;
 
   void loadConfig();
-  void fetchWeather();
+  void updateWeather();
   void drawClock();
   void drawTemperature();
   int mapWmoCode(int code, bool isNight);
@@ -48,6 +48,7 @@ private:
 
 public:
   void setup() override;
+  void prepare() override;
   void loop() override;
   void teardown() override;
   void websocketHook(JsonDocument &request) override;
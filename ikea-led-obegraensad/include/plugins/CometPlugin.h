@@ -1,17 +1,14 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
 #include "timing.h"
 
 class CometPlugin : public Plugin
 {
 private:
   NonBlockingDelay timer;
-  float x = 0.0f;
-  float y = 0.0f;
-  float vx = 0.8f;
-  float vy = 0.5f;
-  uint8_t trail[16][16] = {};
+  Particles<1> comet;
 
   void resetComet();
 
@@ -26,7 +26,6 @@ private:
   int numCacti;
   int spawnTimer;
 
-  void drawDino(int bx, int by);
   void drawCactus(const Cactus &c);
 
 public:
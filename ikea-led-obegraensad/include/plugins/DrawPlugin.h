@@ -1,11 +1,17 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "coroutine.h"
 
 class DrawPlugin : public Plugin
 {
+private:
+  Coroutine co;
+
 public:
   void setup() override;
+  void loop() override;
   const char *getName() const override;
   void websocketHook(JsonDocument &request) override;
+  void websocketFrameHook(const WsFrame &frame) override;
 };
@@ -1,21 +1,14 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
 #include "timing.h"
 
-struct Droplet
-{
-  float x, y;
-  float radius;
-  float maxRadius;
-  bool active;
-};
-
 class DropletPlugin : public Plugin
 {
 private:
   static const int MAX_DROPLETS = 5;
-  Droplet droplets[MAX_DROPLETS];
+  Particles<MAX_DROPLETS> droplets;
   NonBlockingDelay frameTimer;
   NonBlockingDelay spawnTimer;
 
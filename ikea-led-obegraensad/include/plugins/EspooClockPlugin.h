@@ -8,11 +8,11 @@ class EspooClockPlugin : public Plugin
 private:
   struct tm timeinfo;
   NonBlockingDelay secondTimer;
+  NonBlockingDelay weatherTimer;
 
   int cachedTemperature = -99;
   int weatherIcon = -1; // -1 = no data, 0-7 = weatherIcons index
   bool hasWeatherData = false;
-  unsigned long lastWeatherUpdate = 0;
   int lastHttpError = 0; // 0=not tried, 200=ok, negative=HTTP error
 
   // Display modes: 0=clock, 1=scrolling city name, 2=temperature+icon
@@ -22,13 +22,14 @@ private:
   bool colonVisible = true;
   int cityScrollX = -16;
 
-  void fetchWeather();
+  void updateWeather();
   void drawClock();
   void drawTemperature();
   int mapWmoCode(int code, bool isNight);
 
 public:
   void setup() override;
+  void prepare() override;
   void loop() override;
   void teardown() override;
   const char *getName() const override;
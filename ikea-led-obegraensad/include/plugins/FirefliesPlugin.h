@@ -1,22 +1,15 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
 #include "timing.h"
 
 class FirefliesPlugin : public Plugin
 {
 private:
-  struct Firefly
-  {
-    float x;
-    float y;
-    float vx;
-    float vy;
-  };
-
   NonBlockingDelay timer;
   static constexpr uint8_t kFireflyCount = 10;
-  Firefly fireflies[kFireflyCount];
+  Particles<kFireflyCount> fireflies;
 
 public:
   void setup() override;
@@ -1,18 +1,22 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
+#include "timing.h"
 
 class FireworkPlugin : public Plugin
 {
 private:
-  unsigned long previousMillis = 0;
-  const long explosionDelay = 60;
-  const long fadeDelay = 24;
-  const long rocketDelay = 60;
-  const long explosionDuration = 500;
+  NonBlockingDelay timer;
+  static constexpr uint8_t FRAME_MS = 30;
+  static constexpr uint8_t MAX_SPARKS = 96;
 
-  void drawExplosion(int x, int y, int maxRadius, int brightness);
-  void explode(int x, int y);
+  Particles<1> rocket;
+  Particles<MAX_SPARKS> sparks;
+  int16_t burstY = 0;
+
+  void launch();
+  void explode(int16_t x, int16_t y);
 
 public:
   void setup() override;
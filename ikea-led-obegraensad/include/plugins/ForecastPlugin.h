@@ -21,20 +21,20 @@ private:
   static constexpr int cityCount = 4;
 
   NonBlockingDelay displayTimer;
+  NonBlockingDelay fetchTimer;
 
   int currentCityIndex = 0;
   int maxTemp = -99;
   int minTemp = -99;
   int weatherIcon = -1;
   bool hasData = false;
-  unsigned long lastFetch = 0;
 
   int displayMode = 0;
   unsigned long modeStart = 0;
   int scrollX = -16;
 
   void loadConfig();
-  void fetchForecast();
+  void updateForecast();
   void drawIcon();
   void drawTemps();
   void drawTempValue(int temp, int y);
@@ -42,6 +42,7 @@ private:
 
 public:
   void setup() override;
+  void prepare() override;
   void loop() override;
   void websocketHook(JsonDocument &request) override;
   const char *getName() const override;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "coroutine.h"
+#include "lifeengine.h"
 #include "timing.h"
 
 class GameOfLifePlugin : public Plugin
@@ -10,20 +12,41 @@ private:
   static constexpr uint8_t STATE_END = 2;
   static constexpr uint8_t STATE_INIT = 3;
   static constexpr uint8_t STATE_END_DELAY = 4;
+
+  // displayed frames per run for a 16x16 universe, larger ones get proportionally more
+  static constexpr uint16_t FRAMES_PER_RUN = 120;
+  // frames still shown once an oscillator (period > 1) is found
+  static constexpr uint16_t FRAMES_AFTER_CYCLE = 20;
+  static constexpr uint16_t MAX_STEPS_PER_FRAME = 1000;
+
   uint8_t state;
-  uint8_t previous2[ROWS * COLS];
-  uint8_t previous[ROWS * COLS];
-  uint8_t buffer[ROWS * COLS];
-  uint8_t updateCell(int row, int col);
-  uint8_t countNeighbours(int row, int col);
-  void next();
+  LifeEngine life;
+  uint8_t universeSize = 64;
+  uint16_t stepsPerFrame = 1;
+  int16_t framesLeft = 0;
+
+  // rule change from the websocket, picked up with the next board
+  uint16_t pendingBirth = 0;
+  uint16_t pendingSurvive = 0;
+  volatile bool pendingRule = false;
+
+  // top-left corner of the visible 16x16 window; auto pan drifts it towards activity
+  uint8_t viewX = 0;
+  uint8_t viewY = 0;
+  uint8_t targetX = 0;
+  uint8_t targetY = 0;
+  bool autoPan = true;
+  uint8_t panCounter = 0;
+
   void init();
   void show();
+  void pan();
+  uint8_t getCell(int x, int y) const;
   uint16_t gol_delay = 150;
 
   NonBlockingDelay updateTimer;
-  NonBlockingDelay initTimer;
-  uint8_t initStep = 0;
+  Coroutine initCo;
+  uint8_t revealStep = 0;
 
 public:
   void setup() override;
@@ -13,9 +13,6 @@ private:
   int jumpPhase = -1; // -1 = not jumping, 0..JUMP_LEN-1 = arc
   int frameCount = 0;
 
-  void drawSprite(const uint8_t *sprite, int rows, int x, int y,
-                  int width, uint8_t brightness);
-
 public:
   void setup() override;
   void loop() override;
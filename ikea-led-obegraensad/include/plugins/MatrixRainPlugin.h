@@ -1,6 +1,7 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
 #include "timing.h"
 
 class MatrixRainPlugin : public Plugin
@@ -8,18 +9,12 @@ class MatrixRainPlugin : public Plugin
 private:
   NonBlockingDelay timer;
   static constexpr uint8_t NUM_COLUMNS = 16;
-  static constexpr uint8_t HEIGHT = 16;
   static constexpr uint8_t MAX_TRAIL_LENGTH = 8;
-  
-  struct Column
-  {
-    int8_t y;
-    uint8_t speed;
-    uint8_t length;
-    bool active;
-  };
 
-  Column columns[NUM_COLUMNS];
+  Particles<2 * NUM_COLUMNS> streams;
+  ParticleEmitter column;
+
+  void startStream(uint8_t x, int16_t y);
 
 public:
   void setup() override;
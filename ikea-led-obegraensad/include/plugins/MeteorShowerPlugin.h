@@ -1,24 +1,16 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
 #include "timing.h"
 
 class MeteorShowerPlugin : public Plugin
 {
 private:
-  struct Meteor
-  {
-    float x;
-    float y;
-    float vx;
-    float vy;
-  };
-
   NonBlockingDelay timer;
   static constexpr uint8_t kMeteorCount = 6;
-  Meteor meteors[kMeteorCount];
-
-  void resetMeteor(Meteor &meteor);
+  Particles<kMeteorCount> meteors;
+  ParticleEmitter sky;
 
 public:
   void setup() override;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "snakeengine.h"
 #include "timing.h"
 
 class SnakePlugin : public Plugin
@@ -15,13 +16,13 @@ private:
   static constexpr uint16_t SNAKE_DELAY_MS = 100;
   static constexpr uint16_t BLINK_SHORT_MS = 200;
   static constexpr uint16_t BLINK_LONG_MS = 500;
+  // a full board has 256 cells, fade it out faster than a short snake
+  static constexpr uint16_t FADE_FAST_MS = 20;
+  static constexpr uint8_t FOOD_BRIGHTNESS = 40;
 
   unsigned char gameState;
-  unsigned char lastDirection = 0; // 0=unset 1=up 2=right 3=down 4 =left
-
-  std::vector<uint> position = {240, 241, 242};
-
-  uint8_t dot;
+  SnakeEngine snake;
+  uint16_t moveDelay = SNAKE_DELAY_MS;
 
   NonBlockingDelay moveTimer;
   NonBlockingDelay animationTimer;
@@ -29,8 +30,8 @@ private:
 
   void initGame();
   void newDot();
-  void findDirection();
-  void moveSnake(uint newpos);
+  void moveSnake();
+  void drawBody(uint8_t value);
   void end();
   void updateDeathAnimation();
 
@@ -38,4 +39,5 @@ public:
   void setup() override;
   void loop() override;
   const char *getName() const override;
+  void websocketHook(JsonDocument &request) override;
 };
@@ -1,13 +1,17 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
 #include "timing.h"
 
 class SparkleFieldPlugin : public Plugin
 {
 private:
   NonBlockingDelay timer;
-  uint8_t sparkles[16][16] = {};
+  static constexpr uint8_t SPARKLES_PER_FRAME = 6;
+  static constexpr uint8_t SPARKLE_FRAMES = 14;
+  Particles<SPARKLES_PER_FRAME * SPARKLE_FRAMES> sparkles;
+  ParticleEmitter sparkle;
 
 public:
   void setup() override;
@@ -2,6 +2,29 @@
 
 #include "PluginManager.h"
 #include "timing.h"
+#if __has_include("AsyncUDP.h")
+#include "AsyncUDP.h"
+#include "audiospectrum.h"
+#define ASYNC_UDP_ENABLED
+#endif
+
+/**
+ * Spectrum analyzer for audio streamed over UDP (port 4049, see audio.py), falling back to an
+ * idle animation when nothing arrives.
+ *
+ * Packet: 12 byte header, then 16 bit little endian mono samples.
+ *   0-1  "AU"
+ *   2    version, 1
+ *   3    channels, 1
+ *   4-7  sample rate in Hz, little endian
+ *   8-11 sequence number, little endian; late and duplicate packets are dropped
+ *
+ * The UDP task only copies samples into the ring buffer; the FFT runs in loop() every 10 ms
+ * on the newest 256 samples.
+ */
+
+constexpr uint16_t AUDIO_PORT = 4049;
+constexpr uint8_t AUDIO_HEADER_SIZE = 12;
 
 class SpectrumPlugin : public Plugin
 {
@@ -9,11 +32,29 @@ private:
   float levels[16];
   float targets[16];
   float peaks[16];
+  unsigned long peakTimes[16];
   NonBlockingDelay frameTimer;
   NonBlockingDelay targetTimer;
 
+#ifdef ASYNC_UDP_ENABLED
+  AsyncUDP *udp = nullptr;
+  AudioSpectrum *audio = nullptr;
+  volatile uint32_t sampleRate = 0;
+  uint32_t lastSequence = 0;
+  bool sequenced = false;
+  uint32_t lastWritten = 0;
+  unsigned long lastAudio = 0;
+
+  void receive(const uint8_t *data, size_t length);
+  void showAudio();
+#endif
+
+  void showIdle();
+  void drawBars();
+
 public:
   void setup() override;
+  void teardown() override;
   void loop() override;
   const char *getName() const override;
 };
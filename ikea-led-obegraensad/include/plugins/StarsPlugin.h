@@ -1,19 +1,16 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "particles.h"
+#include "timing.h"
 
-struct Star
-{
-  int x;
-  int y;
-  int brightness;
-  unsigned long lastUpdateTime;
-};
 class StarsPlugin : public Plugin
 {
 private:
-  int numStars = 25;
-  Star stars[25];
+  NonBlockingDelay timer;
+  static constexpr uint8_t NUM_STARS = 25;
+  Particles<NUM_STARS> stars;
+  ParticleEmitter sky;
 
 public:
   void setup() override;
@@ -1,20 +1,34 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "tetrisengine.h"
 #include "timing.h"
 
 class TetrisPlugin : public Plugin
 {
 private:
-  static const int FIELD_W = 10;
-  static const int FIELD_H = 16;
+  static const int FIELD_W = TETRIS_WIDTH;
+  static const int FIELD_H = TETRIS_HEIGHT;
   static const int OFFSET_X = 3;
 
+  // CPU time the placement search may use per loop() call
+  static constexpr uint16_t SEARCH_BUDGET_US = 1000;
+
+  TetrisEngine engine;
+  // piece type + 1 of every locked block, only for drawing
   uint8_t board[FIELD_H][FIELD_W];
 
   int currentType;
+  int nextType;
   int currentRot;
   int currentX, currentY;
+  bool thinking = false;
+
+  // measured cost of one scored field in 1/16 us, sizes the per-call search budget
+  uint32_t evalCost16 = 16 * 8;
+  uint32_t searchMicros = 0;
+  uint32_t pieces = 0;
+  uint32_t lines = 0;
 
   enum State { PLAYING, CLEARING, GAMEOVER };
   State state;
@@ -25,13 +39,9 @@ private:
 
   void newGame();
   void spawnPiece();
-  bool canPlace(int type, int rot, int x, int y);
-  int findDropY(int type, int rot, int x);
+  void think();
   void lockPiece();
-  bool hasCompleteLines();
   void removeCompleteLines();
-  void chooseBestPlacement(int type, int &outRot, int &outX);
-  int evaluatePlacement(int type, int rot, int x);
   void drawBoard();
 
 public:
@@ -1,33 +1,23 @@
 #pragma once
 
-#ifdef ESP32
-#include <HTTPClient.h>
-#endif
-#ifdef ESP8266
-#include <ESP8266HTTPClient.h>
-#include <ESP8266WiFi.h>
-#include <WiFiClient.h>
-#endif
 #include "PluginManager.h"
+#include "timing.h"
 #include <ArduinoJson.h>
 class WeatherPlugin : public Plugin
 {
 private:
-  unsigned long lastUpdate = 0;
-  HTTPClient http;
-#ifdef ESP32
-#endif
-#ifdef ESP8266
-  WiFiClient wiFiClient;
-#endif
+  NonBlockingDelay updateTimer;
 
   // Cached weather data
-  bool hasCachedData = false;
   int cachedTemperature = 0;
   int cachedWeatherIcon = 0;
   int cachedIconY = 1;
   int cachedTempY = 10;
 
+  // What is on screen, to redraw only on change (-1 = loading, -2 = error)
+  int shownCode = -1;
+  int shownTemperature = 0;
+
   std::vector<int> thunderCodes = {200, 386, 389, 392, 395};
   std::vector<int> cloudyCodes = {119, 122};
   std::vector<int> partyCloudyCodes = {116};
@@ -39,17 +29,11 @@ private:
 
 private:
   void drawWeather();
+  void drawError();
 
 public:
-  ~WeatherPlugin()
-  {
-#ifdef ESP32
-#endif
-  }
-
   void update();
   void setup() override;
   void loop() override;
-  void teardown() override;
   const char *getName() const override;
 };
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "constants.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * Standby for the hours nobody looks at the display.
+ *
+ * Blanking windows are times of day (optionally per weekday) in which the panel goes into
+ * standby: the PWM timer is stopped, the LED drivers are disabled through PIN_ENABLE, the render
+ * task parks until woken and WiFi drops to modem sleep at a lower CPU clock. The web server stays
+ * reachable. A button press or POST /api/power wakes the panel right away; such a manual
+ * override lasts until the next window edge, then the schedule takes over again.
+ *
+ * Energy figures are estimates from the constants below, not measurements.
+ */
+
+constexpr uint8_t POWER_MAX_WINDOWS = 4;
+constexpr unsigned long POWER_CHECK_INTERVAL_MS = 1000;
+
+// rough figures of a typical board at 5 V, adjust for your hardware
+constexpr uint16_t POWER_RUN_MW = 600;       // ESP32 with WiFi, PWM timer and SPI running
+constexpr uint16_t POWER_STANDBY_MW = 150;   // modem sleep at 80 MHz, timer stopped
+constexpr uint16_t POWER_LEDS_FULL_MW = 2500; // all 256 LEDs at full brightness
+
+struct BlankingWindow
+{
+  uint16_t start; // minutes since midnight
+  uint16_t end;   // exclusive, may be smaller than start to span midnight
+  uint8_t days;   // bit 0 = Sunday, as in tm_wday; refers to the day the window starts
+};
+
+enum PowerOverride : uint8_t
+{
+  POWER_OVERRIDE_NONE,
+  POWER_OVERRIDE_ON,
+  POWER_OVERRIDE_STANDBY,
+};
+
+class Power_
+{
+private:
+  Power_() = default;
+
+  BlankingWindow windows[POWER_MAX_WINDOWS];
+  uint8_t windowCount = 0;
+
+  volatile bool standby = false;
+  bool scheduled = false; // state the windows asked for at the last check
+  PowerOverride manual = POWER_OVERRIDE_NONE;
+  volatile PowerOverride requested = POWER_OVERRIDE_NONE;
+  volatile bool requestAuto = false;
+  unsigned long lastCheck = 0;
+  bool recheck = true;
+
+  unsigned long standbySince = 0;
+  uint64_t standbyMs = 0;
+  uint32_t savingMw = 0; // estimated while the current standby lasts
+  uint64_t savedMwMs = 0;
+  uint32_t standbyCount = 0;
+  uint32_t cpuMhz = 0;
+
+#ifdef ESP32
+  TaskHandle_t renderTask = nullptr;
+#endif
+
+  bool isScheduled(const struct tm &now) const;
+  void enterStandby();
+  void leaveStandby();
+
+public:
+  static Power_ &getInstance();
+
+  Power_(const Power_ &) = delete;
+  Power_ &operator=(const Power_ &) = delete;
+
+  void begin();
+
+  // Applies requests and follows the windows; called from loop()
+  void update();
+
+  // Manual overrides, applied on the next update(); they hold until the next window edge
+  void wake();
+  void sleep();
+  // Drops a manual override and follows the windows again
+  void resumeSchedule();
+
+  bool isStandby() const;
+
+  // Called by the render task before each plugin frame, blocks while in standby
+  void parkRenderTask();
+
+  // JSON array like [{"start":"22:00","end":"07:00","days":[1,2,3,4,5]}], days are optional
+  bool setWindowsByJSONString(const String &json);
+
+  void toJson(JsonObject object);
+};
+
+extern Power_ &Power;
@@ -10,16 +10,16 @@ struct ScheduleItem
   unsigned long duration; // Duration in milliseconds
 };
 
+// Plugin::prepare() of the next entry runs this long before its slot starts
+constexpr unsigned long SCHEDULER_PREPARE_LEAD_MS = 15000;
+
 class PluginScheduler
 {
 private:
   PluginScheduler() = default;
   unsigned long lastSwitch = 0;
   size_t currentIndex = 0;
-
-  bool needsPersist = false;
-  unsigned long lastPersistRequest = 0;
-  static constexpr unsigned long PERSIST_DELAY_MS = 2000;
+  bool nextPrepared = false;
 
 public:
   static PluginScheduler &getInstance();
@@ -35,13 +35,19 @@ public:
   void start();
   void stop();
   void update();
+
+  // Entry that follows the current slot, nullptr while the schedule is not running
+  const ScheduleItem *getNextItem() const;
+  unsigned long getMillisUntilNext() const;
+  void nextToJson(JsonObject object) const;
   void init();
   bool setScheduleByJSONString(String scheduleJson);
 
 private:
   void switchToCurrentPlugin();
-  void requestPersist();
-  void checkAndPersist();
+  // Index of the entry after the current one, skipping demoted plugins (see
+  // PluginManager::isDemoted); schedule.size() when every entry is demoted
+  size_t nextRunnableIndex() const;
 };
 
 extern PluginScheduler &Scheduler;
\ No newline at end of file
@@ -1,18 +1,20 @@
 #pragma once
 
 #include "PluginManager.h"
+#include "canvas.h"
 #include "constants.h"
 #include "signs.h"
 #include "storage.h"
 #include <Arduino.h>
 #include <vector>
-class Screen_
+// The canvas shown on the panel, plus the LED driver behind it
+class Screen_ : public Canvas
 {
 private:
-  Screen_() = default;
+  Screen_() : Canvas(renderBuffer_) {}
 
   uint8_t brightness_ = MAX_BRIGHTNESS;
-  uint8_t renderBuffer_[ROWS * COLS];
+  alignas(4) uint8_t renderBuffer_[ROWS * COLS];
   uint8_t rotatedRenderBuffer_[ROWS * COLS];
   const uint8_t positions[ROWS * COLS] = {
       0x0f, 0x0e, 0x0d, 0x0c, 0x0b, 0x0a, 0x09, 0x08, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
@@ -32,8 +34,25 @@ private:
       0xe7, 0xe6, 0xe5, 0xe4, 0xe3, 0xe2, 0xe1, 0xe0, 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
       0xef, 0xee, 0xed, 0xec, 0xeb, 0xea, 0xe9, 0xe8, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
 
+  bool standby_ = false;
+  volatile uint32_t skippedRenders_ = 0;
+#ifdef ESP32
+  hw_timer_t *timer_ = nullptr;
+#endif
+
+  // pixel value -> on time per PWM cycle in ticks with 4 fraction bits, gamma and brightness
+  // applied; rebuilt by setBrightness()
+  uint16_t levelTable_[256] = {0};
+  // in shift order: ticks to stay on in the current PWM cycle, and the fraction carried over
+  // to the next cycles (temporal dithering)
+  uint8_t duty_[ROWS * COLS] = {0};
+  uint8_t residual_[ROWS * COLS] = {0};
+
   static void onScreenTimer();
+  void buildLevelTable();
+  void prepareCycle(const uint8_t *buf);
   void _render();
+  bool isBlank() const;
   void rotate();
   uint8_t *getRotatedRenderBuffer();
 
@@ -49,45 +68,21 @@ public:
   uint8_t getCurrentBrightness() const;
   void setBrightness(uint8_t brightness, bool shouldStore = false);
 
-  void setRenderBuffer(const uint8_t *renderBuffer, bool grays = false);
-  uint8_t *getRenderBuffer();
-
-  void clear();
-  void clearRect(int x, int y, int width, int height);
-
-  void setPixel(uint8_t x, uint8_t y, uint8_t value, uint8_t brightness = MAX_BRIGHTNESS);
-  void setPixelAtIndex(uint8_t index, uint8_t value, uint8_t brightness = MAX_BRIGHTNESS);
+  // The render task is done with a frame, hands it to the recorder (see framerecorder.h)
+  void commitFrame();
 
   void setup();
 
+  // Stops the PWM timer and disables the LED drivers, see power.h
+  void setStandby(bool standby);
+  bool isStandby() const;
+  // Timer ticks that had nothing to shift out because the frame is dark
+  uint32_t getSkippedRenders() const;
+
   void loadFromStorage();
   void persist();
-  uint8_t getBufferIndex(int index);
-
-  void drawLine(int x1, int y1, int x2, int y2, int ledStatus, uint8_t brightness = MAX_BRIGHTNESS);
-  void drawRectangle(int x,
-                     int y,
-                     int width,
-                     int height,
-                     bool fill,
-                     int ledStatus,
-                     uint8_t brightness = MAX_BRIGHTNESS);
-  void drawCharacter(int x,
-                     int y,
-                     const std::vector<int> &bits,
-                     int bitCount,
-                     uint8_t brightness = MAX_BRIGHTNESS);
-  void drawNumbers(int x,
-                   int y,
-                   const std::vector<int> &numbers,
-                   uint8_t brightness = MAX_BRIGHTNESS);
-  void drawBigNumbers(int x,
-                      int y,
-                      const std::vector<int> &numbers,
-                      uint8_t brightness = MAX_BRIGHTNESS);
-  void drawWeather(int x, int y, int weather, uint8_t brightness = MAX_BRIGHTNESS);
-  std::vector<int> readBytes(const std::vector<int> &bytes);
 
+  // Blocking animations straight on the panel, for messages outside of any plugin
   void scrollText(const std::string &text,
                   int delayTime = 30,
                   uint8_t brightness = MAX_BRIGHTNESS,
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "constants.h"
+
+#include <Arduino.h>
+
+/**
+ * Write-behind store for everything the firmware keeps in NVS.
+ *
+ * All settings are read once at boot into an in-RAM shadow. Setters only update the shadow and
+ * mark the entry dirty; a low-priority task commits dirty entries in one batch per namespace once
+ * no change arrived for SETTINGS_DEBOUNCE_MS (or SETTINGS_MAX_DELAY_MS after the first change, so
+ * a slider dragged for a minute is still saved). Every flash write stalls the caches of both
+ * cores and with it the display ISR, so a burst of events costs one commit instead of one each.
+ *
+ * Keys and NVS types are unchanged from the previous direct Preferences calls, existing devices
+ * keep their settings. FetchService keeps its last good values here as well, in a fixed number
+ * of blob settings, so nothing else in the firmware opens Preferences.
+ */
+
+enum SettingId : uint8_t
+{
+  SETTING_BRIGHTNESS,
+  SETTING_ROTATION,
+  SETTING_CURRENT_PLUGIN,
+  SETTING_SCHEDULE,
+  SETTING_SCHEDULE_ACTIVE,
+  SETTING_SCHEDULE_INDEX,
+  SETTING_WEATHER_LOCATION,
+  SETTING_NTP_SERVER,
+  SETTING_TZ_INFO,
+  SETTING_AUTO_SCHEDULE,
+  SETTING_CITYCLOCK_CITY,
+  SETTING_FORECAST_CITY,
+  SETTING_POWER_WINDOWS,
+  SETTING_PLUGIN_BUDGET,
+  SETTING_TLS_RESERVE,
+  // blobs of FetchService's last good values, see FETCH_PERSIST_SLOTS
+  SETTING_FETCH_SLOT_0,
+  SETTING_FETCH_SLOT_1,
+  SETTING_FETCH_SLOT_2,
+  SETTING_FETCH_SLOT_3,
+  SETTING_COUNT
+};
+
+constexpr uint8_t FETCH_PERSIST_SLOTS = SETTING_COUNT - SETTING_FETCH_SLOT_0;
+// blob settings are the last ones, each holds at most SETTINGS_BLOB_BYTES
+constexpr uint8_t SETTINGS_FIRST_BLOB = SETTING_FETCH_SLOT_0;
+constexpr size_t SETTINGS_BLOB_BYTES = 32;
+
+constexpr unsigned long SETTINGS_DEBOUNCE_MS = 2000;
+constexpr unsigned long SETTINGS_MAX_DELAY_MS = 10000;
+
+class Settings_
+{
+private:
+  Settings_() = default;
+
+  int32_t ints[SETTING_COUNT] = {0};
+  String strings[SETTING_COUNT];
+  uint8_t blobs[SETTING_COUNT - SETTINGS_FIRST_BLOB][SETTINGS_BLOB_BYTES] = {{0}};
+  uint8_t blobLengths[SETTING_COUNT - SETTINGS_FIRST_BLOB] = {0};
+  bool dirty[SETTING_COUNT] = {false};
+
+  bool available = false;
+  bool pending = false;
+  unsigned long firstChange = 0;
+  unsigned long lastChange = 0;
+
+  uint32_t commits = 0;
+  uint32_t writes = 0;
+  uint32_t coalesced = 0;
+
+#ifdef ESP32
+  SemaphoreHandle_t mutex = nullptr;
+  SemaphoreHandle_t commitMutex = nullptr;
+  TaskHandle_t taskHandle = nullptr;
+  static void task(void *parameter);
+#endif
+
+  void lock();
+  void unlock();
+  void setDefault(SettingId id);
+  void markDirty(SettingId id);
+  void commit();
+
+public:
+  static Settings_ &getInstance();
+
+  Settings_(const Settings_ &) = delete;
+  Settings_ &operator=(const Settings_ &) = delete;
+
+  // Loads the shadow from NVS and starts the commit task; safe to call more than once
+  bool begin();
+  bool isAvailable() const;
+
+  int32_t getInt(SettingId id);
+  bool getBool(SettingId id);
+  String getString(SettingId id);
+
+  void setInt(SettingId id, int32_t value);
+  void setBool(SettingId id, bool value);
+  void setString(SettingId id, const String &value);
+
+  // Copies a blob setting into out, returns its length (0 = never stored or larger than maxLen)
+  size_t getBlob(SettingId id, void *out, size_t maxLen);
+  // length is capped at SETTINGS_BLOB_BYTES
+  void setBlob(SettingId id, const void *data, size_t length);
+
+  // Commits when the debounce window has passed; called by the task (ESP32) or loop() (ESP8266)
+  void update();
+
+  // Commits all dirty settings right away, e.g. before a reboot
+  void flush();
+
+  // Drops pending changes of a namespace, erases it in NVS and restores the defaults
+  void clear(const char *ns);
+
+  uint32_t getCommitCount() const;
+  uint32_t getWriteCount() const;
+  uint32_t getCoalescedCount() const;
+};
+
+extern Settings_ &Settings;
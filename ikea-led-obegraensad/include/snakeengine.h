@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Snake on the 16x16 board that plays until the board is full.
+ *
+ * The body is a ring buffer (push head and pop tail are O(1)) mirrored in a 256 bit occupancy
+ * bitboard. Moves follow a Hamiltonian cycle over the board and take shortcuts whenever they
+ * do not jump past the tail in cycle order: the body then always lies on the cycle between tail
+ * and head, so following the cycle stays possible and the snake never traps itself. Among the
+ * allowed shortcuts a BFS distance field from the food picks the shortest real route; the chosen
+ * move is checked once more for a free path to the tail, otherwise the plain cycle step is
+ * taken. A decision is two BFS passes over at most 256 cells.
+ */
+
+constexpr uint8_t SNAKE_WIDTH = 16;
+constexpr uint8_t SNAKE_HEIGHT = 16;
+constexpr uint16_t SNAKE_CELLS = SNAKE_WIDTH * SNAKE_HEIGHT;
+
+enum SnakeStep : uint8_t
+{
+  SNAKE_MOVED,
+  SNAKE_ATE,
+  SNAKE_DEAD,
+  SNAKE_WON,
+};
+
+class SnakeEngine
+{
+private:
+  uint8_t body[SNAKE_CELLS]; // ring buffer, tail first
+  uint8_t tailSlot = 0;
+  uint16_t length = 0;
+  uint32_t occupied[SNAKE_CELLS / 32];
+
+  uint8_t food = 0;
+  uint8_t vacated = 0;
+
+  // Hamiltonian cycle: position of each cell on it and the cell at each position
+  uint8_t cycleIndex[SNAKE_CELLS];
+  uint8_t cycleOrder[SNAKE_CELLS];
+
+  void buildCycle();
+  bool isBlocked(const uint32_t *board, uint8_t cell) const;
+  void setBit(uint32_t *board, uint8_t cell, bool value);
+  uint8_t getNeighbours(uint8_t cell, uint8_t *out) const;
+  uint16_t cycleDistance(uint8_t from, uint8_t to) const;
+  uint8_t bodyAt(uint16_t i) const;
+  void computeFoodDistances(uint8_t *distances) const;
+  bool tailReachableAfter(uint8_t next) const;
+  bool chooseMove(uint8_t &next);
+
+public:
+  SnakeEngine();
+
+  // Starts a three cell snake on the cycle; place food afterwards
+  void reset();
+
+  // Puts the food on the n-th free cell, n = random % free cells; false if the board is full
+  bool placeFood(uint32_t random);
+
+  SnakeStep step();
+
+  uint8_t getHead() const { return bodyAt(length - 1); }
+  uint16_t getLength() const { return length; }
+  uint8_t getFood() const { return food; }
+  // Body cell counted from the tail
+  uint8_t getBodyCell(uint16_t i) const { return bodyAt(i); }
+  // Cell the tail left in the last SNAKE_MOVED step
+  uint8_t getVacated() const { return vacated; }
+  bool isOccupied(uint8_t cell) const { return isBlocked(occupied, cell); }
+
+  // Removes the tail, for the fade out animation
+  void dropTail();
+};
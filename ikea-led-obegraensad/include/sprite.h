@@ -0,0 +1,79 @@
+#pragma once
+
+#include "canvas.h"
+#include <Arduino.h>
+
+/**
+ * Packed sprites, animation sequences and tilemaps for the character plugins.
+ *
+ * Pixels are palette indices packed 1, 2 or 4 bits per pixel, most significant bits first,
+ * each row starting on a byte boundary, frames one after the other. Index 0 is transparent;
+ * the palette maps the others to brightness. The assets are generated by sprites.py from the
+ * text or PNG art in sprites/ into include/sprites/ and stay in flash.
+ *
+ * drawSprite() clips once per call to the range of visible columns. A 1bpp row is its own
+ * opacity mask, so only its set bits are visited; deeper rows are read a byte at a time and
+ * fully transparent bytes are skipped.
+ */
+
+constexpr uint8_t SPRITE_MAX_WIDTH = 16;
+
+enum SpriteFlags : uint8_t
+{
+  SPRITE_FLIP_X = 1,
+  SPRITE_FLIP_Y = 2,
+};
+
+struct Sprite
+{
+  uint8_t width;
+  uint8_t height;
+  uint8_t bpp;
+  uint8_t frames;
+  const uint8_t *palette; // 1 << bpp brightness values, PROGMEM
+  const uint8_t *data;    // PROGMEM
+};
+
+struct SpriteAnimation
+{
+  const uint8_t *sequence; // frame numbers, PROGMEM
+  uint8_t length;
+  uint16_t frameMs;
+};
+
+// Side-scroller world: a grid of tiles stored column by column, so scrolling streams whole
+// columns in from the map
+struct Tilemap
+{
+  const Sprite *tiles; // one tile per frame, tile 0 is empty
+  uint16_t columns;
+  uint8_t rows;
+  const uint8_t *map; // columns * rows tile numbers, column-major, PROGMEM
+};
+
+// Palette index of one pixel, for effects that sample a sprite instead of blitting it
+uint8_t getSpritePixel(const Sprite &sprite, uint8_t frame, uint8_t x, uint8_t y);
+
+// Draws a frame with its top-left corner at x, y; brightness is scaled by scale / 255
+void drawSprite(Canvas &canvas,
+                const Sprite &sprite,
+                uint8_t frame,
+                int x,
+                int y,
+                uint8_t flags = 0,
+                uint8_t scale = 255);
+
+// Frame number to show elapsed ms into a looping animation
+uint8_t getAnimationFrame(const SpriteAnimation &animation, unsigned long elapsed);
+
+// Draws the map scrolled left by scrollX pixels, wrapping around at its end
+void drawTilemap(Canvas &canvas,
+                 const Tilemap &tilemap,
+                 int scrollX,
+                 int y = 0,
+                 uint8_t scale = 255);
+int getTilemapWidth(const Tilemap &tilemap);
+
+// Screen x of an object in a wrapping world of worldWidth pixels, in [-SPRITE_MAX_WIDTH,
+// worldWidth - SPRITE_MAX_WIDTH) so anything partly visible gets a usable position
+int worldToScreenX(int worldX, int scrollX, int worldWidth);
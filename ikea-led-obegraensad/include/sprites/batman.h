@@ -0,0 +1,32 @@
+// Generated by sprites.py from sprites/batman.txt, do not edit
+#pragma once
+
+#include "sprite.h"
+
+// 16x16, 2 frame(s), 4 bpp
+static const uint8_t BATMAN_PALETTE[] PROGMEM = {0, 45, 90, 140, 200, 255, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t BATMAN_DATA[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x12, 0x10, 0x01, 0x21, 0x00, 0x00,
+    0x00, 0x00, 0x23, 0x33, 0x33, 0x32, 0x00, 0x00, 0x00, 0x00, 0x25, 0x13,
+    0x15, 0x20, 0x00, 0x00, 0x00, 0x00, 0x02, 0x34, 0x32, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x23, 0x44, 0x43, 0x20, 0x00, 0x00, 0x00, 0x01, 0x23, 0x25,
+    0x23, 0x21, 0x00, 0x00, 0x00, 0x11, 0x03, 0x44, 0x43, 0x01, 0x10, 0x00,
+    0x01, 0x10, 0x03, 0x44, 0x43, 0x00, 0x11, 0x00, 0x01, 0x10, 0x05, 0x55,
+    0x55, 0x00, 0x11, 0x00, 0x11, 0x00, 0x02, 0x30, 0x32, 0x00, 0x01, 0x10,
+    0x10, 0x00, 0x02, 0x30, 0x32, 0x00, 0x00, 0x10, 0x11, 0x00, 0x23, 0x30,
+    0x33, 0x20, 0x01, 0x10, 0x01, 0x11, 0x11, 0x00, 0x01, 0x11, 0x11, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x10, 0x00, 0x00,
+    0x00, 0x00, 0x12, 0x10, 0x01, 0x21, 0x00, 0x00, 0x00, 0x00, 0x23, 0x33,
+    0x33, 0x32, 0x00, 0x00, 0x00, 0x00, 0x25, 0x13, 0x15, 0x20, 0x00, 0x00,
+    0x00, 0x00, 0x02, 0x34, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x23, 0x44,
+    0x43, 0x20, 0x00, 0x00, 0x00, 0x01, 0x23, 0x25, 0x23, 0x21, 0x00, 0x00,
+    0x00, 0x01, 0x03, 0x44, 0x43, 0x01, 0x11, 0x00, 0x00, 0x10, 0x03, 0x44,
+    0x43, 0x00, 0x11, 0x10, 0x00, 0x10, 0x05, 0x55, 0x55, 0x00, 0x11, 0x10,
+    0x01, 0x00, 0x02, 0x30, 0x32, 0x00, 0x01, 0x11, 0x00, 0x00, 0x02, 0x30,
+    0x32, 0x00, 0x01, 0x10, 0x01, 0x00, 0x23, 0x30, 0x33, 0x20, 0x11, 0x00,
+    0x00, 0x11, 0x11, 0x00, 0x01, 0x11, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+};
+static const Sprite BATMAN = {16, 16, 4, 2, BATMAN_PALETTE, BATMAN_DATA};
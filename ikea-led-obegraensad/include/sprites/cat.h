@@ -0,0 +1,24 @@
+// Generated by sprites.py from sprites/cat.txt, do not edit
+#pragma once
+
+#include "sprite.h"
+
+// 16x13, 1 frame(s), 1 bpp
+static const uint8_t CAT_PALETTE[] PROGMEM = {0, 200};
+static const uint8_t CAT_DATA[] PROGMEM = {
+    0x04, 0x20, 0x0d, 0xb0, 0x0f, 0xf0, 0x09, 0x90, 0x0f, 0xf0, 0x07, 0xe0,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xc0, 0x01, 0x80, 0x02, 0x40,
+    0x04, 0x20,
+};
+static const Sprite CAT = {16, 13, 1, 1, CAT_PALETTE, CAT_DATA};
+
+// 16x3, 3 frame(s), 1 bpp
+static const uint8_t CAT_ARMS_PALETTE[] PROGMEM = {0, 200};
+static const uint8_t CAT_ARMS_DATA[] PROGMEM = {
+    0x03, 0xc8, 0x03, 0xd0, 0x07, 0xf8, 0x13, 0xc8, 0x0b, 0xd0, 0x1f, 0xf8,
+    0x13, 0xc0, 0x0b, 0xc0, 0x1f, 0xe0,
+};
+static const Sprite CAT_ARMS = {16, 3, 1, 3, CAT_ARMS_PALETTE, CAT_ARMS_DATA};
+
+static const uint8_t CAT_FLEX_SEQUENCE[] PROGMEM = {0, 1, 2, 1};
+static const SpriteAnimation CAT_FLEX = {CAT_FLEX_SEQUENCE, 4, 350};
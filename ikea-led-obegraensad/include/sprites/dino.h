@@ -0,0 +1,27 @@
+// Generated by sprites.py from sprites/dino.txt, do not edit
+#pragma once
+
+#include "sprite.h"
+
+// 5x7, 3 frame(s), 1 bpp
+static const uint8_t DINO_PALETTE[] PROGMEM = {0, 220};
+static const uint8_t DINO_DATA[] PROGMEM = {
+    0x38, 0x78, 0x30, 0xf8, 0x70, 0x30, 0x48, 0x38, 0x78, 0x30, 0xf8, 0x70,
+    0x30, 0x28, 0x38, 0x78, 0x30, 0xf8, 0x70, 0x30, 0x30,
+};
+static const Sprite DINO = {5, 7, 1, 3, DINO_PALETTE, DINO_DATA};
+
+// 1x5, 3 frame(s), 1 bpp
+static const uint8_t CACTUS_THIN_PALETTE[] PROGMEM = {0, 180};
+static const uint8_t CACTUS_THIN_DATA[] PROGMEM = {
+    0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80,
+};
+static const Sprite CACTUS_THIN = {1, 5, 1, 3, CACTUS_THIN_PALETTE, CACTUS_THIN_DATA};
+
+// 3x3, 1 frame(s), 1 bpp
+static const uint8_t CACTUS_WIDE_PALETTE[] PROGMEM = {0, 180};
+static const uint8_t CACTUS_WIDE_DATA[] PROGMEM = {
+    0x40, 0xe0, 0x40,
+};
+static const Sprite CACTUS_WIDE = {3, 3, 1, 1, CACTUS_WIDE_PALETTE, CACTUS_WIDE_DATA};
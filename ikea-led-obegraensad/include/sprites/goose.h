@@ -0,0 +1,64 @@
+// Generated by sprites.py from sprites/goose.txt, do not edit
+#pragma once
+
+#include "sprite.h"
+
+// 13x14, 2 frame(s), 4 bpp
+static const uint8_t GOOSE_WALK_PALETTE[] PROGMEM = {0, 25, 70, 120, 160, 190, 200, 255, 0, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t GOOSE_WALK_DATA[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26,
+    0x72, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x75, 0x50, 0x00, 0x00, 0x00,
+    0x00, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x02, 0x62, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x26, 0x62, 0x00, 0x00, 0x00, 0x00, 0x22, 0x36, 0x62, 0x00,
+    0x00, 0x00, 0x02, 0x36, 0x77, 0x76, 0x20, 0x00, 0x00, 0x23, 0x67, 0x77,
+    0x63, 0x20, 0x00, 0x02, 0x36, 0x77, 0x76, 0x32, 0x00, 0x00, 0x02, 0x36,
+    0x67, 0x63, 0x20, 0x00, 0x00, 0x00, 0x22, 0x22, 0x20, 0x00, 0x00, 0x00,
+    0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x40,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x26, 0x72, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x75, 0x50, 0x00,
+    0x00, 0x00, 0x00, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x02, 0x62, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x26, 0x62, 0x00, 0x00, 0x00, 0x00, 0x22, 0x36,
+    0x62, 0x00, 0x00, 0x00, 0x02, 0x36, 0x77, 0x76, 0x20, 0x00, 0x00, 0x23,
+    0x67, 0x77, 0x63, 0x20, 0x00, 0x02, 0x36, 0x77, 0x76, 0x32, 0x00, 0x00,
+    0x02, 0x36, 0x67, 0x63, 0x20, 0x00, 0x00, 0x00, 0x22, 0x22, 0x20, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44,
+    0x40, 0x00, 0x00, 0x00,
+};
+static const Sprite GOOSE_WALK = {13, 14, 4, 2, GOOSE_WALK_PALETTE, GOOSE_WALK_DATA};
+
+// 12x16, 1 frame(s), 4 bpp
+static const uint8_t GOOSE_STAND_PALETTE[] PROGMEM = {0, 25, 70, 120, 160, 190, 200, 255, 0, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t GOOSE_STAND_DATA[] PROGMEM = {
+    0x00, 0x00, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x26, 0x72, 0x00, 0x00,
+    0x00, 0x00, 0x21, 0x72, 0x55, 0x00, 0x00, 0x00, 0x02, 0x62, 0x00, 0x00,
+    0x00, 0x00, 0x02, 0x62, 0x00, 0x00, 0x00, 0x00, 0x23, 0x62, 0x00, 0x00,
+    0x00, 0x02, 0x36, 0x76, 0x20, 0x00, 0x00, 0x23, 0x67, 0x76, 0x62, 0x00,
+    0x02, 0x36, 0x77, 0x76, 0x32, 0x00, 0x02, 0x36, 0x77, 0x76, 0x32, 0x00,
+    0x00, 0x23, 0x67, 0x63, 0x20, 0x00, 0x00, 0x02, 0x36, 0x62, 0x00, 0x00,
+    0x00, 0x00, 0x23, 0x20, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x40, 0x04, 0x00, 0x00, 0x00, 0x04, 0x40, 0x04, 0x40, 0x00,
+};
+static const Sprite GOOSE_STAND = {12, 16, 4, 1, GOOSE_STAND_PALETTE, GOOSE_STAND_DATA};
+
+// 13x16, 1 frame(s), 4 bpp
+static const uint8_t GOOSE_HONK_PALETTE[] PROGMEM = {0, 25, 70, 120, 160, 190, 200, 255, 0, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t GOOSE_HONK_DATA[] PROGMEM = {
+    0x00, 0x00, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0x72, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x21, 0x75, 0x55, 0x00, 0x00, 0x00, 0x00, 0x02,
+    0x60, 0x55, 0x00, 0x00, 0x00, 0x00, 0x02, 0x62, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x23, 0x62, 0x00, 0x00, 0x00, 0x00, 0x02, 0x36, 0x76, 0x20, 0x00,
+    0x00, 0x00, 0x23, 0x67, 0x76, 0x62, 0x00, 0x00, 0x02, 0x36, 0x77, 0x76,
+    0x32, 0x00, 0x00, 0x02, 0x36, 0x77, 0x76, 0x32, 0x00, 0x00, 0x00, 0x23,
+    0x67, 0x63, 0x20, 0x00, 0x00, 0x00, 0x02, 0x36, 0x62, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x23, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x40, 0x04, 0x00, 0x00, 0x00, 0x00, 0x04, 0x40,
+    0x04, 0x40, 0x00, 0x00,
+};
+static const Sprite GOOSE_HONK = {13, 16, 4, 1, GOOSE_HONK_PALETTE, GOOSE_HONK_DATA};
+
+// 2x6, 1 frame(s), 1 bpp
+static const uint8_t GOOSE_EXCLAMATION_PALETTE[] PROGMEM = {0, 220};
+static const uint8_t GOOSE_EXCLAMATION_DATA[] PROGMEM = {
+    0xc0, 0xc0, 0xc0, 0xc0, 0x00, 0xc0,
+};
+static const Sprite GOOSE_EXCLAMATION = {2, 6, 1, 1, GOOSE_EXCLAMATION_PALETTE, GOOSE_EXCLAMATION_DATA};
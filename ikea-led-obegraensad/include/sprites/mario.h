@@ -0,0 +1,58 @@
+// Generated by sprites.py from sprites/mario.txt, do not edit
+#pragma once
+
+#include "sprite.h"
+
+// 5x7, 3 frame(s), 1 bpp
+static const uint8_t MARIO_PALETTE[] PROGMEM = {0, 255};
+static const uint8_t MARIO_DATA[] PROGMEM = {
+    0x70, 0xf8, 0x50, 0x70, 0xf8, 0x50, 0x88, 0x70, 0xf8, 0x50, 0x70, 0xf8,
+    0x20, 0x50, 0x70, 0xf8, 0x50, 0x70, 0xf8, 0x88, 0x00,
+};
+static const Sprite MARIO = {5, 7, 1, 3, MARIO_PALETTE, MARIO_DATA};
+
+static const uint8_t MARIO_RUN_SEQUENCE[] PROGMEM = {0, 1};
+static const SpriteAnimation MARIO_RUN = {MARIO_RUN_SEQUENCE, 2, 280};
+
+// 5x2, 1 frame(s), 1 bpp
+static const uint8_t CLOUD_PALETTE[] PROGMEM = {0, 50};
+static const uint8_t CLOUD_DATA[] PROGMEM = {
+    0x70, 0xf8,
+};
+static const Sprite CLOUD = {5, 2, 1, 1, CLOUD_PALETTE, CLOUD_DATA};
+
+// 3x3, 2 frame(s), 2 bpp
+static const uint8_t QBLOCK_PALETTE[] PROGMEM = {0, 80, 200, 0};
+static const uint8_t QBLOCK_DATA[] PROGMEM = {
+    0xa8, 0xa8, 0xa8, 0x54, 0x44, 0x54,
+};
+static const Sprite QBLOCK = {3, 3, 2, 2, QBLOCK_PALETTE, QBLOCK_DATA};
+
+// 2x2, 1 frame(s), 1 bpp
+static const uint8_t COIN_PALETTE[] PROGMEM = {0, 180};
+static const uint8_t COIN_DATA[] PROGMEM = {
+    0xc0, 0xc0,
+};
+static const Sprite COIN = {2, 2, 1, 1, COIN_PALETTE, COIN_DATA};
+
+// 4x8, 7 frame(s), 4 bpp
+static const uint8_t MARIO_WORLD_TILES_PALETTE[] PROGMEM = {0, 60, 90, 110, 130, 150, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t MARIO_WORLD_TILES_DATA[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x33, 0x31, 0x31, 0x33, 0x00, 0x00, 0x00, 0x00,
+    0x55, 0x55, 0x42, 0x24, 0x42, 0x24, 0x42, 0x24, 0x33, 0x31, 0x31, 0x33,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x00, 0x42, 0x00, 0x42,
+    0x33, 0x31, 0x31, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x00,
+    0x24, 0x00, 0x24, 0x00, 0x33, 0x31, 0x31, 0x33, 0x00, 0x00, 0x00, 0x55,
+    0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x33, 0x31, 0x31, 0x33,
+    0x00, 0x00, 0x55, 0x00, 0x24, 0x00, 0x24, 0x00, 0x24, 0x00, 0x24, 0x00,
+    0x33, 0x31, 0x31, 0x33,
+};
+static const Sprite MARIO_WORLD_TILES = {4, 8, 4, 7, MARIO_WORLD_TILES_PALETTE, MARIO_WORLD_TILES_DATA};
+// 20 columns of 1 tiles
+static const uint8_t MARIO_WORLD_MAP[] PROGMEM = {
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x01, 0x01, 0x01, 0x03, 0x04,
+    0x01, 0x01, 0x01, 0x05, 0x06, 0x01, 0x01, 0x01,
+};
+static const Tilemap MARIO_WORLD = {&MARIO_WORLD_TILES, 20, 1, MARIO_WORLD_MAP};
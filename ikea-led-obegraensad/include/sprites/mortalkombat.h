@@ -0,0 +1,13 @@
+// Generated by sprites.py from sprites/mortalkombat.txt, do not edit
+#pragma once
+
+#include "sprite.h"
+
+// 16x16, 1 frame(s), 1 bpp
+static const uint8_t MK_LOGO_PALETTE[] PROGMEM = {0, 220};
+static const uint8_t MK_LOGO_DATA[] PROGMEM = {
+    0x07, 0xe0, 0x18, 0x18, 0x26, 0xc4, 0x4f, 0xc2, 0x5e, 0xf2, 0x9e, 0x79,
+    0x8e, 0x71, 0x87, 0xe1, 0x83, 0xc1, 0x81, 0xc1, 0x41, 0xe2, 0x43, 0x72,
+    0x26, 0x34, 0x1c, 0x18, 0x0c, 0x30, 0x03, 0xc0,
+};
+static const Sprite MK_LOGO = {16, 16, 1, 1, MK_LOGO_PALETTE, MK_LOGO_DATA};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Tetris field and placement search for the self-playing Tetris plugin.
+ *
+ * Every row of the field is one 16 bit word (bit x = column x, row 0 at the top) and every
+ * piece rotation is a precomputed stack of row masks, so a collision test is at most four
+ * AND operations and clearing lines is a compaction of words.
+ *
+ * The search tries every drop of the current piece followed by every drop of the next piece
+ * and scores the resulting field with a weighted sum of cleared lines, aggregate height,
+ * holes and bumpiness. It runs incrementally: searchStep() stops after a number of
+ * evaluations, so a caller can spread one decision over several frames.
+ */
+
+constexpr uint8_t TETRIS_WIDTH = 10;
+constexpr uint8_t TETRIS_HEIGHT = 16;
+constexpr uint8_t TETRIS_PIECE_TYPES = 7;
+constexpr uint16_t TETRIS_FULL_ROW = (1 << TETRIS_WIDTH) - 1;
+
+struct TetrisShape
+{
+  uint16_t rows[4]; // top row first, leftmost block in bit 0
+  uint8_t width;
+  uint8_t height;
+};
+
+// Heuristic weights: score = lines * cleared lines - height * aggregate column height
+//                            - holes * covered empty cells - bumpiness * column steps
+struct TetrisWeights
+{
+  int16_t lines;
+  int16_t height;
+  int16_t holes;
+  int16_t bumpiness;
+};
+
+struct TetrisPlacement
+{
+  uint8_t rotation;
+  int8_t x;
+};
+
+class TetrisEngine
+{
+private:
+  uint16_t rows[TETRIS_HEIGHT];
+  TetrisWeights weights = {76, 51, 36, 18};
+
+  // incremental search state
+  uint8_t searchType = 0;
+  uint8_t searchNext = 0;
+  uint8_t searchRotation = 0;
+  int8_t searchX = 0;
+  bool searching = false;
+  bool found = false;
+  int32_t bestScore = 0;
+  TetrisPlacement best = {0, 0};
+  uint32_t evaluations = 0;
+
+  bool canPlace(const uint16_t *field, uint8_t type, uint8_t rotation, int8_t x, int8_t y) const;
+  int8_t findDropY(const uint16_t *field, uint8_t type, uint8_t rotation, int8_t x) const;
+  uint8_t drop(uint16_t *field, uint8_t type, uint8_t rotation, int8_t x) const;
+  int32_t evaluate(const uint16_t *field, uint8_t lines) const;
+  int32_t scorePlacement(uint8_t rotation, int8_t x, uint16_t &cost);
+  bool advance();
+
+public:
+  static const TetrisShape &getShape(uint8_t type, uint8_t rotation);
+  static uint8_t getRotations(uint8_t type);
+
+  void clear();
+  uint16_t getRow(uint8_t y) const { return rows[y]; }
+  bool canPlace(uint8_t type, uint8_t rotation, int8_t x, int8_t y) const;
+  // ORs the piece into the field; full rows stay until removeFullRows()
+  void lock(uint8_t type, uint8_t rotation, int8_t x, int8_t y);
+  // Bit y set = row y is full
+  uint16_t getFullRows() const;
+  uint8_t removeFullRows();
+
+  void setWeights(const TetrisWeights &newWeights) { weights = newWeights; }
+  const TetrisWeights &getWeights() const { return weights; }
+
+  // Starts looking for the best drop of type, with next as one piece of look-ahead
+  void beginSearch(uint8_t type, uint8_t next);
+  // Runs until about maxEvaluations fields were scored; true once the search is finished
+  bool searchStep(uint16_t maxEvaluations);
+  bool isSearching() const { return searching; }
+  // false if the piece fits nowhere (game over)
+  bool getBest(TetrisPlacement &placement) const;
+  // Fields scored since the last beginSearch()
+  uint32_t getEvaluations() const { return evaluations; }
+};
@@ -2,6 +2,9 @@
 
 #include "ESPAsyncWebServer.h"
 
+constexpr size_t BATCH_MAX_BODY = 8192;
+constexpr size_t BATCH_MAX_OPS = 32;
+
 // Helper functions for JSON responses
 void sendJsonSuccess(AsyncWebServerRequest *request, const char *message);
 void sendJsonError(AsyncWebServerRequest *request, int statusCode, const char *error);
@@ -9,6 +12,13 @@ void sendJsonError(AsyncWebServerRequest *request, int statusCode, const char *e
 void handleMessage(AsyncWebServerRequest *request);
 void handleMessageRemove(AsyncWebServerRequest *request);
 void handleGetInfo(AsyncWebServerRequest *request);
+void handleGetBoot(AsyncWebServerRequest *request);
+void handleGetHeap(AsyncWebServerRequest *request);
+void handleGetRecorder(AsyncWebServerRequest *request);
+void handleGetRecorderCapture(AsyncWebServerRequest *request);
+void handleWifiPortal(AsyncWebServerRequest *request);
+void handleGetPower(AsyncWebServerRequest *request);
+void handleSetPower(AsyncWebServerRequest *request);
 void handleSetPlugin(AsyncWebServerRequest *request);
 void handleSetBrightness(AsyncWebServerRequest *request);
 void handleGetData(AsyncWebServerRequest *request);
@@ -23,4 +33,21 @@ void handleSetConfigBody(AsyncWebServerRequest *request,
 						 size_t len,
 						 size_t index,
 						 size_t total);
-void handleResetConfig(AsyncWebServerRequest *request);
\ No newline at end of file
+void handleResetConfig(AsyncWebServerRequest *request);
+void handleGetAnimation(AsyncWebServerRequest *request);
+void handleDeleteAnimation(AsyncWebServerRequest *request);
+void handleAnimationUploadBody(AsyncWebServerRequest *request,
+                               uint8_t *data,
+                               size_t len,
+                               size_t index,
+                               size_t total);
+void handleImageUploadBody(AsyncWebServerRequest *request,
+                           uint8_t *data,
+                           size_t len,
+                           size_t index,
+                           size_t total);
+void handleBatchBody(AsyncWebServerRequest *request,
+                     uint8_t *data,
+                     size_t len,
+                     size_t index,
+                     size_t total);
@@ -14,6 +14,9 @@ void onWsEvent(AsyncWebSocket *server,
                uint8_t *data,
                size_t len);
 void sendInfo();
+// While held, sendInfo() calls are collected and sent once by the last releaseInfo()
+void holdInfo();
+void releaseInfo();
 void initWebsocketServer(AsyncWebServer &server);
 void cleanUpClients();
 
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "canvas.h"
+#include "constants.h"
+#include <Arduino.h>
+
+/**
+ * Compact binary frames for the WebSocket, as an alternative to the JSON "led"/"screen" events.
+ *
+ * Every message starts with a 2 byte header:
+ *   0  FRAME_MAGIC
+ *   1  format: bits per pixel (1, 4 or 8) in the low nibble, ORed with
+ *      FRAME_RECT  the header continues with x, y, width and height (1 byte each) and only that
+ *                  rectangle is replaced
+ *      FRAME_RLE   the pixel data is PackBits compressed (see animationstore.h)
+ *
+ * The pixel data is the full screen or the rectangle in row-major order, packed MSB first
+ * without padding between rows: 1 bit per pixel is 32 bytes for the whole screen (set = full
+ * brightness), 4 bits are 128 bytes (value * 17), 8 bits are 256 bytes of brightness.
+ * Messages may be split over several WS frames. A frame is drawn by the active plugin's
+ * websocketFrameHook() (Draw), or straight onto the screen while the status is WSBINARY, where
+ * a plain 256 byte message without header is still accepted.
+ */
+
+constexpr uint8_t FRAME_MAGIC = 0xA6;
+constexpr uint8_t FRAME_RECT = 0x10;
+constexpr uint8_t FRAME_RLE = 0x20;
+
+constexpr uint8_t FRAME_HEADER_SIZE = 2;
+constexpr uint8_t FRAME_RECT_HEADER_SIZE = FRAME_HEADER_SIZE + 4;
+// a full 8 bit frame, or its PackBits worst case with one control byte per 128 literals
+constexpr uint16_t FRAME_MAX_MESSAGE = FRAME_RECT_HEADER_SIZE + ROWS * COLS + ROWS * COLS / 128 + 1;
+
+struct WsFrame
+{
+  uint8_t x = 0;
+  uint8_t y = 0;
+  uint8_t width = COLS;
+  uint8_t height = ROWS;
+  // width * height brightness values, row-major
+  uint8_t pixels[ROWS * COLS];
+};
+
+bool isFrameMessage(const uint8_t *data, size_t len);
+// Unpacks a frame message, false when it is malformed or the rectangle leaves the screen
+bool decodeFrameMessage(const uint8_t *data, size_t len, WsFrame &frame);
+// Draws the decoded pixels onto the canvas
+void drawFrame(const WsFrame &frame, Canvas &canvas);
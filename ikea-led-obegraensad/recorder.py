@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import sys
+import time
+
+import requests
+
+logger: logging.Logger = logging.getLogger(__name__)
+
+MAGIC = b"OBRC"
+VERSION = 1
+HEADER = struct.Struct("<4sBBBxIIII")
+MAX_BRIGHTNESS = 255
+
+# darkest to brightest, for the terminal replay
+SHADES = " .:-=+*#%@"
+
+
+def read_varint(data: bytes, offset: int) -> tuple[int, int]:
+    value = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, offset
+
+
+def apply_record(data: bytes, offset: int, pixels: bytearray) -> tuple[int, int]:
+    """Apply one frame record to pixels, returns (elapsed ms, next offset)"""
+    header, offset = read_varint(data, offset)
+    toggle = header & 1
+
+    pixel = 0
+    while pixel < len(pixels):
+        pixel += data[offset]
+        count = data[offset + 1]
+        offset += 2
+        if pixel + count > len(pixels):
+            raise ValueError(f"Record at {offset} runs past the frame")
+        for _ in range(count):
+            if toggle:
+                pixels[pixel] = MAX_BRIGHTNESS - pixels[pixel]
+            else:
+                pixels[pixel] = data[offset]
+                offset += 1
+            pixel += 1
+
+    return header >> 1, offset
+
+
+def parse_capture(data: bytes) -> tuple[int, int, list[tuple[int, bytes]]]:
+    """Decode a capture into (cols, rows, [(uptime ms, pixels), ...]), the last frame
+    lasting until the download"""
+    if len(data) < HEADER.size or data[:4] != MAGIC:
+        raise ValueError("Not a frame recorder capture")
+
+    _, version, cols, rows, base_at, export_at, count, size = HEADER.unpack_from(data)
+    if version != VERSION:
+        raise ValueError(f"Unsupported capture version {version}")
+
+    offset = HEADER.size
+    pixels = bytearray(data[offset : offset + cols * rows])
+    offset += cols * rows
+    end = offset + size
+    if end > len(data):
+        raise ValueError("Capture is truncated")
+
+    frames = [(base_at, bytes(pixels))]
+    at = base_at
+    while offset < end:
+        elapsed, offset = apply_record(data, offset, pixels)
+        at += elapsed
+        frames.append((at, bytes(pixels)))
+
+    if len(frames) != count + 1:
+        logger.warning(f"Header announces {count} frames, found {len(frames) - 1}")
+    frames.append((export_at, bytes(pixels)))
+    return cols, rows, frames
+
+
+def download(ip: str) -> bytes:
+    response = requests.get(f"http://{ip}/api/recorder/capture", timeout=30)
+    response.raise_for_status()
+    return response.content
+
+
+def replay(cols: int, frames: list[tuple[int, bytes]], speed: float) -> None:
+    start = frames[0][0]
+    for (at, pixels), (next_at, _) in zip(frames, frames[1:]):
+        lines = [
+            "".join(
+                SHADES[value * (len(SHADES) - 1) // MAX_BRIGHTNESS] * 2
+                for value in pixels[row : row + cols]
+            )
+            for row in range(0, len(pixels), cols)
+        ]
+        sys.stdout.write("\x1b[H\x1b[2J" + "\n".join(lines))
+        sys.stdout.write(f"\n{(at - start) / 1000:8.2f} s (uptime {at / 1000:.2f} s)\n")
+        sys.stdout.flush()
+        time.sleep((next_at - at) / 1000 / speed)
+
+
+def write_gif(
+    path: str, cols: int, rows: int, frames: list[tuple[int, bytes]], scale: int
+) -> None:
+    from PIL import Image
+
+    images = []
+    durations = []
+    for (at, pixels), (next_at, _) in zip(frames, frames[1:]):
+        image = Image.frombytes("L", (cols, rows), pixels)
+        images.append(image.resize((cols * scale, rows * scale), Image.NEAREST))
+        durations.append(max(next_at - at, 20))
+
+    images[0].save(
+        path, save_all=True, append_images=images[1:], duration=durations, loop=0
+    )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="Download and replay the panel's frame recorder"
+    )
+    parser.add_argument("file", nargs="?", help="Capture to replay instead of --ip")
+    parser.add_argument("--ip", type=str, help="Download the capture from this lamp")
+    parser.add_argument("-o", "--output", type=str, help="Save the downloaded capture")
+    parser.add_argument("--gif", type=str, help="Render the capture into a GIF")
+    parser.add_argument("--scale", type=int, default=16, help="GIF pixel size")
+    parser.add_argument("--speed", type=float, default=1.0, help="Replay speed")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.DEBUG if args.verbose else logging.INFO)
+
+    if args.ip:
+        data = download(args.ip)
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(data)
+            logger.info(f"Saved {len(data)} bytes to {args.output}")
+    elif args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("Give a capture file or --ip")
+
+    cols, rows, frames = parse_capture(data)
+    logger.info(
+        f"{len(frames) - 2} changes over {(frames[-1][0] - frames[0][0]) / 1000:.1f} s"
+    )
+
+    if args.gif:
+        write_gif(args.gif, cols, rows, frames, args.scale)
+        logger.info(f"Wrote {args.gif}")
+    elif not args.output:
+        replay(cols, frames, args.speed)
+
+
+if __name__ == "__main__":
+    main()
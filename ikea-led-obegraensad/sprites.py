@@ -0,0 +1,364 @@
+#!/usr/bin/env python3
+"""
+Converts the art in sprites/ into flash-resident sprite headers in include/sprites/.
+
+Runs as a PlatformIO pre-build script (only outdated headers are rewritten) or by hand:
+
+    python sprites.py [sprites/goose.txt ...]
+
+Source format, one file per plugin:
+
+    # comment
+    palette . 0  o 70  w 200      characters and their brightness; '.' is transparent
+    sprite NAME 13x14             followed by the rows of all frames, height rows per frame
+    sprite NAME 5x7 from art.png  frames side by side in a greyscale PNG, black is transparent
+    tilemap NAME 80x16 tile 1x16  a whole world; equal tiles are stored once
+    animation NAME 100 0 1 0 2    ms per frame, then the frame sequence
+
+Each sprite gets the smallest of 1, 2 or 4 bits per pixel that holds its colours.
+"""
+
+from __future__ import annotations
+
+import argparse
+import logging
+import os
+import struct
+import sys
+import zlib
+from dataclasses import dataclass, field
+
+logger: logging.Logger = logging.getLogger(__name__)
+
+SOURCE_DIR = "sprites"
+OUTPUT_DIR = os.path.join("include", "sprites")
+MAX_WIDTH = 16
+TRANSPARENT = "."
+KEYWORDS = ("palette", "sprite", "tilemap", "animation")
+
+
+@dataclass
+class SpriteArt:
+    name: str
+    width: int
+    height: int
+    frames: list[list[int]]  # brightness per pixel, row-major, 0 = transparent
+    palette: list[int] = field(default_factory=list)
+
+
+def read_png(path: str) -> tuple[int, int, list[int]]:
+    """Greyscale values of an 8 bit PNG (grey, grey+alpha, RGB or RGBA, not interlaced)"""
+    with open(path, "rb") as file:
+        data = file.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError(f"{path}: not a PNG file")
+
+    offset = 8
+    compressed = b""
+    width = height = color_type = 0
+    while offset < len(data):
+        length, kind = struct.unpack(">I4s", data[offset : offset + 8])
+        chunk = data[offset + 8 : offset + 8 + length]
+        offset += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color_type, _, _, interlace = struct.unpack(
+                ">IIBBBBB", chunk
+            )
+            if depth != 8 or interlace or color_type not in (0, 2, 4, 6):
+                raise ValueError(f"{path}: only 8 bit, non-interlaced PNGs are supported")
+        elif kind == b"IDAT":
+            compressed += chunk
+        elif kind == b"IEND":
+            break
+
+    channels = {0: 1, 2: 3, 4: 2, 6: 4}[color_type]
+    raw = zlib.decompress(compressed)
+    stride = width * channels
+    previous = bytearray(stride)
+    pixels: list[int] = []
+    position = 0
+    for _ in range(height):
+        kind = raw[position]
+        line = bytearray(raw[position + 1 : position + 1 + stride])
+        position += 1 + stride
+        for i in range(stride):
+            left = line[i - channels] if i >= channels else 0
+            up = previous[i]
+            up_left = previous[i - channels] if i >= channels else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (left + up) // 2) & 0xFF
+            elif kind == 4:
+                estimate = left + up - up_left
+                nearest = min(
+                    (abs(estimate - left), left),
+                    (abs(estimate - up), up),
+                    (abs(estimate - up_left), up_left),
+                    key=lambda candidate: candidate[0],
+                )[1]
+                line[i] = (line[i] + nearest) & 0xFF
+        previous = line
+
+        for x in range(width):
+            px = line[x * channels : (x + 1) * channels]
+            if color_type in (2, 6):
+                grey = (px[0] * 77 + px[1] * 150 + px[2] * 29) >> 8
+            else:
+                grey = px[0]
+            if color_type in (4, 6) and px[-1] < 128:
+                grey = 0
+            pixels.append(grey)
+    return width, height, pixels
+
+
+def parse_size(text: str) -> tuple[int, int]:
+    width, height = text.lower().split("x")
+    return int(width), int(height)
+
+
+def parse_art(
+    rows: list[str], width: int, height: int, palette: dict[str, int], where: str
+) -> list[list[int]]:
+    """Rows of characters into frames of brightness values"""
+    if not rows or len(rows) % height:
+        raise ValueError(f"{where}: {len(rows)} rows is not a multiple of {height}")
+
+    frames = []
+    for start in range(0, len(rows), height):
+        pixels = []
+        for row in rows[start : start + height]:
+            if len(row) > width:
+                raise ValueError(f"{where}: row '{row}' is wider than {width}")
+            for char in row.ljust(width, TRANSPARENT):
+                if char not in palette:
+                    raise ValueError(f"{where}: '{char}' is not in the palette")
+                pixels.append(palette[char])
+        frames.append(pixels)
+    return frames
+
+
+def split_tiles(
+    name: str, world: list[int], width: int, height: int, tile_w: int, tile_h: int
+) -> tuple[SpriteArt, list[int], int, int]:
+    """Cuts a world into tiles, column by column, and stores every distinct tile once"""
+    if width % tile_w or height % tile_h:
+        raise ValueError(f"{name}: {width}x{height} is not a multiple of the tile size")
+
+    tiles: list[list[int]] = [[0] * (tile_w * tile_h)]
+    index: dict[tuple[int, ...], int] = {tuple(tiles[0]): 0}
+    columns, rows = width // tile_w, height // tile_h
+    tile_map = []
+    for column in range(columns):
+        for row in range(rows):
+            pixels = [
+                world[(row * tile_h + y) * width + column * tile_w + x]
+                for y in range(tile_h)
+                for x in range(tile_w)
+            ]
+            key = tuple(pixels)
+            if key not in index:
+                index[key] = len(tiles)
+                tiles.append(pixels)
+            tile_map.append(index[key])
+    if len(tiles) > 256:
+        raise ValueError(f"{name}: {len(tiles)} distinct tiles, at most 256 fit")
+    return SpriteArt(f"{name}_TILES", tile_w, tile_h, tiles), tile_map, columns, rows
+
+
+def pack(sprite: SpriteArt) -> tuple[int, bytes]:
+    """Palette and packed pixels; palette index 0 is transparent"""
+    levels = sorted({value for frame in sprite.frames for value in frame} - {0})
+    sprite.palette = [0] + levels
+    bpp = next((bits for bits in (1, 2, 4) if len(sprite.palette) <= 1 << bits), None)
+    if bpp is None:
+        raise ValueError(f"{sprite.name}: {len(levels)} brightness levels, at most 15 fit")
+    if sprite.width > MAX_WIDTH:
+        raise ValueError(f"{sprite.name}: wider than {MAX_WIDTH} pixels")
+    sprite.palette += [0] * ((1 << bpp) - len(sprite.palette))
+
+    out = bytearray()
+    for frame in sprite.frames:
+        for y in range(sprite.height):
+            bits = 0
+            count = 0
+            for x in range(sprite.width):
+                bits = (bits << bpp) | sprite.palette.index(frame[y * sprite.width + x])
+                count += bpp
+            padding = (8 - count % 8) % 8
+            bits <<= padding
+            count += padding
+            out += bits.to_bytes(count // 8, "big")
+    return bpp, bytes(out)
+
+
+def byte_lines(data: bytes | list[int], indent: str = "    ", per_line: int = 12) -> str:
+    return "\n".join(
+        indent + ", ".join(f"0x{value:02x}" for value in data[i : i + per_line]) + ","
+        for i in range(0, len(data), per_line)
+    )
+
+
+def emit_sprite(sprite: SpriteArt) -> tuple[str, int]:
+    bpp, data = pack(sprite)
+    text = (
+        f"// {sprite.width}x{sprite.height}, {len(sprite.frames)} frame(s), {bpp} bpp\n"
+        f"static const uint8_t {sprite.name}_PALETTE[] PROGMEM = {{"
+        + ", ".join(str(value) for value in sprite.palette)
+        + "};\n"
+        f"static const uint8_t {sprite.name}_DATA[] PROGMEM = {{\n{byte_lines(data)}\n}};\n"
+        f"static const Sprite {sprite.name} = {{{sprite.width}, {sprite.height}, {bpp}, "
+        f"{len(sprite.frames)}, {sprite.name}_PALETTE, {sprite.name}_DATA}};\n"
+    )
+    return text, len(data) + len(sprite.palette)
+
+
+def convert(source: str, display_name: str) -> str:
+    """C header for one art file"""
+    directory = os.path.dirname(source)
+    lines = open(source, encoding="utf-8").read().splitlines()
+    palette: dict[str, int] = {TRANSPARENT: 0}
+    parts: list[str] = []
+    total = 0
+
+    i = 0
+    while i < len(lines):
+        words = lines[i].split()
+        where = f"{display_name}:{i + 1}"
+        i += 1
+        if not words or words[0].startswith("#"):
+            continue
+
+        # art rows: everything up to the next keyword line
+        def take_rows() -> list[str]:
+            """Art rows up to the next keyword, skipping blank and comment lines"""
+            nonlocal i
+            rows = []
+            while i < len(lines):
+                line = lines[i].strip()
+                if line.split() and line.split()[0] in KEYWORDS:
+                    break
+                if line and not line.startswith("#"):
+                    rows.append(line)
+                i += 1
+            return rows
+
+        keyword = words[0]
+        if keyword == "palette":
+            pairs = words[1:]
+            palette = {TRANSPARENT: 0}
+            for char, value in zip(pairs[::2], pairs[1::2]):
+                palette[char] = int(value)
+        elif keyword == "sprite":
+            name = words[1]
+            width, height = parse_size(words[2])
+            if len(words) > 4 and words[3] == "from":
+                png_w, png_h, pixels = read_png(os.path.join(directory, words[4]))
+                if png_h != height or png_w % width:
+                    raise ValueError(f"{where}: {words[4]} is not a row of {width}x{height} frames")
+                frames = [
+                    [pixels[y * png_w + f * width + x] for y in range(height) for x in range(width)]
+                    for f in range(png_w // width)
+                ]
+            else:
+                frames = parse_art(take_rows(), width, height, palette, where)
+            text, size = emit_sprite(SpriteArt(name, width, height, frames))
+            parts.append(text)
+            total += size
+        elif keyword == "tilemap":
+            name = words[1]
+            width, height = parse_size(words[2])
+            tile_w, tile_h = parse_size(words[4])
+            world = parse_art(take_rows(), width, height, palette, where)[0]
+            tiles, tile_map, columns, rows = split_tiles(name, world, width, height, tile_w, tile_h)
+            text, size = emit_sprite(tiles)
+            parts.append(
+                text
+                + f"// {columns} columns of {rows} tiles\n"
+                f"static const uint8_t {name}_MAP[] PROGMEM = {{\n{byte_lines(tile_map)}\n}};\n"
+                f"static const Tilemap {name} = {{&{tiles.name}, {columns}, {rows}, {name}_MAP}};\n"
+            )
+            total += size + len(tile_map)
+        elif keyword == "animation":
+            name, frame_ms = words[1], int(words[2])
+            sequence = [int(word) for word in words[3:]]
+            parts.append(
+                f"static const uint8_t {name}_SEQUENCE[] PROGMEM = {{"
+                + ", ".join(str(frame) for frame in sequence)
+                + "};\n"
+                f"static const SpriteAnimation {name} = {{{name}_SEQUENCE, {len(sequence)}, {frame_ms}}};\n"
+            )
+            total += len(sequence)
+        else:
+            raise ValueError(f"{where}: unknown keyword '{keyword}'")
+
+    logger.info(f"{display_name}: {total} bytes of flash")
+    return (
+        f"// Generated by sprites.py from {display_name}, do not edit\n"
+        "#pragma once\n\n"
+        '#include "sprite.h"\n\n' + "\n".join(parts)
+    )
+
+
+def output_path(source: str, project_dir: str) -> str:
+    name = os.path.splitext(os.path.basename(source))[0] + ".h"
+    return os.path.join(project_dir, OUTPUT_DIR, name)
+
+
+def generate(sources: list[str], project_dir: str, only_outdated: bool) -> None:
+    os.makedirs(os.path.join(project_dir, OUTPUT_DIR), exist_ok=True)
+    for source in sources:
+        target = output_path(source, project_dir)
+        if (
+            only_outdated
+            and os.path.exists(target)
+            and os.path.getmtime(target) >= os.path.getmtime(source)
+        ):
+            continue
+        relative = os.path.relpath(source, project_dir)
+        header = convert(source, relative.replace(os.sep, "/"))
+        with open(target, "w", encoding="utf-8") as file:
+            file.write(header)
+        print(f"[sprites] {relative} -> {os.path.relpath(target, project_dir)}")
+
+
+def all_sources(project_dir: str) -> list[str]:
+    directory = os.path.join(project_dir, SOURCE_DIR)
+    if not os.path.isdir(directory):
+        return []
+    return sorted(
+        os.path.join(directory, name) for name in os.listdir(directory) if name.endswith(".txt")
+    )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Convert sprite art into C headers")
+    parser.add_argument("sources", nargs="*", help=f"art files (default: {SOURCE_DIR}/*.txt)")
+    parser.add_argument("--verbose", "-v", action="store_true")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO if args.verbose else logging.WARNING)
+    project_dir = os.path.dirname(os.path.abspath(__file__))
+    os.chdir(project_dir)
+    sources = args.sources or all_sources(project_dir)
+    try:
+        generate(sources, project_dir, only_outdated=False)
+    except ValueError as error:
+        sys.exit(f"[sprites] {error}")
+
+
+try:
+    Import("env")  # noqa: F821 - defined when PlatformIO runs this as a pre script
+except NameError:
+    if __name__ == "__main__":
+        main()
+else:
+    project = env.subst("$PROJECT_DIR")  # noqa: F821
+    previous = os.getcwd()
+    os.chdir(project)
+    try:
+        generate(all_sources(project), project, only_outdated=True)
+    finally:
+        os.chdir(previous)
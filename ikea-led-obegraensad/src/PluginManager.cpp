@@ -1,10 +1,23 @@
 #include "PluginManager.h"
+#include "config.h"
 #include "scheduler.h"
+#include "settings.h"
 
-Plugin::Plugin() : id(-1)
+// not the Screen reference, plugins may be constructed before it is initialised
+Plugin::Plugin() : id(-1), canvas(&Screen_::getInstance())
 {
 }
 
+void Plugin::setCanvas(Canvas &target)
+{
+  canvas = &target;
+}
+
+Canvas &Plugin::getCanvas() const
+{
+  return *canvas;
+}
+
 void Plugin::setId(int id)
 {
   this->id = id;
@@ -15,15 +28,26 @@ int Plugin::getId() const
   return id;
 }
 
+const PluginHealth &Plugin::getHealth() const
+{
+  return health;
+}
+
 void Plugin::teardown()
 {
 }
+void Plugin::prepare()
+{
+}
 void Plugin::loop()
 {
 }
 void Plugin::websocketHook(JsonDocument &request)
 {
 }
+void Plugin::websocketFrameHook(const WsFrame &frame)
+{
+}
 
 PluginManager::PluginManager() : nextPluginId(1)
 {
@@ -47,20 +71,23 @@ void PluginManager::init()
   Serial.print("[PluginManager] Initializing with ");
   Serial.print(getNumPlugins());
   Serial.println(" plugins");
-  
+
+  // setup() runs right here instead of after the number, the first frame is the plugin's own
+  booting = true;
   activatePersistedPlugin();
-  
+  booting = false;
+
   if (!activePlugin)
   {
     Serial.println("[PluginManager] CRITICAL: No active plugin after initialization!");
   }
 }
 
-void PluginManager::renderPluginId(int pluginId)
+bool PluginManager::renderPluginId(int pluginId)
 {
-  if (Scheduler.isActive)
+  if (booting || Scheduler.isActive)
   {
-    return;
+    return false;
   }
 
   Screen.clear();
@@ -86,18 +113,21 @@ void PluginManager::renderPluginId(int pluginId)
     Screen.drawNumbers(6, 6, digits, MAX_BRIGHTNESS);
   }
 
-  // Non-blocking delay using vTaskDelay (ESP32) or delay (ESP8266)
-  // Avoids millis() overflow issues by using interval counting method
-  int iterations = 80; // 800ms / 10ms per iteration
-  while (iterations > 0)
+  return true;
+}
+
+void PluginManager::startActivePlugin()
+{
+  if (renderPluginId(activePlugin->getId()))
   {
-    yield();
-#ifdef ESP32
-    vTaskDelay(pdMS_TO_TICKS(10));
-#else
-    delay(10);
-#endif
-    iterations--;
+    // runActivePlugin() calls setup() once the number was up long enough, the caller (web
+    // request, button) does not wait for it
+    setupRequestedAt = millis();
+    setupPending = true;
+  }
+  else
+  {
+    runMeasured(activePlugin, true);
   }
 }
 
@@ -109,14 +139,12 @@ void PluginManager::activatePersistedPlugin()
     Serial.println("[PluginManager] No plugins registered!");
     return;
   }
-#ifdef ENABLE_STORAGE
-  storage.begin("led-wall", true);
-  persistedPluginId = storage.getInt("current-plugin", allPlugins.at(0)->getId());
-  storage.end();
+  persistedPluginId = Settings.getInt(SETTING_CURRENT_PLUGIN);
+  if (persistedPluginId < 0)
+  {
+    persistedPluginId = allPlugins.at(0)->getId();
+  }
   pluginManager.setActivePluginById(persistedPluginId);
-#else
-  pluginManager.setActivePluginById(allPlugins.at(0)->getId());
-#endif
   if (!activePlugin)
   {
     Serial.println("[PluginManager] Failed to activate persisted plugin, activating first plugin");
@@ -126,15 +154,11 @@ void PluginManager::activatePersistedPlugin()
 
 void PluginManager::persistActivePlugin()
 {
-#ifdef ENABLE_STORAGE
-  storage.begin("led-wall", false);
   if (activePlugin)
   {
     persistedPluginId = activePlugin->getId();
-    storage.putInt("current-plugin", persistedPluginId);
+    Settings.setInt(SETTING_CURRENT_PLUGIN, persistedPluginId);
   }
-  storage.end();
-#endif
 }
 
 int PluginManager::getPersistedPluginId()
@@ -145,14 +169,12 @@ int PluginManager::getPersistedPluginId()
     Serial.println("[PluginManager] No plugins registered!");
     return -1;
   }
-#ifdef ENABLE_STORAGE
-  storage.begin("led-wall", true);
-  persistedPluginId = storage.getInt("current-plugin", allPlugins.at(0)->getId());
-  storage.end();
+  persistedPluginId = Settings.getInt(SETTING_CURRENT_PLUGIN);
+  if (persistedPluginId < 0)
+  {
+    persistedPluginId = allPlugins.at(0)->getId();
+  }
   return persistedPluginId;
-#else
-  return -1;
-#endif
 }
 
 int PluginManager::addPlugin(Plugin *plugin)
@@ -174,6 +196,7 @@ void PluginManager::setActivePlugin(const char *pluginName)
 #endif
 
   currentStatus = LOADING; // Block Core 0 FIRST to prevent race condition
+  setupPending = false;
 
   if (activePlugin)
   {
@@ -193,10 +216,9 @@ void PluginManager::setActivePlugin(const char *pluginName)
     if (strcmp(plugin->getName(), pluginName) == 0)
     {
       activePlugin = plugin;
-      renderPluginId(activePlugin->getId());
       Serial.print("[PluginSwitch] Setting up: ");
       Serial.println(pluginName);
-      activePlugin->setup();
+      startActivePlugin();
       break;
     }
   }
@@ -243,17 +265,174 @@ void PluginManager::setupActivePlugin()
 {
   if (activePlugin)
   {
-    renderPluginId(activePlugin->getId());
-    activePlugin->setup();
+    startActivePlugin();
+  }
+}
+
+void PluginManager::preparePluginById(int pluginId)
+{
+  // the active plugin is busy in its own loop on the other core
+  if (activePlugin && activePlugin->getId() == pluginId)
+  {
+    return;
+  }
+
+  for (Plugin *plugin : plugins)
+  {
+    if (plugin->getId() == pluginId)
+    {
+      Serial.print("[PluginManager] Preparing: ");
+      Serial.println(plugin->getName());
+      plugin->prepare();
+      return;
+    }
+  }
+}
+
+bool PluginManager::runActivePlugin()
+{
+  if (!activePlugin || currentStatus == UPDATE || currentStatus == LOADING ||
+      currentStatus == WSBINARY)
+  {
+    return false;
+  }
+
+  if (setupPending)
+  {
+    if (millis() - setupRequestedAt < PLUGIN_ID_DISPLAY_MS)
+    {
+      return false;
+    }
+    setupPending = false;
+    runMeasured(activePlugin, true);
+  }
+  runMeasured(activePlugin, false);
+  return true;
+}
+
+static unsigned long budgetFor(bool isSetup)
+{
+  return (unsigned long)config.getPluginBudgetMs() * (isSetup ? PLUGIN_SETUP_BUDGET_FACTOR : 1);
+}
+
+void PluginManager::runMeasured(Plugin *plugin, bool isSetup)
+{
+  runningSetup = isSetup;
+  stallReported = false;
+  runStartedAt = millis();
+  runningPlugin = plugin;
+
+  if (isSetup)
+  {
+    plugin->setup();
   }
+  else
+  {
+    plugin->loop();
+  }
+
+  runningPlugin = nullptr;
+  unsigned long elapsed = millis() - runStartedAt;
+  unsigned long budget = budgetFor(isSetup);
+
+  if (elapsed > plugin->health.worstMs)
+  {
+    plugin->health.worstMs = elapsed;
+  }
+  if (elapsed <= budget)
+  {
+    return;
+  }
+
+  char reason[sizeof(PluginHealth::reason)];
+  snprintf(reason, sizeof(reason), "%s() took %lu ms, budget %lu ms", isSetup ? "setup" : "loop",
+           elapsed, budget);
+  if (stallReported)
+  {
+    // already counted by checkBudget() while it ran, only the final duration is new
+    strlcpy(plugin->health.reason, reason, sizeof(plugin->health.reason));
+    return;
+  }
+  recordOverrun(plugin, reason);
 }
 
-void PluginManager::runActivePlugin()
+void PluginManager::checkBudget()
 {
-  if (activePlugin && currentStatus != UPDATE && currentStatus != LOADING &&
-      currentStatus != WSBINARY)
+  Plugin *plugin = runningPlugin;
+  if (!plugin || stallReported)
+  {
+    return;
+  }
+
+  unsigned long elapsed = millis() - runStartedAt;
+  if (elapsed <= budgetFor(runningSetup) || plugin != runningPlugin)
+  {
+    return;
+  }
+
+  // a blocked render task cannot be interrupted, but it is counted now instead of after it
+  // returns (if ever) and the watchdog reset may still follow
+  stallReported = true;
+  char reason[sizeof(PluginHealth::reason)];
+  snprintf(reason, sizeof(reason), "%s() still running after %lu ms",
+           runningSetup ? "setup" : "loop", elapsed);
+  recordOverrun(plugin, reason);
+}
+
+void PluginManager::recordOverrun(Plugin *plugin, const char *reason)
+{
+  PluginHealth &health = plugin->health;
+  unsigned long now = millis();
+
+  health.overruns++;
+  strlcpy(health.reason, reason, sizeof(health.reason));
+  if (health.strikes == 0 || now - health.windowStart > PLUGIN_STRIKE_WINDOW_MS)
+  {
+    health.strikes = 0;
+    health.windowStart = now;
+  }
+  health.strikes++;
+
+  Serial.printf("[PluginManager] Budget overrun in %s: %s\n", plugin->getName(), reason);
+
+  if (health.strikes >= PLUGIN_DEMOTE_STRIKES && !isDemoted(plugin->getId()))
+  {
+    health.demoted = true;
+    health.demotedAt = now;
+    health.strikes = 0;
+    Serial.printf("[PluginManager] %s demoted, the scheduler skips it for %lu minutes\n",
+                  plugin->getName(), PLUGIN_DEMOTION_MS / 60000);
+  }
+}
+
+bool PluginManager::isDemoted(int pluginId) const
+{
+  for (const Plugin *plugin : plugins)
+  {
+    if (plugin->getId() == pluginId)
+    {
+      const PluginHealth &health = plugin->health;
+      return health.demoted && millis() - health.demotedAt < PLUGIN_DEMOTION_MS;
+    }
+  }
+  return false;
+}
+
+void PluginManager::healthToJson(const Plugin *plugin, JsonObject object) const
+{
+  const PluginHealth &health = plugin->health;
+  if (health.overruns == 0)
+  {
+    return;
+  }
+
+  object["overruns"] = health.overruns;
+  object["worstMs"] = health.worstMs;
+  object["reason"] = health.reason;
+  if (isDemoted(plugin->getId()))
   {
-    activePlugin->loop();
+    object["demoted"] = true;
+    object["demotedForSeconds"] = (PLUGIN_DEMOTION_MS - (millis() - health.demotedAt)) / 1000;
   }
 }
 
@@ -0,0 +1,927 @@
+#include "animationstore.h"
+#include <algorithm>
+
+#ifdef ENABLE_STORAGE
+#include <LittleFS.h>
+
+static fs::FS &animationFs = LittleFS;
+#else
+struct RamAnimationEntry
+{
+  char path[16] = "";
+  uint8_t *data = nullptr;
+  size_t size = 0;
+  size_t capacity = 0;
+};
+
+// Stand-in for LittleFS: room for the live container and the temporary files of the JSON and
+// the image upload, which may be written at the same time
+class RamAnimationFs
+{
+private:
+  RamAnimationEntry entries[3];
+
+  RamAnimationEntry *find(const char *path)
+  {
+    for (RamAnimationEntry &entry : entries)
+    {
+      if (strcmp(entry.path, path) == 0)
+      {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+public:
+  bool exists(const char *path)
+  {
+    return path[0] && find(path);
+  }
+
+  // "w" creates or truncates, anything else opens an existing container for reading
+  RamAnimationFile open(const char *path, const char *mode)
+  {
+    RamAnimationEntry *entry = path[0] ? find(path) : nullptr;
+    if (mode[0] == 'w')
+    {
+      if (!entry)
+      {
+        entry = find("");
+      }
+      if (!entry || strlen(path) >= sizeof(entry->path))
+      {
+        return RamAnimationFile();
+      }
+      strcpy(entry->path, path);
+      entry->size = 0;
+    }
+    return RamAnimationFile(entry);
+  }
+
+  bool remove(const char *path)
+  {
+    RamAnimationEntry *entry = path[0] ? find(path) : nullptr;
+    if (!entry)
+    {
+      return false;
+    }
+    free(entry->data);
+    *entry = RamAnimationEntry();
+    return true;
+  }
+
+  bool rename(const char *from, const char *to)
+  {
+    RamAnimationEntry *entry = from[0] ? find(from) : nullptr;
+    if (!entry || strlen(to) >= sizeof(entry->path))
+    {
+      return false;
+    }
+    remove(to);
+    strcpy(entry->path, to);
+    return true;
+  }
+};
+
+static RamAnimationFs animationFs;
+
+size_t RamAnimationFile::read(uint8_t *buffer, size_t length)
+{
+  if (!entry || position >= entry->size)
+  {
+    return 0;
+  }
+  length = std::min(length, entry->size - position);
+  memcpy(buffer, entry->data + position, length);
+  position += length;
+  return length;
+}
+
+size_t RamAnimationFile::write(const uint8_t *buffer, size_t length)
+{
+  if (!entry || position + length > ANIMATION_RAM_BYTES)
+  {
+    return 0;
+  }
+
+  if (position + length > entry->capacity)
+  {
+    // doubling keeps an upload of many small records from reallocating on every one of them
+    size_t capacity = std::max<size_t>(entry->capacity * 2, 256);
+    capacity = std::min(std::max(capacity, position + length), ANIMATION_RAM_BYTES);
+    uint8_t *data = static_cast<uint8_t *>(realloc(entry->data, capacity));
+    if (!data)
+    {
+      return 0;
+    }
+    entry->data = data;
+    entry->capacity = capacity;
+  }
+
+  memcpy(entry->data + position, buffer, length);
+  position += length;
+  entry->size = std::max(entry->size, position);
+  return length;
+}
+
+bool RamAnimationFile::seek(uint32_t offset)
+{
+  if (!entry || offset > entry->size)
+  {
+    return false;
+  }
+  position = offset;
+  return true;
+}
+
+size_t RamAnimationFile::size() const
+{
+  return entry ? entry->size : 0;
+}
+
+void RamAnimationFile::close()
+{
+  entry = nullptr;
+  position = 0;
+}
+#endif
+
+static uint16_t readU16(const uint8_t *raw)
+{
+  return raw[0] | (raw[1] << 8);
+}
+
+static void writeU16(uint8_t *raw, uint16_t value)
+{
+  raw[0] = value & 0xFF;
+  raw[1] = value >> 8;
+}
+
+bool parseAnimationHeader(const uint8_t *raw, AnimationHeader &header)
+{
+  if (memcmp(raw, "OBA1", 4) != 0 || raw[4] != ANIM_VERSION)
+  {
+    return false;
+  }
+
+  uint8_t bpp = raw[5];
+  if (bpp != 1 && bpp != 4 && bpp != 8)
+  {
+    return false;
+  }
+
+  header.bitsPerPixel = bpp;
+  header.frameCount = readU16(raw + 6);
+  header.loopStart = readU16(raw + 8);
+  header.defaultDelay = readU16(raw + 10);
+
+  return header.frameCount > 0 && header.loopStart < header.frameCount;
+}
+
+void writeAnimationHeader(uint8_t *raw, const AnimationHeader &header)
+{
+  memset(raw, 0, ANIM_HEADER_SIZE);
+  memcpy(raw, "OBA1", 4);
+  raw[4] = ANIM_VERSION;
+  raw[5] = header.bitsPerPixel;
+  writeU16(raw + 6, header.frameCount);
+  writeU16(raw + 8, header.loopStart);
+  writeU16(raw + 10, header.defaultDelay);
+}
+
+void packAnimationPlane(const uint8_t *pixels, uint8_t bitsPerPixel, uint8_t *plane)
+{
+  if (bitsPerPixel == 8)
+  {
+    memcpy(plane, pixels, ROWS * COLS);
+  }
+  else if (bitsPerPixel == 4)
+  {
+    for (int i = 0; i < ROWS * COLS; i += 2)
+    {
+      plane[i >> 1] = (pixels[i] & 0xF0) | (pixels[i + 1] >> 4);
+    }
+  }
+  else
+  {
+    memset(plane, 0, ROWS * COLS / 8);
+    for (int i = 0; i < ROWS * COLS; i++)
+    {
+      if (pixels[i] >= 0x80)
+      {
+        plane[i >> 3] |= 0x80 >> (i & 7);
+      }
+    }
+  }
+}
+
+void unpackAnimationPlane(const uint8_t *plane, uint8_t bitsPerPixel, uint8_t *pixels)
+{
+  if (bitsPerPixel == 8)
+  {
+    memcpy(pixels, plane, ROWS * COLS);
+  }
+  else if (bitsPerPixel == 4)
+  {
+    for (int i = 0; i < ROWS * COLS; i += 2)
+    {
+      pixels[i] = (plane[i >> 1] >> 4) * 17;
+      pixels[i + 1] = (plane[i >> 1] & 0x0F) * 17;
+    }
+  }
+  else
+  {
+    for (int i = 0; i < ROWS * COLS; i++)
+    {
+      pixels[i] = (plane[i >> 3] & (0x80 >> (i & 7))) ? MAX_BRIGHTNESS : 0;
+    }
+  }
+}
+
+// PackBits: control byte n >= 0 copies n + 1 literals, n < 0 repeats the next byte 1 - n times
+size_t packBitsEncode(const uint8_t *in, size_t len, uint8_t *out)
+{
+  size_t i = 0;
+  size_t o = 0;
+
+  while (i < len)
+  {
+    size_t run = 1;
+    while (i + run < len && run < 128 && in[i + run] == in[i])
+    {
+      run++;
+    }
+
+    if (run >= 2)
+    {
+      out[o++] = (uint8_t)(1 - (int)run);
+      out[o++] = in[i];
+      i += run;
+      continue;
+    }
+
+    size_t start = i;
+    size_t literals = 0;
+    while (i < len && literals < 128)
+    {
+      if (i + 1 < len && in[i] == in[i + 1])
+      {
+        break;
+      }
+      i++;
+      literals++;
+    }
+
+    out[o++] = (uint8_t)(literals - 1);
+    memcpy(out + o, in + start, literals);
+    o += literals;
+  }
+
+  return o;
+}
+
+size_t packBitsDecode(const uint8_t *in, size_t len, uint8_t *out, size_t outLen)
+{
+  size_t i = 0;
+  size_t o = 0;
+
+  while (i < len)
+  {
+    int8_t n = (int8_t)in[i++];
+
+    if (n >= 0)
+    {
+      if (i + n + 1 > len || o + n + 1 > outLen)
+      {
+        return 0;
+      }
+      memcpy(out + o, in + i, n + 1);
+      i += n + 1;
+      o += n + 1;
+    }
+    else if (n != -128)
+    {
+      if (i >= len || o + 1 - n > outLen)
+      {
+        return 0;
+      }
+      memset(out + o, in[i++], 1 - n);
+      o += 1 - n;
+    }
+  }
+
+  return o;
+}
+
+AnimationStore_ &AnimationStore_::getInstance()
+{
+  static AnimationStore_ instance;
+  return instance;
+}
+
+bool AnimationStore_::begin()
+{
+#ifdef ENABLE_STORAGE
+  if (mounted)
+  {
+    return true;
+  }
+
+#ifdef ESP32
+  if (!mutex)
+  {
+    mutex = xSemaphoreCreateMutex();
+  }
+#endif
+
+  // format on first use, the partition is shipped empty
+  mounted = LittleFS.begin(true);
+  if (!mounted)
+  {
+    Serial.println("[AnimationStore] Could not mount LittleFS");
+  }
+  return mounted;
+#else
+  // nothing to mount, containers are kept in RAM
+  mounted = true;
+  return true;
+#endif
+}
+
+bool AnimationStore_::isAvailable() const
+{
+  return mounted;
+}
+
+bool AnimationStore_::hasAnimation()
+{
+  return begin() && animationFs.exists(ANIMATION_PATH);
+}
+
+bool AnimationStore_::remove()
+{
+  if (!begin())
+  {
+    return false;
+  }
+
+  lock();
+  if (activeReader)
+  {
+    activeReader->closeLocked();
+  }
+  bool removed = animationFs.remove(ANIMATION_PATH);
+  generation++;
+  unlock();
+
+  return removed;
+}
+
+size_t AnimationStore_::getFileSize()
+{
+  if (!hasAnimation())
+  {
+    return 0;
+  }
+
+  AnimationFile file = animationFs.open(ANIMATION_PATH, "r");
+  size_t size = file ? file.size() : 0;
+  file.close();
+  return size;
+}
+
+bool AnimationStore_::validate(const char *path, AnimationHeader &header)
+{
+  if (!begin())
+  {
+    return false;
+  }
+
+  AnimationFile file = animationFs.open(path, "r");
+  if (!file)
+  {
+    return false;
+  }
+
+  uint8_t raw[ANIM_HEADER_SIZE];
+  if (file.read(raw, sizeof(raw)) != sizeof(raw) || !parseAnimationHeader(raw, header))
+  {
+    file.close();
+    return false;
+  }
+
+  const uint16_t planeSize = animationPlaneSize(header.bitsPerPixel);
+  const uint32_t size = file.size();
+  uint32_t offset = ANIM_HEADER_SIZE;
+
+  for (uint16_t i = 0; i < header.frameCount; i++)
+  {
+    uint8_t record[ANIM_FRAME_HEADER_SIZE];
+    if (!file.seek(offset) || file.read(record, sizeof(record)) != sizeof(record))
+    {
+      file.close();
+      return false;
+    }
+
+    uint8_t type = record[0];
+    uint16_t length = readU16(record + 3);
+    bool keyRequired = i == 0 || i == header.loopStart;
+
+    if (type > (ANIM_FRAME_DELTA | ANIM_FRAME_RLE) || (keyRequired && (type & ANIM_FRAME_DELTA)) ||
+        length > ANIM_MAX_PAYLOAD_SIZE || (!(type & ANIM_FRAME_RLE) && length != planeSize))
+    {
+      file.close();
+      return false;
+    }
+    offset += ANIM_FRAME_HEADER_SIZE + length;
+  }
+
+  file.close();
+  return offset == size;
+}
+
+void AnimationStore_::lock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+  }
+#endif
+}
+
+void AnimationStore_::unlock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreGive(mutex);
+  }
+#endif
+}
+
+void AnimationStore_::publish(const char *tmpPath)
+{
+  // LittleFS cannot replace a file that is still open, so the player lets go first and
+  // reopens the new container on its next frame
+  // closeLocked() detaches the reader, so keep hold of it
+  AnimationReader *reader = activeReader;
+  if (reader)
+  {
+    reader->closeLocked();
+    reader->wantOpen = true;
+  }
+
+  animationFs.remove(ANIMATION_PATH);
+  animationFs.rename(tmpPath, ANIMATION_PATH);
+  generation++;
+}
+
+uint32_t AnimationStore_::getGeneration() const
+{
+  return generation;
+}
+
+void AnimationStore_::attachReader(AnimationReader *reader)
+{
+  activeReader = reader;
+}
+
+void AnimationStore_::detachReader(AnimationReader *reader)
+{
+  if (activeReader == reader)
+  {
+    activeReader = nullptr;
+  }
+}
+
+// READER START
+AnimationReader::~AnimationReader()
+{
+  close();
+}
+
+bool AnimationReader::open()
+{
+  if (!AnimationStore.begin())
+  {
+    return false;
+  }
+
+  AnimationStore.lock();
+  wantOpen = true;
+  bool opened = openLocked();
+  AnimationStore.unlock();
+
+  return opened;
+}
+
+void AnimationReader::close()
+{
+  AnimationStore.lock();
+  wantOpen = false;
+  closeLocked();
+  AnimationStore.unlock();
+}
+
+bool AnimationReader::isOpen() const
+{
+  return (bool)file;
+}
+
+const AnimationHeader &AnimationReader::getHeader() const
+{
+  return header;
+}
+
+bool AnimationReader::openLocked()
+{
+  closeLocked();
+  // also on failure, so nextFrame() only retries once another container is published
+  openedGeneration = AnimationStore.getGeneration();
+
+  if (!animationFs.exists(ANIMATION_PATH))
+  {
+    return false;
+  }
+
+  file = animationFs.open(ANIMATION_PATH, "r");
+  if (!file)
+  {
+    return false;
+  }
+
+  uint8_t raw[ANIM_HEADER_SIZE];
+  if (file.read(raw, sizeof(raw)) != sizeof(raw) || !parseAnimationHeader(raw, header))
+  {
+    Serial.println("[AnimationStore] Invalid animation header");
+    closeLocked();
+    return false;
+  }
+
+  planeSize = animationPlaneSize(header.bitsPerPixel);
+
+  // Walk the record headers once so looping is a single seek
+  uint32_t offset = ANIM_HEADER_SIZE;
+  for (uint16_t i = 0; i < header.loopStart; i++)
+  {
+    uint8_t record[ANIM_FRAME_HEADER_SIZE];
+    if (!file.seek(offset) || file.read(record, sizeof(record)) != sizeof(record))
+    {
+      closeLocked();
+      return false;
+    }
+    offset += ANIM_FRAME_HEADER_SIZE + readU16(record + 3);
+  }
+  loopOffset = offset;
+
+  file.seek(ANIM_HEADER_SIZE);
+  ioLength = 0;
+  ioPosition = 0;
+  frameIndex = 0;
+  memset(plane, 0, sizeof(plane));
+
+  AnimationStore.attachReader(this);
+  return true;
+}
+
+void AnimationReader::closeLocked()
+{
+  if (file)
+  {
+    file.close();
+  }
+  AnimationStore.detachReader(this);
+}
+
+bool AnimationReader::readExact(uint8_t *dst, size_t len)
+{
+  while (len > 0)
+  {
+    if (ioPosition >= ioLength)
+    {
+      ioLength = file.read(io, sizeof(io));
+      ioPosition = 0;
+      if (ioLength == 0)
+      {
+        return false;
+      }
+    }
+
+    size_t chunk = std::min<size_t>(len, ioLength - ioPosition);
+    memcpy(dst, io + ioPosition, chunk);
+    ioPosition += chunk;
+    dst += chunk;
+    len -= chunk;
+  }
+  return true;
+}
+
+bool AnimationReader::nextPayloadByte(uint8_t &value)
+{
+  if (payloadRemaining == 0 || !readExact(&value, 1))
+  {
+    return false;
+  }
+  payloadRemaining--;
+  return true;
+}
+
+bool AnimationReader::decodePayload(uint8_t type, uint16_t length)
+{
+  const bool delta = type & ANIM_FRAME_DELTA;
+  uint16_t position = 0;
+  uint8_t value;
+
+  payloadRemaining = length;
+
+  if (!(type & ANIM_FRAME_RLE))
+  {
+    while (position < planeSize)
+    {
+      if (!nextPayloadByte(value))
+      {
+        return false;
+      }
+      plane[position] = delta ? plane[position] ^ value : value;
+      position++;
+    }
+    return payloadRemaining == 0;
+  }
+
+  while (payloadRemaining > 0)
+  {
+    uint8_t control;
+    if (!nextPayloadByte(control))
+    {
+      return false;
+    }
+    int8_t n = (int8_t)control;
+
+    if (n >= 0)
+    {
+      for (int i = 0; i <= n; i++)
+      {
+        if (position >= planeSize || !nextPayloadByte(value))
+        {
+          return false;
+        }
+        plane[position] = delta ? plane[position] ^ value : value;
+        position++;
+      }
+    }
+    else if (n != -128)
+    {
+      if (!nextPayloadByte(value))
+      {
+        return false;
+      }
+      for (int i = 0; i < 1 - n; i++)
+      {
+        if (position >= planeSize)
+        {
+          return false;
+        }
+        plane[position] = delta ? plane[position] ^ value : value;
+        position++;
+      }
+    }
+  }
+
+  return position == planeSize;
+}
+
+bool AnimationReader::nextFrame(uint8_t *pixels, uint16_t &delayMs)
+{
+  AnimationStore.lock();
+
+  if (wantOpen && openedGeneration != AnimationStore.getGeneration())
+  {
+    openLocked();
+  }
+
+  if (!file)
+  {
+    AnimationStore.unlock();
+    return false;
+  }
+
+  if (frameIndex >= header.frameCount)
+  {
+    file.seek(loopOffset);
+    ioLength = 0;
+    ioPosition = 0;
+    frameIndex = header.loopStart;
+  }
+
+  uint8_t record[ANIM_FRAME_HEADER_SIZE];
+  bool ok = readExact(record, sizeof(record));
+  uint8_t type = record[0];
+
+  // the first frame and the loop target must not depend on an earlier plane
+  if (ok && (type & ANIM_FRAME_DELTA) && (frameIndex == 0 || frameIndex == header.loopStart))
+  {
+    ok = false;
+  }
+
+  ok = ok && readU16(record + 3) <= ANIM_MAX_PAYLOAD_SIZE &&
+       decodePayload(type, readU16(record + 3));
+
+  if (!ok)
+  {
+    // keep wantOpen, the next upload is picked up through the generation check
+    Serial.printf("[AnimationStore] Corrupt frame %u, waiting for a new animation\n", frameIndex);
+    closeLocked();
+    AnimationStore.unlock();
+    return false;
+  }
+
+  uint16_t frameDelay = readU16(record + 1);
+  delayMs = frameDelay > 0 ? frameDelay : header.defaultDelay;
+  frameIndex++;
+
+  AnimationStore.unlock();
+
+  unpackAnimationPlane(plane, header.bitsPerPixel, pixels);
+  return true;
+}
+// READER END
+
+// WRITER START
+AnimationWriter::AnimationWriter(const char *tmpPath) : tmpPath(tmpPath) {}
+
+AnimationWriter::~AnimationWriter()
+{
+  abort();
+}
+
+bool AnimationWriter::begin(uint8_t bitsPerPixel,
+                            uint16_t defaultDelay,
+                            uint16_t loopStart,
+                            uint16_t keyframeInterval)
+{
+  abort();
+
+  if (bitsPerPixel != 1 && bitsPerPixel != 4 && bitsPerPixel != 8)
+  {
+    return false;
+  }
+
+  if (!AnimationStore.begin())
+  {
+    return false;
+  }
+
+  header.bitsPerPixel = bitsPerPixel;
+  header.frameCount = 0;
+  header.loopStart = loopStart;
+  header.defaultDelay = defaultDelay;
+  planeSize = animationPlaneSize(bitsPerPixel);
+  this->keyframeInterval = keyframeInterval > 0 ? keyframeInterval : 1;
+  framesSinceKey = 0;
+  memset(previous, 0, sizeof(previous));
+
+  file = animationFs.open(tmpPath, "w");
+  if (!file)
+  {
+    Serial.println("[AnimationStore] Could not create temporary animation file");
+    return false;
+  }
+
+  // placeholder, patched with the final frame count on commit
+  uint8_t raw[ANIM_HEADER_SIZE];
+  writeAnimationHeader(raw, header);
+  if (file.write(raw, sizeof(raw)) != sizeof(raw))
+  {
+    abort();
+    return false;
+  }
+
+  active = true;
+  return true;
+}
+
+bool AnimationWriter::writeFrame(uint8_t type, uint16_t delayMs, const uint8_t *payload, uint16_t length)
+{
+  uint8_t record[ANIM_FRAME_HEADER_SIZE];
+  record[0] = type;
+  writeU16(record + 1, delayMs);
+  writeU16(record + 3, length);
+
+  return file.write(record, sizeof(record)) == sizeof(record) &&
+         file.write(payload, length) == length;
+}
+
+bool AnimationWriter::addFrame(const uint8_t *pixels, uint16_t delayMs)
+{
+  if (!active || header.frameCount == UINT16_MAX)
+  {
+    return false;
+  }
+
+  packAnimationPlane(pixels, header.bitsPerPixel, current);
+
+  bool keyframe = header.frameCount == 0 || header.frameCount == header.loopStart ||
+                  framesSinceKey >= keyframeInterval;
+  bool written = false;
+
+  if (!keyframe)
+  {
+    for (uint16_t i = 0; i < planeSize; i++)
+    {
+      previous[i] ^= current[i];
+    }
+
+    size_t deltaLength = packBitsEncode(previous, planeSize, encoded);
+    if (deltaLength < planeSize)
+    {
+      written = writeFrame(ANIM_FRAME_DELTA | ANIM_FRAME_RLE, delayMs, encoded, deltaLength);
+      framesSinceKey++;
+    }
+    else
+    {
+      keyframe = true;
+    }
+  }
+
+  if (keyframe)
+  {
+    size_t keyLength = packBitsEncode(current, planeSize, encoded);
+    written = keyLength < planeSize ? writeFrame(ANIM_FRAME_RLE, delayMs, encoded, keyLength)
+                                    : writeFrame(0, delayMs, current, planeSize);
+    framesSinceKey = 1;
+  }
+
+  if (!written)
+  {
+    Serial.println("[AnimationStore] Write failed (flash full?)");
+    abort();
+    return false;
+  }
+
+  memcpy(previous, current, planeSize);
+  header.frameCount++;
+  return true;
+}
+
+bool AnimationWriter::commit()
+{
+  if (!active || header.frameCount == 0)
+  {
+    abort();
+    return false;
+  }
+
+  if (header.loopStart >= header.frameCount)
+  {
+    header.loopStart = 0;
+  }
+
+  uint8_t raw[ANIM_HEADER_SIZE];
+  writeAnimationHeader(raw, header);
+  bool ok = file.seek(0) && file.write(raw, sizeof(raw)) == sizeof(raw);
+  file.close();
+  active = false;
+
+  if (!ok)
+  {
+    animationFs.remove(tmpPath);
+    return false;
+  }
+
+  AnimationStore.lock();
+  AnimationStore.publish(tmpPath);
+  AnimationStore.unlock();
+
+  Serial.printf("[AnimationStore] Stored %u frames (%u bpp)\n",
+                header.frameCount,
+                header.bitsPerPixel);
+  return true;
+}
+
+void AnimationWriter::abort()
+{
+  if (file)
+  {
+    file.close();
+  }
+  if (active)
+  {
+    animationFs.remove(tmpPath);
+  }
+  active = false;
+}
+
+bool AnimationWriter::isActive() const
+{
+  return active;
+}
+
+uint16_t AnimationWriter::getFrameCount() const
+{
+  return header.frameCount;
+}
+// WRITER END
+
+AnimationStore_ &AnimationStore = AnimationStore.getInstance();
@@ -0,0 +1,305 @@
+#include "animationupload.h"
+
+#ifdef ENABLE_SERVER
+
+#ifdef ENABLE_STORAGE
+#include <LittleFS.h>
+#endif
+
+static uint32_t readU32(const uint8_t *raw)
+{
+  return raw[0] | (raw[1] << 8) | (raw[2] << 16) | ((uint32_t)raw[3] << 24);
+}
+
+// CRC-32 (IEEE 802.3), nibble table to keep the flash footprint small
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len)
+{
+  static const uint32_t table[16] = {0x00000000,
+                                     0x1DB71064,
+                                     0x3B6E20C8,
+                                     0x26D930AC,
+                                     0x76DC4190,
+                                     0x6B6B51F4,
+                                     0x4DB26158,
+                                     0x5005713C,
+                                     0xEDB88320,
+                                     0xF00F9344,
+                                     0xD6D6A3E8,
+                                     0xCB61B38C,
+                                     0x9B64C2B0,
+                                     0x86D3D2D4,
+                                     0xA00AE278,
+                                     0xBDBDF21C};
+
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+AnimationUpload_ &AnimationUpload_::getInstance()
+{
+  static AnimationUpload_ instance;
+  return instance;
+}
+
+bool AnimationUpload_::isUploadMessage(const uint8_t *data, size_t len)
+{
+  return len >= UPLOAD_HEADER_SIZE && data[0] == UPLOAD_MAGIC;
+}
+
+bool AnimationUpload_::isActive() const
+{
+  return active;
+}
+
+uint32_t AnimationUpload_::getReceived() const
+{
+  return received;
+}
+
+uint32_t AnimationUpload_::getTotalSize() const
+{
+  return totalSize;
+}
+
+void AnimationUpload_::fillReply(JsonDocument &reply, const char *status, uint16_t seq)
+{
+  reply["event"] = "upload";
+  reply["status"] = status;
+  reply["seq"] = seq;
+  reply["offset"] = received;
+  reply["size"] = totalSize;
+
+#ifdef ESP32
+  // shrink the window when the heap gets tight so the TCP stack can keep up
+  reply["window"] = ESP.getMaxAllocHeap() > 32768 ? 4 : 1;
+#else
+  reply["window"] = 1;
+#endif
+}
+
+void AnimationUpload_::abort()
+{
+#ifdef ENABLE_STORAGE
+  if (file)
+  {
+    file.close();
+  }
+  if (active)
+  {
+    LittleFS.remove(ANIMATION_UPLOAD_PATH);
+  }
+#endif
+  active = false;
+  received = 0;
+  nextSeq = 0;
+}
+
+void AnimationUpload_::handleMessage(const uint8_t *data, size_t len, JsonDocument &reply)
+{
+  if (!isUploadMessage(data, len))
+  {
+    fillReply(reply, "error", 0);
+    reply["message"] = "Not an upload message";
+    return;
+  }
+
+  uint8_t opcode = data[1];
+  uint16_t seq = data[2] | (data[3] << 8);
+  const uint8_t *payload = data + UPLOAD_HEADER_SIZE;
+  size_t payloadLength = len - UPLOAD_HEADER_SIZE;
+
+  if (active && millis() - lastActivity > UPLOAD_SESSION_TIMEOUT_MS && opcode != UPLOAD_BEGIN)
+  {
+    Serial.println("[Upload] Session timed out");
+    abort();
+  }
+
+  switch (opcode)
+  {
+  case UPLOAD_BEGIN:
+    begin(seq, payload, payloadLength, reply);
+    break;
+  case UPLOAD_CHUNK:
+    chunk(seq, payload, payloadLength, reply);
+    break;
+  case UPLOAD_END:
+    end(seq, reply);
+    break;
+  case UPLOAD_ABORT:
+    abort();
+    fillReply(reply, "aborted", seq);
+    break;
+  default:
+    fillReply(reply, "error", seq);
+    reply["message"] = "Unknown opcode";
+    break;
+  }
+
+  lastActivity = millis();
+}
+
+void AnimationUpload_::begin(uint16_t seq, const uint8_t *payload, size_t len, JsonDocument &reply)
+{
+#ifdef ENABLE_STORAGE
+  if (len < 8)
+  {
+    fillReply(reply, "error", seq);
+    reply["message"] = "BEGIN needs size and crc";
+    return;
+  }
+
+  uint32_t size = readU32(payload);
+  uint32_t crc = readU32(payload + 4);
+
+  // same container again: continue where the previous connection stopped
+  bool resumable = millis() - lastActivity <= UPLOAD_SESSION_TIMEOUT_MS;
+  if (active && resumable && size == totalSize && crc == totalCrc)
+  {
+    Serial.printf("[Upload] Resuming at %u/%u\n", received, totalSize);
+    fillReply(reply, "resume", nextSeq);
+    return;
+  }
+
+  abort();
+
+  if (!AnimationStore.begin())
+  {
+    fillReply(reply, "error", seq);
+    reply["message"] = "Storage unavailable";
+    return;
+  }
+
+  if (size <= ANIM_HEADER_SIZE || size > LittleFS.totalBytes() - LittleFS.usedBytes())
+  {
+    fillReply(reply, "error", seq);
+    reply["message"] = "Invalid size or not enough flash";
+    return;
+  }
+
+  file = LittleFS.open(ANIMATION_UPLOAD_PATH, "w");
+  if (!file)
+  {
+    fillReply(reply, "error", seq);
+    reply["message"] = "Could not create upload file";
+    return;
+  }
+
+  active = true;
+  totalSize = size;
+  totalCrc = crc;
+  received = 0;
+  runningCrc = 0;
+  nextSeq = seq + 1;
+
+  Serial.printf("[Upload] Started, %u bytes\n", size);
+  fillReply(reply, "ready", nextSeq);
+#else
+  fillReply(reply, "error", seq);
+  reply["message"] = "Storage disabled";
+#endif
+}
+
+void AnimationUpload_::chunk(uint16_t seq, const uint8_t *payload, size_t len, JsonDocument &reply)
+{
+#ifdef ENABLE_STORAGE
+  if (!active)
+  {
+    fillReply(reply, "error", seq);
+    reply["message"] = "No upload in progress";
+    return;
+  }
+
+  if (len < 8 || len - 8 > UPLOAD_MAX_CHUNK)
+  {
+    fillReply(reply, "retry", nextSeq);
+    return;
+  }
+
+  uint32_t offset = readU32(payload);
+  uint32_t crc = readU32(payload + 4);
+  const uint8_t *chunkData = payload + 8;
+  size_t chunkLength = len - 8;
+
+  // duplicate of an already written chunk (lost ack), just confirm again
+  if (offset + chunkLength <= received && seq != nextSeq)
+  {
+    fillReply(reply, "ack", nextSeq);
+    return;
+  }
+
+  if (seq != nextSeq || offset != received || offset + chunkLength > totalSize ||
+      crc32Update(0, chunkData, chunkLength) != crc)
+  {
+    fillReply(reply, "retry", nextSeq);
+    return;
+  }
+
+  if (file.write(chunkData, chunkLength) != chunkLength)
+  {
+    Serial.println("[Upload] Flash write failed");
+    abort();
+    fillReply(reply, "error", seq);
+    reply["message"] = "Flash write failed";
+    return;
+  }
+
+  runningCrc = crc32Update(runningCrc, chunkData, chunkLength);
+  received += chunkLength;
+  nextSeq++;
+
+  fillReply(reply, "ack", nextSeq);
+#else
+  fillReply(reply, "error", seq);
+#endif
+}
+
+void AnimationUpload_::end(uint16_t seq, JsonDocument &reply)
+{
+#ifdef ENABLE_STORAGE
+  if (!active)
+  {
+    fillReply(reply, "error", seq);
+    reply["message"] = "No upload in progress";
+    return;
+  }
+
+  if (received != totalSize)
+  {
+    fillReply(reply, "retry", nextSeq);
+    return;
+  }
+
+  file.close();
+
+  AnimationHeader header;
+  if (runningCrc != totalCrc || !AnimationStore.validate(ANIMATION_UPLOAD_PATH, header))
+  {
+    Serial.println("[Upload] Verification failed");
+    abort();
+    fillReply(reply, "error", seq);
+    reply["message"] = "CRC or container check failed";
+    return;
+  }
+
+  AnimationStore.lock();
+  AnimationStore.publish(ANIMATION_UPLOAD_PATH);
+  AnimationStore.unlock();
+  active = false;
+
+  Serial.printf("[Upload] Done, %u frames\n", header.frameCount);
+  fillReply(reply, "done", seq);
+  reply["frames"] = header.frameCount;
+#else
+  fillReply(reply, "error", seq);
+#endif
+}
+
+AnimationUpload_ &AnimationUpload = AnimationUpload.getInstance();
+
+#endif
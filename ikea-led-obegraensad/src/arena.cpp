@@ -0,0 +1,225 @@
+#include "arena.h"
+#include "config.h"
+
+struct ArenaHeader
+{
+  uint32_t size;
+  uint32_t padding; // keeps the payload 8 byte aligned for doubles
+};
+
+struct ArenaStats
+{
+  uint32_t uses = 0;
+  uint32_t busy = 0;
+  uint32_t spills = 0;
+  size_t peak = 0;
+};
+
+alignas(8) static uint8_t blocks[JSON_ARENA_COUNT][JSON_ARENA_SIZE];
+static bool taken[JSON_ARENA_COUNT] = {false};
+static ArenaStats stats;
+
+#ifdef ESP32
+static portMUX_TYPE arenaLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+static size_t footprint(size_t size)
+{
+  return sizeof(ArenaHeader) + ((size + 7) & ~(size_t)7);
+}
+
+JsonArena::JsonArena()
+{
+#ifdef ESP32
+  portENTER_CRITICAL(&arenaLock);
+#endif
+  for (uint8_t i = 0; i < JSON_ARENA_COUNT; i++)
+  {
+    if (!taken[i])
+    {
+      taken[i] = true;
+      block = blocks[i];
+      index = i;
+      break;
+    }
+  }
+  stats.uses++;
+  if (!block)
+  {
+    stats.busy++;
+  }
+#ifdef ESP32
+  portEXIT_CRITICAL(&arenaLock);
+#endif
+}
+
+JsonArena::~JsonArena()
+{
+#ifdef ESP32
+  portENTER_CRITICAL(&arenaLock);
+#endif
+  stats.spills += spills;
+  stats.peak = max(stats.peak, peak);
+  if (block)
+  {
+    taken[index] = false;
+  }
+#ifdef ESP32
+  portEXIT_CRITICAL(&arenaLock);
+#endif
+}
+
+bool JsonArena::owns(const void *pointer) const
+{
+  const uint8_t *address = static_cast<const uint8_t *>(pointer);
+  return block && address >= block && address < block + JSON_ARENA_SIZE;
+}
+
+void *JsonArena::allocate(size_t size)
+{
+  size_t needed = footprint(size);
+  if (block && used + needed <= JSON_ARENA_SIZE)
+  {
+    auto *header = reinterpret_cast<ArenaHeader *>(block + used);
+    header->size = size;
+    last = used;
+    used += needed;
+    peak = max(peak, used);
+    return header + 1;
+  }
+
+  spills++;
+  return malloc(size);
+}
+
+void JsonArena::deallocate(void *pointer)
+{
+  if (!pointer)
+  {
+    return;
+  }
+  if (!owns(pointer))
+  {
+    free(pointer);
+    return;
+  }
+
+  // only the most recent allocation can be handed back, the rest goes with the arena
+  size_t offset = static_cast<uint8_t *>(pointer) - block - sizeof(ArenaHeader);
+  if (offset == last)
+  {
+    used = last;
+    last = SIZE_MAX;
+  }
+}
+
+void *JsonArena::reallocate(void *pointer, size_t newSize)
+{
+  if (!pointer)
+  {
+    return allocate(newSize);
+  }
+  if (!owns(pointer))
+  {
+    return realloc(pointer, newSize);
+  }
+
+  auto *header = static_cast<ArenaHeader *>(pointer) - 1;
+  size_t offset = reinterpret_cast<uint8_t *>(header) - block;
+
+  if (offset == last && offset + footprint(newSize) <= JSON_ARENA_SIZE)
+  {
+    header->size = newSize;
+    used = offset + footprint(newSize);
+    peak = max(peak, used);
+    return pointer;
+  }
+  if (newSize <= header->size)
+  {
+    header->size = newSize;
+    return pointer;
+  }
+
+  void *moved = allocate(newSize);
+  if (moved)
+  {
+    memcpy(moved, pointer, header->size);
+  }
+  return moved;
+}
+
+const char *JsonArena::serialize(JsonVariantConst json)
+{
+  size_t length = measureJson(json);
+  if (block && used + length + 1 <= JSON_ARENA_SIZE)
+  {
+    char *text = reinterpret_cast<char *>(block + used);
+    serializeJson(json, text, length + 1);
+    // not handed out as an allocation, later allocations may reuse the space
+    peak = max(peak, used + length + 1);
+    return text;
+  }
+
+  spills++;
+  overflow = String();
+  overflow.reserve(length);
+  serializeJson(json, overflow);
+  return overflow.c_str();
+}
+
+void JsonArena::statsToJson(JsonObject object)
+{
+  object["blocks"] = JSON_ARENA_COUNT;
+  object["blockSize"] = JSON_ARENA_SIZE;
+  object["uses"] = stats.uses;
+  object["busy"] = stats.busy;
+  object["spills"] = stats.spills;
+  object["peak"] = stats.peak;
+}
+
+#ifdef ESP32
+
+TlsReserve_ &TlsReserve_::getInstance()
+{
+  static TlsReserve_ instance;
+  return instance;
+}
+
+bool TlsReserve_::reserve()
+{
+  if (!config.getTlsReserve())
+  {
+    release();
+    return false;
+  }
+
+  if (!block)
+  {
+    block = malloc(TLS_RESERVE_BYTES);
+    if (!block)
+    {
+      failures++;
+      Serial.printf("[Arena] No %u byte block left for TLS (maxAlloc=%u)\n",
+                    (unsigned)TLS_RESERVE_BYTES, ESP.getMaxAllocHeap());
+    }
+  }
+  return block != nullptr;
+}
+
+void TlsReserve_::release()
+{
+  free(block);
+  block = nullptr;
+}
+
+void TlsReserve_::toJson(JsonObject object) const
+{
+  object["enabled"] = config.getTlsReserve();
+  object["bytes"] = TLS_RESERVE_BYTES;
+  object["held"] = block != nullptr;
+  object["failures"] = failures;
+}
+
+TlsReserve_ &TlsReserve = TlsReserve.getInstance();
+
+#endif
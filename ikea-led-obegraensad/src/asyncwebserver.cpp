@@ -1,10 +1,9 @@
 #include "asyncwebserver.h"
+#include "arena.h"
 #include "messages.h"
+#include "settings.h"
 #include "webhandler.h"
 #include <ArduinoJson.h>
-#ifdef ENABLE_STORAGE
-#include <Preferences.h>
-#endif
 
 #ifdef ENABLE_SERVER
 
@@ -27,6 +26,14 @@ void initWebServer()
   server.on("/api/removemessage", HTTP_GET, handleMessageRemove);
 
   server.on("/api/info", HTTP_GET, handleGetInfo);
+  server.on("/api/boot", HTTP_GET, handleGetBoot);
+  server.on("/api/heap", HTTP_GET, handleGetHeap);
+  // before /api/recorder, which would also match its subpaths
+  server.on("/api/recorder/capture", HTTP_GET, handleGetRecorderCapture);
+  server.on("/api/recorder", HTTP_GET, handleGetRecorder);
+  server.on("/api/wifi/portal", HTTP_POST, handleWifiPortal);
+  server.on("/api/power", HTTP_GET, handleGetPower);
+  server.on("/api/power", HTTP_POST, handleSetPower);
 
   // Handle API request to set an active plugin by ID
   server.on("/api/plugin", HTTP_PATCH, handleSetPlugin);
@@ -41,6 +48,20 @@ void initWebServer()
   server.on("/api/schedule/stop", HTTP_GET, handleStopSchedule);
   server.on("/api/schedule/start", HTTP_GET, handleStartSchedule);
 
+  // Several of the calls above in one request, applied all or nothing
+  server.on(
+      "/api/batch",
+      HTTP_POST,
+      [](AsyncWebServerRequest *request) {
+        // Response is sent from the body handler; a request without a body never gets there
+        if (!request->contentLength())
+        {
+          sendJsonError(request, 400, "Expected a JSON array of operations");
+        }
+      },
+      nullptr,
+      handleBatchBody);
+
   server.on("/api/storage/clear", HTTP_GET, handleClearStorage);
 
   // Configuration endpoints
@@ -55,17 +76,38 @@ void initWebServer()
       handleSetConfigBody);
   server.on("/api/config/reset", HTTP_POST, handleResetConfig);
 
+  // Animation store: chunked binary upload (same protocol as the websocket)
+  server.on("/api/animation", HTTP_GET, handleGetAnimation);
+  server.on("/api/animation", HTTP_DELETE, handleDeleteAnimation);
+  server.on(
+      "/api/animation/upload",
+      HTTP_POST,
+      [](AsyncWebServerRequest *request) {
+        // Response is sent after full body is received.
+      },
+      nullptr,
+      handleAnimationUploadBody);
+  // GIF or PNG, decoded on the device into the animation store
+  server.on(
+      "/api/animation/image",
+      HTTP_POST,
+      [](AsyncWebServerRequest *request) {
+        // Response is sent from the body handler; a request without a body never gets there
+        if (!request->contentLength())
+        {
+          sendJsonError(request, 400, "Empty upload");
+        }
+      },
+      nullptr,
+      handleImageUploadBody);
+
   // City Clock config API
   server.on("/api/cityclock", HTTP_GET, [](AsyncWebServerRequest *request) {
 #ifdef ENABLE_STORAGE
-    Preferences prefs;
-    prefs.begin("cityclock", true);
-    JsonDocument doc;
-    doc["cityIndex"] = prefs.getInt("cityIdx", 0);
-    prefs.end();
-    String output;
-    serializeJson(doc, output);
-    request->send(200, "application/json", output);
+    JsonArena arena;
+    JsonDocument doc(&arena);
+    doc["cityIndex"] = Settings.getInt(SETTING_CITYCLOCK_CITY);
+    request->send(200, "application/json", arena.serialize(doc));
 #else
     request->send(200, "application/json", "{\"cityIndex\":0}");
 #endif
@@ -78,7 +120,8 @@ void initWebServer()
       NULL,
       [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t, size_t) {
 #ifdef ENABLE_STORAGE
-        JsonDocument doc;
+        JsonArena arena;
+        JsonDocument doc(&arena);
         DeserializationError err = deserializeJson(doc, data, len);
         if (err)
         {
@@ -96,10 +139,7 @@ void initWebServer()
           request->send(400, "application/json", "{\"error\":\"cityIndex 0-3\"}");
           return;
         }
-        Preferences prefs;
-        prefs.begin("cityclock", false);
-        prefs.putInt("cityIdx", idx);
-        prefs.end();
+        Settings.setInt(SETTING_CITYCLOCK_CITY, idx);
         Serial.printf("[API] Saved cityclock cityIdx=%d\n", idx);
         request->send(200, "application/json", "{\"ok\":true}");
 #else
@@ -171,14 +211,10 @@ document.getElementById('save').onclick=async()=>{
   // Forecast config API
   server.on("/api/forecast", HTTP_GET, [](AsyncWebServerRequest *request) {
 #ifdef ENABLE_STORAGE
-    Preferences prefs;
-    prefs.begin("forecast", true);
-    JsonDocument doc;
-    doc["cityIndex"] = prefs.getInt("cityIdx", 0);
-    prefs.end();
-    String output;
-    serializeJson(doc, output);
-    request->send(200, "application/json", output);
+    JsonArena arena;
+    JsonDocument doc(&arena);
+    doc["cityIndex"] = Settings.getInt(SETTING_FORECAST_CITY);
+    request->send(200, "application/json", arena.serialize(doc));
 #else
     request->send(200, "application/json", "{\"cityIndex\":0}");
 #endif
@@ -190,7 +226,8 @@ document.getElementById('save').onclick=async()=>{
       NULL,
       [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t, size_t) {
 #ifdef ENABLE_STORAGE
-        JsonDocument doc;
+        JsonArena arena;
+        JsonDocument doc(&arena);
         DeserializationError err = deserializeJson(doc, data, len);
         if (err)
         {
@@ -208,10 +245,7 @@ document.getElementById('save').onclick=async()=>{
           request->send(400, "application/json", "{\"error\":\"cityIndex 0-3\"}");
           return;
         }
-        Preferences prefs;
-        prefs.begin("forecast", false);
-        prefs.putInt("cityIdx", idx);
-        prefs.end();
+        Settings.setInt(SETTING_FORECAST_CITY, idx);
         Serial.printf("[API] Saved forecast cityIdx=%d\n", idx);
         request->send(200, "application/json", "{\"ok\":true}");
 #else
@@ -0,0 +1,220 @@
+#include "audiospectrum.h"
+
+#include <math.h>
+
+// log2 power in 8.8 fixed point, 1.0 = 3 dB
+static constexpr int32_t AUDIO_RANGE = 14 * 256;
+// the AGC never goes below this, so hiss is not amplified to full bars; a full scale sine is
+// about 25 * 256
+static constexpr int32_t AUDIO_FLOOR = 11 * 256;
+// 6 dB per second at 100 analyses per second
+static constexpr int32_t AUDIO_RELEASE = 5;
+
+static constexpr float AUDIO_LOW_HZ = 60.0f;
+static constexpr float AUDIO_HIGH_HZ = 8000.0f;
+
+// Piecewise linear log2: exact at powers of two, off by at most 0.09 in between
+static int32_t log2Fixed(uint64_t value)
+{
+  if (!value)
+  {
+    return 0;
+  }
+  int32_t exponent = 63 - __builtin_clzll(value);
+  uint32_t mantissa = exponent >= 8 ? (uint32_t)(value >> (exponent - 8))
+                                    : (uint32_t)(value << (8 - exponent));
+  return exponent * 256 + (mantissa & 0xff);
+}
+
+AudioSpectrum::AudioSpectrum()
+{
+  for (uint16_t i = 0; i < AUDIO_FFT_SIZE; i++)
+  {
+    window[i] = (int16_t)(16383.5f * (1.0f - cosf(2.0f * (float)M_PI * i / AUDIO_FFT_SIZE)));
+
+    uint8_t bits = 0;
+    for (uint8_t b = 0; b < AUDIO_FFT_BITS; b++)
+    {
+      bits |= ((i >> b) & 1) << (AUDIO_FFT_BITS - 1 - b);
+    }
+    reversed[i] = bits;
+    windowSum += window[i];
+  }
+  for (uint16_t i = 0; i < AUDIO_FFT_SIZE / 2; i++)
+  {
+    float angle = 2.0f * (float)M_PI * i / AUDIO_FFT_SIZE;
+    cosTable[i] = (int16_t)lroundf(32767.0f * cosf(angle));
+    sinTable[i] = (int16_t)lroundf(32767.0f * sinf(angle));
+  }
+
+  setSampleRate(16000);
+  reset();
+}
+
+void AudioSpectrum::setSampleRate(uint32_t hz)
+{
+  hz = hz < AUDIO_MIN_RATE ? AUDIO_MIN_RATE : (hz > AUDIO_MAX_RATE ? AUDIO_MAX_RATE : hz);
+  if (hz == sampleRate)
+  {
+    return;
+  }
+  sampleRate = hz;
+
+  // log-spaced edges, but every band at least one bin wide; the lowest bands run into the
+  // FFT resolution first (62.5 Hz per bin at 16 kHz)
+  float binHz = (float)hz / AUDIO_FFT_SIZE;
+  float high = AUDIO_HIGH_HZ < hz / 2.0f ? AUDIO_HIGH_HZ : hz / 2.0f;
+  uint8_t limit = AUDIO_FFT_SIZE / 2;
+  bandStart[0] = 1;
+  for (uint8_t band = 1; band <= AUDIO_BANDS; band++)
+  {
+    float edge = AUDIO_LOW_HZ * powf(high / AUDIO_LOW_HZ, (float)band / AUDIO_BANDS);
+    int32_t bin = lroundf(edge / binHz);
+    int32_t minimum = bandStart[band - 1] + 1;
+    int32_t maximum = limit - (AUDIO_BANDS - band);
+    bin = bin < minimum ? minimum : bin;
+    bandStart[band] = bin > maximum ? maximum : bin;
+  }
+}
+
+void AudioSpectrum::reset()
+{
+  for (uint16_t i = 0; i < AUDIO_RING_SIZE; i++)
+  {
+    ring[i] = 0;
+  }
+  ceiling = AUDIO_FLOOR;
+}
+
+void AudioSpectrum::push(const uint8_t *pcm, size_t samples)
+{
+  uint32_t head = written;
+  for (size_t i = 0; i < samples; i++)
+  {
+    ring[(head + i) & (AUDIO_RING_SIZE - 1)] = (int16_t)(pcm[2 * i] | pcm[2 * i + 1] << 8);
+  }
+  __atomic_store_n(&written, head + (uint32_t)samples, __ATOMIC_RELEASE);
+}
+
+void AudioSpectrum::push(const int16_t *samples, size_t count)
+{
+  uint32_t head = written;
+  for (size_t i = 0; i < count; i++)
+  {
+    ring[(head + i) & (AUDIO_RING_SIZE - 1)] = samples[i];
+  }
+  __atomic_store_n(&written, head + (uint32_t)count, __ATOMIC_RELEASE);
+}
+
+uint32_t AudioSpectrum::getWritten() const
+{
+  return __atomic_load_n(&written, __ATOMIC_ACQUIRE);
+}
+
+void AudioSpectrum::transform(int16_t *re, int16_t *im) const
+{
+  for (uint16_t i = 0; i < AUDIO_FFT_SIZE; i++)
+  {
+    uint16_t j = reversed[i];
+    if (j > i)
+    {
+      int16_t swap = re[i];
+      re[i] = re[j];
+      re[j] = swap;
+      swap = im[i];
+      im[i] = im[j];
+      im[j] = swap;
+    }
+  }
+
+  for (uint16_t half = 1, step = AUDIO_FFT_SIZE / 2; half < AUDIO_FFT_SIZE; half <<= 1, step >>= 1)
+  {
+    for (uint16_t k = 0; k < half; k++)
+    {
+      // e^(-2 pi i k / 2half)
+      int32_t wr = cosTable[k * step];
+      int32_t wi = -sinTable[k * step];
+      for (uint16_t i = k; i < AUDIO_FFT_SIZE; i += half << 1)
+      {
+        uint16_t j = i + half;
+        int32_t tr = (wr * re[j] - wi * im[j]) >> 15;
+        int32_t ti = (wr * im[j] + wi * re[j]) >> 15;
+        int32_t ur = re[i];
+        int32_t ui = im[i];
+        re[i] = (ur + tr) >> 1;
+        im[i] = (ui + ti) >> 1;
+        re[j] = (ur - tr) >> 1;
+        im[j] = (ui - ti) >> 1;
+      }
+    }
+  }
+}
+
+void AudioSpectrum::analyze(uint8_t *levels)
+{
+  uint32_t end = getWritten();
+  uint32_t start = end - AUDIO_FFT_SIZE;
+
+  // DC offset as the window weighted mean, so what is removed is exactly what would have
+  // leaked from bin 0 into the bass bands
+  int64_t sum = 0;
+  for (uint16_t i = 0; i < AUDIO_FFT_SIZE; i++)
+  {
+    real[i] = ring[(start + i) & (AUDIO_RING_SIZE - 1)];
+    sum += (int32_t)real[i] * window[i];
+  }
+  int32_t mean = sum / windowSum;
+
+  // remove DC, apply the Hann window and find the headroom left in 16 bits
+  int32_t peak = 0;
+  for (uint16_t i = 0; i < AUDIO_FFT_SIZE; i++)
+  {
+    int32_t sample = real[i] - mean;
+    sample = sample > 32767 ? 32767 : (sample < -32768 ? -32768 : sample);
+    sample = sample * window[i] >> 15;
+    real[i] = sample;
+    imag[i] = 0;
+    int32_t magnitude = sample < 0 ? -sample : sample;
+    peak = magnitude > peak ? magnitude : peak;
+  }
+
+  uint8_t shift = 0;
+  while (peak && peak < 0x4000 && shift < 15)
+  {
+    peak <<= 1;
+    shift++;
+  }
+  if (shift)
+  {
+    for (uint16_t i = 0; i < AUDIO_FFT_SIZE; i++)
+    {
+      real[i] = (int16_t)(real[i] * (1 << shift));
+    }
+  }
+
+  transform(real, imag);
+
+  int32_t loudest = -AUDIO_RANGE * 4;
+  for (uint8_t band = 0; band < AUDIO_BANDS; band++)
+  {
+    uint64_t power = 0;
+    for (uint8_t bin = bandStart[band]; bin < bandStart[band + 1]; bin++)
+    {
+      power += (uint32_t)(real[bin] * real[bin]) + (uint32_t)(imag[bin] * imag[bin]);
+    }
+    // the shift scaled the amplitude by 2^shift, so the power by 4^shift
+    bandLog[band] = power ? log2Fixed(power) - shift * 2 * 256 : -AUDIO_RANGE * 4;
+    loudest = bandLog[band] > loudest ? bandLog[band] : loudest;
+  }
+
+  // AGC: jump up to the loudest band at once, sink back slowly
+  ceiling = loudest > ceiling ? loudest : ceiling - AUDIO_RELEASE;
+  ceiling = ceiling < AUDIO_FLOOR ? AUDIO_FLOOR : ceiling;
+
+  int32_t bottom = ceiling - AUDIO_RANGE;
+  for (uint8_t band = 0; band < AUDIO_BANDS; band++)
+  {
+    int32_t level = (bandLog[band] - bottom) * 255 / AUDIO_RANGE;
+    levels[band] = level < 0 ? 0 : (level > 255 ? 255 : level);
+  }
+}
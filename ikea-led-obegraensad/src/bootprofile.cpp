@@ -0,0 +1,42 @@
+#include "bootprofile.h"
+
+struct BootStage
+{
+  const char *name;
+  uint32_t micros;
+};
+
+static BootStage stages[BOOT_PROFILE_MAX_STAGES];
+static uint8_t stageCount = 0;
+
+#ifdef ESP32
+static portMUX_TYPE stageLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+void markBootStage(const char *stage)
+{
+  uint32_t now = micros();
+
+#ifdef ESP32
+  portENTER_CRITICAL(&stageLock);
+#endif
+  if (stageCount < BOOT_PROFILE_MAX_STAGES)
+  {
+    stages[stageCount++] = {stage, now};
+  }
+#ifdef ESP32
+  portEXIT_CRITICAL(&stageLock);
+#endif
+
+  Serial.printf("[Boot] %-12s %6lu.%lu ms\n", stage, (unsigned long)(now / 1000), (unsigned long)((now / 100) % 10));
+}
+
+void bootProfileToJson(JsonArray array)
+{
+  for (uint8_t i = 0; i < stageCount; i++)
+  {
+    JsonObject object = array.add<JsonObject>();
+    object["stage"] = stages[i].name;
+    object["ms"] = stages[i].micros / 1000.0f;
+  }
+}
@@ -0,0 +1,168 @@
+#include "canvas.h"
+#include "signs.h"
+#include <algorithm>
+
+void Canvas::setRenderBuffer(const uint8_t *renderBuffer, bool grays)
+{
+  if (grays)
+  {
+    memcpy(pixels_, renderBuffer, ROWS * COLS);
+  }
+  else
+  {
+    for (int i = 0; i < ROWS * COLS; i++)
+    {
+      pixels_[i] = renderBuffer[i] * MAX_BRIGHTNESS;
+    }
+  }
+}
+
+void Canvas::clear()
+{
+  memset(pixels_, 0, ROWS * COLS);
+}
+
+void Canvas::clearRect(int x, int y, int width, int height)
+{
+  if (x < 0)
+  {
+    width += x;
+    x = 0;
+  }
+  if (y < 0)
+  {
+    height += y;
+    y = 0;
+  }
+
+  if (x >= COLS || y >= ROWS || width <= 0 || height <= 0)
+  {
+    return;
+  }
+
+  width = std::min(width, COLS - x);
+  for (int row = y; row < y + height; row++)
+  {
+    memset(pixels_ + (row * COLS + x), 0, width);
+  }
+}
+
+void Canvas::setPixelAtIndex(uint8_t index, uint8_t value, uint8_t brightness)
+{
+  if (index >= COLS * ROWS)
+    return;
+  pixels_[index] =
+      value <= 0 || brightness <= 0 ? 0 : (brightness > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : brightness);
+}
+
+void Canvas::setPixel(uint8_t x, uint8_t y, uint8_t value, uint8_t brightness)
+{
+  if (x >= COLS || y >= ROWS)
+    return;
+  pixels_[y * COLS + x] =
+      value <= 0 || brightness <= 0 ? 0 : (brightness > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : brightness);
+}
+
+void Canvas::drawLine(int x1, int y1, int x2, int y2, int ledStatus, uint8_t brightness)
+{
+  int dx = abs(x2 - x1);
+  int sx = x1 < x2 ? 1 : -1;
+  int dy = -abs(y2 - y1);
+  int sy = y1 < y2 ? 1 : -1;
+  int error = dx + dy;
+
+  for (;;)
+  {
+    setPixel(x1, y1, ledStatus, brightness);
+    if (x1 == x2 && y1 == y2) break;
+    int e2 = 2 * error;
+    if (e2 >= dy)
+    {
+      error += dy;
+      x1 += sx;
+    }
+    if (e2 <= dx)
+    {
+      error += dx;
+      y1 += sy;
+    }
+  }
+}
+
+void Canvas::drawRectangle(int x,
+                           int y,
+                           int width,
+                           int height,
+                           bool fill,
+                           int ledStatus,
+                           uint8_t brightness)
+{
+  if (!fill)
+  {
+    drawLine(x, y, x + width, y, ledStatus, brightness);
+    drawLine(x, y + 1, x, y + height - 1, ledStatus, brightness);
+    drawLine(x + width, y + 1, x + width, y + height - 1, ledStatus, brightness);
+    drawLine(x, y + height - 1, x + width, y + height - 1, ledStatus, brightness);
+  }
+  else
+  {
+    for (int i = x; i < x + width; i++)
+    {
+      drawLine(i, y, i, y + height - 1, ledStatus, brightness);
+    }
+  }
+}
+
+void Canvas::drawCharacter(int x,
+                           int y,
+                           const std::vector<int> &bits,
+                           int bitCount,
+                           uint8_t brightness)
+{
+  for (int i = 0; i < bits.size(); i += bitCount)
+  {
+    for (int j = 0; j < bitCount; j++)
+    {
+      setPixel(x + j, (y + (i / bitCount)), bits[i + j], brightness);
+    }
+  }
+}
+
+std::vector<int> Canvas::readBytes(const std::vector<int> &bytes)
+{
+  std::vector<int> bits;
+  int k = 0;
+
+  for (int i = 0; i < bytes.size(); i++)
+  {
+    for (int j = 8 - 1; j >= 0; j--)
+    {
+      int b = (bytes[i] >> j) & 1;
+      bits.push_back(b);
+      k++;
+    }
+  }
+
+  return bits;
+}
+
+void Canvas::drawNumbers(int x, int y, const std::vector<int> &numbers, uint8_t brightness)
+{
+  for (int i = 0; i < numbers.size(); i++)
+  {
+    drawCharacter(x + (i * 5), y, readBytes(smallNumbers[numbers.at(i)]), 4, brightness);
+  }
+}
+
+void Canvas::drawBigNumbers(int x, int y, const std::vector<int> &numbers, uint8_t brightness)
+{
+  for (int i = 0; i < numbers.size(); i++)
+  {
+    drawCharacter(x + (i * 8), y, readBytes(bigNumbers[numbers.at(i)]), 8, brightness);
+  }
+}
+
+void Canvas::drawWeather(int x, int y, int weather, uint8_t brightness)
+{
+  drawCharacter(x, y, readBytes(weatherIcons[weather]), 16, brightness);
+}
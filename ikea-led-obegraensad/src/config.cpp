@@ -1,4 +1,6 @@
 #include "config.h"
+#include "arena.h"
+#include "settings.h"
 #include <ArduinoJson.h>
 
 Config config;
@@ -22,18 +24,14 @@ void Config::begin()
   setDefaults();
   
 #ifdef ENABLE_STORAGE
-  // Try to initialize storage
+  // Values come from the settings shadow, loaded once at boot
   try {
-    if (preferences.begin("config", false)) {
+    if (Settings.begin()) {
       storageAvailable = true;
       Serial.println("[Config] Storage initialized successfully");
 
       // Try to load saved configuration
       load();
-
-      // Close handle immediately - keeping it open blocks NVS garbage collection
-      // and eventually fills the 20KB NVS partition with dead entries
-      preferences.end();
     } else {
       Serial.println("[Config] Warning: Could not initialize storage, using defaults");
       storageAvailable = false;
@@ -58,6 +56,10 @@ void Config::begin()
   Serial.println(tzInfo);
   Serial.print("[Config] Auto-Start Schedule: ");
   Serial.println(autoStartSchedule ? "enabled" : "disabled");
+  Serial.print("[Config] Plugin Budget: ");
+  Serial.println(pluginBudgetMs);
+  Serial.print("[Config] TLS Reserve: ");
+  Serial.println(tlsReserve ? "enabled" : "disabled");
   Serial.println("[Config] ============================================");
 }
 
@@ -68,6 +70,8 @@ void Config::setDefaults()
   ntpServer = String(NTP_SERVER);
   tzInfo = String(TZ_INFO);
   autoStartSchedule = false;
+  pluginBudgetMs = PLUGIN_BUDGET_MS;
+  tlsReserve = false;
 }
 
 void Config::load()
@@ -80,10 +84,12 @@ void Config::load()
   
   try {
     // Load with fallback to defaults
-    weatherLocation = preferences.getString("weatherLoc", String(WEATHER_LOCATION));
-    ntpServer = preferences.getString("ntpServer", String(NTP_SERVER));
-    tzInfo = preferences.getString("tzInfo", String(TZ_INFO));
-    autoStartSchedule = preferences.getBool("autoSchedule", false);
+    weatherLocation = Settings.getString(SETTING_WEATHER_LOCATION);
+    ntpServer = Settings.getString(SETTING_NTP_SERVER);
+    tzInfo = Settings.getString(SETTING_TZ_INFO);
+    autoStartSchedule = Settings.getBool(SETTING_AUTO_SCHEDULE);
+    setPluginBudgetMs(Settings.getInt(SETTING_PLUGIN_BUDGET));
+    tlsReserve = Settings.getBool(SETTING_TLS_RESERVE);
     
     Serial.println("[Config] Configuration loaded from storage");
   } catch (...) {
@@ -102,17 +108,15 @@ void Config::save()
   }
 
   try {
-    if (preferences.begin("config", false)) {
-      preferences.putString("weatherLoc", weatherLocation);
-      preferences.putString("ntpServer", ntpServer);
-      preferences.putString("tzInfo", tzInfo);
-      preferences.putBool("autoSchedule", autoStartSchedule);
-      preferences.end();
-
-      Serial.println("[Config] Configuration saved");
-    } else {
-      Serial.println("[Config] Error: Could not open storage for saving");
-    }
+    // Written behind together with any other pending setting
+    Settings.setString(SETTING_WEATHER_LOCATION, weatherLocation);
+    Settings.setString(SETTING_NTP_SERVER, ntpServer);
+    Settings.setString(SETTING_TZ_INFO, tzInfo);
+    Settings.setBool(SETTING_AUTO_SCHEDULE, autoStartSchedule);
+    Settings.setInt(SETTING_PLUGIN_BUDGET, pluginBudgetMs);
+    Settings.setBool(SETTING_TLS_RESERVE, tlsReserve);
+
+    Serial.println("[Config] Configuration saved");
   } catch (...) {
     Serial.println("[Config] Error: Could not save configuration");
   }
@@ -142,6 +146,16 @@ bool Config::getAutoStartSchedule() const
   return autoStartSchedule;
 }
 
+uint16_t Config::getPluginBudgetMs() const
+{
+  return pluginBudgetMs;
+}
+
+bool Config::getTlsReserve() const
+{
+  return tlsReserve;
+}
+
 void Config::setWeatherLocation(const String& location)
 {
   if (location.length() > 0 && location.length() < 100) {
@@ -169,14 +183,29 @@ void Config::setAutoStartSchedule(bool autoStart)
   autoStartSchedule = autoStart;
 }
 
+void Config::setPluginBudgetMs(uint16_t budgetMs)
+{
+  if (budgetMs >= PLUGIN_BUDGET_MIN_MS && budgetMs <= PLUGIN_BUDGET_MAX_MS) {
+    pluginBudgetMs = budgetMs;
+  }
+}
+
+void Config::setTlsReserve(bool reserve)
+{
+  tlsReserve = reserve;
+}
+
 
 String Config::toJson() const
 {
-  JsonDocument doc;
+  JsonArena arena;
+  JsonDocument doc(&arena);
   doc["weatherLocation"] = weatherLocation;
   doc["ntpServer"] = ntpServer;
   doc["tzInfo"] = tzInfo;
   doc["autoStartSchedule"] = autoStartSchedule;
+  doc["pluginBudgetMs"] = pluginBudgetMs;
+  doc["tlsReserve"] = tlsReserve;
   
   String output;
   serializeJson(doc, output);
@@ -191,7 +220,8 @@ bool Config::fromJson(const String& json)
     return false;
   }
   
-  JsonDocument doc;
+  JsonArena arena;
+  JsonDocument doc(&arena);
   DeserializationError error = deserializeJson(doc, json);
   
   if (error) {
@@ -225,6 +255,17 @@ bool Config::fromJson(const String& json)
   if (doc["autoStartSchedule"].is<bool>()) {
     autoStartSchedule = doc["autoStartSchedule"].as<bool>();
   }
+
+  if (doc["pluginBudgetMs"].is<int>()) {
+    int budget = doc["pluginBudgetMs"].as<int>();
+    if (budget >= PLUGIN_BUDGET_MIN_MS && budget <= PLUGIN_BUDGET_MAX_MS) {
+      pluginBudgetMs = budget;
+    }
+  }
+
+  if (doc["tlsReserve"].is<bool>()) {
+    tlsReserve = doc["tlsReserve"].as<bool>();
+  }
   
   return true;
 }
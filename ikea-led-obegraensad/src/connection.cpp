@@ -0,0 +1,301 @@
+#include "connection.h"
+
+#ifdef ENABLE_SERVER
+
+#ifdef ESP8266
+/* Fix duplicate defs of HTTP_GET, HTTP_POST, ... in ESPAsyncWebServer.h */
+#define WEBSERVER_H
+#endif
+
+#include <WiFiManager.h>
+
+#ifdef ESP32
+#include <ESPmDNS.h>
+#include <WiFi.h>
+#endif
+#ifdef ESP8266
+#include <ESP8266WiFi.h>
+#endif
+
+#include "asyncwebserver.h"
+#include "bootprofile.h"
+#include "secrets.h"
+#include "settings.h"
+
+static WiFiManager wifiManager;
+
+static const char *stateNames[] = {"idle", "connecting", "connected", "waiting", "portal"};
+
+Connection_ &Connection_::getInstance()
+{
+  static Connection_ instance;
+  return instance;
+}
+
+void Connection_::begin()
+{
+  outageSince = millis();
+
+#ifdef ESP32
+  WiFi.setHostname(WIFI_HOSTNAME);
+#endif
+  WiFi.mode(WIFI_STA);
+#ifdef ESP8266
+  WiFi.hostname(WIFI_HOSTNAME);
+#endif
+
+#if defined(IP_ADDRESS) && defined(GWY) && defined(SUBNET) && defined(DNS1)
+  auto ip = IPAddress();
+  ip.fromString(IP_ADDRESS);
+
+  auto gwy = IPAddress();
+  gwy.fromString(GWY);
+
+  auto subnet = IPAddress();
+  subnet.fromString(SUBNET);
+
+  auto dns = IPAddress();
+  dns.fromString(DNS1);
+
+  WiFi.config(ip, gwy, subnet, dns);
+  wifiManager.setSTAStaticIPConfig(ip, gwy, subnet, dns);
+#endif
+
+  // Retries are ours: the driver's own reconnect would race with the backoff below
+  WiFi.setAutoReconnect(false);
+
+#ifdef ESP32
+  WiFi.onEvent([](arduino_event_id_t event, arduino_event_info_t info) {
+    switch (event)
+    {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      Connection.gotIp = true;
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      Connection.lastDisconnectReason = info.wifi_sta_disconnected.reason;
+      Connection.linkLost = true;
+      break;
+    default:
+      break;
+    }
+  });
+#endif
+
+  wifiManager.setHostname(WIFI_HOSTNAME);
+  wifiManager.setConfigPortalBlocking(false);
+  wifiManager.setConfigPortalTimeout(WIFI_PORTAL_TIMEOUT_S);
+  wifiManager.setSaveConfigCallback([]() { Connection.portalSaved = true; });
+}
+
+void Connection_::setState(ConnectionState newState)
+{
+  state = newState;
+  stateSince = millis();
+}
+
+void Connection_::startAttempt()
+{
+  gotIp = false;
+  linkLost = false;
+
+  Serial.printf("[WiFi] Connecting (backoff %lus)\n", backoff / 1000);
+  WiFi.begin();
+  setState(WIFI_STATE_CONNECTING);
+}
+
+void Connection_::scheduleRetry()
+{
+  Serial.printf("[WiFi] Not connected (reason %u), retry in %lus\n", lastDisconnectReason, backoff / 1000);
+
+  WiFi.disconnect();
+  retryAt = millis() + backoff;
+  backoff = min(backoff * 2, WIFI_MAX_BACKOFF_MS);
+  setState(WIFI_STATE_WAITING);
+}
+
+void Connection_::onConnected()
+{
+  gotIp = false;
+  linkLost = false;
+  backoff = WIFI_MIN_BACKOFF_MS;
+
+  if (everConnected)
+  {
+    reconnects++;
+    Serial.printf("[WiFi] Reconnected after %lus\n", (millis() - outageSince) / 1000);
+  }
+  else
+  {
+    everConnected = true;
+    markBootStage("wifi");
+  }
+  outageSince = 0;
+
+  Serial.print("[WiFi] IP ");
+  Serial.println(WiFi.localIP());
+
+  startMdns();
+  setState(WIFI_STATE_CONNECTED);
+}
+
+void Connection_::startMdns()
+{
+  // the responder follows the interface on its own, it only has to be started once
+  if (mdnsStarted)
+  {
+    return;
+  }
+
+#ifdef ESP32
+  if (MDNS.begin(WIFI_HOSTNAME))
+  {
+    MDNS.addService("http", "tcp", 80);
+    MDNS.setInstanceName(WIFI_HOSTNAME);
+    mdnsStarted = true;
+  }
+  else
+  {
+    Serial.println("Could not start mDNS!");
+  }
+#endif
+}
+
+void Connection_::openPortal()
+{
+  portalRequested = false;
+  portalSaved = false;
+
+  Serial.println("[WiFi] Opening setup portal " WIFI_MANAGER_SSID);
+
+  // WiFiManager brings its own server on port 80
+  server.end();
+  wifiManager.startConfigPortal(WIFI_MANAGER_SSID);
+  setState(WIFI_STATE_PORTAL);
+}
+
+void Connection_::update()
+{
+  unsigned long now = millis();
+
+#ifdef ESP8266
+  // no event handlers registered here, derive the edges from the status
+  bool connected = WiFi.status() == WL_CONNECTED;
+  if (connected && state != WIFI_STATE_CONNECTED)
+  {
+    gotIp = true;
+  }
+  else if (!connected && state == WIFI_STATE_CONNECTED)
+  {
+    linkLost = true;
+  }
+#endif
+
+  bool portalAsked = portalRequested && now - portalRequestedAt >= WIFI_PORTAL_REQUEST_DELAY_MS;
+  bool portalDue = portalAsked || (WIFI_PORTAL_AFTER_OUTAGE_MS > 0 && outageSince != 0 &&
+                                   now - outageSince >= WIFI_PORTAL_AFTER_OUTAGE_MS);
+
+  switch (state)
+  {
+  case WIFI_STATE_IDLE:
+    if (portalRequested || !wifiManager.getWiFiIsSaved())
+    {
+      openPortal();
+    }
+    else
+    {
+      startAttempt();
+    }
+    break;
+
+  case WIFI_STATE_CONNECTING:
+    if (gotIp)
+    {
+      onConnected();
+    }
+    else if (linkLost || now - stateSince >= WIFI_CONNECT_TIMEOUT_MS)
+    {
+      scheduleRetry();
+    }
+    break;
+
+  case WIFI_STATE_CONNECTED:
+    if (portalAsked)
+    {
+      openPortal();
+    }
+    else if (linkLost)
+    {
+      Serial.println("[WiFi] Connection lost");
+      outageSince = now;
+      backoff = WIFI_MIN_BACKOFF_MS;
+      scheduleRetry();
+    }
+    break;
+
+  case WIFI_STATE_WAITING:
+    if (portalDue)
+    {
+      openPortal();
+    }
+    else if ((long)(now - retryAt) >= 0)
+    {
+      startAttempt();
+    }
+    break;
+
+  case WIFI_STATE_PORTAL:
+    wifiManager.process();
+
+    if (portalSaved)
+    {
+      // Reboot required, otherwise the portal's routes and server interfere with ours
+      Serial.println("Done running WiFi Manager webserver - rebooting");
+      Settings.flush();
+      ESP.restart();
+    }
+    else if (!wifiManager.getConfigPortalActive())
+    {
+      Serial.println("[WiFi] Portal closed, back to retrying");
+      server.begin();
+      WiFi.mode(WIFI_STA);
+      outageSince = WiFi.status() == WL_CONNECTED ? 0 : now;
+      backoff = WIFI_MIN_BACKOFF_MS;
+      retryAt = now;
+      setState(WIFI_STATE_WAITING);
+    }
+    break;
+  }
+}
+
+void Connection_::requestPortal()
+{
+  portalRequestedAt = millis();
+  portalRequested = true;
+}
+
+bool Connection_::isConnected() const
+{
+  return state == WIFI_STATE_CONNECTED;
+}
+
+ConnectionState Connection_::getState() const
+{
+  return state;
+}
+
+const char *Connection_::getStateName() const
+{
+  return stateNames[state];
+}
+
+void Connection_::toJson(JsonObject object) const
+{
+  object["state"] = getStateName();
+  object["reconnects"] = reconnects;
+  object["lastDisconnectReason"] = lastDisconnectReason;
+  object["outageMs"] = outageSince ? millis() - outageSince : 0;
+}
+
+Connection_ &Connection = Connection.getInstance();
+
+#endif
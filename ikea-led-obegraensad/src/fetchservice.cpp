@@ -0,0 +1,472 @@
+#include "fetchservice.h"
+
+#ifdef ENABLE_SERVER
+
+#include <ArduinoJson.h>
+
+#include "arena.h"
+#include "jsonstream.h"
+
+#ifdef ESP32
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#endif
+#ifdef ESP8266
+#include <ESP8266HTTPClient.h>
+#include <ESP8266WiFi.h>
+#include <WiFiClient.h>
+#endif
+
+static uint32_t hashUrl(const char *url)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  while (*url)
+  {
+    hash ^= (uint8_t)*url++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Only the fields the plugins use are kept; everything else is skipped while streaming.
+// Built once on first use, fetches only ever run on the fetch task.
+static const JsonDocument &getFilter(FetchKind kind)
+{
+  static JsonDocument filters[3];
+  static bool built = false;
+
+  if (!built)
+  {
+    JsonObject current = filters[FETCH_OPEN_METEO_CURRENT]["current"].to<JsonObject>();
+    current["temperature_2m"] = true;
+    current["weather_code"] = true;
+    current["is_day"] = true;
+
+    JsonObject daily = filters[FETCH_OPEN_METEO_DAILY]["daily"].to<JsonObject>();
+    daily["temperature_2m_max"] = true;
+    daily["temperature_2m_min"] = true;
+    daily["weather_code"] = true;
+
+    // the filter's first array element applies to every element
+    JsonObject condition = filters[FETCH_WTTR_CURRENT]["current_condition"][0].to<JsonObject>();
+    condition["temp_C"] = true;
+    condition["weatherCode"] = true;
+
+    built = true;
+  }
+
+  return filters[kind];
+}
+
+FetchService_ &FetchService_::getInstance()
+{
+  static FetchService_ instance;
+  return instance;
+}
+
+void FetchService_::begin()
+{
+#ifdef ESP32
+  if (!mutex)
+  {
+    mutex = xSemaphoreCreateMutex();
+  }
+#endif
+
+  // Settings already holds the blobs in RAM, copying them here keeps NVS off the render task
+  for (uint8_t slot = 0; slot < FETCH_PERSIST_SLOTS; slot++)
+  {
+    StoredValue &value = stored[slot];
+    if (Settings.getBlob((SettingId)(SETTING_FETCH_SLOT_0 + slot), &value, sizeof(value)) !=
+        sizeof(value))
+    {
+      value = StoredValue();
+    }
+    storedSequence = max(storedSequence, value.sequence);
+  }
+
+#ifdef ESP32
+
+  // Taken while the heap is still in one piece if the config asks for it, the first handshake
+  // gets it back
+  TlsReserve.reserve();
+
+  if (!taskHandle)
+  {
+    // Core 1 next to the network stack, below the Arduino loop so it never delays input handling
+    xTaskCreatePinnedToCore(task, "fetchTask", 8192, NULL, 0, &taskHandle, 1);
+  }
+#endif
+}
+
+#ifdef ESP32
+void FetchService_::task(void *parameter)
+{
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(5000));
+    FetchService.processPending();
+  }
+}
+#endif
+
+void FetchService_::lock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+  }
+#endif
+}
+
+void FetchService_::unlock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreGive(mutex);
+  }
+#endif
+}
+
+FetchService_::Entry *FetchService_::findOrCreate(uint32_t key,
+                                                  FetchKind kind,
+                                                  const char *url,
+                                                  unsigned long ttl)
+{
+  Entry *victim = nullptr;
+
+  for (Entry &entry : entries)
+  {
+    if (entry.used && entry.key == key)
+    {
+      return &entry;
+    }
+
+    // least recently used entry that is not being fetched right now
+    if (!entry.inFlight && (!victim || !entry.used || (victim->used && entry.lastUsed < victim->lastUsed)))
+    {
+      if (!victim || victim->used)
+      {
+        victim = &entry;
+      }
+    }
+  }
+
+  if (!victim || strlen(url) >= MAX_URL_LENGTH)
+  {
+    return nullptr;
+  }
+
+  *victim = Entry();
+  victim->used = true;
+  victim->key = key;
+  victim->kind = kind;
+  victim->ttl = ttl;
+  strncpy(victim->url, url, MAX_URL_LENGTH - 1);
+  victim->refreshAt = millis();
+  restore(*victim);
+
+  return victim;
+}
+
+FetchStatus FetchService_::get(FetchKind kind, const char *url, unsigned long ttlMs, WeatherData &out)
+{
+  FetchStatus status;
+  const uint32_t key = hashUrl(url);
+  const unsigned long now = millis();
+  bool wake = false;
+
+  lock();
+  Entry *entry = findOrCreate(key, kind, url, ttlMs);
+  if (entry)
+  {
+    entry->lastUsed = now;
+    entry->ttl = ttlMs;
+
+    if (!entry->queued && !entry->inFlight && (long)(now - entry->refreshAt) >= 0)
+    {
+      entry->queued = true;
+      wake = true;
+    }
+
+    if (entry->hasData)
+    {
+      out = entry->data;
+    }
+    status.hasData = entry->hasData;
+    status.pending = entry->queued || entry->inFlight;
+    status.lastHttpCode = entry->lastHttpCode;
+  }
+  unlock();
+
+#ifdef ESP32
+  if (wake && taskHandle)
+  {
+    xTaskNotifyGive(taskHandle);
+  }
+#endif
+
+  return status;
+}
+
+void FetchService_::processPending()
+{
+  // Requests stay queued until WiFi is up, so a boot without network does not start the backoff
+  if (WiFi.status() != WL_CONNECTED)
+  {
+    return;
+  }
+
+  for (;;)
+  {
+    uint32_t key = 0;
+    Entry job;
+
+    lock();
+    for (Entry &entry : entries)
+    {
+      if (entry.used && entry.queued && !entry.inFlight)
+      {
+        entry.queued = false;
+        entry.inFlight = true;
+        job = entry;
+        key = entry.key;
+        break;
+      }
+    }
+    unlock();
+
+    if (!key)
+    {
+      return;
+    }
+
+    WeatherData data;
+    int httpCode = 0;
+    bool ok = fetch(job, data, httpCode);
+
+    requests++;
+    if (!ok)
+    {
+      failures++;
+    }
+
+    lock();
+    for (Entry &entry : entries)
+    {
+      if (!entry.used || entry.key != key)
+      {
+        continue;
+      }
+
+      entry.inFlight = false;
+      entry.lastHttpCode = httpCode;
+
+      if (ok)
+      {
+        entry.data = data;
+        entry.hasData = true;
+        entry.failures = 0;
+        entry.refreshAt = millis() + entry.ttl;
+        persist(entry);
+      }
+      else
+      {
+        // 30 s, 1 min, 2 min, ... capped at 30 min
+        entry.failures = min<uint8_t>(entry.failures + 1, 16);
+        unsigned long backoff = MIN_BACKOFF_MS << min<uint8_t>(entry.failures - 1, 6);
+        entry.refreshAt = millis() + min(backoff, MAX_BACKOFF_MS);
+      }
+      break;
+    }
+    unlock();
+  }
+}
+
+bool FetchService_::fetch(Entry &entry, WeatherData &data, int &httpCode)
+{
+  if (WiFi.status() != WL_CONNECTED)
+  {
+    httpCode = -100;
+    return false;
+  }
+
+#ifdef ESP32
+  Serial.printf("[Fetch] GET %s (heap free=%u maxAlloc=%u)\n",
+                entry.url,
+                ESP.getFreeHeap(),
+                ESP.getMaxAllocHeap());
+
+  // One long-lived TLS client for the whole firmware: the ~40 KB of mbedTLS buffers are
+  // allocated once instead of per request, and keep-alive skips the handshake for
+  // consecutive requests to the same host
+  static WiFiClientSecure secureClient;
+  static WiFiClient plainClient;
+  static bool secureClientReady = false;
+  if (!secureClientReady)
+  {
+    secureClient.setInsecure();
+    secureClientReady = true;
+  }
+
+  bool secure = strncmp(entry.url, "https://", 8) == 0;
+  HTTPClient http;
+  http.setReuse(true);
+  if (secure)
+  {
+    if (!secureClient.connected())
+    {
+      // A new handshake follows: let mbedTLS allocate into the reserved block
+      TlsReserve.release();
+    }
+    http.begin(secureClient, entry.url);
+  }
+  else
+  {
+    http.begin(plainClient, entry.url);
+  }
+#endif
+#ifdef ESP8266
+  Serial.printf("[Fetch] GET %s\n", entry.url);
+  static WiFiClient plainClient;
+  HTTPClient http;
+  http.begin(plainClient, entry.url);
+#endif
+
+  const char *collect[] = {"Transfer-Encoding"};
+  http.collectHeaders(collect, 1);
+  http.setConnectTimeout(5000);
+  http.setTimeout(10000);
+  httpCode = http.GET();
+
+  if (httpCode != HTTP_CODE_OK)
+  {
+    Serial.printf("[Fetch] HTTP FAILED: %d (%s)\n", httpCode, http.errorToString(httpCode).c_str());
+    http.end();
+#ifdef ESP32
+    if (!secureClient.connected())
+    {
+      TlsReserve.reserve();
+    }
+#endif
+    return false;
+  }
+
+  // Parse straight from the socket: nothing but the filtered fields is ever held in RAM
+  bool chunked = http.header("Transfer-Encoding").equalsIgnoreCase("chunked");
+  HttpBodyStream body(http.getStream(), chunked, http.getSize());
+  CappedAllocator allocator(MAX_JSON_BYTES);
+  JsonDocument doc(&allocator);
+
+  DeserializationError err = deserializeJson(doc, body, DeserializationOption::Filter(getFilter(entry.kind)));
+  body.drain();
+  http.end();
+#ifdef ESP32
+  // Kept open for keep-alive holds its buffers, a closed one handed them back
+  if (!secureClient.connected())
+  {
+    TlsReserve.reserve();
+  }
+#endif
+
+  peakJsonBytes = max<uint32_t>(peakJsonBytes, allocator.getPeak());
+
+  if (err)
+  {
+    Serial.printf("[Fetch] JSON parse error: %s\n", err.c_str());
+    httpCode = -200;
+    return false;
+  }
+
+  switch (entry.kind)
+  {
+  case FETCH_OPEN_METEO_CURRENT:
+    data.temperature = doc["current"]["temperature_2m"] | -99.0f;
+    data.code = doc["current"]["weather_code"] | 0;
+    data.isDay = (doc["current"]["is_day"] | 1) != 0;
+    break;
+
+  case FETCH_OPEN_METEO_DAILY:
+    // Index 1 = tomorrow
+    data.temperatureMax = doc["daily"]["temperature_2m_max"][1] | -99.0f;
+    data.temperatureMin = doc["daily"]["temperature_2m_min"][1] | -99.0f;
+    data.code = doc["daily"]["weather_code"][1] | 0;
+    break;
+
+  case FETCH_WTTR_CURRENT:
+    data.temperature = doc["current_condition"][0]["temp_C"].as<float>();
+    data.code = doc["current_condition"][0]["weatherCode"].as<int>();
+    break;
+  }
+
+  return true;
+}
+
+void FetchService_::restore(Entry &entry)
+{
+  for (const StoredValue &value : stored)
+  {
+    if (value.key != entry.key)
+    {
+      continue;
+    }
+
+    entry.data = value.data;
+    entry.hasData = true;
+    entry.lastHttpCode = HTTP_CODE_OK;
+
+    // Show the stored value right away and refresh it a little later, spread out so a fleet
+    // coming back from a power cut does not hit the API at the same second
+    entry.refreshAt = millis() + random(60000, 300000);
+    return;
+  }
+}
+
+void FetchService_::persist(const Entry &entry)
+{
+  // the slot of this URL, otherwise an empty one, otherwise the one refreshed longest ago
+  uint8_t target = 0;
+  for (uint8_t slot = 0; slot < FETCH_PERSIST_SLOTS; slot++)
+  {
+    if (stored[slot].key == entry.key)
+    {
+      target = slot;
+      break;
+    }
+    if (stored[target].key && (!stored[slot].key || stored[slot].sequence < stored[target].sequence))
+    {
+      target = slot;
+    }
+  }
+
+  StoredValue &value = stored[target];
+  value.key = entry.key;
+  value.sequence = ++storedSequence;
+  value.data = entry.data;
+
+  // write-behind: the settings task commits it together with whatever else changed
+  Settings.setBlob((SettingId)(SETTING_FETCH_SLOT_0 + target), &value, sizeof(value));
+}
+
+uint32_t FetchService_::getRequestCount() const
+{
+  return requests;
+}
+
+uint32_t FetchService_::getFailureCount() const
+{
+  return failures;
+}
+
+uint32_t FetchService_::getPeakJsonBytes() const
+{
+  return peakJsonBytes;
+}
+
+FetchService_ &FetchService = FetchService.getInstance();
+
+#endif
@@ -0,0 +1,473 @@
+#include "framerecorder.h"
+
+FrameRecorder_::FrameRecorder_()
+{
+#ifdef ESP32
+  mutex = xSemaphoreCreateMutex();
+#endif
+}
+
+FrameRecorder_ &FrameRecorder_::getInstance()
+{
+  static FrameRecorder_ instance;
+  return instance;
+}
+
+void FrameRecorder_::lock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+  }
+#endif
+}
+
+void FrameRecorder_::unlock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreGive(mutex);
+  }
+#endif
+}
+
+uint8_t FrameRecorder_::readByte(size_t offset) const
+{
+  return ring[(head + offset) % RECORDER_BYTES];
+}
+
+uint32_t FrameRecorder_::readVarint(size_t &offset) const
+{
+  uint32_t value = 0;
+  for (uint8_t shift = 0; shift < 32; shift += 7)
+  {
+    uint8_t byte = readByte(offset++);
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+    {
+      break;
+    }
+  }
+  return value;
+}
+
+size_t FrameRecorder_::applyRecord(size_t offset, uint8_t *pixels, uint32_t &elapsed) const
+{
+  uint32_t header = readVarint(offset);
+  bool toggle = header & 1;
+  elapsed = header >> 1;
+
+  size_t pixel = 0;
+  while (pixel < TOTAL_PIXELS)
+  {
+    pixel += readByte(offset++);
+    uint8_t count = readByte(offset++);
+    for (uint8_t i = 0; i < count && pixel < TOTAL_PIXELS; i++, pixel++)
+    {
+      pixels[pixel] = toggle ? MAX_BRIGHTNESS - pixels[pixel] : readByte(offset++);
+    }
+  }
+  return offset;
+}
+
+size_t FrameRecorder_::encode(const uint8_t *frame, uint32_t elapsed, uint8_t *out) const
+{
+  // on/off content, the bulk of the plugins, only needs the positions of the changes
+  bool toggle = true;
+  for (size_t i = 0; i < TOTAL_PIXELS && toggle; i++)
+  {
+    if (frame[i] != last[i])
+    {
+      toggle = (frame[i] == 0 || frame[i] == MAX_BRIGHTNESS) &&
+               (last[i] == 0 || last[i] == MAX_BRIGHTNESS);
+    }
+  }
+
+  size_t length = 0;
+  uint32_t header = (min<uint32_t>(elapsed, 0x7FFFFFFF) << 1) | toggle;
+  do
+  {
+    out[length++] = (header & 0x7F) | (header > 0x7F ? 0x80 : 0);
+    header >>= 7;
+  } while (header);
+
+  size_t pixel = 0;
+  while (pixel < TOTAL_PIXELS)
+  {
+    uint8_t skip = 0;
+    while (pixel < TOTAL_PIXELS && frame[pixel] == last[pixel] && skip < 255)
+    {
+      skip++;
+      pixel++;
+    }
+    size_t start = pixel;
+    uint8_t count = 0;
+    while (pixel < TOTAL_PIXELS && frame[pixel] != last[pixel] && count < 255)
+    {
+      count++;
+      pixel++;
+    }
+
+    out[length++] = skip;
+    out[length++] = count;
+    if (!toggle)
+    {
+      memcpy(out + length, frame + start, count);
+      length += count;
+    }
+  }
+  return length;
+}
+
+void FrameRecorder_::dropOldest()
+{
+  uint32_t elapsed;
+  size_t length = applyRecord(0, base, elapsed);
+  baseAt += elapsed;
+  head = (head + length) % RECORDER_BYTES;
+  used -= length;
+  frames--;
+}
+
+void FrameRecorder_::append(const uint8_t *record, size_t length)
+{
+  while (used + length > RECORDER_BYTES)
+  {
+    dropOldest();
+  }
+
+  size_t tail = (head + used) % RECORDER_BYTES;
+  size_t first = min(length, RECORDER_BYTES - tail);
+  memcpy(ring + tail, record, first);
+  memcpy(ring, record + first, length - first);
+  used += length;
+  frames++;
+}
+
+void FrameRecorder_::capture(const uint8_t *frame)
+{
+  unsigned long now = millis();
+  if ((started && now - lastCapture < RECORDER_MIN_FRAME_MS) || exporting)
+  {
+    return;
+  }
+  lastCapture = now;
+  uint32_t begin = micros();
+
+  if (!started)
+  {
+    lock();
+    memcpy(base, frame, TOTAL_PIXELS);
+    baseAt = now;
+    unlock();
+    memcpy(last, frame, TOTAL_PIXELS);
+    lastAt = now;
+    startedAt = now;
+    started = true;
+    return;
+  }
+
+  bool changed = memcmp(frame, last, TOTAL_PIXELS) != 0;
+  uint8_t record[RECORDER_MAX_RECORD];
+  size_t length = changed ? encode(frame, now - lastAt, record) : 0;
+
+  lock();
+  // a download may have started since the check above
+  bool stored = !exporting;
+  if (stored)
+  {
+    if (changed)
+    {
+      append(record, length);
+    }
+    while (frames > 0)
+    {
+      size_t offset = 0;
+      unsigned long oldestAt = baseAt + (readVarint(offset) >> 1);
+      if (now - oldestAt <= RECORDER_SECONDS * 1000)
+      {
+        break;
+      }
+      dropOldest();
+    }
+  }
+  unlock();
+
+  if (stored && changed)
+  {
+    memcpy(last, frame, TOTAL_PIXELS);
+    lastAt = now;
+  }
+  busyMicros += micros() - begin;
+}
+
+bool FrameRecorder_::beginExport()
+{
+  lock();
+  bool available = !exporting;
+  exporting = true;
+  unlock();
+  return available;
+}
+
+void FrameRecorder_::endExport()
+{
+  exporting = false;
+}
+
+void FrameRecorder_::toJson(JsonObject object) const
+{
+  unsigned long now = millis();
+  object["seconds"] = started ? (now - baseAt) / 1000 : 0;
+  object["frames"] = frames;
+  object["bytes"] = used;
+  object["capacity"] = RECORDER_BYTES;
+  object["exporting"] = exporting;
+  // share of the time since recording started spent in capture()
+  uint64_t runningMicros = (uint64_t)(now - startedAt) * 1000;
+  object["cpuPercent"] = runningMicros ? busyMicros * 100.0 / runningMicros : 0.0;
+}
+
+FrameRecorder_ &FrameRecorder = FrameRecorder.getInstance();
+
+static void putLE(uint8_t *out, size_t &position, uint32_t value, uint8_t bytes)
+{
+  for (uint8_t i = 0; i < bytes; i++)
+  {
+    out[position++] = value >> (8 * i);
+  }
+}
+
+FrameCapture::FrameCapture(Format format)
+    : format(format), open(FrameRecorder.beginExport()), exportAt(millis())
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+  if (open)
+  {
+    FrameRecorder.endExport();
+  }
+}
+
+bool FrameCapture::isOpen() const
+{
+  return open;
+}
+
+size_t FrameCapture::read(uint8_t *buffer, size_t maxLen)
+{
+  size_t written = 0;
+  while (open && written < maxLen)
+  {
+    if (stagedPosition == stagedLength && !stageNext())
+    {
+      break;
+    }
+    size_t length = min(maxLen - written, stagedLength - stagedPosition);
+    memcpy(buffer + written, staged + stagedPosition, length);
+    written += length;
+    stagedPosition += length;
+  }
+  return written;
+}
+
+bool FrameCapture::stageNext()
+{
+  const FrameRecorder_ &recorder = FrameRecorder;
+  stagedLength = 0;
+  stagedPosition = 0;
+
+  switch (stage)
+  {
+  case HEADER:
+    if (format == GIF)
+    {
+      stageGifHeader();
+      memcpy(current, recorder.base, TOTAL_PIXELS);
+      currentAt = recorder.baseAt;
+      remaining = recorder.frames;
+      stage = FRAMES;
+      return true;
+    }
+    memcpy(staged, "OBRC", 4);
+    stagedLength = 4;
+    staged[stagedLength++] = RECORDER_VERSION;
+    staged[stagedLength++] = COLS;
+    staged[stagedLength++] = ROWS;
+    staged[stagedLength++] = 0;
+    putLE(staged, stagedLength, recorder.baseAt, 4);
+    putLE(staged, stagedLength, exportAt, 4);
+    putLE(staged, stagedLength, recorder.frames, 4);
+    putLE(staged, stagedLength, recorder.used, 4);
+    remaining = recorder.used;
+    stage = BASE;
+    return true;
+
+  case BASE:
+    memcpy(staged, recorder.base, TOTAL_PIXELS);
+    stagedLength = TOTAL_PIXELS;
+    stage = RECORDS;
+    return true;
+
+  case RECORDS:
+    if (remaining == 0)
+    {
+      stage = DONE;
+      return false;
+    }
+    stagedLength = min<size_t>(remaining, sizeof(staged));
+    for (size_t i = 0; i < stagedLength; i++)
+    {
+      staged[i] = recorder.readByte(offset + i);
+    }
+    offset += stagedLength;
+    remaining -= stagedLength;
+    return true;
+
+  case FRAMES:
+    if (remaining > 0)
+    {
+      // a GIF frame carries how long it stays, which is the gap to the next record
+      size_t peek = offset;
+      stageGifFrame(recorder.readVarint(peek) >> 1);
+      uint32_t elapsed;
+      offset = recorder.applyRecord(offset, current, elapsed);
+      currentAt += elapsed;
+      remaining--;
+      return true;
+    }
+    stageGifFrame(max<unsigned long>(exportAt - currentAt, RECORDER_MIN_FRAME_MS));
+    stage = TRAILER;
+    return true;
+
+  case TRAILER:
+    staged[stagedLength++] = 0x3B;
+    stage = DONE;
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+void FrameCapture::stageGifHeader()
+{
+  static const uint8_t screen[] = {'G', 'I', 'F', '8', '9', 'a', COLS, 0, ROWS, 0,
+                                   // global color table of 256 entries, background 0
+                                   0xF7, 0, 0};
+  memcpy(staged, screen, sizeof(screen));
+  stagedLength = sizeof(screen);
+
+  // the pixel values are brightness levels, shown as greys
+  for (uint16_t level = 0; level < 256; level++)
+  {
+    staged[stagedLength++] = level;
+    staged[stagedLength++] = level;
+    staged[stagedLength++] = level;
+  }
+
+  static const uint8_t loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P',
+                                 'E',  '2',  '.',  '0', 0x03, 0x01, 0, 0, 0};
+  memcpy(staged + stagedLength, loop, sizeof(loop));
+  stagedLength += sizeof(loop);
+}
+
+void FrameCapture::stageGifFrame(uint32_t durationMs)
+{
+  // only the rectangle that changed since the previous GIF frame, the rest stays in place
+  uint8_t left = COLS, top = ROWS, right = 0, bottom = 0;
+  for (uint8_t y = 0; y < ROWS; y++)
+  {
+    for (uint8_t x = 0; x < COLS; x++)
+    {
+      if (first || current[y * COLS + x] != shown[y * COLS + x])
+      {
+        left = min(left, x);
+        top = min(top, y);
+        right = max<uint8_t>(right, x + 1);
+        bottom = max<uint8_t>(bottom, y + 1);
+      }
+    }
+  }
+  if (right == 0)
+  {
+    left = top = 0;
+    right = bottom = 1;
+  }
+
+  // delays are in centiseconds, the rounding error moves on to the next frame
+  uint32_t total = durationMs + delayCarry;
+  uint32_t delay = min<uint32_t>(total / 10, 0xFFFF);
+  delayCarry = delay == 0xFFFF ? 0 : total % 10;
+
+  size_t &length = stagedLength;
+  const uint8_t control[] = {0x21, 0xF9, 0x04, 0x04, (uint8_t)delay, (uint8_t)(delay >> 8), 0, 0};
+  memcpy(staged + length, control, sizeof(control));
+  length += sizeof(control);
+
+  staged[length++] = 0x2C;
+  putLE(staged, length, left, 2);
+  putLE(staged, length, top, 2);
+  putLE(staged, length, right - left, 2);
+  putLE(staged, length, bottom - top, 2);
+  staged[length++] = 0;
+
+  // Uncompressed LZW: 9 bit literals with a clear code before the decoder's dictionary would
+  // grow to 10 bits. Real compression would need a dictionary of several KB for frames that
+  // are at most 256 pixels, and usually only a small changed rectangle.
+  constexpr uint16_t CLEAR = 256;
+  constexpr uint16_t END = 257;
+  constexpr uint8_t LITERALS_PER_CLEAR = 254;
+  staged[length++] = 8;
+  size_t block = length++;
+  uint32_t bits = 0;
+  uint8_t bitCount = 0;
+  auto put = [&](uint16_t code) {
+    bits |= (uint32_t)code << bitCount;
+    bitCount += 9;
+    while (bitCount >= 8)
+    {
+      staged[length++] = bits;
+      bits >>= 8;
+      bitCount -= 8;
+      if (length - block - 1 == 255)
+      {
+        staged[block] = 255;
+        block = length++;
+      }
+    }
+  };
+
+  uint8_t literals = LITERALS_PER_CLEAR;
+  for (uint8_t y = top; y < bottom; y++)
+  {
+    for (uint8_t x = left; x < right; x++)
+    {
+      if (literals == LITERALS_PER_CLEAR)
+      {
+        put(CLEAR);
+        literals = 0;
+      }
+      put(current[y * COLS + x]);
+      literals++;
+    }
+  }
+  put(END);
+  if (bitCount > 0)
+  {
+    staged[length++] = bits;
+  }
+  staged[block] = length - block - 1;
+  if (staged[block] > 0)
+  {
+    // terminator, unless the last block came out empty and already is one
+    staged[length++] = 0;
+  }
+
+  memcpy(shown, current, TOTAL_PIXELS);
+  first = false;
+}
@@ -0,0 +1,81 @@
+#include "heapstats.h"
+
+HeapStats_ &HeapStats_::getInstance()
+{
+  static HeapStats_ instance;
+  return instance;
+}
+
+HeapStats_::Sample HeapStats_::sample() const
+{
+#ifdef ESP32
+  return {ESP.getFreeHeap(), ESP.getMaxAllocHeap()};
+#else
+  return {ESP.getFreeHeap(), ESP.getMaxFreeBlockSize()};
+#endif
+}
+
+void HeapStats_::update()
+{
+  unsigned long now = millis();
+  if (lastSample != 0 && now - lastSample < HEAP_SAMPLE_MS)
+  {
+    return;
+  }
+  lastSample = now;
+
+  Sample current = sample();
+  interval.free = min(interval.free, current.free);
+  interval.maxBlock = min(interval.maxBlock, current.maxBlock);
+  if (current.maxBlock < lowestMaxBlock)
+  {
+    lowestMaxBlock = current.maxBlock;
+    lowestMaxBlockAt = now;
+  }
+
+  if (now - intervalStart >= HEAP_HISTORY_INTERVAL_MS)
+  {
+    history[historyNext] = interval;
+    historyNext = (historyNext + 1) % HEAP_HISTORY_LENGTH;
+    if (historyCount < HEAP_HISTORY_LENGTH)
+    {
+      historyCount++;
+    }
+    interval = {UINT32_MAX, UINT32_MAX};
+    intervalStart = now;
+  }
+}
+
+void HeapStats_::summaryToJson(JsonObject object) const
+{
+  Sample current = sample();
+  object["free"] = current.free;
+  object["maxBlock"] = current.maxBlock;
+  object["fragmentation"] = current.free ? 100 - current.maxBlock * 100 / current.free : 0;
+}
+
+void HeapStats_::toJson(JsonObject object) const
+{
+  summaryToJson(object);
+#ifdef ESP32
+  object["minFree"] = ESP.getMinFreeHeap();
+#endif
+  if (lowestMaxBlock != UINT32_MAX)
+  {
+    object["lowestMaxBlock"] = lowestMaxBlock;
+    object["lowestMaxBlockUptime"] = lowestMaxBlockAt / 1000;
+  }
+
+  object["intervalSeconds"] = HEAP_HISTORY_INTERVAL_MS / 1000;
+  JsonArray array = object["history"].to<JsonArray>();
+  for (uint8_t i = 0; i < historyCount; i++)
+  {
+    const Sample &entry =
+        history[(historyNext + HEAP_HISTORY_LENGTH - historyCount + i) % HEAP_HISTORY_LENGTH];
+    JsonObject item = array.add<JsonObject>();
+    item["free"] = entry.free;
+    item["maxBlock"] = entry.maxBlock;
+  }
+}
+
+HeapStats_ &HeapStats = HeapStats.getInstance();
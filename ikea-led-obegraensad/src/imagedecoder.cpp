@@ -0,0 +1,1522 @@
+#include "imagedecoder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t LENGTH_BASES[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,
+                                          15, 17, 19, 23, 27, 31, 35, 43, 51,  59,
+                                          67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_BITS[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASES[30] = {1,    2,    3,    4,    5,    7,     9,     13,
+                                            17,   25,   33,   49,   65,   97,    129,   193,
+                                            257,  385,  513,  769,  1025, 1537,  2049,  3073,
+                                            4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_BITS[30] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,  4,  4,  5,  5,  6,
+                                          6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                              11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+// Adam7 passes; a non-interlaced image is pass 7, the whole image
+static const uint8_t PASS_X[8] = {0, 4, 0, 2, 0, 1, 0, 0};
+static const uint8_t PASS_Y[8] = {0, 0, 4, 0, 2, 0, 1, 0};
+static const uint8_t PASS_STEP_X[8] = {8, 8, 4, 4, 2, 2, 1, 1};
+static const uint8_t PASS_STEP_Y[8] = {8, 8, 8, 4, 4, 2, 2, 1};
+
+// GIF interlacing: rows 0, 8, 16, ... then 4, 12, ... then 2, 6, ... then 1, 3, ...
+static const uint8_t GIF_PASS_START[4] = {0, 4, 2, 1};
+static const uint8_t GIF_PASS_STEP[4] = {8, 8, 4, 2};
+
+static const uint8_t BAYER[16] = {0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5};
+
+constexpr uint16_t LZW_CODES = 4096;
+
+static inline uint8_t luma(uint8_t r, uint8_t g, uint8_t b)
+{
+  return (77 * r + 150 * g + 29 * b) >> 8;
+}
+
+static inline uint32_t readBigEndian(const uint8_t *p)
+{
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | p[2] << 8 | p[3];
+}
+
+// Length of the overlap of [start, end) and [cellStart, cellEnd)
+static inline uint32_t overlap(uint32_t start, uint32_t end, uint32_t cellStart, uint32_t cellEnd)
+{
+  uint32_t low = start > cellStart ? start : cellStart;
+  uint32_t high = end < cellEnd ? end : cellEnd;
+  return high > low ? high - low : 0;
+}
+
+void ditherImage(const uint8_t *in, uint8_t *out, uint16_t levels, ImageDither mode)
+{
+  if (levels >= 256 || levels < 2)
+  {
+    memcpy(out, in, IMAGE_SIZE * IMAGE_SIZE);
+    return;
+  }
+
+  int32_t top = levels - 1;
+  int16_t errors[2][IMAGE_SIZE + 2] = {{0}};
+
+  for (uint8_t y = 0; y < IMAGE_SIZE; y++)
+  {
+    for (uint8_t x = 0; x < IMAGE_SIZE; x++)
+    {
+      uint16_t i = y * IMAGE_SIZE + x;
+      int32_t value = in[i];
+      int32_t level;
+
+      if (mode == DITHER_ORDERED)
+      {
+        // nearest level after shifting by the threshold map, (t + 0.5) / 16 of a step
+        uint8_t t = BAYER[(y & 3) * 4 + (x & 3)];
+        level = (value * top * 32 + (2 * t + 1) * 255) / (255 * 32);
+      }
+      else
+      {
+        if (mode == DITHER_DIFFUSION)
+        {
+          value += errors[0][x + 1];
+          value = value < 0 ? 0 : (value > 255 ? 255 : value);
+        }
+        level = (value * top + 127) / 255;
+      }
+
+      level = level > top ? top : level;
+      out[i] = level * 255 / top;
+
+      if (mode == DITHER_DIFFUSION)
+      {
+        int32_t error = value - out[i];
+        errors[0][x + 2] += error * 7 / 16;
+        errors[1][x] += error * 3 / 16;
+        errors[1][x + 1] += error * 5 / 16;
+        errors[1][x + 2] += error / 16;
+      }
+    }
+
+    memcpy(errors[0], errors[1], sizeof(errors[0]));
+    memset(errors[1], 0, sizeof(errors[1]));
+  }
+}
+
+void ImageScaler::begin(uint16_t canvasWidth, uint16_t canvasHeight)
+{
+  width = canvasWidth;
+  height = canvasHeight;
+  rowOpen = false;
+  memset(canvas, 0, sizeof(canvas));
+}
+
+void ImageScaler::beginFrame()
+{
+  memset(sum, 0, sizeof(sum));
+  memset(cover, 0, sizeof(cover));
+  rowOpen = false;
+}
+
+void ImageScaler::beginRow(uint16_t y)
+{
+  endRow();
+  row = y;
+  rowOpen = y < height;
+  memset(rowSum, 0, sizeof(rowSum));
+  memset(rowCover, 0, sizeof(rowCover));
+}
+
+void ImageScaler::addPixel(uint16_t x, uint8_t grey, uint8_t alpha)
+{
+  if (!rowOpen || !alpha || x >= width)
+  {
+    return;
+  }
+
+  // the pixel spans [16x, 16x + 16), cell c spans [c * width, (c + 1) * width)
+  uint32_t start = (uint32_t)x * IMAGE_SIZE;
+  uint32_t end = start + IMAGE_SIZE;
+  uint8_t cell = start / width;
+  while (start < end)
+  {
+    uint32_t cellEnd = (uint32_t)(cell + 1) * width;
+    uint32_t stop = end < cellEnd ? end : cellEnd;
+    uint32_t weight = (stop - start) * alpha;
+    rowSum[cell] += (uint64_t)weight * grey;
+    rowCover[cell] += weight;
+    start = stop;
+    cell++;
+  }
+}
+
+void ImageScaler::addPixels(uint16_t x, uint16_t count, uint8_t grey)
+{
+  if (!rowOpen || x >= width)
+  {
+    return;
+  }
+
+  uint32_t start = (uint32_t)x * IMAGE_SIZE;
+  uint32_t end = (x + count < width ? x + count : width) * (uint32_t)IMAGE_SIZE;
+  uint8_t cell = start / width;
+  while (start < end)
+  {
+    uint32_t cellEnd = (uint32_t)(cell + 1) * width;
+    uint32_t stop = end < cellEnd ? end : cellEnd;
+    uint32_t weight = (stop - start) * 255;
+    rowSum[cell] += (uint64_t)weight * grey;
+    rowCover[cell] += weight;
+    start = stop;
+    cell++;
+  }
+}
+
+void ImageScaler::endRow()
+{
+  if (!rowOpen)
+  {
+    return;
+  }
+  rowOpen = false;
+
+  uint32_t start = (uint32_t)row * IMAGE_SIZE;
+  uint32_t end = start + IMAGE_SIZE;
+  uint8_t cell = start / height;
+  while (start < end)
+  {
+    uint32_t cellEnd = (uint32_t)(cell + 1) * height;
+    uint32_t stop = end < cellEnd ? end : cellEnd;
+    uint32_t weight = stop - start;
+    for (uint8_t x = 0; x < IMAGE_SIZE; x++)
+    {
+      sum[cell * IMAGE_SIZE + x] += rowSum[x] * weight;
+      cover[cell * IMAGE_SIZE + x] += (uint64_t)rowCover[x] * weight;
+    }
+    start = stop;
+    cell++;
+  }
+}
+
+void ImageScaler::endFrame()
+{
+  endRow();
+
+  uint64_t area = (uint64_t)width * height * 255;
+  for (uint16_t i = 0; i < IMAGE_SIZE * IMAGE_SIZE; i++)
+  {
+    if (!cover[i])
+    {
+      continue;
+    }
+    uint64_t covered = cover[i] < area ? cover[i] : area;
+    canvas[i] = (sum[i] + canvas[i] * (area - covered) + area / 2) / area;
+  }
+}
+
+Inflater::~Inflater()
+{
+  free(window);
+}
+
+void Inflater::reset()
+{
+  free(window);
+  window = nullptr;
+  state = ZLIB_HEADER;
+  windowPosition = 0;
+  produced = 0;
+  bits = 0;
+  bitCount = 0;
+  code = first = index = 0;
+  length = 0;
+}
+
+bool Inflater::need(uint8_t count)
+{
+  while (bitCount < count)
+  {
+    if (inputPosition >= inputLength)
+    {
+      return false;
+    }
+    bits |= (uint32_t)input[inputPosition++] << bitCount;
+    bitCount += 8;
+  }
+  return true;
+}
+
+uint16_t Inflater::take(uint8_t count)
+{
+  uint16_t value = bits & ((1UL << count) - 1);
+  bits >>= count;
+  bitCount -= count;
+  return value;
+}
+
+bool Inflater::decode(const Huffman &table, bool &failed)
+{
+  // canonical code, one bit at a time (as in zlib's puff); the partial code survives a stall
+  while (need(1))
+  {
+    code |= take(1);
+    length++;
+    uint16_t count = table.count[length];
+    if (code < first + count)
+    {
+      symbol = table.symbol[index + (code - first)];
+      code = first = index = 0;
+      length = 0;
+      return true;
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+    if (length == 15)
+    {
+      failed = true;
+      return false;
+    }
+  }
+  return false;
+}
+
+bool Inflater::build(Huffman &table, const uint8_t *lengths, uint16_t count)
+{
+  memset(table.count, 0, sizeof(table.count));
+  for (uint16_t s = 0; s < count; s++)
+  {
+    table.count[lengths[s]]++;
+  }
+
+  int32_t left = 1;
+  for (uint8_t len = 1; len < 16; len++)
+  {
+    left = (left << 1) - table.count[len];
+    if (left < 0)
+    {
+      return false; // over-subscribed
+    }
+  }
+
+  uint16_t offsets[16];
+  offsets[1] = 0;
+  for (uint8_t len = 1; len < 15; len++)
+  {
+    offsets[len + 1] = offsets[len] + table.count[len];
+  }
+  for (uint16_t s = 0; s < count; s++)
+  {
+    if (lengths[s])
+    {
+      table.symbol[offsets[lengths[s]]++] = s;
+    }
+  }
+  return true;
+}
+
+void Inflater::buildFixed()
+{
+  for (uint16_t s = 0; s < 288; s++)
+  {
+    lengths[s] = s < 144 ? 8 : (s < 256 ? 9 : (s < 280 ? 7 : 8));
+  }
+  build(literals, lengths, 288);
+  for (uint16_t s = 0; s < 30; s++)
+  {
+    lengths[s] = 5;
+  }
+  build(distances, lengths, 30);
+}
+
+size_t Inflater::inflate(const uint8_t *in, size_t inLength, size_t &consumed, uint8_t *out,
+                         size_t outLength)
+{
+  input = in;
+  inputLength = inLength;
+  inputPosition = 0;
+  size_t written = 0;
+  bool stalled = false;
+  bool failed = false;
+
+  auto emit = [&](uint8_t value) {
+    window[windowPosition++ & windowMask] = value;
+    out[written++] = value;
+    if (produced <= windowMask)
+    {
+      produced++;
+    }
+  };
+
+  while (!stalled && state != FINISHED && state != BROKEN)
+  {
+    switch (state)
+    {
+    case ZLIB_HEADER:
+    {
+      if (!need(16))
+      {
+        stalled = true;
+        break;
+      }
+      uint8_t cmf = take(8);
+      uint8_t flg = take(8);
+      if ((cmf & 0x0f) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 || (flg & 0x20))
+      {
+        state = BROKEN;
+        break;
+      }
+      // the encoder promises distances of at most this much, so the window can be smaller
+      uint16_t size = 1U << ((cmf >> 4) + 8);
+      window = (uint8_t *)malloc(size);
+      windowMask = size - 1;
+      state = window ? BLOCK_HEADER : BROKEN;
+      break;
+    }
+
+    case BLOCK_HEADER:
+    {
+      if (!need(3))
+      {
+        stalled = true;
+        break;
+      }
+      finalBlock = take(1);
+      uint8_t type = take(2);
+      if (type == 0)
+      {
+        take(bitCount & 7);
+        state = STORED_LENGTH;
+      }
+      else if (type == 1)
+      {
+        buildFixed();
+        state = SYMBOL;
+      }
+      else
+      {
+        state = type == 2 ? DYNAMIC_COUNTS : BROKEN;
+      }
+      break;
+    }
+
+    case STORED_LENGTH:
+    {
+      if (!need(32))
+      {
+        stalled = true;
+        break;
+      }
+      uint16_t len = take(16);
+      uint16_t check = take(16);
+      if (len != (uint16_t)~check)
+      {
+        state = BROKEN;
+        break;
+      }
+      remaining = len;
+      state = STORED_COPY;
+      break;
+    }
+
+    case STORED_COPY:
+      while (remaining && written < outLength && need(8))
+      {
+        emit(take(8));
+        remaining--;
+      }
+      if (remaining)
+      {
+        stalled = true;
+        break;
+      }
+      state = finalBlock ? FINISHED : BLOCK_HEADER;
+      break;
+
+    case DYNAMIC_COUNTS:
+      if (!need(14))
+      {
+        stalled = true;
+        break;
+      }
+      literalCount = take(5) + 257;
+      distanceCount = take(5) + 1;
+      codeLengthCount = take(4) + 4;
+      lengthIndex = 0;
+      state = literalCount > 286 || distanceCount > 30 ? BROKEN : DYNAMIC_CODE_LENGTHS;
+      break;
+
+    case DYNAMIC_CODE_LENGTHS:
+      while (lengthIndex < 19)
+      {
+        if (lengthIndex < codeLengthCount)
+        {
+          if (!need(3))
+          {
+            stalled = true;
+            break;
+          }
+          lengths[CODE_LENGTH_ORDER[lengthIndex]] = take(3);
+        }
+        else
+        {
+          lengths[CODE_LENGTH_ORDER[lengthIndex]] = 0;
+        }
+        lengthIndex++;
+      }
+      if (stalled)
+      {
+        break;
+      }
+      lengthIndex = 0;
+      state = build(codeLengths, lengths, 19) ? DYNAMIC_LENGTHS : BROKEN;
+      break;
+
+    case DYNAMIC_LENGTHS:
+      while (lengthIndex < literalCount + distanceCount)
+      {
+        if (!decode(codeLengths, failed))
+        {
+          stalled = !failed;
+          break;
+        }
+        if (symbol >= 16)
+        {
+          state = DYNAMIC_REPEAT;
+          break;
+        }
+        lengths[lengthIndex++] = symbol;
+      }
+      if (failed)
+      {
+        state = BROKEN;
+      }
+      else if (!stalled && state == DYNAMIC_LENGTHS)
+      {
+        bool valid = lengths[256] && build(literals, lengths, literalCount) &&
+                     build(distances, lengths + literalCount, distanceCount);
+        state = valid ? SYMBOL : BROKEN;
+      }
+      break;
+
+    case DYNAMIC_REPEAT:
+    {
+      uint8_t extra = symbol == 16 ? 2 : (symbol == 17 ? 3 : 7);
+      if (!need(extra))
+      {
+        stalled = true;
+        break;
+      }
+      uint16_t repeat = take(extra) + (symbol == 18 ? 11 : 3);
+      if ((symbol == 16 && !lengthIndex) || lengthIndex + repeat > literalCount + distanceCount)
+      {
+        state = BROKEN;
+        break;
+      }
+      uint8_t value = symbol == 16 ? lengths[lengthIndex - 1] : 0;
+      while (repeat--)
+      {
+        lengths[lengthIndex++] = value;
+      }
+      state = DYNAMIC_LENGTHS;
+      break;
+    }
+
+    case SYMBOL:
+      if (written == outLength || !decode(literals, failed))
+      {
+        stalled = !failed;
+        state = failed ? BROKEN : SYMBOL;
+        break;
+      }
+      if (symbol < 256)
+      {
+        emit(symbol);
+      }
+      else if (symbol == 256)
+      {
+        state = finalBlock ? FINISHED : BLOCK_HEADER;
+      }
+      else
+      {
+        symbol -= 257;
+        state = symbol < 29 ? LENGTH_EXTRA : BROKEN;
+      }
+      break;
+
+    case LENGTH_EXTRA:
+      if (!need(LENGTH_BITS[symbol]))
+      {
+        stalled = true;
+        break;
+      }
+      remaining = LENGTH_BASES[symbol] + take(LENGTH_BITS[symbol]);
+      state = DISTANCE;
+      break;
+
+    case DISTANCE:
+      if (!decode(distances, failed))
+      {
+        stalled = !failed;
+        state = failed ? BROKEN : DISTANCE;
+        break;
+      }
+      state = symbol < 30 ? DISTANCE_EXTRA : BROKEN;
+      break;
+
+    case DISTANCE_EXTRA:
+      if (!need(DISTANCE_BITS[symbol]))
+      {
+        stalled = true;
+        break;
+      }
+      distance = DISTANCE_BASES[symbol] + take(DISTANCE_BITS[symbol]);
+      state = distance > produced ? BROKEN : COPY;
+      break;
+
+    case COPY:
+      while (remaining && written < outLength)
+      {
+        emit(window[(uint16_t)(windowPosition - distance) & windowMask]);
+        remaining--;
+      }
+      if (remaining)
+      {
+        stalled = true;
+        break;
+      }
+      state = SYMBOL;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  consumed = inputPosition;
+  return written;
+}
+
+ImageDecoder::ImageDecoder(ImageFrameSink &sink) : sink(sink)
+{
+  memset(alpha, 255, sizeof(alpha));
+}
+
+ImageDecoder::~ImageDecoder()
+{
+  freeGif();
+  freePng();
+}
+
+void ImageDecoder::setOutput(uint16_t outputLevels, ImageDither mode, uint16_t delayMs)
+{
+  levels = outputLevels;
+  dither = mode;
+  defaultDelay = delayMs;
+}
+
+bool ImageDecoder::fail(const char *message)
+{
+  if (state != FAILED)
+  {
+    error = message;
+    state = FAILED;
+    freeGif();
+    freePng();
+  }
+  return false;
+}
+
+void ImageDecoder::collect(uint8_t count, State next)
+{
+  fieldNeeded = count;
+  fieldLength = 0;
+  state = next;
+}
+
+bool ImageDecoder::emitFrame(uint16_t delayMs)
+{
+  uint8_t pixels[IMAGE_SIZE * IMAGE_SIZE];
+  ditherImage(scaler.canvas, pixels, levels, dither);
+  frames++;
+  return sink.addImageFrame(pixels, delayMs) || fail("Could not store frame");
+}
+
+bool ImageDecoder::write(const uint8_t *data, size_t length)
+{
+  while (length && state != FAILED && state != FINISHED)
+  {
+    size_t used;
+    if (fieldNeeded)
+    {
+      used = fieldNeeded - fieldLength;
+      used = used < length ? used : length;
+      memcpy(field + fieldLength, data, used);
+      fieldLength += used;
+      if (fieldLength == fieldNeeded)
+      {
+        fieldNeeded = 0;
+        parseField();
+      }
+    }
+    else if (state == DETECT)
+    {
+      detect(data[0]);
+      used = 0;
+    }
+    else
+    {
+      used = stream(data, length);
+    }
+    data += used;
+    length -= used;
+  }
+  return state != FAILED;
+}
+
+bool ImageDecoder::finish()
+{
+  if (state != FAILED && state != FINISHED)
+  {
+    // a GIF without its trailer is common and harmless once the frames are out
+    if (format != IMAGE_GIF || imageData || !frames)
+    {
+      fail(state == DETECT ? "Empty upload" : "Truncated image");
+    }
+  }
+  freeGif();
+  freePng();
+  return state != FAILED && frames > 0;
+}
+
+void ImageDecoder::detect(uint8_t first)
+{
+  if (first == 'G')
+  {
+    format = IMAGE_GIF;
+    collect(13, GIF_HEADER);
+  }
+  else if (first == 0x89)
+  {
+    format = IMAGE_PNG;
+    collect(8, PNG_SIGNATURE);
+  }
+  else
+  {
+    fail("Not a GIF or PNG image");
+  }
+}
+
+bool ImageDecoder::parseField()
+{
+  switch (state)
+  {
+  case GIF_HEADER:
+    return gifHeader();
+
+  case GIF_COLOR:
+    (localColors ? palette : globalPalette)[color++] = luma(field[0], field[1], field[2]);
+    if (color < colors)
+    {
+      collect(3, GIF_COLOR);
+    }
+    else
+    {
+      collect(1, localColors ? GIF_CODE_SIZE : GIF_BLOCK);
+    }
+    return true;
+
+  case GIF_BLOCK:
+    if (field[0] == 0x21)
+    {
+      collect(1, GIF_EXTENSION);
+    }
+    else if (field[0] == 0x2C)
+    {
+      collect(9, GIF_DESCRIPTOR);
+    }
+    else if (field[0] == 0x3B)
+    {
+      state = FINISHED;
+    }
+    else
+    {
+      return fail("Broken GIF block");
+    }
+    return true;
+
+  case GIF_EXTENSION:
+    extensionLabel = field[0];
+    extensionFirst = true;
+    collect(1, GIF_SUB_BLOCK);
+    return true;
+
+  case GIF_SUB_BLOCK:
+    if (!field[0])
+    {
+      // block terminator
+      if (imageData && !gifEndImage())
+      {
+        return false;
+      }
+      collect(1, GIF_BLOCK);
+    }
+    else if (!imageData && extensionLabel == 0xF9 && extensionFirst && field[0] == 4)
+    {
+      collect(4, GIF_SUB_DATA);
+    }
+    else
+    {
+      skip = field[0];
+      state = GIF_SUB_DATA;
+    }
+    extensionFirst = false;
+    return true;
+
+  case GIF_SUB_DATA:
+    // graphic control extension: disposal, delay in 1/100 s, transparent index
+    graphicControl = true;
+    disposal = (field[0] >> 2) & 7;
+    frameDelay = (field[1] | field[2] << 8) * 10;
+    transparent = (field[0] & 1) ? field[3] : -1;
+    collect(1, GIF_SUB_BLOCK);
+    return true;
+
+  case GIF_DESCRIPTOR:
+    return gifDescriptor();
+
+  case GIF_CODE_SIZE:
+    minimumCodeSize = field[0];
+    if (minimumCodeSize < 1 || minimumCodeSize > 8)
+    {
+      return fail("Broken GIF data");
+    }
+    return gifStartImage();
+
+  case PNG_SIGNATURE:
+  {
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (memcmp(field, SIGNATURE, sizeof(SIGNATURE)))
+    {
+      return fail("Not a PNG image");
+    }
+    collect(8, PNG_CHUNK);
+    return true;
+  }
+
+  case PNG_CHUNK:
+    return pngChunk();
+
+  case PNG_HEADER:
+    return pngHeader();
+
+  case PNG_PALETTE:
+    palette[color++] = luma(field[0], field[1], field[2]);
+    collect(color < colors ? 3 : 4, color < colors ? PNG_PALETTE : PNG_CRC);
+    return true;
+
+  case PNG_CRC:
+    // chunk CRCs are not checked; broken image data fails in the inflater
+    collect(8, PNG_CHUNK);
+    return true;
+
+  default:
+    return fail("Broken image");
+  }
+}
+
+size_t ImageDecoder::stream(const uint8_t *data, size_t length)
+{
+  if (state == GIF_SUB_DATA)
+  {
+    size_t used = length < skip ? length : skip;
+    for (size_t i = 0; i < used && imageData && !lzwEnded; i++)
+    {
+      codeBits |= (uint32_t)data[i] << codeBitCount;
+      codeBitCount += 8;
+      while (codeBitCount >= codeSize && !lzwEnded)
+      {
+        uint16_t code = codeBits & ((1U << codeSize) - 1);
+        codeBits >>= codeSize;
+        codeBitCount -= codeSize;
+        if (!gifCode(code))
+        {
+          return used;
+        }
+      }
+    }
+    skip -= used;
+    if (!skip)
+    {
+      collect(1, GIF_SUB_BLOCK);
+    }
+    return used;
+  }
+
+  if (state == PNG_DATA)
+  {
+    size_t used = length < chunkRemaining ? length : chunkRemaining;
+
+    if (chunkType == 0x49444154) // IDAT
+    {
+      size_t offset = 0;
+      uint8_t out[64];
+      size_t produced;
+      do
+      {
+        size_t consumed = 0;
+        produced = inflater->inflate(data + offset, used - offset, consumed, out, sizeof(out));
+        offset += consumed;
+        for (size_t i = 0; i < produced && state != FAILED; i++)
+        {
+          pngByte(out[i]);
+        }
+        if (state == FAILED)
+        {
+          return used;
+        }
+        if (inflater->isBroken())
+        {
+          fail("Broken PNG data");
+          return used;
+        }
+      } while (!inflater->isFinished() && (produced == sizeof(out) || offset < used));
+    }
+    else if (chunkType == 0x74524E53) // tRNS
+    {
+      for (size_t i = 0; i < used; i++, color++)
+      {
+        if (colorType == 3)
+        {
+          alpha[color & 0xff] = data[i];
+        }
+        else if (color < 6)
+        {
+          key[color >> 1] = key[color >> 1] << 8 | data[i];
+          hasKey = true;
+        }
+      }
+    }
+
+    chunkRemaining -= used;
+    if (!chunkRemaining)
+    {
+      collect(4, PNG_CRC);
+    }
+    return used;
+  }
+
+  fail("Broken image");
+  return length;
+}
+
+bool ImageDecoder::gifHeader()
+{
+  if (memcmp(field, "GIF87a", 6) && memcmp(field, "GIF89a", 6))
+  {
+    return fail("Not a GIF image");
+  }
+  width = field[6] | field[7] << 8;
+  height = field[8] | field[9] << 8;
+  if (!width || !height)
+  {
+    return fail("Unsupported image size");
+  }
+  scaler.begin(width, height);
+
+  bool blocked = (uint32_t)width * height > GIF_CANVAS_PIXELS;
+  blockWidth = blocked ? (width + GIF_CANVAS_SIZE - 1) / GIF_CANVAS_SIZE : 1;
+  blockHeight = blocked ? (height + GIF_CANVAS_SIZE - 1) / GIF_CANVAS_SIZE : 1;
+  compositeWidth = (width + blockWidth - 1) / blockWidth;
+  compositeHeight = (height + blockHeight - 1) / blockHeight;
+  uint16_t blocks = compositeWidth * compositeHeight;
+  composite = (uint8_t *)calloc(blocks, 1);
+  accumulator = blocked ? (uint16_t *)malloc(blocks * 2) : nullptr;
+  if (!composite || (blocked && !accumulator))
+  {
+    return fail("Out of memory");
+  }
+
+  // without a global table the index itself is the grey value
+  for (uint16_t i = 0; i < 256; i++)
+  {
+    globalPalette[i] = i;
+  }
+  globalColors = 256;
+
+  localColors = false;
+  if (field[10] & 0x80)
+  {
+    globalColors = 2 << (field[10] & 7);
+    colors = globalColors;
+    color = 0;
+    collect(3, GIF_COLOR);
+  }
+  else
+  {
+    collect(1, GIF_BLOCK);
+  }
+  return true;
+}
+
+bool ImageDecoder::gifDescriptor()
+{
+  frameX = field[0] | field[1] << 8;
+  frameY = field[2] | field[3] << 8;
+  frameWidth = field[4] | field[5] << 8;
+  frameHeight = field[6] | field[7] << 8;
+  interlaced = field[8] & 0x40;
+
+  localColors = field[8] & 0x80;
+  if (localColors)
+  {
+    colors = 2 << (field[8] & 7);
+    color = 0;
+    collect(3, GIF_COLOR);
+  }
+  else
+  {
+    memcpy(palette, globalPalette, sizeof(palette));
+    colors = globalColors;
+    collect(1, GIF_CODE_SIZE);
+  }
+  return true;
+}
+
+bool ImageDecoder::gifStartImage()
+{
+  if (!prefix)
+  {
+    // one block for the dictionary (prefix, suffix) and the decode stack
+    prefix = (uint16_t *)malloc(LZW_CODES * 2 + LZW_CODES + LZW_CODES + 1);
+    if (!prefix)
+    {
+      return fail("Out of memory");
+    }
+    suffix = (uint8_t *)(prefix + LZW_CODES);
+    stack = suffix + LZW_CODES;
+  }
+
+  codeSize = minimumCodeSize + 1;
+  nextCode = (1 << minimumCodeSize) + 2;
+  previousCode = -1;
+  codeBits = 0;
+  codeBitCount = 0;
+  lzwEnded = false;
+
+  uint16_t blocks = compositeWidth * compositeHeight;
+  if (disposal == 3)
+  {
+    if (!saved && !(saved = (uint8_t *)malloc(blocks)))
+    {
+      return fail("Out of memory");
+    }
+    memcpy(saved, composite, blocks);
+  }
+  for (uint16_t i = 0; accumulator && i < blocks; i++)
+  {
+    accumulator[i] = composite[i] << 8;
+  }
+
+  column = 0;
+  frameRow = 0;
+  pass = 0;
+  gifRow();
+  imageData = true;
+  collect(1, GIF_SUB_BLOCK);
+  return true;
+}
+
+bool ImageDecoder::gifCode(uint16_t code)
+{
+  uint16_t clear = 1 << minimumCodeSize;
+  if (code == clear)
+  {
+    codeSize = minimumCodeSize + 1;
+    nextCode = clear + 2;
+    previousCode = -1;
+    return true;
+  }
+  if (code == clear + 1)
+  {
+    lzwEnded = true;
+    return true;
+  }
+
+  if (previousCode < 0)
+  {
+    if (code > clear)
+    {
+      return fail("Broken GIF data");
+    }
+    gifPixel(code);
+    previousCode = code;
+    previousFirst = code;
+    return true;
+  }
+
+  // the string is walked back to front onto the stack, then emitted in order
+  uint16_t top = 0;
+  uint16_t walk = code;
+  if (code == nextCode)
+  {
+    // not in the dictionary yet: previous string plus its own first pixel
+    stack[top++] = previousFirst;
+    walk = previousCode;
+  }
+  else if (code > nextCode)
+  {
+    return fail("Broken GIF data");
+  }
+
+  while (walk > clear)
+  {
+    stack[top++] = suffix[walk];
+    walk = prefix[walk];
+  }
+  stack[top++] = walk;
+  uint8_t firstPixel = walk;
+
+  while (top)
+  {
+    gifPixel(stack[--top]);
+  }
+
+  if (nextCode < LZW_CODES)
+  {
+    prefix[nextCode] = previousCode;
+    suffix[nextCode] = firstPixel;
+    nextCode++;
+    if (nextCode == (1U << codeSize) && codeSize < 12)
+    {
+      codeSize++;
+    }
+  }
+  previousCode = code;
+  previousFirst = firstPixel;
+  return true;
+}
+
+void ImageDecoder::gifPixel(uint8_t index)
+{
+  if (pass > 3 || frameRow >= frameHeight)
+  {
+    return;
+  }
+
+  uint32_t x = (uint32_t)frameX + column;
+  if (rowInside && x < width && index != transparent)
+  {
+    if (!accumulator)
+    {
+      composite[blockRow + x] = palette[index];
+    }
+    else
+    {
+      // move the block towards the pixel by the share of the block it covers
+      uint16_t block = blockRow + x / blockWidth;
+      uint32_t left = x / blockWidth * blockWidth;
+      uint32_t area = (width - left < blockWidth ? width - left : blockWidth) * blockRowHeight;
+      int32_t change = ((int32_t)palette[index] - composite[block]) * 256 / (int32_t)area;
+      int32_t value = accumulator[block] + change;
+      accumulator[block] = value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value);
+    }
+  }
+
+  if (++column < frameWidth)
+  {
+    return;
+  }
+  column = 0;
+
+  if (!interlaced)
+  {
+    frameRow++;
+  }
+  else
+  {
+    frameRow += GIF_PASS_STEP[pass];
+    while (frameRow >= frameHeight && ++pass < 4)
+    {
+      frameRow = GIF_PASS_START[pass];
+    }
+  }
+  gifRow();
+}
+
+void ImageDecoder::gifRow()
+{
+  uint32_t y = (uint32_t)frameY + frameRow;
+  rowInside = pass < 4 && frameRow < frameHeight && y < height;
+  if (rowInside)
+  {
+    uint32_t top = y / blockHeight * blockHeight;
+    blockRow = y / blockHeight * compositeWidth;
+    blockRowHeight = height - top < blockHeight ? height - top : blockHeight;
+  }
+}
+
+bool ImageDecoder::gifEndImage()
+{
+  imageData = false;
+  rowInside = false;
+
+  uint16_t blocks = compositeWidth * compositeHeight;
+  for (uint16_t i = 0; accumulator && i < blocks; i++)
+  {
+    uint16_t value = (accumulator[i] + 128) >> 8;
+    composite[i] = value > 255 ? 255 : value;
+  }
+
+  // blocks are uniform, so they go to the scaler as runs
+  scaler.beginFrame();
+  for (uint16_t y = 0; y < height; y++)
+  {
+    scaler.beginRow(y);
+    const uint8_t *row = composite + y / blockHeight * compositeWidth;
+    for (uint16_t block = 0; block < compositeWidth; block++)
+    {
+      scaler.addPixels(block * blockWidth, blockWidth, row[block]);
+    }
+  }
+  scaler.endFrame();
+
+  // browsers show delays of 0 and 10 ms at their default speed, so do the same
+  uint16_t delay = graphicControl && frameDelay > 10 ? frameDelay : defaultDelay;
+  if (!emitFrame(delay))
+  {
+    return false;
+  }
+
+  if (disposal == 2)
+  {
+    gifClear();
+  }
+  else if (disposal == 3)
+  {
+    memcpy(composite, saved, blocks);
+  }
+
+  graphicControl = false;
+  disposal = 0;
+  transparent = -1;
+  return true;
+}
+
+// Disposal to background: fades the blocks under the frame towards black by how much of them
+// the frame covered
+void ImageDecoder::gifClear()
+{
+  for (uint16_t by = 0; by < compositeHeight; by++)
+  {
+    uint32_t top = (uint32_t)by * blockHeight;
+    uint32_t bottom = top + blockHeight < height ? top + blockHeight : height;
+    uint32_t overlapY = overlap(frameY, (uint32_t)frameY + frameHeight, top, bottom);
+    for (uint16_t bx = 0; bx < compositeWidth && overlapY; bx++)
+    {
+      uint32_t left = (uint32_t)bx * blockWidth;
+      uint32_t right = left + blockWidth < width ? left + blockWidth : width;
+      uint32_t overlapX = overlap(frameX, (uint32_t)frameX + frameWidth, left, right);
+      uint32_t area = (right - left) * (bottom - top);
+      uint8_t &value = composite[by * compositeWidth + bx];
+      value = (uint64_t)value * (area - overlapX * overlapY) / area;
+    }
+  }
+}
+
+void ImageDecoder::freeGif()
+{
+  free(prefix);
+  prefix = nullptr;
+  suffix = nullptr;
+  stack = nullptr;
+  free(composite);
+  free(saved);
+  free(accumulator);
+  composite = nullptr;
+  saved = nullptr;
+  accumulator = nullptr;
+  rowInside = false;
+}
+
+bool ImageDecoder::pngChunk()
+{
+  chunkRemaining = readBigEndian(field);
+  chunkType = readBigEndian(field + 4);
+
+  bool headerSeen = rows != nullptr;
+  if (!headerSeen && chunkType != 0x49484452) // IHDR
+  {
+    return fail("Broken PNG header");
+  }
+
+  switch (chunkType)
+  {
+  case 0x49484452: // IHDR
+    if (headerSeen || chunkRemaining != 13)
+    {
+      return fail("Broken PNG header");
+    }
+    collect(13, PNG_HEADER);
+    return true;
+
+  case 0x504C5445: // PLTE
+    if (chunkRemaining % 3 || chunkRemaining > 768)
+    {
+      return fail("Broken PNG palette");
+    }
+    colors = chunkRemaining / 3;
+    color = 0;
+    collect(colors ? 3 : 4, colors ? PNG_PALETTE : PNG_CRC);
+    return true;
+
+  case 0x49454E44: // IEND
+    return pngEnd();
+
+  default:
+    if (chunkType == 0x74524E53) // tRNS
+    {
+      color = 0;
+      key[0] = key[1] = key[2] = 0;
+      hasKey = false;
+    }
+    else if (chunkType != 0x49444154 && !(field[4] & 0x20))
+    {
+      // unknown critical chunk
+      return fail("Unsupported PNG");
+    }
+    state = PNG_DATA;
+    if (!chunkRemaining)
+    {
+      collect(4, PNG_CRC);
+    }
+    return true;
+  }
+}
+
+bool ImageDecoder::pngHeader()
+{
+  uint32_t w = readBigEndian(field);
+  uint32_t h = readBigEndian(field + 4);
+  bitDepth = field[8];
+  colorType = field[9];
+  adam7 = field[12] == 1;
+
+  if (!w || !h || w > 65535 || h > 65535)
+  {
+    return fail("Unsupported image size");
+  }
+
+  static const uint8_t CHANNELS[7] = {1, 0, 3, 1, 2, 0, 4};
+  channels = colorType < 7 ? CHANNELS[colorType] : 0;
+  bool validDepth = colorType == 0   ? (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 ||
+                                        bitDepth == 8 || bitDepth == 16)
+                    : colorType == 3 ? (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 ||
+                                        bitDepth == 8)
+                                     : (bitDepth == 8 || bitDepth == 16);
+  if (!channels || !validDepth || field[10] || field[11] || field[12] > 1)
+  {
+    return fail("Unsupported PNG");
+  }
+
+  uint8_t bitsPerPixel = channels * bitDepth;
+  filterStride = bitsPerPixel < 8 ? 1 : bitsPerPixel / 8;
+  uint32_t maxRowBytes = (w * bitsPerPixel + 7) / 8;
+  if (maxRowBytes > IMAGE_MAX_ROW_BYTES)
+  {
+    return fail("Image too wide");
+  }
+
+  width = w;
+  height = h;
+  rows = (uint8_t *)malloc(maxRowBytes * 2);
+  inflater = new Inflater();
+  if (!rows || !inflater)
+  {
+    return fail("Out of memory");
+  }
+  current = rows;
+  prior = rows + maxRowBytes;
+
+  // grey levels for sub-byte depths, palettes override this
+  for (uint16_t i = 0; i < 256; i++)
+  {
+    palette[i] = i;
+  }
+
+  scaler.begin(width, height);
+  scaler.beginFrame();
+  pass = adam7 ? 0 : 7;
+  imageComplete = false;
+  pngStartPass();
+  collect(4, PNG_CRC);
+  return true;
+}
+
+bool ImageDecoder::pngStartPass()
+{
+  for (; pass < 8; pass = adam7 && pass < 6 ? pass + 1 : 8)
+  {
+    // pixels of the pass in a row and rows of the pass, rounding up
+    uint8_t stepX = PASS_STEP_X[pass];
+    uint8_t stepY = PASS_STEP_Y[pass];
+    passWidth = width > PASS_X[pass] ? (width - PASS_X[pass] + stepX - 1) / stepX : 0;
+    passHeight = height > PASS_Y[pass] ? (height - PASS_Y[pass] + stepY - 1) / stepY : 0;
+    if (passWidth && passHeight)
+    {
+      rowBytes = ((uint32_t)passWidth * channels * bitDepth + 7) / 8;
+      memset(prior, 0, rowBytes);
+      rowPosition = 0;
+      frameRow = 0;
+      return true;
+    }
+  }
+  imageComplete = true;
+  return false;
+}
+
+void ImageDecoder::pngByte(uint8_t value)
+{
+  if (imageComplete)
+  {
+    return;
+  }
+
+  if (!rowPosition)
+  {
+    filter = value;
+    rowPosition = 1;
+    if (filter > 4)
+    {
+      fail("Broken PNG filter");
+    }
+    return;
+  }
+
+  uint16_t i = rowPosition - 1;
+  uint8_t a = i >= filterStride ? current[i - filterStride] : 0;
+  uint8_t b = prior[i];
+  uint8_t c = i >= filterStride ? prior[i - filterStride] : 0;
+  switch (filter)
+  {
+  case 1:
+    value += a;
+    break;
+  case 2:
+    value += b;
+    break;
+  case 3:
+    value += (a + b) >> 1;
+    break;
+  case 4:
+  {
+    int16_t p = a + b - c;
+    int16_t pa = p > a ? p - a : a - p;
+    int16_t pb = p > b ? p - b : b - p;
+    int16_t pc = p > c ? p - c : c - p;
+    value += (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+    break;
+  }
+  }
+  current[i] = value;
+
+  if (rowPosition++ < rowBytes)
+  {
+    return;
+  }
+
+  pngRow();
+  uint8_t *swap = prior;
+  prior = current;
+  current = swap;
+  rowPosition = 0;
+  if (++frameRow == passHeight)
+  {
+    pass = adam7 && pass < 6 ? pass + 1 : 8;
+    pngStartPass();
+  }
+}
+
+void ImageDecoder::pngRow()
+{
+  scaler.beginRow(PASS_Y[pass] + frameRow * PASS_STEP_Y[pass]);
+
+  uint16_t maximum = (1U << bitDepth) - 1;
+  uint16_t samples[4];
+  for (uint16_t px = 0; px < passWidth; px++)
+  {
+    for (uint8_t ch = 0; ch < channels; ch++)
+    {
+      uint32_t n = (uint32_t)px * channels + ch;
+      if (bitDepth == 16)
+      {
+        samples[ch] = current[2 * n] << 8 | current[2 * n + 1];
+      }
+      else if (bitDepth == 8)
+      {
+        samples[ch] = current[n];
+      }
+      else
+      {
+        uint32_t bit = n * bitDepth;
+        samples[ch] = (current[bit >> 3] >> (8 - bitDepth - (bit & 7))) & maximum;
+      }
+    }
+
+    uint8_t shift = bitDepth == 16 ? 8 : 0;
+    uint8_t grey;
+    uint8_t opacity = 255;
+    switch (colorType)
+    {
+    case 0:
+      grey = bitDepth < 8 ? samples[0] * 255 / maximum : samples[0] >> shift;
+      opacity = hasKey && samples[0] == key[0] ? 0 : 255;
+      break;
+    case 2:
+      grey = luma(samples[0] >> shift, samples[1] >> shift, samples[2] >> shift);
+      opacity =
+          hasKey && samples[0] == key[0] && samples[1] == key[1] && samples[2] == key[2] ? 0 : 255;
+      break;
+    case 3:
+      grey = palette[samples[0]];
+      opacity = alpha[samples[0]];
+      break;
+    case 4:
+      grey = samples[0] >> shift;
+      opacity = samples[1] >> shift;
+      break;
+    default:
+      grey = luma(samples[0] >> shift, samples[1] >> shift, samples[2] >> shift);
+      opacity = samples[3] >> shift;
+      break;
+    }
+
+    // transparent parts show black: the new pixel is blended with the zero canvas
+    scaler.addPixel(PASS_X[pass] + px * PASS_STEP_X[pass], grey, opacity);
+  }
+
+  scaler.endRow();
+}
+
+bool ImageDecoder::pngEnd()
+{
+  if (!imageComplete)
+  {
+    return fail("Truncated image");
+  }
+  scaler.endFrame();
+  if (!emitFrame(defaultDelay))
+  {
+    return false;
+  }
+  state = FINISHED;
+  freePng();
+  return true;
+}
+
+void ImageDecoder::freePng()
+{
+  delete inflater;
+  inflater = nullptr;
+  free(rows);
+  rows = nullptr;
+}
@@ -0,0 +1,171 @@
+#include "imageupload.h"
+
+#ifdef ENABLE_SERVER
+
+#include <new>
+
+ImageUpload_ &ImageUpload_::getInstance()
+{
+  static ImageUpload_ instance;
+  return instance;
+}
+
+void ImageUpload_::release()
+{
+  delete decoder;
+  decoder = nullptr;
+  delete writer;
+  writer = nullptr;
+  owner = nullptr;
+}
+
+bool ImageUpload_::begin(const void *owner,
+                         uint8_t bitsPerPixel,
+                         ImageDither dither,
+                         uint16_t delayMs)
+{
+  if (this->owner)
+  {
+    if (millis() - lastActivity <= IMAGE_UPLOAD_TIMEOUT_MS)
+    {
+      error = "Another image upload is in progress";
+      return false;
+    }
+    Serial.println("[ImageUpload] Session timed out");
+    release();
+  }
+
+  // the build has exceptions enabled, plain new would throw instead of returning nullptr
+  decoder = new (std::nothrow) ImageDecoder(*this);
+  writer = new (std::nothrow) AnimationWriter(IMAGE_UPLOAD_PATH);
+  if (!decoder || !writer)
+  {
+    release();
+    error = "Out of memory";
+    return false;
+  }
+
+  if (!writer->begin(bitsPerPixel, delayMs))
+  {
+    release();
+    error = "Storage unavailable";
+    return false;
+  }
+
+  decoder->setOutput(1 << bitsPerPixel, dither, delayMs);
+  this->owner = owner;
+  error = nullptr;
+  frames = 0;
+  width = 0;
+  height = 0;
+  format = IMAGE_UNKNOWN;
+  lastActivity = millis();
+  return true;
+}
+
+bool ImageUpload_::write(const void *owner, const uint8_t *data, size_t len)
+{
+  if (!isOwner(owner))
+  {
+    error = "No image upload in progress";
+    return false;
+  }
+
+  lastActivity = millis();
+  if (!decoder->write(data, len))
+  {
+    error = decoder->getError();
+    Serial.printf("[ImageUpload] Decoding failed: %s\n", error);
+    release();
+    return false;
+  }
+  return true;
+}
+
+bool ImageUpload_::finish(const void *owner)
+{
+  if (!isOwner(owner))
+  {
+    error = "No image upload in progress";
+    return false;
+  }
+
+  bool complete = decoder->finish();
+  frames = decoder->getFrameCount();
+  width = decoder->getWidth();
+  height = decoder->getHeight();
+  format = decoder->getFormat();
+
+  if (!complete)
+  {
+    error = decoder->getError();
+    Serial.printf("[ImageUpload] Decoding failed: %s\n", error);
+    release();
+    return false;
+  }
+
+  if (!writer->commit())
+  {
+    error = "Could not store animation";
+    release();
+    return false;
+  }
+
+  Serial.printf("[ImageUpload] %ux%u image stored as %u frames\n", width, height, frames);
+  release();
+  return true;
+}
+
+void ImageUpload_::abort(const void *owner)
+{
+  if (isOwner(owner))
+  {
+    Serial.println("[ImageUpload] Aborted");
+    release();
+  }
+}
+
+bool ImageUpload_::isActive() const
+{
+  return owner != nullptr;
+}
+
+bool ImageUpload_::isOwner(const void *owner) const
+{
+  return owner && this->owner == owner;
+}
+
+const char *ImageUpload_::getError() const
+{
+  return error ? error : "Unknown error";
+}
+
+uint16_t ImageUpload_::getFrameCount() const
+{
+  return frames;
+}
+
+uint16_t ImageUpload_::getWidth() const
+{
+  return width;
+}
+
+uint16_t ImageUpload_::getHeight() const
+{
+  return height;
+}
+
+const char *ImageUpload_::getFormat() const
+{
+  return format == IMAGE_GIF ? "gif" : (format == IMAGE_PNG ? "png" : "unknown");
+}
+
+bool ImageUpload_::addImageFrame(const uint8_t *pixels, uint16_t delayMs)
+{
+  // the writer aborts itself when the flash is full
+  return writer && writer->addFrame(pixels, delayMs);
+}
+
+ImageUpload_ &ImageUpload = ImageUpload.getInstance();
+
+#endif
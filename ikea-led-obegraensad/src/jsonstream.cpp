@@ -0,0 +1,219 @@
+#include "jsonstream.h"
+
+// every block carries its size so deallocate/reallocate can keep the running total
+struct AllocationHeader
+{
+  size_t size;
+  size_t padding; // keeps the payload 8 byte aligned for doubles
+};
+
+void *CappedAllocator::allocate(size_t size)
+{
+  if (used + size > limit)
+  {
+    return nullptr;
+  }
+
+  auto *header = static_cast<AllocationHeader *>(malloc(sizeof(AllocationHeader) + size));
+  if (!header)
+  {
+    return nullptr;
+  }
+
+  header->size = size;
+  used += size;
+  peak = max(peak, used);
+  return header + 1;
+}
+
+void CappedAllocator::deallocate(void *pointer)
+{
+  if (!pointer)
+  {
+    return;
+  }
+
+  auto *header = static_cast<AllocationHeader *>(pointer) - 1;
+  used -= header->size;
+  free(header);
+}
+
+void *CappedAllocator::reallocate(void *pointer, size_t newSize)
+{
+  if (!pointer)
+  {
+    return allocate(newSize);
+  }
+
+  auto *header = static_cast<AllocationHeader *>(pointer) - 1;
+  size_t oldSize = header->size;
+  if (newSize > oldSize && used + newSize - oldSize > limit)
+  {
+    return nullptr;
+  }
+
+  auto *resized = static_cast<AllocationHeader *>(realloc(header, sizeof(AllocationHeader) + newSize));
+  if (!resized)
+  {
+    return nullptr;
+  }
+
+  resized->size = newSize;
+  used = used - oldSize + newSize;
+  peak = max(peak, used);
+  return resized + 1;
+}
+
+HttpBodyStream::HttpBodyStream(Stream &source, bool chunked, long contentLength)
+    : source(source), chunked(chunked), remaining(chunked ? 0 : contentLength)
+{
+  setTimeout(source.getTimeout());
+}
+
+int HttpBodyStream::readRaw()
+{
+  // readBytes waits up to the source timeout, read() alone would give up on a slow packet
+  uint8_t c;
+  return source.readBytes(&c, 1) == 1 ? c : -1;
+}
+
+bool HttpBodyStream::nextChunk()
+{
+  // "<hex size>[;extensions]\r\n", preceded by the "\r\n" closing the previous chunk
+  long size = 0;
+  bool digits = false;
+  bool extension = false;
+
+  for (;;)
+  {
+    int c = readRaw();
+    if (c < 0)
+    {
+      return false;
+    }
+    if (c == '\n')
+    {
+      if (digits)
+      {
+        break;
+      }
+      continue;
+    }
+
+    if (extension || c == '\r')
+    {
+      continue;
+    }
+    if (c == ';')
+    {
+      extension = true;
+      continue;
+    }
+
+    int value = isDigit(c) ? c - '0' : (isHexadecimalDigit(c) ? (c | 0x20) - 'a' + 10 : -1);
+    if (value < 0)
+    {
+      return false;
+    }
+    size = (size << 4) | value;
+    digits = true;
+  }
+
+  if (size == 0)
+  {
+    // skip the trailer up to the final empty line
+    int previous = '\n';
+    for (int c = readRaw(); c >= 0; c = readRaw())
+    {
+      if (c == '\n' && previous == '\n')
+      {
+        break;
+      }
+      if (c != '\r')
+      {
+        previous = c;
+      }
+    }
+    return false;
+  }
+
+  remaining = size;
+  return true;
+}
+
+int HttpBodyStream::readBody()
+{
+  if (finished)
+  {
+    return -1;
+  }
+
+  if (chunked && remaining == 0 && !nextChunk())
+  {
+    finished = true;
+    return -1;
+  }
+
+  if (!chunked && remaining == 0)
+  {
+    finished = true;
+    return -1;
+  }
+
+  int c = readRaw();
+  if (c < 0)
+  {
+    finished = true;
+    return -1;
+  }
+
+  if (remaining > 0)
+  {
+    remaining--;
+  }
+  return c;
+}
+
+int HttpBodyStream::available()
+{
+  if (lookahead >= 0)
+  {
+    return 1;
+  }
+  return finished ? 0 : max(source.available(), 1);
+}
+
+int HttpBodyStream::read()
+{
+  if (lookahead >= 0)
+  {
+    int c = lookahead;
+    lookahead = -1;
+    return c;
+  }
+  return readBody();
+}
+
+int HttpBodyStream::peek()
+{
+  if (lookahead < 0)
+  {
+    lookahead = readBody();
+  }
+  return lookahead;
+}
+
+void HttpBodyStream::drain()
+{
+  lookahead = -1;
+
+  // without length or chunking the server closes the connection anyway
+  if (!chunked && remaining < 0)
+  {
+    return;
+  }
+
+  while (readBody() >= 0)
+  {
+  }
+}
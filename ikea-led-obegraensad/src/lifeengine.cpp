@@ -0,0 +1,310 @@
+#include "lifeengine.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+struct NamedRule
+{
+  const char *name;
+  const char *rule;
+};
+
+static const NamedRule namedRules[] = {
+    {"conway", "B3/S23"},
+    {"highlife", "B36/S23"},
+    {"seeds", "B2/S"},
+    {"daynight", "B3678/S34678"},
+};
+
+void LifeEngine::setSize(uint8_t newSize)
+{
+  if (newSize < 16)
+  {
+    newSize = 16;
+  }
+  if (newSize > LIFE_MAX_SIZE)
+  {
+    newSize = LIFE_MAX_SIZE;
+  }
+
+  size = newSize;
+  mask = size == 64 ? ~0ULL : (1ULL << size) - 1;
+  clear();
+}
+
+bool LifeEngine::parseRule(const char *rule, uint16_t &birthMask, uint16_t &surviveMask)
+{
+  if (!rule)
+  {
+    return false;
+  }
+
+  for (const NamedRule &named : namedRules)
+  {
+    if (strcasecmp(rule, named.name) == 0)
+    {
+      rule = named.rule;
+      break;
+    }
+  }
+
+  uint16_t newBirth = 0;
+  uint16_t newSurvive = 0;
+  uint16_t *target = nullptr;
+  bool sawBirth = false;
+  bool sawSurvive = false;
+
+  for (const char *c = rule; *c; c++)
+  {
+    char upper = toupper(*c);
+    if (upper == 'B')
+    {
+      target = &newBirth;
+      sawBirth = true;
+    }
+    else if (upper == 'S')
+    {
+      target = &newSurvive;
+      sawSurvive = true;
+    }
+    else if (*c >= '0' && *c <= '8' && target)
+    {
+      *target |= 1 << (*c - '0');
+    }
+    else if (*c != '/' && *c != ' ')
+    {
+      return false;
+    }
+  }
+
+  if (!sawBirth || !sawSurvive)
+  {
+    return false;
+  }
+
+  birthMask = newBirth;
+  surviveMask = newSurvive;
+  return true;
+}
+
+bool LifeEngine::setRule(const char *rule)
+{
+  uint16_t newBirth;
+  uint16_t newSurvive;
+  if (!parseRule(rule, newBirth, newSurvive))
+  {
+    return false;
+  }
+
+  setRule(newBirth, newSurvive);
+  return true;
+}
+
+void LifeEngine::setRule(uint16_t birthMask, uint16_t surviveMask)
+{
+  birth = birthMask & 0x1ff;
+  survive = surviveMask & 0x1ff;
+  resetCycle();
+}
+
+void LifeEngine::getRule(char *out, size_t length) const
+{
+  size_t used = 0;
+  auto append = [&](char c) {
+    if (used + 1 < length)
+    {
+      out[used++] = c;
+    }
+  };
+
+  append('B');
+  for (uint8_t n = 0; n <= 8; n++)
+  {
+    if (birth & (1 << n))
+    {
+      append('0' + n);
+    }
+  }
+  append('/');
+  append('S');
+  for (uint8_t n = 0; n <= 8; n++)
+  {
+    if (survive & (1 << n))
+    {
+      append('0' + n);
+    }
+  }
+
+  if (length > 0)
+  {
+    out[used] = '\0';
+  }
+}
+
+void LifeEngine::clear()
+{
+  memset(rows, 0, sizeof(rows));
+  generation = 0;
+  resetCycle();
+}
+
+void LifeEngine::setRow(uint8_t y, uint64_t bits)
+{
+  if (y >= size)
+  {
+    return;
+  }
+  rows[y] = bits & mask;
+  resetCycle();
+}
+
+uint64_t LifeEngine::rotateLeft(uint64_t row) const
+{
+  return ((row << 1) | (row >> (size - 1))) & mask;
+}
+
+uint64_t LifeEngine::rotateRight(uint64_t row) const
+{
+  return (row >> 1) | ((row & 1) << (size - 1));
+}
+
+uint16_t LifeEngine::getWindowRow(uint8_t x, uint8_t y) const
+{
+  uint64_t row = rows[y % size];
+  x %= size;
+  if (x == 0)
+  {
+    return row;
+  }
+  return ((row >> x) | (row << (size - x))) & 0xffff;
+}
+
+uint16_t LifeEngine::countWindow(uint8_t x, uint8_t y) const
+{
+  uint16_t count = 0;
+  for (uint8_t row = 0; row < 16; row++)
+  {
+    count += __builtin_popcount(getWindowRow(x, y + row));
+  }
+  return count;
+}
+
+uint32_t LifeEngine::computeHash() const
+{
+  // FNV-1a over 32 bit halves, enough to tell generations apart
+  uint32_t hash = 2166136261u;
+  for (uint8_t y = 0; y < size; y++)
+  {
+    hash = (hash ^ (uint32_t)rows[y]) * 16777619u;
+    hash = (hash ^ (uint32_t)(rows[y] >> 32)) * 16777619u;
+  }
+  return hash;
+}
+
+void LifeEngine::resetCycle()
+{
+  currentHash = computeHash();
+  savedHash = currentHash;
+  power = 1;
+  lambda = 0;
+  period = 0;
+}
+
+void LifeEngine::step()
+{
+  // neighbour counts n = 0..8 for which a live (survive) or dead (birth) cell is alive next
+  uint16_t wanted = birth | survive;
+
+  uint64_t first = rows[0];
+  uint64_t above = rows[size - 1];
+  uint64_t current = rows[0];
+
+  for (uint8_t y = 0; y < size; y++)
+  {
+    uint64_t below = y + 1 < size ? rows[y + 1] : first;
+
+    // horizontal sums: rows above and below count 3 cells (0..3), the middle row 2 (0..2)
+    uint64_t al = rotateLeft(above), ar = rotateRight(above);
+    uint64_t a0 = al ^ above ^ ar;
+    uint64_t a1 = (al & above) | (ar & (al ^ above));
+
+    uint64_t bl = rotateLeft(below), br = rotateRight(below);
+    uint64_t b0 = bl ^ below ^ br;
+    uint64_t b1 = (bl & below) | (br & (bl ^ below));
+
+    uint64_t ml = rotateLeft(current), mr = rotateRight(current);
+    uint64_t m0 = ml ^ mr;
+    uint64_t m1 = ml & mr;
+
+    // above + below (0..6)
+    uint64_t t0 = a0 ^ b0;
+    uint64_t c0 = a0 & b0;
+    uint64_t t1 = a1 ^ b1 ^ c0;
+    uint64_t t2 = (a1 & b1) | (c0 & (a1 ^ b1));
+
+    // + middle (0..8), four bit planes
+    uint64_t s0 = t0 ^ m0;
+    uint64_t k0 = t0 & m0;
+    uint64_t s1 = t1 ^ m1 ^ k0;
+    uint64_t k1 = (t1 & m1) | (k0 & (t1 ^ m1));
+    uint64_t s2 = t2 ^ k1;
+    uint64_t s3 = t2 & k1;
+
+    uint64_t next = 0;
+    for (uint8_t n = 0; n <= 8; n++)
+    {
+      if (!(wanted & (1 << n)))
+      {
+        continue;
+      }
+
+      uint64_t equal = (n & 1 ? s0 : ~s0) & (n & 2 ? s1 : ~s1) & (n & 4 ? s2 : ~s2) &
+                       (n & 8 ? s3 : ~s3);
+      uint64_t cells = ((birth >> n) & 1 ? ~current : 0) | ((survive >> n) & 1 ? current : 0);
+      next |= equal & cells;
+    }
+
+    rows[y] = next & mask;
+    above = current;
+    current = below;
+  }
+
+  generation++;
+  currentHash = computeHash();
+
+  if (period)
+  {
+    return;
+  }
+
+  lambda++;
+  if (currentHash == savedHash)
+  {
+    period = lambda;
+  }
+  else if (lambda == power)
+  {
+    savedHash = currentHash;
+    power <<= 1;
+    lambda = 0;
+  }
+}
+
+void LifeEngine::step(uint32_t generations)
+{
+  while (generations--)
+  {
+    step();
+  }
+}
+
+uint32_t LifeEngine::getPopulation() const
+{
+  uint32_t count = 0;
+  for (uint8_t y = 0; y < size; y++)
+  {
+    count += __builtin_popcountll(rows[y]);
+  }
+  return count;
+}
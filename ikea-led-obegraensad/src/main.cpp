@@ -2,22 +2,20 @@
 #include <BfButton.h>
 #include <SPI.h>
 
-#ifdef ESP8266
-/* Fix duplicate defs of HTTP_GET, HTTP_POST, ... in ESPAsyncWebServer.h */
-#define WEBSERVER_H
-#endif
-
-#include <WiFiManager.h>
-
 #ifdef ESP32
-#include <ESPmDNS.h>
+#include <esp_sntp.h>
 #endif
 #ifdef ESP8266
 #include <ESP8266WiFi.h>
 #endif
 
 #include "PluginManager.h"
+#include "animationstore.h"
+#include "bootprofile.h"
 #include "config.h"
+#include "connection.h"
+#include "heapstats.h"
+#include "power.h"
 #include "scheduler.h"
 
 #include "plugins/ArtNet.h"
@@ -76,10 +74,12 @@
 #endif
 
 #include "asyncwebserver.h"
+#include "fetchservice.h"
 #include "messages.h"
 #include "ota.h"
 #include "screen.h"
 #include "secrets.h"
+#include "settings.h"
 #include "websocket.h"
 
 BfButton btn(BfButton::STANDALONE_DIGITAL, PIN_BUTTON, true, LOW);
@@ -93,68 +93,15 @@ DRAM_ATTR volatile SYSTEM_STATUS currentStatus = NONE;
 #else
 volatile SYSTEM_STATUS currentStatus = NONE;
 #endif
-WiFiManager wifiManager;
-
-unsigned long lastConnectionAttempt = 0;
-const unsigned long connectionInterval = 10000;
-unsigned long reconnectionBackoff = 5000;            // Start with 5 seconds
-const unsigned long maxReconnectionBackoff = 300000; // Max 5 minutes
-uint8_t reconnectionAttempts = 0;
-
-void connectToWiFi()
+void pressHandler(BfButton *btn, BfButton::press_pattern_t pattern)
 {
-  // if a WiFi setup AP was started, reboot is required to clear routes
-  bool wifiWebServerStarted = false;
-  wifiManager.setWebServerCallback([&wifiWebServerStarted]() { wifiWebServerStarted = true; });
-
-  wifiManager.setHostname(WIFI_HOSTNAME);
-
-#if defined(IP_ADDRESS) && defined(GWY) && defined(SUBNET) && defined(DNS1)
-  auto ip = IPAddress();
-  ip.fromString(IP_ADDRESS);
-
-  auto gwy = IPAddress();
-  gwy.fromString(GWY);
-
-  auto subnet = IPAddress();
-  subnet.fromString(SUBNET);
-
-  auto dns = IPAddress();
-  dns.fromString(DNS1);
-
-  wifiManager.setSTAStaticIPConfig(ip, gwy, subnet, dns);
-#endif
-
-  wifiManager.setConnectRetries(10);
-  wifiManager.setConnectTimeout(10);
-  wifiManager.setConfigPortalTimeout(180);
-  wifiManager.setWiFiAutoReconnect(true);
-  wifiManager.autoConnect(WIFI_MANAGER_SSID);
-
-#ifdef ESP32
-  if (MDNS.begin(WIFI_HOSTNAME))
-  {
-    MDNS.addService("http", "tcp", 80);
-    MDNS.setInstanceName(WIFI_HOSTNAME);
-  }
-  else
-  {
-    Serial.println("Could not start mDNS!");
-  }
-#endif
-
-  if (wifiWebServerStarted)
+  // any press only wakes a blanked display
+  if (Power.isStandby())
   {
-    // Reboot required, otherwise wifiManager server interferes with our server
-    Serial.println("Done running WiFi Manager webserver - rebooting");
-    ESP.restart();
+    Power.wake();
+    return;
   }
 
-  lastConnectionAttempt = millis();
-}
-
-void pressHandler(BfButton *btn, BfButton::press_pattern_t pattern)
-{
   switch (pattern)
   {
   case BfButton::SINGLE_PRESS:
@@ -174,6 +121,33 @@ void pressHandler(BfButton *btn, BfButton::press_pattern_t pattern)
   }
 }
 
+#ifdef ESP32
+TaskHandle_t screenDrawingTaskHandle = NULL;
+
+// Created by baseSetup() once the settings are loaded: the panel refreshes while storage and
+// plugins come up, and shows the persisted plugin's first frame as soon as it is active
+void screenDrawingTask(void *parameter)
+{
+  Screen.setup();
+  markBootStage("display");
+
+  while (!pluginManager.runActivePlugin())
+  {
+    vTaskDelay(1);
+  }
+  Screen.commitFrame();
+  markBootStage("first-frame");
+
+  for (;;)
+  {
+    Power.parkRenderTask();
+    pluginManager.runActivePlugin();
+    Screen.commitFrame();
+    vTaskDelay(1);
+  }
+}
+#endif
+
 void baseSetup()
 {
   Serial.begin(115200);
@@ -217,31 +191,39 @@ void baseSetup()
   pinMode(PIN_CLOCK, OUTPUT);
   pinMode(PIN_DATA, OUTPUT);
   pinMode(PIN_ENABLE, OUTPUT);
+  markBootStage("pins");
 
 #if !defined(ESP32) && !defined(ESP8266)
   Screen.setup();
 #endif
 
+  // Load all persisted settings once; config, screen and plugins read the shadow
+  Settings.begin();
+
   // Initialize configuration system (always safe)
   config.begin();
+  Power.begin();
+  markBootStage("settings");
 
-// server
-#ifdef ENABLE_SERVER
-  connectToWiFi();
+#ifdef ESP32
+  // Screen.setup() only needs the settings; mounting storage (a format on first boot) and
+  // registering plugins happen while the panel already runs
+  xTaskCreatePinnedToCore(screenDrawingTask,
+                          "screenDrawingTask",
+                          16384,
+                          NULL,
+                          1,
+                          &screenDrawingTaskHandle,
+                          0);
+#endif
 
-  // set time server using config values
-  // NTP server name must persist - sntp_setservername stores the pointer, not a copy
-  static char ntpServerBuf[100];
-  static char tzInfoBuf[100];
-  strncpy(ntpServerBuf, config.getNtpServer().c_str(), sizeof(ntpServerBuf) - 1);
-  ntpServerBuf[sizeof(ntpServerBuf) - 1] = '\0';
-  strncpy(tzInfoBuf, config.getTzInfo().c_str(), sizeof(tzInfoBuf) - 1);
-  tzInfoBuf[sizeof(tzInfoBuf) - 1] = '\0';
-  configTzTime(tzInfoBuf, ntpServerBuf);
+  // Mount the animation filesystem before any task can touch it
+  AnimationStore.begin();
+  markBootStage("storage");
 
-  initOTA(server);
-  initWebsocketServer(server);
-  initWebServer();
+#ifdef ENABLE_SERVER
+  // Weather requests run in their own task and wait for WiFi, plugins only read the cache
+  FetchService.begin();
 #endif
 
   pluginManager.addPlugin(new DrawPlugin());
@@ -298,36 +280,57 @@ void baseSetup()
   pluginManager.addPlugin(new ArtNetPlugin());
 #endif
 
-  Screen.clear();
+  markBootStage("plugins");
+
   pluginManager.init();
   Scheduler.init();
+  markBootStage("plugin-setup");
 
   btn.onPress(pressHandler).onDoublePress(pressHandler).onPressFor(pressHandler, 1000);
 }
 
+#ifdef ENABLE_SERVER
+// Network bring-up, runs after the display is already showing the persisted plugin
+void networkSetup()
+{
+  // Only configures the station, connecting happens in Connection.update()
+  Connection.begin();
+
+  // set time server using config values
+  // NTP server name must persist - sntp_setservername stores the pointer, not a copy
+  static char ntpServerBuf[100];
+  static char tzInfoBuf[100];
+  strncpy(ntpServerBuf, config.getNtpServer().c_str(), sizeof(ntpServerBuf) - 1);
+  ntpServerBuf[sizeof(ntpServerBuf) - 1] = '\0';
+  strncpy(tzInfoBuf, config.getTzInfo().c_str(), sizeof(tzInfoBuf) - 1);
+  tzInfoBuf[sizeof(tzInfoBuf) - 1] = '\0';
 #ifdef ESP32
-TaskHandle_t screenDrawingTaskHandle = NULL;
+  sntp_set_time_sync_notification_cb([](struct timeval *tv) {
+    static bool first = true;
+    if (first)
+    {
+      first = false;
+      markBootStage("time-sync");
+    }
+  });
+#endif
+  configTzTime(tzInfoBuf, ntpServerBuf);
 
-void screenDrawingTask(void *parameter)
-{
-  Screen.setup();
-  for (;;)
-  {
-    pluginManager.runActivePlugin();
-    vTaskDelay(1);
-  }
+  initOTA(server);
+  initWebsocketServer(server);
+  initWebServer();
+  markBootStage("web");
 }
+#endif
 
+#ifdef ESP32
 void setup()
 {
   baseSetup();
-  xTaskCreatePinnedToCore(screenDrawingTask,
-                          "screenDrawingTask",
-                          16384,
-                          NULL,
-                          1,
-                          &screenDrawingTaskHandle,
-                          0);
+
+#ifdef ENABLE_SERVER
+  networkSetup();
+#endif
 }
 #endif
 #ifdef ESP8266
@@ -335,12 +338,16 @@ void screenDrawingTask()
 {
   Screen.setup();
   pluginManager.runActivePlugin();
+  Screen.commitFrame();
   yield();
 }
 
 void setup()
 {
   baseSetup();
+#ifdef ENABLE_SERVER
+  networkSetup();
+#endif
   Scheduler.start();
 }
 #endif
@@ -357,9 +364,14 @@ void loop()
 
 #if !defined(ESP32) && !defined(ESP8266)
   pluginManager.runActivePlugin();
+  Screen.commitFrame();
 #endif
 
-  if (currentStatus == NONE)
+  Power.update();
+  pluginManager.checkBudget();
+  HeapStats.update();
+
+  if (currentStatus == NONE && !Power.isStandby())
   {
     Scheduler.update();
 
@@ -369,29 +381,10 @@ void loop()
     }
   }
 
-  // Check WiFi less frequently with exponential backoff
-  if (WiFi.status() != WL_CONNECTED)
-  {
-    unsigned long currentMillis = millis();
-    if (currentMillis - lastConnectionAttempt >= reconnectionBackoff)
-    {
-      Serial.println("WiFi disconnected, attempting reconnection...");
-      connectToWiFi();
-
-      // Exponential backoff: double the wait time, up to max
-      reconnectionAttempts++;
-      reconnectionBackoff = min(reconnectionBackoff * 2, maxReconnectionBackoff);
-    }
-  }
-  else
-  {
-    if (reconnectionAttempts > 0)
-    {
-      Serial.println("WiFi reconnected successfully");
-      reconnectionAttempts = 0;
-      reconnectionBackoff = 5000;
-    }
-  }
+#ifdef ENABLE_SERVER
+  // Never blocks: association, DHCP and retries are driven by WiFi events and timers
+  Connection.update();
+#endif
 
   taskCounter++;
   if (taskCounter > 16)
@@ -401,9 +394,16 @@ void loop()
 
 #ifdef ENABLE_SERVER
   cleanUpClients();
+#ifndef ESP32
+  FetchService.processPending();
+#endif
+#endif
+#ifndef ESP32
+  Settings.update();
 #endif
 #ifdef ESP32
-  vTaskDelay(1);
+  // in standby only the button and the network need attention, let the CPU idle longer
+  vTaskDelay(Power.isStandby() ? pdMS_TO_TICKS(20) : 1);
 #else
   delay(1);
 #endif
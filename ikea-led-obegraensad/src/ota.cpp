@@ -1,4 +1,5 @@
 #include "ota.h"
+#include "settings.h"
 
 #ifdef ENABLE_SERVER
 
@@ -12,6 +13,9 @@ void onOTAStart()
   Serial.println("OTA update started!");
   currentStatus = UPDATE;
 
+  // The device reboots right after the update, nothing may be left unwritten
+  Settings.flush();
+
   Screen.clear();
   std::vector<int> bits = Screen.readBytes(letterU);
 
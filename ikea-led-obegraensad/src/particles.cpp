@@ -0,0 +1,365 @@
+#include "particles.h"
+
+// sin(2 * pi * i / 64) * 127
+static const int8_t SINE[64] PROGMEM = {
+    0, 12, 25, 37, 49, 60, 71, 81, 90, 98, 106, 112, 117, 122, 125, 126,
+    127, 126, 125, 122, 117, 112, 106, 98, 90, 81, 71, 60, 49, 37, 25, 12,
+    0, -12, -25, -37, -49, -60, -71, -81, -90, -98, -106, -112, -117, -122, -125, -126,
+    -127, -126, -125, -122, -117, -112, -106, -98, -90, -81, -71, -60, -49, -37, -25, -12,
+};
+
+static inline void addPixel(uint8_t *pixel, uint8_t value)
+{
+  uint16_t sum = *pixel + value;
+  *pixel = sum > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : sum;
+}
+
+static uint16_t squareRoot(uint32_t value)
+{
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+  while (bit)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+ParticleSystem::ParticleSystem(int16_t *x,
+                               int16_t *y,
+                               int16_t *vx,
+                               int16_t *vy,
+                               uint16_t *phase,
+                               uint16_t *rate,
+                               uint8_t *brightness,
+                               uint8_t *size,
+                               uint16_t capacity)
+    : x(x), y(y), vx(vx), vy(vy), phase(phase), rate(rate), brightness(brightness), size(size),
+      capacity(capacity)
+{
+}
+
+void ParticleSystem::setGravity(int16_t gx, int16_t gy)
+{
+  gravityX = gx;
+  gravityY = gy;
+}
+
+void ParticleSystem::setDrag(uint8_t shift)
+{
+  dragShift = shift;
+}
+
+void ParticleSystem::setWobble(int16_t amount)
+{
+  wobble = amount;
+}
+
+void ParticleSystem::setEdge(ParticleEdge mode, uint8_t marginPixels)
+{
+  edge = mode;
+  margin = marginPixels * PARTICLE_ONE;
+}
+
+void ParticleSystem::setFade(ParticleFade curve, bool loop)
+{
+  fade = curve;
+  looping = loop;
+}
+
+void ParticleSystem::setShape(ParticleShape newShape, int16_t width)
+{
+  shape = newShape;
+  ringWidth = width > 0 ? width : 1;
+}
+
+void ParticleSystem::clear()
+{
+  count = 0;
+  rng.seed(micros());
+}
+
+bool ParticleSystem::emit(const ParticleEmitter &emitter)
+{
+  if (count >= capacity)
+  {
+    return false;
+  }
+
+  uint16_t i = count++;
+  x[i] = emitter.x + rng.between(-emitter.spreadX, emitter.spreadX + 1);
+  y[i] = emitter.y + rng.between(-emitter.spreadY, emitter.spreadY + 1);
+  vx[i] = emitter.vx + rng.between(-emitter.jitterX, emitter.jitterX + 1);
+  vy[i] = emitter.vy + rng.between(-emitter.jitterY, emitter.jitterY + 1);
+
+  if (emitter.radialMax > 0)
+  {
+    int32_t speed = rng.between(emitter.radialMin, emitter.radialMax + 1);
+    uint8_t angle = rng.below(64);
+    vx[i] += speed * (int8_t)pgm_read_byte(&SINE[(angle + 16) & 63]) >> 7;
+    vy[i] += speed * (int8_t)pgm_read_byte(&SINE[angle]) >> 7;
+  }
+
+  uint16_t life = emitter.lifeMin + rng.below(emitter.lifeMax - emitter.lifeMin + 1);
+  // looping particles start anywhere in their cycle so they do not pulse in step
+  phase[i] = looping ? rng.next() : 0;
+  rate[i] = life == 0 ? 0 : (life == 1 ? 0xffff : 0x10000UL / life);
+  brightness[i] = rng.between(emitter.brightnessMin, emitter.brightnessMax + 1);
+  size[i] = rng.between(emitter.sizeMin, emitter.sizeMax + 1);
+  return true;
+}
+
+uint16_t ParticleSystem::emit(const ParticleEmitter &emitter, uint16_t amount)
+{
+  uint16_t emitted = 0;
+  while (emitted < amount && emit(emitter))
+  {
+    emitted++;
+  }
+  return emitted;
+}
+
+void ParticleSystem::kill(uint16_t index)
+{
+  // keep the live particles packed: the last one takes the free slot
+  uint16_t last = --count;
+  x[index] = x[last];
+  y[index] = y[last];
+  vx[index] = vx[last];
+  vy[index] = vy[last];
+  phase[index] = phase[last];
+  rate[index] = rate[last];
+  brightness[index] = brightness[last];
+  size[index] = size[last];
+}
+
+bool ParticleSystem::applyEdge(uint16_t i)
+{
+  constexpr int16_t MAX_X = (COLS - 1) * PARTICLE_ONE;
+  constexpr int16_t MAX_Y = (ROWS - 1) * PARTICLE_ONE;
+  constexpr int16_t WIDTH = COLS * PARTICLE_ONE;
+  constexpr int16_t HEIGHT = ROWS * PARTICLE_ONE;
+
+  switch (edge)
+  {
+  case EDGE_KILL:
+    return !((x[i] < -margin && vx[i] <= 0) || (x[i] >= WIDTH + margin && vx[i] >= 0) ||
+             (y[i] < -margin && vy[i] <= 0) || (y[i] >= HEIGHT + margin && vy[i] >= 0));
+
+  case EDGE_BOUNCE:
+    if (x[i] < 0 || x[i] > MAX_X)
+    {
+      x[i] = x[i] < 0 ? 0 : MAX_X;
+      vx[i] = -vx[i];
+    }
+    if (y[i] < 0 || y[i] > MAX_Y)
+    {
+      y[i] = y[i] < 0 ? 0 : MAX_Y;
+      vy[i] = -vy[i];
+    }
+    return true;
+
+  case EDGE_WRAP:
+    x[i] = ((x[i] % WIDTH) + WIDTH) % WIDTH;
+    y[i] = ((y[i] % HEIGHT) + HEIGHT) % HEIGHT;
+    return true;
+
+  default:
+    return true;
+  }
+}
+
+void ParticleSystem::update()
+{
+  for (uint16_t i = 0; i < count;)
+  {
+    if (rate[i])
+    {
+      uint32_t next = (uint32_t)phase[i] + rate[i];
+      if (next > 0xffff)
+      {
+        if (!looping)
+        {
+          kill(i);
+          continue;
+        }
+        next &= 0xffff;
+      }
+      phase[i] = next;
+    }
+
+    vx[i] += gravityX;
+    vy[i] += gravityY;
+    if (dragShift)
+    {
+      vx[i] -= vx[i] >> dragShift;
+      vy[i] -= vy[i] >> dragShift;
+    }
+
+    x[i] += vx[i];
+    y[i] += vy[i];
+    if (wobble)
+    {
+      x[i] += rng.between(-wobble, wobble + 1);
+      y[i] += rng.between(-wobble, wobble + 1);
+    }
+
+    if (!applyEdge(i))
+    {
+      kill(i);
+      continue;
+    }
+    i++;
+  }
+}
+
+uint8_t ParticleSystem::getBrightness(uint16_t i) const
+{
+  uint16_t value = brightness[i];
+  uint16_t progress = phase[i] >> 8;
+  uint16_t triangle = progress < 128 ? progress * 2 : (255 - progress) * 2;
+
+  switch (fade)
+  {
+  case FADE_LINEAR:
+    return value * (256 - progress) >> 8;
+  case FADE_EASE_OUT:
+    return (uint32_t)value * (256 - progress) * (256 - progress) >> 16;
+  case FADE_TWINKLE:
+    return value * (triangle + 1) >> 8;
+  case FADE_PULSE:
+    return value * (102 + (triangle * 154 >> 8)) >> 8;
+  default:
+    return value;
+  }
+}
+
+void ParticleSystem::drawPoint(uint8_t *buffer, int16_t px, int16_t py, uint8_t value) const
+{
+  if (shape == SHAPE_POINT)
+  {
+    int16_t column = (px + PARTICLE_ONE / 2) >> 8;
+    int16_t row = (py + PARTICLE_ONE / 2) >> 8;
+    if (column >= 0 && column < COLS && row >= 0 && row < ROWS)
+    {
+      addPixel(&buffer[row * COLS + column], value);
+    }
+    return;
+  }
+
+  // bilinear splat: the fractional part decides how the value is shared by four pixels
+  int16_t column = px >> 8;
+  int16_t row = py >> 8;
+  uint16_t fx = px & 0xff;
+  uint16_t fy = py & 0xff;
+  uint16_t weights[4] = {
+      (uint16_t)((256 - fx) * (256 - fy) >> 8),
+      (uint16_t)(fx * (256 - fy) >> 8),
+      (uint16_t)((256 - fx) * fy >> 8),
+      (uint16_t)(fx * fy >> 8),
+  };
+
+  for (uint8_t corner = 0; corner < 4; corner++)
+  {
+    int16_t cx = column + (corner & 1);
+    int16_t cy = row + (corner >> 1);
+    if (cx >= 0 && cx < COLS && cy >= 0 && cy < ROWS)
+    {
+      addPixel(&buffer[cy * COLS + cx], value * weights[corner] >> 8);
+    }
+  }
+}
+
+void ParticleSystem::drawRing(uint8_t *buffer, uint16_t i, uint8_t value) const
+{
+  int32_t radius = (int32_t)size[i] * (phase[i] >> 8);
+  int32_t reach = radius + ringWidth;
+
+  int32_t left = (x[i] - reach) >> 8;
+  int32_t right = (x[i] + reach) >> 8;
+  int32_t top = (y[i] - reach) >> 8;
+  int32_t bottom = (y[i] + reach) >> 8;
+  left = left < 0 ? 0 : left;
+  right = right >= COLS ? COLS - 1 : right;
+  top = top < 0 ? 0 : top;
+  bottom = bottom >= ROWS ? ROWS - 1 : bottom;
+
+  for (int32_t row = top; row <= bottom; row++)
+  {
+    int32_t dy = (row << 8) - y[i];
+    for (int32_t column = left; column <= right; column++)
+    {
+      int32_t dx = (column << 8) - x[i];
+      int32_t distance = squareRoot(dx * dx + dy * dy);
+      int32_t delta = distance > radius ? distance - radius : radius - distance;
+      if (delta < ringWidth)
+      {
+        addPixel(&buffer[row * COLS + column], value * (ringWidth - delta) / ringWidth);
+      }
+    }
+  }
+}
+
+void ParticleSystem::draw(Canvas &canvas) const
+{
+  uint8_t *buffer = canvas.getRenderBuffer();
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    uint8_t value = getBrightness(i);
+    if (!value)
+    {
+      continue;
+    }
+
+    if (shape == SHAPE_RING)
+    {
+      drawRing(buffer, i, value);
+      continue;
+    }
+
+    drawPoint(buffer, x[i], y[i], value);
+
+    // trail where the particle was in the last frames, dimmer with age
+    int16_t px = x[i];
+    int16_t py = y[i];
+    uint8_t step = value / (size[i] + 1);
+    for (uint8_t t = 1; t <= size[i]; t++)
+    {
+      px -= vx[i];
+      py -= vy[i];
+      drawPoint(buffer, px, py, value - step * t);
+    }
+  }
+}
+
+void fadeScreen(Canvas &canvas, uint8_t amount)
+{
+  uint8_t *buffer = canvas.getRenderBuffer();
+  for (uint16_t i = 0; i < ROWS * COLS; i++)
+  {
+    buffer[i] = buffer[i] > amount ? buffer[i] - amount : 0;
+  }
+}
+
+void dimScreen(Canvas &canvas, uint8_t scale)
+{
+  uint8_t *buffer = canvas.getRenderBuffer();
+  for (uint16_t i = 0; i < ROWS * COLS; i++)
+  {
+    buffer[i] = buffer[i] * scale >> 8;
+  }
+}
@@ -1,82 +1,140 @@
 #include "plugins/AnimationPlugin.h"
 
+#include <new>
+
+void AnimationPlugin::showPlaceholder()
+{
+  canvas->clear();
+  canvas->setPixel(7, 4, 1);
+  canvas->setPixel(8, 4, 1);
+  canvas->setPixel(7, 5, 1);
+  canvas->setPixel(8, 5, 1);
+  canvas->setPixel(7, 6, 1);
+  canvas->setPixel(8, 6, 1);
+  canvas->setPixel(7, 7, 1);
+  canvas->setPixel(8, 7, 1);
+  canvas->setPixel(7, 8, 1);
+  canvas->setPixel(8, 8, 1);
+
+  canvas->setPixel(7, 10, 1);
+  canvas->setPixel(8, 10, 1);
+  canvas->setPixel(7, 11, 1);
+  canvas->setPixel(8, 11, 1);
+}
+
 void AnimationPlugin::setup()
 {
-  this->step = 0;
-  if (customAnimationFrames.size() == 0)
+  frameDelay = 0;
+  lastFrame = millis();
+
+  if (!reader.open())
   {
-    Screen.setPixel(7, 4, 1);
-    Screen.setPixel(8, 4, 1);
-    Screen.setPixel(7, 5, 1);
-    Screen.setPixel(8, 5, 1);
-    Screen.setPixel(7, 6, 1);
-    Screen.setPixel(8, 6, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(8, 7, 1);
-    Screen.setPixel(7, 8, 1);
-    Screen.setPixel(8, 8, 1);
-
-    Screen.setPixel(7, 10, 1);
-    Screen.setPixel(8, 10, 1);
-    Screen.setPixel(7, 11, 1);
-    Screen.setPixel(8, 11, 1);
+    showPlaceholder();
   }
 }
 
-void AnimationPlugin::loop()
+void AnimationPlugin::storePendingUpload()
 {
-  int size = customAnimationFrames.size();
-
-  if (size > 0)
+  AnimationWriter *writer = new (std::nothrow) AnimationWriter();
+  if (writer && writer->begin(1, pendingDelay))
   {
-    std::vector<int> bits = Screen.readBytes(customAnimationFrames[this->step]);
-
-    for (int i = 0; i < bits.size(); i++)
+    uint8_t pixels[ROWS * COLS];
+    bool written = true;
+    for (uint16_t i = 0; i < pendingCount && written; i++)
     {
-      Screen.setPixelAtIndex(i, bits[i]);
+      // a legacy screen is a packed 1 bit plane, same layout as the container's
+      unpackAnimationPlane(pendingScreens + i * (ROWS * COLS / 8), 1, pixels);
+      written = writer->addFrame(pixels);
     }
 
-    this->step++;
-
-    if (this->step >= size)
+    // the player picks the new container up on its next frame
+    if (written)
     {
-      this->step = 0;
+      writer->commit();
     }
-#ifdef ESP32
-    vTaskDelay(pdMS_TO_TICKS(frameDelay));
-#else
-    delay(frameDelay);
-#endif
   }
+  delete writer;
+
+  free(pendingScreens);
+  pendingScreens = nullptr;
+  pendingUpload = false;
+}
+
+void AnimationPlugin::loop()
+{
+  if (pendingUpload)
+  {
+    storePendingUpload();
+    frameDelay = 0;
+  }
+
+  if (millis() - lastFrame < frameDelay)
+  {
+    return;
+  }
+
+  // frames are streamed from flash one at a time, the reader reopens by itself after an upload
+  // or a clear
+  if (reader.nextFrame(frame, frameDelay))
+  {
+    canvas->setRenderBuffer(frame, true);
+  }
+  else
+  {
+    showPlaceholder();
+    frameDelay = 500;
+  }
+  lastFrame = millis();
+}
+
+void AnimationPlugin::teardown()
+{
+  reader.close();
 }
 
 void AnimationPlugin::websocketHook(JsonDocument &request)
 {
   const char *event = request["event"];
+  // runs on the network task: only hand the data over, loop() writes flash and draws
   if (!strcmp(event, "upload"))
   {
-    int size = (int)request["screens"];
-    if (request["frameDelay"].is<int>())
+    if (pendingUpload)
+    {
+      Serial.println("[AnimationPlugin] Previous upload not stored yet, ignoring");
+      return;
+    }
+
+    // Legacy JSON upload: 1-bit frames as 32 bytes each
+    int size = request["screens"].as<int>();
+    int delay = request["frameDelay"] | 400;
+    size = constrain(size, 0, (int)UINT16_MAX);
+    delay = constrain(delay, 10, 10000);
+
+    const size_t screenSize = ROWS * COLS / 8;
+    uint8_t *screens = static_cast<uint8_t *>(malloc(size * screenSize));
+    if (size == 0 || !screens)
     {
-      frameDelay = request["frameDelay"].as<int>();
-      if (frameDelay < 10)
-        frameDelay = 10;
-      if (frameDelay > 10000)
-        frameDelay = 10000;
+      free(screens);
+      return;
     }
 
-    customAnimationFrames.resize(size);
     for (int i = 0; i < size; i++)
     {
-      for (int k = 0; k < 32; k++)
+      for (size_t k = 0; k < screenSize; k++)
       {
-        if (k == 0)
-        {
-          customAnimationFrames[i].resize(32);
-        }
-        customAnimationFrames[i][k] = (int)request["data"][i][k];
+        screens[i * screenSize + k] = request["data"][i][k].as<uint8_t>();
       }
     }
+
+    pendingScreens = screens;
+    pendingCount = size;
+    pendingDelay = delay;
+    pendingUpload = true;
+  }
+  else if (!strcmp(event, "clear-animation"))
+  {
+    // the reader notices the removal and loop() shows the placeholder
+    AnimationStore.remove();
   }
 }
 
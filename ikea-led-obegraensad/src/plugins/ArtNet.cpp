@@ -1,7 +1,10 @@
 #include "plugins/ArtNet.h"
 
+ArtNetPlugin *ArtNetPlugin::instance = nullptr;
+
 void ArtNetPlugin::setup()
 {
+  instance = this;
   artnet.begin();
   artnet.setArtDmxCallback(onDmxFrame);
   Serial.print("ArtNet server listening at IP: ");
@@ -31,11 +34,11 @@ void ArtNetPlugin::onDmxFrame(uint16_t universe, uint16_t length, uint16_t outgo
 {
   Serial.print("Universe: ");
   Serial.println(universe);
-  if (universe == 0 || universe == outgoing)
+  if (instance && (universe == 0 || universe == outgoing))
   {
     for (int i = 0; i < ROWS * COLS; i++)
     {
-      Screen.setPixelAtIndex(i, data[i] > 4, data[i]);
+      instance->canvas->setPixelAtIndex(i, data[i] > 4, data[i]);
     }
   }
 }
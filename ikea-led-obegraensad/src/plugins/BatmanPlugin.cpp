@@ -1,88 +1,9 @@
 #include "plugins/BatmanPlugin.h"
 #include "screen.h"
+#include "sprite.h"
+#include "sprites/batman.h"
 #include <math.h>
 
-// Brightness levels for sprite data
-#define B_ 0
-#define B1 45
-#define B2 90
-#define B3 140
-#define B4 200
-#define B5 255
-
-// Batman standing pose A - cape symmetric
-// 16x16, each byte = pixel brightness
-static const uint8_t BATMAN_A[256] PROGMEM = {
-    // Row 0: empty
-    B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_,
-    // Row 1: ear tips
-    B_, B_, B_, B_, B_, B1, B_, B_, B_, B_, B1, B_, B_, B_, B_, B_,
-    // Row 2: ears
-    B_, B_, B_, B_, B1, B2, B1, B_, B_, B1, B2, B1, B_, B_, B_, B_,
-    // Row 3: cowl
-    B_, B_, B_, B_, B2, B3, B3, B3, B3, B3, B3, B2, B_, B_, B_, B_,
-    // Row 4: eyes + face
-    B_, B_, B_, B_, B2, B5, B1, B3, B1, B5, B2, B_, B_, B_, B_, B_,
-    // Row 5: lower face
-    B_, B_, B_, B_, B_, B2, B3, B4, B3, B2, B_, B_, B_, B_, B_, B_,
-    // Row 6: shoulders
-    B_, B_, B_, B_, B2, B3, B4, B4, B4, B3, B2, B_, B_, B_, B_, B_,
-    // Row 7: chest + bat logo center
-    B_, B_, B_, B1, B2, B3, B2, B5, B2, B3, B2, B1, B_, B_, B_, B_,
-    // Row 8: torso + cape start
-    B_, B_, B1, B1, B_, B3, B4, B4, B4, B3, B_, B1, B1, B_, B_, B_,
-    // Row 9: torso + cape
-    B_, B1, B1, B_, B_, B3, B4, B4, B4, B3, B_, B_, B1, B1, B_, B_,
-    // Row 10: belt (bright!)
-    B_, B1, B1, B_, B_, B5, B5, B5, B5, B5, B_, B_, B1, B1, B_, B_,
-    // Row 11: legs + cape
-    B1, B1, B_, B_, B_, B2, B3, B_, B3, B2, B_, B_, B_, B1, B1, B_,
-    // Row 12: legs
-    B1, B_, B_, B_, B_, B2, B3, B_, B3, B2, B_, B_, B_, B_, B1, B_,
-    // Row 13: boots + cape
-    B1, B1, B_, B_, B2, B3, B3, B_, B3, B3, B2, B_, B_, B1, B1, B_,
-    // Row 14: cape bottom
-    B_, B1, B1, B1, B1, B1, B_, B_, B_, B1, B1, B1, B1, B1, B_, B_,
-    // Row 15: empty
-    B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_,
-};
-
-// Batman standing pose B - cape blown right
-static const uint8_t BATMAN_B[256] PROGMEM = {
-    // Rows 0-7: same as A
-    B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_,
-    B_, B_, B_, B_, B_, B1, B_, B_, B_, B_, B1, B_, B_, B_, B_, B_,
-    B_, B_, B_, B_, B1, B2, B1, B_, B_, B1, B2, B1, B_, B_, B_, B_,
-    B_, B_, B_, B_, B2, B3, B3, B3, B3, B3, B3, B2, B_, B_, B_, B_,
-    B_, B_, B_, B_, B2, B5, B1, B3, B1, B5, B2, B_, B_, B_, B_, B_,
-    B_, B_, B_, B_, B_, B2, B3, B4, B3, B2, B_, B_, B_, B_, B_, B_,
-    B_, B_, B_, B_, B2, B3, B4, B4, B4, B3, B2, B_, B_, B_, B_, B_,
-    B_, B_, B_, B1, B2, B3, B2, B5, B2, B3, B2, B1, B_, B_, B_, B_,
-    // Row 8: cape shifts right
-    B_, B_, B_, B1, B_, B3, B4, B4, B4, B3, B_, B1, B1, B1, B_, B_,
-    // Row 9: right cape extends
-    B_, B_, B1, B_, B_, B3, B4, B4, B4, B3, B_, B_, B1, B1, B1, B_,
-    // Row 10: belt + cape right
-    B_, B_, B1, B_, B_, B5, B5, B5, B5, B5, B_, B_, B1, B1, B1, B_,
-    // Row 11: legs + cape blown right
-    B_, B1, B_, B_, B_, B2, B3, B_, B3, B2, B_, B_, B_, B1, B1, B1,
-    // Row 12: legs + right cape
-    B_, B_, B_, B_, B_, B2, B3, B_, B3, B2, B_, B_, B_, B1, B1, B_,
-    // Row 13: boots + cape right
-    B_, B1, B_, B_, B2, B3, B3, B_, B3, B3, B2, B_, B1, B1, B_, B_,
-    // Row 14: cape bottom shifted right
-    B_, B_, B1, B1, B1, B1, B_, B_, B_, B1, B1, B1, B1, B_, B_, B_,
-    // Row 15
-    B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_, B_,
-};
-
-#undef B_
-#undef B1
-#undef B2
-#undef B3
-#undef B4
-#undef B5
-
 // Bat signal mask: 1 = bat shape (darker), bit15 = x=0
 static const uint16_t BAT_MASK[16] PROGMEM = {
     0x0000, // 0
@@ -114,28 +35,6 @@ static const int8_t DROP_Y[12] PROGMEM = {
 // Cape animation sequence: 0=pose A, 1=pose B, 2=pose B mirrored
 static const uint8_t CAPE_SEQ[4] = {0, 1, 0, 2};
 
-void BatmanPlugin::drawBatmanFrame(const uint8_t *frame, int yOff,
-                                   uint8_t scale, bool mirror)
-{
-  for (int y = 0; y < 16; y++)
-  {
-    int sy = y + yOff;
-    if (sy < 0 || sy >= 16)
-      continue;
-    for (int x = 0; x < 16; x++)
-    {
-      int srcX = mirror ? (15 - x) : x;
-      uint8_t b = pgm_read_byte(&frame[y * 16 + srcX]);
-      if (b > 0)
-      {
-        int scaled = ((int)b * scale) >> 8;
-        if (scaled > 0)
-          Screen.setPixel(x, sy, 1, (uint8_t)(scaled > 255 ? 255 : scaled));
-      }
-    }
-  }
-}
-
 void BatmanPlugin::drawBatSignal(float pulse, float fade)
 {
   float cx = 7.5f, cy = 5.5f;
@@ -163,9 +62,9 @@ void BatmanPlugin::drawBatSignal(float pulse, float fade)
 
       int bright = (int)raw;
       if (bright > 1 && bright <= 255)
-        Screen.setPixel(x, y, 1, (uint8_t)bright);
+        canvas->setPixel(x, y, 1, (uint8_t)bright);
       else if (bright > 255)
-        Screen.setPixel(x, y, 1, 255);
+        canvas->setPixel(x, y, 1, 255);
     }
   }
 }
@@ -182,14 +81,14 @@ void BatmanPlugin::drawSkyline(uint8_t brightness)
       uint8_t b = (row == h - 1)
                       ? (uint8_t)(brightness + 15 > 255 ? 255 : brightness + 15)
                       : brightness;
-      Screen.setPixel(x, y, 1, b);
+      canvas->setPixel(x, y, 1, b);
     }
   }
 }
 
 void BatmanPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   phase = 0;
   phaseStart = millis();
   frameTimer.forceReady();
@@ -200,7 +99,7 @@ void BatmanPlugin::loop()
   if (!frameTimer.isReady(50))
     return;
 
-  Screen.clear();
+  canvas->clear();
   unsigned long elapsed = millis() - phaseStart;
 
   switch (phase)
@@ -234,13 +133,13 @@ void BatmanPlugin::loop()
     if (dropIdx > 11)
       dropIdx = 11;
     int8_t yOff = (int8_t)pgm_read_byte(&DROP_Y[dropIdx]);
-    drawBatmanFrame(BATMAN_A, yOff, 255, false);
+    drawSprite(*canvas, BATMAN, 0, 0, yOff);
 
     // Landing impact flash at ground line
     if (dropIdx >= 9 && dropIdx <= 10)
     {
       for (int x = 0; x < 16; x++)
-        Screen.setPixel(x, 15, 1, 80);
+        canvas->setPixel(x, 15, 1, 80);
     }
 
     if (elapsed > 950)
@@ -261,11 +160,11 @@ void BatmanPlugin::loop()
     uint8_t breath = 230 + (uint8_t)(25.0f * sinf(elapsed * 0.002f));
 
     if (seq == 0)
-      drawBatmanFrame(BATMAN_A, 0, breath, false);
+      drawSprite(*canvas, BATMAN, 0, 0, 0, 0, breath);
     else if (seq == 1)
-      drawBatmanFrame(BATMAN_B, 0, breath, false);
+      drawSprite(*canvas, BATMAN, 1, 0, 0, 0, breath);
     else
-      drawBatmanFrame(BATMAN_B, 0, breath, true); // mirror = cape left
+      drawSprite(*canvas, BATMAN, 1, 0, 0, SPRITE_FLIP_X, breath); // mirror = cape left
 
     if (elapsed > 7000)
     {
@@ -279,7 +178,7 @@ void BatmanPlugin::loop()
   {
     float fade = fmaxf(0.0f, 1.0f - elapsed / 1000.0f);
     uint8_t scale = (uint8_t)(255.0f * fade);
-    drawBatmanFrame(BATMAN_A, 0, scale, false);
+    drawSprite(*canvas, BATMAN, 0, 0, 0, 0, scale);
 
     if (elapsed > 1000)
     {
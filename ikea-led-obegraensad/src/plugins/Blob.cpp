@@ -13,7 +13,7 @@ BlobPlugin::BlobPlugin()
 
 void BlobPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
 
   // Initialize balls with random positions and velocities
   for (auto &b : balls)
@@ -65,7 +65,7 @@ void BlobPlugin::render()
 
       if (previousBrightness[idx] != brightness)
       {
-        Screen.setPixel(x, y, 1, brightness);
+        canvas->setPixel(x, y, 1, brightness);
         previousBrightness[idx] = brightness;
       }
     }
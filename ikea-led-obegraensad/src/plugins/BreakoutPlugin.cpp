@@ -3,48 +3,37 @@
 
 void BreakoutPlugin::initGame()
 {
-  Screen.clear();
+  canvas->clear();
 
   this->ballDelay = this->BALL_DELAY_MAX;
   this->score = 0;
   this->level = 0;
-  newLevel();
+  this->gameState = this->GAME_STATE_LEVEL;
 }
 
-void BreakoutPlugin::initBricks()
+void BreakoutPlugin::initBrick(byte i)
 {
-  this->destroyedBricks = 0;
-  for (byte i = 0; i < this->BRICK_AMOUNT; i++)
-  {
-    this->bricks[i].x = i % this->X_MAX;
-    this->bricks[i].y = i / this->X_MAX;
-    Screen.setPixelAtIndex(this->bricks[i].y * this->X_MAX + this->bricks[i].x,
-                           this->LED_TYPE_ON,
-                           50);
-
-#ifdef ESP32
-    vTaskDelay(pdMS_TO_TICKS(25));
-#else
-    delay(25);
-#endif
-  }
+  this->bricks[i].x = i % this->X_MAX;
+  this->bricks[i].y = i / this->X_MAX;
+  canvas->setPixelAtIndex(this->bricks[i].y * this->X_MAX + this->bricks[i].x,
+                         this->LED_TYPE_ON,
+                         50);
 }
 
 void BreakoutPlugin::newLevel()
 {
-  this->initBricks();
   for (byte i = 0; i < this->PADDLE_WIDTH; i++)
   {
     this->paddle[i].x = (this->X_MAX / 2) - (this->PADDLE_WIDTH / 2) + i;
     this->paddle[i].y = this->Y_MAX - 1;
-    Screen.setPixelAtIndex(this->paddle[i].y * this->X_MAX + this->paddle[i].x,
+    canvas->setPixelAtIndex(this->paddle[i].y * this->X_MAX + this->paddle[i].x,
                            this->LED_TYPE_ON,
                            50);
   }
   this->ball.x = this->paddle[1].x;
   this->ball.y = this->paddle[1].y - 1;
 
-  Screen.setPixelAtIndex(ball.y * this->X_MAX + ball.x, this->LED_TYPE_ON, 128);
+  canvas->setPixelAtIndex(ball.y * this->X_MAX + ball.x, this->LED_TYPE_ON, 128);
   this->ballMovement[0] = 1;
   this->ballMovement[1] = -1;
   this->lastBallUpdate = 0;
@@ -60,7 +49,7 @@ void BreakoutPlugin::updateBall()
     return;
   }
   this->lastBallUpdate = millis();
-  Screen.setPixelAtIndex(this->ball.y * this->X_MAX + this->ball.x, this->LED_TYPE_OFF, 100);
+  canvas->setPixelAtIndex(this->ball.y * this->X_MAX + this->ball.x, this->LED_TYPE_OFF, 100);
 
   if (this->ballMovement[1] == 1)
   {
@@ -101,7 +90,7 @@ void BreakoutPlugin::updateBall()
   this->ball.x += this->ballMovement[0];
   this->ball.y += this->ballMovement[1];
 
-  Screen.setPixelAtIndex(this->ball.y * this->X_MAX + this->ball.x, this->LED_TYPE_ON, 100);
+  canvas->setPixelAtIndex(this->ball.y * this->X_MAX + this->ball.x, this->LED_TYPE_ON, 100);
 }
 
 void BreakoutPlugin::hitBrick(byte i)
@@ -115,7 +104,7 @@ void BreakoutPlugin::hitBrick(byte i)
   {
     this->ballDelay -= this->BALL_DELAY_STEP;
   }
-  Screen.setPixelAtIndex(this->bricks[i].y * this->X_MAX + this->bricks[i].x, this->LED_TYPE_OFF);
+  canvas->setPixelAtIndex(this->bricks[i].y * this->X_MAX + this->bricks[i].x, this->LED_TYPE_OFF);
 }
 
 void BreakoutPlugin::checkPaddleCollision()
@@ -171,7 +160,8 @@ void BreakoutPlugin::updatePaddle()
   {
     for (byte i = 0; i < this->PADDLE_WIDTH; i++)
     {
-      Screen.setPixelAtIndex(this->paddle[i].y * this->X_MAX + this->paddle[i].x, this->LED_TYPE_OFF);
+      canvas->setPixelAtIndex(this->paddle[i].y * this->X_MAX + this->paddle[i].x,
+                              this->LED_TYPE_OFF);
     }
     for (byte i = 0; i < this->PADDLE_WIDTH; i++)
     {
@@ -179,7 +169,7 @@ void BreakoutPlugin::updatePaddle()
     }
     for (byte i = 0; i < this->PADDLE_WIDTH; i++)
     {
-      Screen.setPixelAtIndex(this->paddle[i].y * this->X_MAX + this->paddle[i].x, this->LED_TYPE_ON);
+      canvas->setPixelAtIndex(this->paddle[i].y * this->X_MAX + this->paddle[i].x, this->LED_TYPE_ON);
     }
   }
   else
@@ -191,34 +181,43 @@ void BreakoutPlugin::updatePaddle()
 void BreakoutPlugin::end()
 {
   this->gameState = this->GAME_STATE_END;
-  Screen.setPixelAtIndex(this->ball.y * this->X_MAX + this->ball.x, this->LED_TYPE_ON);
+  canvas->setPixelAtIndex(this->ball.y * this->X_MAX + this->ball.x, this->LED_TYPE_ON);
 }
 
 void BreakoutPlugin::setup()
 {
   this->gameState = this->GAME_STATE_END;
+  this->co.reset();
 }
 
 void BreakoutPlugin::loop()
 {
-  switch (this->gameState)
+  CO_BEGIN(co);
+  this->initGame();
+
+  while (this->gameState == this->GAME_STATE_LEVEL)
   {
-  case this->GAME_STATE_LEVEL:
+    // build the wall brick by brick
+    this->destroyedBricks = 0;
+    for (this->brickIndex = 0; this->brickIndex < this->BRICK_AMOUNT; this->brickIndex++)
+    {
+      this->initBrick(this->brickIndex);
+      CO_SLEEP(co, 25);
+    }
     this->newLevel();
-    break;
-  case this->GAME_STATE_RUNNING:
-    this->updateBall();
-    this->updatePaddle();
-#ifdef ESP32
-    vTaskDelay(pdMS_TO_TICKS(random(100, 200)));
-#else
-    delay(random(100, 200));
-#endif
-    break;
-  case this->GAME_STATE_END:
-    this->initGame();
-    break;
+
+    // updateBall() ends this with GAME_STATE_LEVEL (wall cleared) or GAME_STATE_END (ball lost)
+    while (this->gameState == this->GAME_STATE_RUNNING)
+    {
+      this->updateBall();
+      this->updatePaddle();
+      CO_SLEEP(co, random(100, 200));
+    }
   }
+  CO_END(co);
+
+  // next game
+  this->co.reset();
 }
 
 const char *BreakoutPlugin::getName() const
@@ -2,7 +2,7 @@
 
 void CheckerboardPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   offset = 0;
   inverted = false;
   phase = 0;
@@ -38,7 +38,7 @@ void CheckerboardPlugin::loop()
         brightness = 255 - phase;
       }
       
-      Screen.setPixel(x, y, 1, brightness);
+      canvas->setPixel(x, y, 1, brightness);
     }
   }
 
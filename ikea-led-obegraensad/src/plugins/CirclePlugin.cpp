@@ -10,11 +10,11 @@ void CirclePlugin::loop()
   if (!timer.isReady(200))
     return;
 
-  std::vector<int> bits = Screen.readBytes(this->frames[this->circleStep]);
+  std::vector<int> bits = canvas->readBytes(this->frames[this->circleStep]);
 
   for (int i = 0; i < bits.size(); i++)
   {
-    Screen.setPixelAtIndex(i, bits[i]);
+    canvas->setPixelAtIndex(i, bits[i]);
   }
 
   this->circleStep++;
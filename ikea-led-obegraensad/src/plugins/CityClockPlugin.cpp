@@ -1,35 +1,18 @@
 #include "plugins/CityClockPlugin.h"
 #include "config.h"
+#include "fetchservice.h"
+#include "settings.h"
 #include <ArduinoJson.h>
 
-#ifdef ESP32
-#include <HTTPClient.h>
-#include <WiFi.h>
-#include <WiFiClientSecure.h>
-#include <Preferences.h>
-#endif
-#ifdef ESP8266
-#include <ESP8266HTTPClient.h>
-#include <ESP8266WiFi.h>
-#include <WiFiClient.h>
-#endif
-
 void CityClockPlugin::loadConfig()
 {
-#ifdef ENABLE_STORAGE
-  Preferences prefs;
-  prefs.begin("cityclock", true);
-  currentCityIndex = prefs.getInt("cityIdx", 0);
-  prefs.end();
+  currentCityIndex = Settings.getInt(SETTING_CITYCLOCK_CITY);
 
   // Validate saved index
   if (currentCityIndex < 0 || currentCityIndex >= cityCount)
   {
     currentCityIndex = 0;
   }
-#else
-  currentCityIndex = 0;
-#endif
 }
 
 String CityClockPlugin::getCurrentCityName()
@@ -57,27 +40,19 @@ void CityClockPlugin::switchToCity(int index)
   Serial.println(cities[currentCityIndex].name);
 
   // Save configuration
-#ifdef ENABLE_STORAGE
-  Preferences prefs;
-  prefs.begin("cityclock", false);
-  prefs.putInt("cityIdx", currentCityIndex);
-  prefs.end();
-#endif
-
-  // Reset weather
+  Settings.setInt(SETTING_CITYCLOCK_CITY, currentCityIndex);
+
+  // Reset weather, the cache keeps the previous city so switching back is instant
   hasWeatherData = false;
-  lastWeatherUpdate = 0;
   weatherIcon = -1;
   cachedTemperature = -99;
+  updateWeather();
 
   // Reset display
   displayMode = 0;
   modeStartTime = millis();
   colonVisible = true;
   secondTimer.forceReady();
-
-  // Don't fetch weather here - let loop() handle it via lastWeatherUpdate == 0
-  // Avoids blocking HTTPS request during plugin switch (5-10 sec)
 }
 
 int CityClockPlugin::mapWmoCode(int code, bool isNight)
@@ -112,7 +87,7 @@ int CityClockPlugin::mapWmoCode(int code, bool isNight)
 
 void CityClockPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   displayMode = 0;
   modeStartTime = millis();
   colonVisible = true;
@@ -135,106 +110,44 @@ void CityClockPlugin::setup()
   Serial.printf("[CityClockPlugin] Setup: city %d (%s)\n",
                 currentCityIndex, cities[currentCityIndex].name);
 
-  // Apply timezone directly - do NOT call switchToCity() which resets weather cache.
-  // Plugin objects persist across activations (created once via new).
-  // Resetting lastWeatherUpdate=0 forces an immediate HTTPS fetch (~40KB SSL alloc).
-  // With scheduler cycling through 20+ plugins, repeated alloc/free fragments heap → crash.
-  // Weather refreshes naturally every 10 minutes via the timer in loop().
+  // Apply timezone directly - switchToCity() would persist the index again
   const char *tz = cities[currentCityIndex].timezone;
   setenv("TZ", tz, 1);
   tzset();
 
+  updateWeather();
+
   if (!hasWeatherData)
   {
     // Show loading dots only on first activation (before any weather data)
-    Screen.setPixel(4, 7, 1);
-    Screen.setPixel(5, 7, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(8, 7, 1);
-    Screen.setPixel(10, 7, 1);
-    Screen.setPixel(11, 7, 1);
+    canvas->setPixel(4, 7, 1);
+    canvas->setPixel(5, 7, 1);
+    canvas->setPixel(7, 7, 1);
+    canvas->setPixel(8, 7, 1);
+    canvas->setPixel(10, 7, 1);
+    canvas->setPixel(11, 7, 1);
   }
 }
 
-void CityClockPlugin::fetchWeather()
+void CityClockPlugin::updateWeather()
 {
-  if (WiFi.status() != WL_CONNECTED)
-  {
-    Serial.printf("[CityClock] WiFi not connected (status=%d)\n", WiFi.status());
-    return;
-  }
   if (currentCityIndex < 0 || currentCityIndex >= cityCount)
   {
-    Serial.printf("[CityClock] Invalid city index: %d\n", currentCityIndex);
     return;
   }
 
-#ifdef ESP32
-  Serial.printf("[CityClock] Heap free=%u maxAlloc=%u RSSI=%d\n",
-                ESP.getFreeHeap(), ESP.getMaxAllocHeap(), WiFi.RSSI());
-#endif
-
   // Open-Meteo API with city coordinates
   char url[200];
   snprintf(url, sizeof(url),
            "https://api.open-meteo.com/v1/forecast?latitude=%.2f&longitude=%.2f&current=temperature_2m,weather_code,is_day",
            cities[currentCityIndex].latitude, cities[currentCityIndex].longitude);
-  Serial.printf("[CityClock] GET %s\n", url);
-
-#ifdef ESP32
-  WiFiClientSecure client;
-  client.setInsecure();
-  HTTPClient http;
-  http.begin(client, url);
-#endif
-#ifdef ESP8266
-  WiFiClient wifiClient;
-  HTTPClient http;
-  http.begin(wifiClient, url);
-#endif
-
-  http.setConnectTimeout(5000);
-  http.setTimeout(10000);
-  int code = http.GET();
-
-  if (code == HTTP_CODE_OK)
-  {
-    String payload = http.getString();
-    Serial.printf("[CityClock] Payload: %s\n", payload.c_str());
-
-    JsonDocument doc;
-    DeserializationError err = deserializeJson(doc, payload);
-    if (!err)
-    {
-      float temp = doc["current"]["temperature_2m"] | -99.0f;
-      int wmoCode = doc["current"]["weather_code"] | 0;
-      int isDay = doc["current"]["is_day"] | 1;
-
-      cachedTemperature = (int)roundf(temp);
-      hasWeatherData = true;
-      weatherIcon = mapWmoCode(wmoCode, isDay == 0);
-
-      Serial.printf("[CityClock] Weather OK: %d°C wmo=%d icon=%d\n",
-                    cachedTemperature, wmoCode, weatherIcon);
-    }
-    else
-    {
-      Serial.printf("[CityClock] JSON parse error: %s\n", err.c_str());
-    }
-  }
-  else
-  {
-    Serial.printf("[CityClock] HTTP FAILED: %d (%s)\n", code, http.errorToString(code).c_str());
-  }
 
-  http.end();
-  if (code == HTTP_CODE_OK)
+  WeatherData data;
+  if (FetchService.get(FETCH_OPEN_METEO_CURRENT, url, 600000UL, data).hasData)
   {
-    lastWeatherUpdate = millis();
-  }
-  else
-  {
-    lastWeatherUpdate = millis() - 540000UL;
+    cachedTemperature = (int)roundf(data.temperature);
+    weatherIcon = mapWmoCode(data.code, !data.isDay);
+    hasWeatherData = true;
   }
 }
 
@@ -242,39 +155,39 @@ void CityClockPlugin::drawClock()
 {
   if (!getLocalTime(&timeinfo, 10) || timeinfo.tm_year < (2020 - 1900))
   {
-    Screen.drawLine(0, 0, 15, 15, 1, 128);
-    Screen.drawLine(15, 0, 0, 15, 1, 128);
+    canvas->drawLine(0, 0, 15, 15, 1, 128);
+    canvas->drawLine(15, 0, 0, 15, 1, 128);
     return;
   }
 
-  Screen.clear();
+  canvas->clear();
 
   std::vector<int> hh = {
       (timeinfo.tm_hour - timeinfo.tm_hour % 10) / 10,
       timeinfo.tm_hour % 10};
-  Screen.drawNumbers(3, 0, hh);
+  canvas->drawNumbers(3, 0, hh);
 
   if (colonVisible)
   {
-    Screen.setPixel(7, 6, 1, 180);
-    Screen.setPixel(8, 6, 1, 180);
+    canvas->setPixel(7, 6, 1, 180);
+    canvas->setPixel(8, 6, 1, 180);
   }
 
   std::vector<int> mm = {
       (timeinfo.tm_min - timeinfo.tm_min % 10) / 10,
       timeinfo.tm_min % 10};
-  Screen.drawNumbers(3, 7, mm);
+  canvas->drawNumbers(3, 7, mm);
 }
 
 void CityClockPlugin::drawTemperature()
 {
-  Screen.clear();
+  canvas->clear();
 
   if (!hasWeatherData)
   {
-    Screen.setPixel(5, 7, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(9, 7, 1);
+    canvas->setPixel(5, 7, 1);
+    canvas->setPixel(7, 7, 1);
+    canvas->setPixel(9, 7, 1);
     return;
   }
 
@@ -282,56 +195,56 @@ void CityClockPlugin::drawTemperature()
 
   if (temp >= 10)
   {
-    Screen.drawNumbers(2, 0, {temp / 10, temp % 10});
-    Screen.setPixel(13, 0, 1, 120);
-    Screen.setPixel(14, 0, 1, 120);
-    Screen.setPixel(13, 1, 1, 120);
-    Screen.setPixel(14, 1, 1, 120);
+    canvas->drawNumbers(2, 0, {temp / 10, temp % 10});
+    canvas->setPixel(13, 0, 1, 120);
+    canvas->setPixel(14, 0, 1, 120);
+    canvas->setPixel(13, 1, 1, 120);
+    canvas->setPixel(14, 1, 1, 120);
   }
   else if (temp <= -10)
   {
     // "-15°" - 2px minus + two digits + degree (centered)
     int t = -temp;
-    Screen.setPixel(0, 2, 1, 120);
-    Screen.setPixel(1, 2, 1, 120);
-    Screen.drawNumbers(3, 0, {t / 10, t % 10});
-    Screen.setPixel(13, 0, 1, 120);
-    Screen.setPixel(14, 0, 1, 120);
-    Screen.setPixel(13, 1, 1, 120);
-    Screen.setPixel(14, 1, 1, 120);
+    canvas->setPixel(0, 2, 1, 120);
+    canvas->setPixel(1, 2, 1, 120);
+    canvas->drawNumbers(3, 0, {t / 10, t % 10});
+    canvas->setPixel(13, 0, 1, 120);
+    canvas->setPixel(14, 0, 1, 120);
+    canvas->setPixel(13, 1, 1, 120);
+    canvas->setPixel(14, 1, 1, 120);
   }
   else if (temp >= 0)
   {
-    Screen.drawNumbers(4, 0, {temp});
-    Screen.setPixel(9, 0, 1, 120);
-    Screen.setPixel(10, 0, 1, 120);
-    Screen.setPixel(9, 1, 1, 120);
-    Screen.setPixel(10, 1, 1, 120);
+    canvas->drawNumbers(4, 0, {temp});
+    canvas->setPixel(9, 0, 1, 120);
+    canvas->setPixel(10, 0, 1, 120);
+    canvas->setPixel(9, 1, 1, 120);
+    canvas->setPixel(10, 1, 1, 120);
   }
   else
   {
     // "-5°" - 2px minus + single digit + degree (centered)
-    Screen.setPixel(3, 2, 1, 120);
-    Screen.setPixel(4, 2, 1, 120);
-    Screen.drawNumbers(6, 0, {-temp});
-    Screen.setPixel(11, 0, 1, 120);
-    Screen.setPixel(12, 0, 1, 120);
-    Screen.setPixel(11, 1, 1, 120);
-    Screen.setPixel(12, 1, 1, 120);
+    canvas->setPixel(3, 2, 1, 120);
+    canvas->setPixel(4, 2, 1, 120);
+    canvas->drawNumbers(6, 0, {-temp});
+    canvas->setPixel(11, 0, 1, 120);
+    canvas->setPixel(12, 0, 1, 120);
+    canvas->setPixel(11, 1, 1, 120);
+    canvas->setPixel(12, 1, 1, 120);
   }
 
   if (weatherIcon >= 0 && weatherIcon < (int)weatherIcons.size())
   {
-    Screen.drawWeather(0, 7, weatherIcon);
+    canvas->drawWeather(0, 7, weatherIcon);
   }
 }
 
 void CityClockPlugin::loop()
 {
-  // Fetch weather every 10 minutes (600000 ms)
-  if (lastWeatherUpdate == 0 || millis() - lastWeatherUpdate > 600000UL)
+  // Cached by FetchService, refreshed in the background every 10 minutes
+  if (weatherTimer.isReady(1000))
   {
-    fetchWeather();
+    updateWeather();
   }
 
   unsigned long elapsed = millis() - modeStartTime;
@@ -360,7 +273,7 @@ void CityClockPlugin::loop()
     }
     if (secondTimer.isReady(40))
     {
-      Screen.clear();
+      canvas->clear();
       String cityStr = getCurrentCityName();
       cityStr.toUpperCase();
       int fw = fonts[0].sizeX + 1;
@@ -374,8 +287,8 @@ void CityClockPlugin::loop()
           int fontIdx = cityStr.charAt(c) - fonts[0].offset;
           if (fontIdx >= 0 && fontIdx < (int)fonts[0].data.size())
           {
-            Screen.drawCharacter(xPos, 4,
-                                 Screen.readBytes(fonts[0].data[fontIdx]), 8, 180);
+            canvas->drawCharacter(xPos, 4,
+                                 canvas->readBytes(fonts[0].data[fontIdx]), 8, 180);
           }
         }
       }
@@ -407,6 +320,13 @@ void CityClockPlugin::loop()
   }
 }
 
+void CityClockPlugin::prepare()
+{
+  // starts the refresh early if the cached weather is stale
+  loadConfig();
+  updateWeather();
+}
+
 void CityClockPlugin::teardown()
 {
   // Restore previous timezone
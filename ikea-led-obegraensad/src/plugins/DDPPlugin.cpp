@@ -8,7 +8,7 @@ void DDPPlugin::setup()
   {
     Serial.print("DDP server listening at port: 4048");
 
-    udp->onPacket([](AsyncUDPPacket packet) {
+    udp->onPacket([this](AsyncUDPPacket packet) {
       if (packet.length() >= 10)
       {                                           // Basic DDP header check
         const uint8_t *data = packet.data() + 10; // Skip header
@@ -20,7 +20,7 @@ void DDPPlugin::setup()
           uint8_t brightness = (data[0] + data[1] + data[2]) / 3;
           for (int i = 0; i < ROWS * COLS; i++)
           {
-            Screen.setPixelAtIndex(i, brightness > 4, brightness);
+            canvas->setPixelAtIndex(i, brightness > 4, brightness);
           }
         }
         else
@@ -28,7 +28,7 @@ void DDPPlugin::setup()
           for (int i = 0; i < count; i++)
           {
             uint8_t brightness = (data[i * 3] + data[i * 3 + 1] + data[i * 3 + 2]) / 3;
-            Screen.setPixelAtIndex(i, brightness > 4, brightness);
+            canvas->setPixelAtIndex(i, brightness > 4, brightness);
           }
         }
       }
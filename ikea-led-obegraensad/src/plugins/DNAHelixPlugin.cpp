@@ -3,7 +3,7 @@
 
 void DNAHelixPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   offset = 0.0f;
 }
 
@@ -12,7 +12,7 @@ void DNAHelixPlugin::loop()
   if (!frameTimer.isReady(60))
     return;
 
-  Screen.clear();
+  canvas->clear();
 
   for (int y = 0; y < 16; y++)
   {
@@ -34,9 +34,9 @@ void DNAHelixPlugin::loop()
 
     // Draw strand points
     if (px1 >= 0 && px1 < 16)
-      Screen.setPixel(px1, y, 1, b1);
+      canvas->setPixel(px1, y, 1, b1);
     if (px2 >= 0 && px2 < 16)
-      Screen.setPixel(px2, y, 1, b2);
+      canvas->setPixel(px2, y, 1, b2);
 
     // Draw connecting rungs every 3 rows
     if (y % 3 == 0)
@@ -51,7 +51,7 @@ void DNAHelixPlugin::loop()
         for (int x = minX + 1; x < maxX; x++)
         {
           if (x >= 0 && x < 16)
-            Screen.setPixel(x, y, 1, rungB);
+            canvas->setPixel(x, y, 1, rungB);
         }
       }
     }
@@ -1,4 +1,6 @@
 #include "plugins/DinoPlugin.h"
+#include "sprite.h"
+#include "sprites/dino.h"
 #include <Arduino.h>
 #include <cstring>
 
@@ -8,7 +10,7 @@ static constexpr int JUMP_LEN = 13;
 
 void DinoPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   frameTimer.forceReady();
   jumpOffset = 0;
   isJumping = false;
@@ -19,84 +21,13 @@ void DinoPlugin::setup()
   spawnTimer = 10;
 }
 
-void DinoPlugin::drawDino(int bx, int by)
-{
-  // T-Rex facing right, 5 wide x 7 tall
-  // Row 0: head top   ..###
-  Screen.setPixel(bx + 2, by, 1, 220);
-  Screen.setPixel(bx + 3, by, 1, 220);
-  Screen.setPixel(bx + 4, by, 1, 220);
-  // Row 1: head       .####
-  Screen.setPixel(bx + 1, by + 1, 1, 220);
-  Screen.setPixel(bx + 2, by + 1, 1, 220);
-  Screen.setPixel(bx + 3, by + 1, 1, 220);
-  Screen.setPixel(bx + 4, by + 1, 1, 220);
-  // Row 2: neck       ..##.
-  Screen.setPixel(bx + 2, by + 2, 1, 220);
-  Screen.setPixel(bx + 3, by + 2, 1, 220);
-  // Row 3: body+tail  #####
-  Screen.setPixel(bx, by + 3, 1, 220);
-  Screen.setPixel(bx + 1, by + 3, 1, 220);
-  Screen.setPixel(bx + 2, by + 3, 1, 220);
-  Screen.setPixel(bx + 3, by + 3, 1, 220);
-  Screen.setPixel(bx + 4, by + 3, 1, 220);
-  // Row 4: body       .###.
-  Screen.setPixel(bx + 1, by + 4, 1, 220);
-  Screen.setPixel(bx + 2, by + 4, 1, 220);
-  Screen.setPixel(bx + 3, by + 4, 1, 220);
-  // Row 5: thighs     ..##.
-  Screen.setPixel(bx + 2, by + 5, 1, 220);
-  Screen.setPixel(bx + 3, by + 5, 1, 220);
-  // Row 6: feet (animated)
-  if (isJumping)
-  {
-    // Legs together when airborne
-    Screen.setPixel(bx + 2, by + 6, 1, 220);
-    Screen.setPixel(bx + 3, by + 6, 1, 220);
-  }
-  else if (runFrame == 0)
-  {
-    Screen.setPixel(bx + 1, by + 6, 1, 220);
-    Screen.setPixel(bx + 4, by + 6, 1, 220);
-  }
-  else
-  {
-    Screen.setPixel(bx + 2, by + 6, 1, 220);
-    Screen.setPixel(bx + 4, by + 6, 1, 220);
-  }
-}
-
 void DinoPlugin::drawCactus(const Cactus &c)
 {
-  int groundY = 14;
-  int top = groundY - c.h + 1;
+  // both cactus sprites are bottom-aligned to end on the ground row 14
   if (c.w == 1)
-  {
-    // Thin cactus: vertical line
-    for (int y = top; y <= groundY; y++)
-    {
-      if (c.x >= 0 && c.x < 16)
-        Screen.setPixel(c.x, y, 1, 180);
-    }
-  }
+    drawSprite(*canvas, CACTUS_THIN, c.h - 3, c.x, 10);
   else
-  {
-    // Wide cactus: stem + branches
-    for (int y = top; y <= groundY; y++)
-    {
-      if (c.x + 1 >= 0 && c.x + 1 < 16)
-        Screen.setPixel(c.x + 1, y, 1, 180); // center stem
-    }
-    // Branches at 2nd row from top
-    int branchY = top + 1;
-    if (branchY >= 0 && branchY < 16)
-    {
-      if (c.x >= 0 && c.x < 16)
-        Screen.setPixel(c.x, branchY, 1, 180);
-      if (c.x + 2 >= 0 && c.x + 2 < 16)
-        Screen.setPixel(c.x + 2, branchY, 1, 180);
-    }
-  }
+    drawSprite(*canvas, CACTUS_WIDE, 0, c.x, 12);
 }
 
 void DinoPlugin::loop()
@@ -179,17 +110,17 @@ void DinoPlugin::loop()
     runFrame = 1 - runFrame;
 
   // Draw
-  Screen.clear();
+  canvas->clear();
 
   // Ground: scrolling dotted line at row 15
   for (int x = 0; x < 16; x++)
   {
     if ((x + frameTick / 2) % 3 != 0)
-      Screen.setPixel(x, 15, 1, 60);
+      canvas->setPixel(x, 15, 1, 60);
   }
 
   // Dino at x=1, base y=8 (feet at y=14 on ground)
-  drawDino(1, 8 + jumpOffset);
+  drawSprite(*canvas, DINO, isJumping ? 2 : runFrame, 1, 8 + jumpOffset);
 
   // Cacti
   for (int i = 0; i < numCacti; i++)
@@ -2,16 +2,20 @@
 
 void DrawPlugin::setup()
 {
-#ifdef ESP32
-  vTaskDelay(pdMS_TO_TICKS(50));
-#else
-  delay(50);
-#endif
-  Screen.clear();
+  co.reset();
+}
+
+void DrawPlugin::loop()
+{
+  CO_BEGIN(co);
+  // let the switch settle before the stored drawing replaces the screen
+  CO_SLEEP(co, 50);
+  canvas->clear();
   Screen.loadFromStorage();
 #ifdef ENABLE_SERVER
   sendInfo();
 #endif
+  CO_END(co);
 }
 
 void DrawPlugin::websocketHook(JsonDocument &request)
@@ -22,11 +26,11 @@ void DrawPlugin::websocketHook(JsonDocument &request)
   {
     if (!strcmp(event, "led"))
     {
-      Screen.setPixelAtIndex(request["index"], request["status"]);
+      canvas->setPixelAtIndex(request["index"], request["status"]);
     }
     else if (!strcmp(event, "clear"))
     {
-      Screen.clear();
+      canvas->clear();
     }
     else if (!strcmp(event, "screen"))
     {
@@ -35,7 +39,7 @@ void DrawPlugin::websocketHook(JsonDocument &request)
       {
         buffer[i] = request["data"][i];
       }
-      Screen.setRenderBuffer(buffer);
+      canvas->setRenderBuffer(buffer);
     }
     else if (!strcmp(event, "persist"))
     {
@@ -52,6 +56,14 @@ void DrawPlugin::websocketHook(JsonDocument &request)
   }
 }
 
+void DrawPlugin::websocketFrameHook(const WsFrame &frame)
+{
+  if (currentStatus == NONE)
+  {
+    drawFrame(frame, *canvas);
+  }
+}
+
 const char *DrawPlugin::getName() const
 {
   return "Draw";
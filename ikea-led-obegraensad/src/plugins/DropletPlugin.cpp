@@ -1,13 +1,13 @@
 #include "plugins/DropletPlugin.h"
-#include <math.h>
 
 void DropletPlugin::setup()
 {
-  Screen.clear();
-  for (int i = 0; i < MAX_DROPLETS; i++)
-  {
-    droplets[i].active = false;
-  }
+  canvas->clear();
+
+  droplets.clear();
+  // ring about 1.5 pixels wide that fades as it spreads
+  droplets.setShape(SHAPE_RING, toFixed(1.5f));
+  droplets.setFade(FADE_LINEAR);
 }
 
 void DropletPlugin::loop()
@@ -15,71 +15,28 @@ void DropletPlugin::loop()
   // Spawn new droplets periodically
   if (spawnTimer.isReady(800))
   {
-    for (int i = 0; i < MAX_DROPLETS; i++)
-    {
-      if (!droplets[i].active)
-      {
-        droplets[i].x = random(2, 14);
-        droplets[i].y = random(2, 14);
-        droplets[i].radius = 0.0f;
-        droplets[i].maxRadius = random(4, 9);
-        droplets[i].active = true;
-        break;
-      }
-    }
+    ParticleEmitter drop;
+    drop.x = toFixed(7.5f);
+    drop.y = toFixed(7.5f);
+    drop.spreadX = toFixed(5.5f);
+    drop.spreadY = toFixed(5.5f);
+
+    // every ring spreads at 0.4 pixels per frame, whatever its final radius
+    uint8_t radius = droplets.getRandom().between(4, 9);
+    drop.sizeMin = radius;
+    drop.sizeMax = radius;
+    drop.lifeMin = radius * 5 / 2;
+    drop.lifeMax = drop.lifeMin;
+    droplets.emit(drop);
   }
 
   if (!frameTimer.isReady(60))
     return;
 
-  Screen.clear();
-
-  for (int y = 0; y < 16; y++)
-  {
-    for (int x = 0; x < 16; x++)
-    {
-      float totalBrightness = 0;
-
-      for (int i = 0; i < MAX_DROPLETS; i++)
-      {
-        if (!droplets[i].active)
-          continue;
+  canvas->clear();
 
-        float dx = x - droplets[i].x;
-        float dy = y - droplets[i].y;
-        float dist = sqrtf(dx * dx + dy * dy);
-        float r = droplets[i].radius;
-
-        // Ring with width ~1.5
-        float ringDist = fabsf(dist - r);
-        if (ringDist < 1.5f)
-        {
-          float fade = 1.0f - (droplets[i].radius / droplets[i].maxRadius);
-          float intensity = (1.0f - ringDist / 1.5f) * fade;
-          totalBrightness += intensity * 255.0f;
-        }
-      }
-
-      if (totalBrightness > 0)
-      {
-        uint8_t b = (uint8_t)min(255.0f, totalBrightness);
-        Screen.setPixel(x, y, 1, b);
-      }
-    }
-  }
-
-  // Expand and deactivate droplets
-  for (int i = 0; i < MAX_DROPLETS; i++)
-  {
-    if (droplets[i].active)
-    {
-      droplets[i].radius += 0.4f;
-      if (droplets[i].radius >= droplets[i].maxRadius)
-      {
-        droplets[i].active = false;
-      }
-    }
-  }
+  droplets.draw(*canvas);
+  droplets.update();
 }
 
 const char *DropletPlugin::getName() const
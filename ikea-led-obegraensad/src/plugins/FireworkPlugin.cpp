@@ -1,84 +1,71 @@
 #include "plugins/FireworkPlugin.h"
 
-void FireworkPlugin::drawExplosion(int x, int y, int maxRadius, int brightness)
+void FireworkPlugin::launch()
 {
-  for (int i = 0; i < 16; i++)
-  {
-    for (int j = 0; j < 16; j++)
-    {
-      int distance = round(sqrt(pow(i - x, 2) + pow(j - y, 2)));
-      if (distance <= maxRadius)
-      {
-        Screen.setPixel(i, j, 1, brightness);
-      }
-    }
-  }
-}
+  Xorshift32 &rng = rocket.getRandom();
 
-void FireworkPlugin::explode(int x, int y)
-{
-  int maxRadius = random(3, 6);
+  // rises one pixel every 60 ms from just below the screen, with a short trail
+  ParticleEmitter launcher;
+  launcher.x = rng.below(COLS) * PARTICLE_ONE;
+  launcher.y = ROWS * PARTICLE_ONE;
+  launcher.vy = -toFixed(0.5f);
+  launcher.sizeMin = 2;
+  launcher.sizeMax = 2;
+  rocket.emit(launcher);
 
-  for (int radius = 1; radius <= maxRadius; radius++)
-  {
-    drawExplosion(x, y, radius, 255);
-#ifdef ESP32
-    vTaskDelay(pdMS_TO_TICKS(explosionDelay));
-#else
-    delay(explosionDelay);
-#endif
-  }
+  burstY = rng.between(2, 8) * PARTICLE_ONE;
+}
 
-  for (int brightness = 248; brightness >= 0; brightness -= 8)
-  {
-    drawExplosion(x, y, maxRadius, brightness);
-#ifdef ESP32
-    vTaskDelay(pdMS_TO_TICKS(fadeDelay));
-#else
-    delay(fadeDelay);
-#endif
-  }
+void FireworkPlugin::explode(int16_t x, int16_t y)
+{
+  ParticleEmitter shell;
+  shell.x = x;
+  shell.y = y;
+  shell.radialMin = toFixed(0.1f);
+  shell.radialMax = toFixed(0.45f);
+  shell.lifeMin = 25;
+  shell.lifeMax = 45;
+  shell.brightnessMin = 160;
+  sparks.emit(shell, sparks.getRandom().between(40, 64));
 }
 
 void FireworkPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
+  timer.forceReady();
+
+  rocket.clear();
+
+  sparks.clear();
+  sparks.setShape(SHAPE_SMOOTH);
+  sparks.setGravity(0, toFixed(0.01f));
+  sparks.setDrag(5);
+  sparks.setFade(FADE_EASE_OUT);
+  sparks.setEdge(EDGE_KILL);
 }
 
 void FireworkPlugin::loop()
 {
-  static int rocketY = 16;
-  static int rocketX = 0;
-  static bool rocketLaunched = false;
+  if (!timer.isReady(FRAME_MS))
+    return;
 
-  unsigned long currentMillis = millis();
+  canvas->clear();
 
-  if (!rocketLaunched)
-  {
-    if (currentMillis - previousMillis >= rocketDelay)
-    {
-      previousMillis = currentMillis;
-      Screen.clear();
-      Screen.setPixel(rocketX, rocketY, 1, 255);
-      rocketY--;
+  rocket.update();
+  sparks.update();
 
-      if (rocketY < random(8))
-      {
-        rocketLaunched = true;
-        explode(rocketX, rocketY);
-      }
-    }
+  if (rocket.getCount() && rocket.getY(0) < burstY)
+  {
+    explode(rocket.getX(0), rocket.getY(0));
+    rocket.kill(0);
   }
-  else
+  else if (!rocket.getCount() && !sparks.getCount())
   {
-    if (currentMillis - previousMillis >= explosionDuration)
-    {
-      rocketY = 16;
-      rocketX = random(16);
-      rocketLaunched = false;
-      previousMillis = currentMillis;
-    }
+    launch();
   }
+
+  rocket.draw(*canvas);
+  sparks.draw(*canvas);
 }
 
 const char *FireworkPlugin::getName() const
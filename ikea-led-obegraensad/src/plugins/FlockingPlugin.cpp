@@ -3,7 +3,7 @@
 
 void FlockingPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   for (int i = 0; i < NUM_BOIDS; i++)
   {
     boids[i].x = random(0, 160) / 10.0f;
@@ -94,7 +94,7 @@ void FlockingPlugin::loop()
     return;
 
   // Fade existing pixels
-  uint8_t *buf = Screen.getRenderBuffer();
+  uint8_t *buf = canvas->getRenderBuffer();
   for (int i = 0; i < 256; i++)
   {
     if (buf[i] > 30)
@@ -111,7 +111,7 @@ void FlockingPlugin::loop()
     int py = (int)(boids[i].y + 0.5f);
     if (px >= 0 && px < 16 && py >= 0 && py < 16)
     {
-      Screen.setPixel(px, py, 1, 255);
+      canvas->setPixel(px, py, 1, 255);
     }
   }
 }
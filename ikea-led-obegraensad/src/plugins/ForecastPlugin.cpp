@@ -1,31 +1,14 @@
 #include "plugins/ForecastPlugin.h"
 #include "config.h"
+#include "fetchservice.h"
+#include "settings.h"
 #include <ArduinoJson.h>
 
-#ifdef ESP32
-#include <HTTPClient.h>
-#include <WiFi.h>
-#include <WiFiClientSecure.h>
-#include <Preferences.h>
-#endif
-#ifdef ESP8266
-#include <ESP8266HTTPClient.h>
-#include <ESP8266WiFi.h>
-#include <WiFiClient.h>
-#endif
-
 void ForecastPlugin::loadConfig()
 {
-#ifdef ENABLE_STORAGE
-  Preferences prefs;
-  prefs.begin("forecast", true);
-  currentCityIndex = prefs.getInt("cityIdx", 0);
-  prefs.end();
+  currentCityIndex = Settings.getInt(SETTING_FORECAST_CITY);
   if (currentCityIndex < 0 || currentCityIndex >= cityCount)
     currentCityIndex = 0;
-#else
-  currentCityIndex = 0;
-#endif
 }
 
 int ForecastPlugin::mapWmoCode(int code)
@@ -60,115 +43,59 @@ int ForecastPlugin::mapWmoCode(int code)
   }
 }
 
-void ForecastPlugin::fetchForecast()
+void ForecastPlugin::updateForecast()
 {
-  if (WiFi.status() != WL_CONNECTED)
-    return;
   if (currentCityIndex < 0 || currentCityIndex >= cityCount)
     return;
 
-#ifdef ESP32
-  Serial.printf("[Forecast] Heap free=%u maxAlloc=%u\n",
-                ESP.getFreeHeap(), ESP.getMaxAllocHeap());
-#endif
-
   char url[256];
   snprintf(url, sizeof(url),
            "https://api.open-meteo.com/v1/forecast?latitude=%.2f&longitude=%.2f"
            "&daily=temperature_2m_max,temperature_2m_min,weather_code"
            "&timezone=auto&forecast_days=2",
            cities[currentCityIndex].latitude, cities[currentCityIndex].longitude);
-  Serial.printf("[Forecast] GET %s\n", url);
-
-#ifdef ESP32
-  WiFiClientSecure client;
-  client.setInsecure();
-  HTTPClient http;
-  http.begin(client, url);
-#endif
-#ifdef ESP8266
-  WiFiClient wifiClient;
-  HTTPClient http;
-  http.begin(wifiClient, url);
-#endif
 
-  http.setConnectTimeout(5000);
-  http.setTimeout(10000);
-  int code = http.GET();
-
-  if (code == HTTP_CODE_OK)
+  WeatherData data;
+  if (FetchService.get(FETCH_OPEN_METEO_DAILY, url, 1800000UL, data).hasData)
   {
-    String payload = http.getString();
-    JsonDocument doc;
-    DeserializationError err = deserializeJson(doc, payload);
-    if (!err)
-    {
-      // Index 1 = tomorrow
-      float maxT = doc["daily"]["temperature_2m_max"][1] | -99.0f;
-      float minT = doc["daily"]["temperature_2m_min"][1] | -99.0f;
-      int wmo = doc["daily"]["weather_code"][1] | 0;
-
-      maxTemp = (int)roundf(maxT);
-      minTemp = (int)roundf(minT);
-      weatherIcon = mapWmoCode(wmo);
-      hasData = true;
-
-      Serial.printf("[Forecast] Tomorrow: %d/%d C wmo=%d icon=%d\n",
-                    maxTemp, minTemp, wmo, weatherIcon);
-    }
-    else
-    {
-      Serial.printf("[Forecast] JSON error: %s\n", err.c_str());
-    }
-  }
-  else
-  {
-    Serial.printf("[Forecast] HTTP error: %d\n", code);
-  }
-
-  http.end();
-
-  if (code == HTTP_CODE_OK)
-  {
-    lastFetch = millis();
-  }
-  else
-  {
-    // Retry in 60 seconds on failure
-    lastFetch = millis() - 1740000UL;
+    maxTemp = (int)roundf(data.temperatureMax);
+    minTemp = (int)roundf(data.temperatureMin);
+    weatherIcon = mapWmoCode(data.code);
+    hasData = true;
   }
 }
 
 void ForecastPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   displayMode = 0;
   modeStart = millis();
   scrollX = -16;
   displayTimer.forceReady();
   loadConfig();
+  updateForecast();
 
   if (!hasData)
   {
     // Loading dots
-    Screen.setPixel(4, 7, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(10, 7, 1);
+    canvas->setPixel(4, 7, 1);
+    canvas->setPixel(7, 7, 1);
+    canvas->setPixel(10, 7, 1);
   }
 }
 
 void ForecastPlugin::drawIcon()
 {
-  Screen.clear();
+  canvas->clear();
   if (!hasData || weatherIcon < 0)
   {
-    Screen.setPixel(5, 7, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(9, 7, 1);
+    canvas->setPixel(5, 7, 1);
+    canvas->setPixel(7, 7, 1);
+    canvas->setPixel(9, 7, 1);
     return;
   }
   // Center weather icon (icons are 16px wide, x=0 fills screen)
-  Screen.drawWeather(0, 5, weatherIcon);
+  canvas->drawWeather(0, 5, weatherIcon);
 }
 
 void ForecastPlugin::drawTempValue(int temp, int y)
@@ -176,80 +103,80 @@ void ForecastPlugin::drawTempValue(int temp, int y)
   // Arrow at x=0-2; sign at x=4-6; digits after sign
   if (temp >= 10)
   {
-    Screen.drawNumbers(3, y, {temp / 10, temp % 10});
+    canvas->drawNumbers(3, y, {temp / 10, temp % 10});
   }
   else if (temp >= 0)
   {
     // Plus sign (3x3 cross centered at x=5)
-    Screen.setPixel(5, y + 1, 1, 150);
-    Screen.setPixel(4, y + 2, 1, 150);
-    Screen.setPixel(5, y + 2, 1, 150);
-    Screen.setPixel(6, y + 2, 1, 150);
-    Screen.setPixel(5, y + 3, 1, 150);
-    Screen.drawNumbers(7, y, {temp});
+    canvas->setPixel(5, y + 1, 1, 150);
+    canvas->setPixel(4, y + 2, 1, 150);
+    canvas->setPixel(5, y + 2, 1, 150);
+    canvas->setPixel(6, y + 2, 1, 150);
+    canvas->setPixel(5, y + 3, 1, 150);
+    canvas->drawNumbers(7, y, {temp});
   }
   else if (temp > -10)
   {
     // Minus sign (3px wide centered at x=5)
-    Screen.setPixel(4, y + 2, 1, 150);
-    Screen.setPixel(5, y + 2, 1, 150);
-    Screen.setPixel(6, y + 2, 1, 150);
-    Screen.drawNumbers(7, y, {-temp});
+    canvas->setPixel(4, y + 2, 1, 150);
+    canvas->setPixel(5, y + 2, 1, 150);
+    canvas->setPixel(6, y + 2, 1, 150);
+    canvas->drawNumbers(7, y, {-temp});
   }
   else
   {
     // "-15" — minus + two digits
     int t = -temp;
-    Screen.setPixel(4, y + 2, 1, 150);
-    Screen.setPixel(5, y + 2, 1, 150);
-    Screen.drawNumbers(6, y, {t / 10, t % 10});
+    canvas->setPixel(4, y + 2, 1, 150);
+    canvas->setPixel(5, y + 2, 1, 150);
+    canvas->drawNumbers(6, y, {t / 10, t % 10});
   }
 }
 
 void ForecastPlugin::drawTemps()
 {
-  Screen.clear();
+  canvas->clear();
   if (!hasData)
   {
-    Screen.setPixel(5, 7, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(9, 7, 1);
+    canvas->setPixel(5, 7, 1);
+    canvas->setPixel(7, 7, 1);
+    canvas->setPixel(9, 7, 1);
     return;
   }
 
   // Top half (rows 0-6): up arrow + max temp
   // Up arrow at x=0: tip(y=0), head(y=1), shaft(y=2,y=3)
-  Screen.setPixel(1, 0, 1, 200);
-  Screen.setPixel(0, 1, 1, 200);
-  Screen.setPixel(1, 1, 1, 200);
-  Screen.setPixel(2, 1, 1, 200);
-  Screen.setPixel(1, 2, 1, 200);
-  Screen.setPixel(1, 3, 1, 200);
+  canvas->setPixel(1, 0, 1, 200);
+  canvas->setPixel(0, 1, 1, 200);
+  canvas->setPixel(1, 1, 1, 200);
+  canvas->setPixel(2, 1, 1, 200);
+  canvas->setPixel(1, 2, 1, 200);
+  canvas->setPixel(1, 3, 1, 200);
   drawTempValue(maxTemp, 0);
 
   // Dotted separator at row 7
-  Screen.setPixel(1, 7, 1, 40);
-  Screen.setPixel(5, 7, 1, 40);
-  Screen.setPixel(9, 7, 1, 40);
-  Screen.setPixel(13, 7, 1, 40);
+  canvas->setPixel(1, 7, 1, 40);
+  canvas->setPixel(5, 7, 1, 40);
+  canvas->setPixel(9, 7, 1, 40);
+  canvas->setPixel(13, 7, 1, 40);
 
   // Bottom half (rows 8-14): down arrow + min temp
   // Down arrow at x=0: shaft(y=8,y=9), head(y=10), tip(y=11)
-  Screen.setPixel(1, 8, 1, 200);
-  Screen.setPixel(1, 9, 1, 200);
-  Screen.setPixel(0, 10, 1, 200);
-  Screen.setPixel(1, 10, 1, 200);
-  Screen.setPixel(2, 10, 1, 200);
-  Screen.setPixel(1, 11, 1, 200);
+  canvas->setPixel(1, 8, 1, 200);
+  canvas->setPixel(1, 9, 1, 200);
+  canvas->setPixel(0, 10, 1, 200);
+  canvas->setPixel(1, 10, 1, 200);
+  canvas->setPixel(2, 10, 1, 200);
+  canvas->setPixel(1, 11, 1, 200);
   drawTempValue(minTemp, 8);
 }
 
 void ForecastPlugin::loop()
 {
-  // Fetch forecast every 30 minutes
-  if (lastFetch == 0 || millis() - lastFetch > 1800000UL)
+  // Cached by FetchService, refreshed in the background every 30 minutes
+  if (fetchTimer.isReady(1000))
   {
-    fetchForecast();
+    updateForecast();
   }
 
   unsigned long elapsed = millis() - modeStart;
@@ -263,7 +190,7 @@ void ForecastPlugin::loop()
 
     if (displayTimer.isReady(40))
     {
-      Screen.clear();
+      canvas->clear();
       String name = String(cities[currentCityIndex].name);
       name.toUpperCase();
       int fw = fonts[0].sizeX + 1;
@@ -277,8 +204,8 @@ void ForecastPlugin::loop()
           int fontIdx = name.charAt(c) - fonts[0].offset;
           if (fontIdx >= 0 && fontIdx < (int)fonts[0].data.size())
           {
-            Screen.drawCharacter(xPos, 4,
-                                 Screen.readBytes(fonts[0].data[fontIdx]), 8, 180);
+            canvas->drawCharacter(xPos, 4,
+                                 canvas->readBytes(fonts[0].data[fontIdx]), 8, 180);
           }
         }
       }
@@ -323,6 +250,13 @@ void ForecastPlugin::loop()
   }
 }
 
+void ForecastPlugin::prepare()
+{
+  // starts the refresh early if the cached forecast is stale
+  loadConfig();
+  updateForecast();
+}
+
 void ForecastPlugin::websocketHook(JsonDocument &request)
 {
   if (request["event"] == "forecast")
@@ -333,18 +267,13 @@ void ForecastPlugin::websocketHook(JsonDocument &request)
       if (idx >= 0 && idx < cityCount)
       {
         currentCityIndex = idx;
-#ifdef ENABLE_STORAGE
-        Preferences prefs;
-        prefs.begin("forecast", false);
-        prefs.putInt("cityIdx", idx);
-        prefs.end();
-#endif
-        // Reset weather data to force re-fetch for new city
+        Settings.setInt(SETTING_FORECAST_CITY, idx);
+        // Show the new city's data, fetched in the background if it is not cached yet
         hasData = false;
-        lastFetch = 0;
         weatherIcon = -1;
         maxTemp = -99;
         minTemp = -99;
+        updateForecast();
         displayMode = 0;
         modeStart = millis();
         scrollX = -16;
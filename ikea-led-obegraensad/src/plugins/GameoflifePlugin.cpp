@@ -1,129 +1,128 @@
 #include "plugins/GameOfLifePlugin.h"
 #include "constants.h"
 
-uint8_t GameOfLifePlugin::countNeighbours(int row, int col)
+uint8_t GameOfLifePlugin::getCell(int x, int y) const
 {
-  const int rowAbove = (row == 0) ? ROWS - 1 : row - 1;
-  const int rowBelow = (row == ROWS - 1) ? 0 : row + 1;
-  const int colLeft = (col == 0) ? COLS - 1 : col - 1;
-  const int colRight = (col == COLS - 1) ? 0 : col + 1;
-
-  // sum all 8 neighbours
-  const uint8_t count = this->previous[rowAbove * COLS + colLeft] +  // top-left
-                        this->previous[rowAbove * COLS + col] +      // top
-                        this->previous[rowAbove * COLS + colRight] + // top-right
-                        this->previous[row * COLS + colLeft] +       // left
-                        this->previous[row * COLS + colRight] +      // right
-                        this->previous[rowBelow * COLS + colLeft] +  // bottom-left
-                        this->previous[rowBelow * COLS + col] +      // bottom
-                        this->previous[rowBelow * COLS + colRight];  // bottom-right
-
-  return count;
-};
-
-uint8_t GameOfLifePlugin::updateCell(int row, int col)
-{
-  uint8_t total = this->countNeighbours(row, col);
-  if (total > 3 || total < 2)
-  {
-    return 0;
-  }
-  else if (this->previous[row * COLS + col] == 0 && total == 3)
-  {
-    return 1;
-  }
-  else
-  {
-    return this->previous[row * COLS + col];
-  }
-};
+  return (life.getWindowRow(viewX, viewY + y) >> x) & 1;
+}
 
 void GameOfLifePlugin::setup()
 {
   this->state = this->STATE_END;
-  this->initStep = 0;
+  this->initCo.reset();
 };
 
 void GameOfLifePlugin::init()
 {
-  if (initStep == 0)
+  CO_BEGIN(initCo);
+  if (pendingRule)
   {
-    memset(this->previous2, 0, ROWS * COLS);
-    memset(this->previous, 0, ROWS * COLS);
-    memset(this->buffer, 0, ROWS * COLS);
-    for (int i = 0; i < ROWS * COLS; i++)
+    life.setRule(pendingBirth, pendingSurvive);
+    pendingRule = false;
+  }
+  if (life.getSize() != universeSize)
+  {
+    life.setSize(universeSize);
+  }
+
+  life.clear();
+  for (uint8_t y = 0; y < universeSize; y++)
+  {
+    uint64_t row = 0;
+    for (uint8_t word = 0; word < 4; word++)
     {
-      this->buffer[i] = (random(2)) ? 1 : 0;
+      row = (row << 16) | random(0x10000);
     }
-    initStep = 1;
-    initTimer.reset();
-    return;
+    life.setRow(y, row);
   }
 
-  // Animated reveal of the board (non-blocking)
-  if (initTimer.isReady(50))
+  viewX = targetX = 0;
+  viewY = targetY = 0;
+  framesLeft = FRAMES_PER_RUN * (universeSize / 16);
+
+  // Animated reveal of the board, four rows per column and step: grey cover, then the cells
+  for (revealStep = 0; revealStep < 8 * COLS; revealStep++)
   {
-    int j = (initStep - 1) / COLS;
-    int i = (initStep - 1) % COLS;
+    CO_SLEEP(initCo, 50);
+    int j = revealStep / COLS;
+    int i = revealStep % COLS;
 
-    if (j < 8)
+    for (int k = 0; k < 4; k++)
     {
       if (j < 4)
-      { // grayish cover
-        Screen.setPixel((i), (j * 4 + 0), 1, 25);
-        Screen.setPixel((i), (j * 4 + 1), 1, 25);
-        Screen.setPixel((i), (j * 4 + 2), 1, 25);
-        Screen.setPixel((i), (j * 4 + 3), 1, 25);
+      {
+        canvas->setPixel(i, j * 4 + k, 1, 25);
       }
       else
-      { // fill in actual cells
-        int actualRow = j - 4;
-        Screen.setPixel(i, (actualRow * 4 + 0), this->buffer[(actualRow * 4 + 0) * COLS + i]);
-        Screen.setPixel(i, (actualRow * 4 + 1), this->buffer[(actualRow * 4 + 1) * COLS + i]);
-        Screen.setPixel(i, (actualRow * 4 + 2), this->buffer[(actualRow * 4 + 2) * COLS + i]);
-        Screen.setPixel(i, (actualRow * 4 + 3), this->buffer[(actualRow * 4 + 3) * COLS + i]);
+      {
+        canvas->setPixel(i, (j - 4) * 4 + k, getCell(i, (j - 4) * 4 + k));
       }
-
-      initStep++;
-    }
-    else
-    {
-      // Animation complete
-      this->state = this->STATE_RUNNING;
-      this->initStep = 0;
     }
   }
+  CO_SLEEP(initCo, 50);
+
+  this->state = this->STATE_RUNNING;
+  CO_END(initCo);
 }
 
-void GameOfLifePlugin::next()
+void GameOfLifePlugin::show()
 {
-  memcpy(this->previous2, this->previous, ROWS * COLS);
-  memcpy(this->previous, this->buffer, ROWS * COLS);
-  for (int i = 0; i < ROWS; i++)
+  canvas->clear();
+
+  for (int y = 0; y < ROWS; y++)
   {
-    for (int j = 0; j < COLS; j++)
+    uint16_t bits = life.getWindowRow(viewX, viewY + y);
+    for (int x = 0; x < COLS; x++)
     {
-      this->buffer[i * COLS + j] = this->updateCell(i, j);
+      canvas->setPixel(x, y, (bits >> x) & 1);
     }
   }
 }
 
-void GameOfLifePlugin::show()
+// signed shortest step from a to b on a ring of the given size
+static int8_t ringStep(uint8_t from, uint8_t to, uint8_t size)
+{
+  if (from == to)
+  {
+    return 0;
+  }
+  uint8_t forward = (to + size - from) % size;
+  return forward <= size / 2 ? 1 : -1;
+}
+
+void GameOfLifePlugin::pan()
 {
-  Screen.clear();
+  uint8_t size = life.getSize();
+  if (!autoPan || size <= COLS)
+  {
+    return;
+  }
 
-  for (int i = 0; i < ROWS; i++)
+  // look for the busiest window every few frames, moving there one cell per frame
+  if (++panCounter >= 8)
   {
-    for (int j = 0; j < COLS; j++)
+    panCounter = 0;
+    uint16_t best = life.countWindow(targetX, targetY);
+    for (uint8_t y = 0; y < size; y += 8)
     {
-      Screen.setPixel(j, i, this->buffer[i * COLS + j]);
+      for (uint8_t x = 0; x < size; x += 8)
+      {
+        uint16_t count = life.countWindow(x, y);
+        // some hysteresis so the view does not jitter between similar areas
+        if (count > best + best / 4 + 2)
+        {
+          best = count;
+          targetX = x;
+          targetY = y;
+        }
+      }
     }
   }
+
+  viewX = (viewX + size + ringStep(viewX, targetX, size)) % size;
+  viewY = (viewY + size + ringStep(viewY, targetY, size)) % size;
 }
 
-int generations = 120;
-bool updated;
-bool updated2;
 void GameOfLifePlugin::loop()
 {
   switch (this->state)
@@ -133,18 +132,19 @@ void GameOfLifePlugin::loop()
     {
       this->show();
 
-      generations--;
-      this->next();
-      updated = memcmp(this->buffer, this->previous, ROWS * COLS);
-      updated2 = memcmp(this->buffer, this->previous2, ROWS * COLS);
+      framesLeft--;
+      life.step(stepsPerFrame);
+      pan();
 
-      // is running in period of 2
-      if (!updated2)
-        generations -= 5;
+      uint32_t period = life.getPeriod();
+      if (period > 1 && framesLeft > FRAMES_AFTER_CYCLE)
+      {
+        // oscillating, show a few more frames and start over
+        framesLeft = FRAMES_AFTER_CYCLE;
+      }
 
-      if (generations < 0 || !updated)
+      if (framesLeft < 0 || period == 1 || life.getPopulation() == 0)
       {
-        generations = 120;
         updateTimer.reset();
         this->state = this->STATE_END_DELAY;
       }
@@ -161,7 +161,7 @@ void GameOfLifePlugin::loop()
     break;
   case this->STATE_END:
     this->state = this->STATE_INIT;
-    this->initStep = 0;
+    this->initCo.reset();
     break;
   }
 };
@@ -184,5 +184,47 @@ void GameOfLifePlugin::websocketHook(JsonDocument &request)
       Serial.println(new_delay);
       gol_delay = new_delay;
     }
+    else if (!strcmp(event, "golspeed"))
+    {
+      // generations per displayed frame, for fast-forward
+      uint16_t steps = request["steps"].as<uint16_t>();
+      stepsPerFrame = constrain(steps, 1, MAX_STEPS_PER_FRAME);
+      Serial.printf("[GameOfLife] %u generations per frame\n", stepsPerFrame);
+    }
+    else if (!strcmp(event, "golrule"))
+    {
+      // applied with the next board, the running one would not survive a rule change anyway
+      uint16_t birth;
+      uint16_t survive;
+      if (LifeEngine::parseRule(request["rule"].as<const char *>(), birth, survive))
+      {
+        pendingBirth = birth;
+        pendingSurvive = survive;
+        pendingRule = true;
+        this->state = this->STATE_END_DELAY;
+        Serial.printf("[GameOfLife] Rule %s\n", request["rule"].as<const char *>());
+      }
+    }
+    else if (!strcmp(event, "golsize"))
+    {
+      uint8_t size = request["size"].as<uint8_t>();
+      universeSize = constrain(size, 16, LIFE_MAX_SIZE);
+      this->state = this->STATE_END_DELAY;
+      Serial.printf("[GameOfLife] Universe %ux%u\n", universeSize, universeSize);
+    }
+    else if (!strcmp(event, "golview"))
+    {
+      if (request["x"].is<int>() && request["y"].is<int>())
+      {
+        uint8_t size = life.getSize();
+        targetX = viewX = (request["x"].as<int>() % size + size) % size;
+        targetY = viewY = (request["y"].as<int>() % size + size) % size;
+        autoPan = false;
+      }
+      else
+      {
+        autoPan = true;
+      }
+    }
   }
 }
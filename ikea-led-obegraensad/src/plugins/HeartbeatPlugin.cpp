@@ -27,7 +27,7 @@ void HeartbeatPlugin::drawHeart(int offsetX, int offsetY, uint8_t brightness)
         int py = offsetY + y;
         if (px >= 0 && px < 16 && py >= 0 && py < 16)
         {
-          Screen.setPixel(px, py, 1, brightness);
+          canvas->setPixel(px, py, 1, brightness);
         }
       }
     }
@@ -36,7 +36,7 @@ void HeartbeatPlugin::drawHeart(int offsetX, int offsetY, uint8_t brightness)
 
 void HeartbeatPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   beatStart = millis();
 }
 
@@ -82,7 +82,7 @@ void HeartbeatPlugin::loop()
       brightness = 100;
   }
 
-  Screen.clear();
+  canvas->clear();
 
   // Heart at offset (2, 3), 12x10 — center exactly at display center
   int offX = 2, offY = 3;
@@ -102,7 +102,7 @@ void HeartbeatPlugin::loop()
 
       if (ix >= 0 && ix < 12 && iy >= 0 && iy < 10 && heartShape[iy][ix])
       {
-        Screen.setPixel(x, y, 1, brightness);
+        canvas->setPixel(x, y, 1, brightness);
       }
     }
   }
@@ -3,7 +3,7 @@
 
 void LavaLampPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   for (int i = 0; i < NUM_BALLS; i++)
   {
     balls[i].x = random(20, 140) / 10.0f;
@@ -59,11 +59,11 @@ void LavaLampPlugin::loop()
           brightness = 255;
         else
           brightness = (uint8_t)((sum - 0.8f) / 1.2f * 255.0f);
-        Screen.setPixel(x, y, 1, brightness);
+        canvas->setPixel(x, y, 1, brightness);
       }
       else
       {
-        Screen.setPixel(x, y, 0, 0);
+        canvas->setPixel(x, y, 0, 0);
       }
     }
   }
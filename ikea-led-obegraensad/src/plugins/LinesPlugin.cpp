@@ -10,12 +10,12 @@ void LinesPlugin::loop()
   if (!timer.isReady(200))
     return;
 
-  std::vector<int> bits = Screen.readBytes(this->frames[this->count]);
+  std::vector<int> bits = canvas->readBytes(this->frames[this->count]);
   for (int row = 0; row < ROWS; row++)
   {
     for (int col = 0; col < bits.size(); col++)
     {
-      Screen.setPixel(col, row, bits[col]);
+      canvas->setPixel(col, row, bits[col]);
     }
   }
 
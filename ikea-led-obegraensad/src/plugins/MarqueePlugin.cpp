@@ -127,7 +127,7 @@ void MarqueePlugin::drawGlyph(int x, int y, uint16_t cp)
       {
         if (rowData & (0x80 >> col))
         {
-          Screen.setPixel(x + col, y + row, 1, MAX_BRIGHTNESS);
+          canvas->setPixel(x + col, y + row, 1, MAX_BRIGHTNESS);
         }
       }
     }
@@ -140,7 +140,7 @@ void MarqueePlugin::drawGlyph(int x, int y, uint16_t cp)
     int fontIdx = cp - fonts[0].offset;
     if (fontIdx >= 0 && fontIdx < (int)fonts[0].data.size())
     {
-      std::vector<int> bits = Screen.readBytes(fonts[0].data[fontIdx]);
+      std::vector<int> bits = canvas->readBytes(fonts[0].data[fontIdx]);
       int bitCount = 8; // system font uses 8-bit wide rows
       for (int i = 0; i < (int)bits.size(); i += bitCount)
       {
@@ -148,7 +148,7 @@ void MarqueePlugin::drawGlyph(int x, int y, uint16_t cp)
         {
           if (bits[i + j])
           {
-            Screen.setPixel(x + j, y + (i / bitCount), 1, MAX_BRIGHTNESS);
+            canvas->setPixel(x + j, y + (i / bitCount), 1, MAX_BRIGHTNESS);
           }
         }
       }
@@ -160,14 +160,14 @@ void MarqueePlugin::drawGlyph(int x, int y, uint16_t cp)
   if (fonts[0].data.size() > ('?' - fonts[0].offset))
   {
     int fontIdx = '?' - fonts[0].offset;
-    std::vector<int> bits = Screen.readBytes(fonts[0].data[fontIdx]);
+    std::vector<int> bits = canvas->readBytes(fonts[0].data[fontIdx]);
     for (int i = 0; i < (int)bits.size(); i += 8)
     {
       for (int j = 0; j < 5 && j < 8; j++)
       {
         if (bits[i + j])
         {
-          Screen.setPixel(x + j, y + (i / 8), 1, MAX_BRIGHTNESS);
+          canvas->setPixel(x + j, y + (i / 8), 1, MAX_BRIGHTNESS);
         }
       }
     }
@@ -176,7 +176,7 @@ void MarqueePlugin::drawGlyph(int x, int y, uint16_t cp)
 
 void MarqueePlugin::renderFrame()
 {
-  Screen.clear();
+  canvas->clear();
   int x = -scrollPos;
   int yOffset = 5; // center 7px tall glyphs vertically: (16-7)/2 ≈ 5
 
@@ -1,15 +1,31 @@
 #include "plugins/MatrixRainPlugin.h"
 
+void MatrixRainPlugin::startStream(uint8_t x, int16_t y)
+{
+  column.x = x * PARTICLE_ONE;
+  column.y = y;
+  streams.emit(column);
+}
+
 void MatrixRainPlugin::setup()
 {
-  Screen.clear();
-  
-  for (uint8_t i = 0; i < NUM_COLUMNS; i++)
+  canvas->clear();
+  streams.clear();
+  streams.setEdge(EDGE_KILL, MAX_TRAIL_LENGTH);
+
+  // 1 to 3 pixels per frame, the trail follows the head
+  column.vy = toFixed(2.0f);
+  column.jitterY = PARTICLE_ONE;
+  column.sizeMin = 2;
+  column.sizeMax = MAX_TRAIL_LENGTH - 2;
+
+  Xorshift32 &rng = streams.getRandom();
+  for (uint8_t x = 0; x < NUM_COLUMNS; x++)
   {
-    columns[i].y = -random(HEIGHT);
-    columns[i].speed = random(1, 4);
-    columns[i].length = random(3, MAX_TRAIL_LENGTH);
-    columns[i].active = random(100) > 30;
+    if (rng.below(100) > 30)
+    {
+      startStream(x, -rng.below(ROWS) * PARTICLE_ONE);
+    }
   }
 }
 
@@ -19,61 +35,20 @@ void MatrixRainPlugin::loop()
     return;
 
   // Fade all pixels
+  fadeScreen(*canvas, 15);
+
+  streams.update();
+
+  Xorshift32 &rng = streams.getRandom();
   for (uint8_t x = 0; x < NUM_COLUMNS; x++)
   {
-    for (uint8_t y = 0; y < HEIGHT; y++)
+    if (rng.below(100) > 97)
     {
-      uint8_t brightness = Screen.getBufferIndex(y * NUM_COLUMNS + x);
-      if (brightness > 15)
-        brightness -= 15;
-      else
-        brightness = 0;
-      
-      Screen.setPixel(x, y, 1, brightness);
+      startStream(x, -rng.below(5) * PARTICLE_ONE);
     }
   }
 
-  // Update columns
-  for (uint8_t i = 0; i < NUM_COLUMNS; i++)
-  {
-    if (!columns[i].active)
-    {
-      if (random(100) > 95)
-      {
-        columns[i].active = true;
-        columns[i].y = -random(5);
-        columns[i].speed = random(1, 4);
-        columns[i].length = random(3, MAX_TRAIL_LENGTH);
-      }
-      continue;
-    }
-
-    // Draw the bright head
-    if (columns[i].y >= 0 && columns[i].y < HEIGHT)
-    {
-      Screen.setPixel(i, columns[i].y, 1, 255);
-    }
-
-    // Draw trail with decreasing brightness
-    for (uint8_t j = 1; j < columns[i].length; j++)
-    {
-      int16_t trailY = columns[i].y - j;
-      if (trailY >= 0 && trailY < HEIGHT)
-      {
-        uint8_t brightness = 255 - (j * 255 / columns[i].length);
-        Screen.setPixel(i, trailY, 1, brightness);
-      }
-    }
-
-    // Move column
-    columns[i].y += columns[i].speed;
-
-    // Reset column if it's past the bottom
-    if (columns[i].y - columns[i].length >= HEIGHT)
-    {
-      columns[i].active = false;
-    }
-  }
+  streams.draw(*canvas);
 }
 
 const char *MatrixRainPlugin::getName() const
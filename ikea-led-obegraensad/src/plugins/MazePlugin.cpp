@@ -125,7 +125,7 @@ void MazePlugin::solveMaze()
 
 void MazePlugin::drawMaze()
 {
-  Screen.clear();
+  canvas->clear();
   for (int my = 0; my < MAZE_H; my++)
   {
     for (int mx = 0; mx < MAZE_W; mx++)
@@ -136,20 +136,20 @@ void MazePlugin::drawMaze()
       // Cell center is always open (off)
       // Draw walls as lit pixels
       if (walls[my][mx] & 1) // North
-        Screen.setPixel(px, py, 1, 80);
+        canvas->setPixel(px, py, 1, 80);
       if (walls[my][mx] & 2) // East
-        Screen.setPixel(px + 1, py, 1, 80);
+        canvas->setPixel(px + 1, py, 1, 80);
       if (walls[my][mx] & 4) // South
-        Screen.setPixel(px, py + 1, 1, 80);
+        canvas->setPixel(px, py + 1, 1, 80);
       if (walls[my][mx] & 8) // West
       {
         if (px > 0)
-          Screen.setPixel(px - 1, py, 1, 80);
+          canvas->setPixel(px - 1, py, 1, 80);
       }
 
       // Corner posts
       if (mx < MAZE_W - 1 && my < MAZE_H - 1)
-        Screen.setPixel(px + 1, py + 1, 1, 80);
+        canvas->setPixel(px + 1, py + 1, 1, 80);
     }
   }
 }
@@ -161,14 +161,14 @@ void MazePlugin::drawSolveStep()
     Cell c = solvePath[solveIdx];
     int px = c.x * 2;
     int py = c.y * 2;
-    Screen.setPixel(px, py, 1, 255);
+    canvas->setPixel(px, py, 1, 255);
     solveIdx++;
   }
 }
 
 void MazePlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   stepTimer.forceReady();
   initMaze();
 }
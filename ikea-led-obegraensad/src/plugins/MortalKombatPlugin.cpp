@@ -1,29 +1,11 @@
 #include "plugins/MortalKombatPlugin.h"
+#include "sprite.h"
+#include "sprites/mortalkombat.h"
 #include <cmath>
 
-// MK dragon logo 16x16 bitmap, MSB = leftmost pixel
-static const uint16_t MK_BITMAP[16] = {
-    0x07E0, // .....######.....
-    0x1818, // ...##......##...
-    0x26C4, // ..#..##.##...#..
-    0x4FC2, // .#..######....#.
-    0x5EF2, // .#.####.####..#.
-    0x9E79, // #..####..####..#
-    0x8E71, // #...###..###...#
-    0x87E1, // #....######....#
-    0x83C1, // #.....####.....#
-    0x81C1, // #......###.....#
-    0x41E2, // .#.....####...#.
-    0x4372, // .#....##.###..#.
-    0x2634, // ..#..##...##.#..
-    0x1C18, // ...###.....##...
-    0x0C30, // ....##....##....
-    0x03C0  // ......####......
-};
-
 void MortalKombatPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   angle = 0.0f;
   frameTimer.forceReady();
 }
@@ -33,7 +15,7 @@ void MortalKombatPlugin::loop()
   if (!frameTimer.isReady(40))
     return;
 
-  Screen.clear();
+  canvas->clear();
 
   float cosA = cosf(angle);
   float absCosA = fabsf(cosA);
@@ -44,10 +26,14 @@ void MortalKombatPlugin::loop()
     // Edge-on: thin vertical line
     for (int y = 0; y < 16; y++)
     {
-      if (MK_BITMAP[y])
+      for (int srcX = 0; srcX < 16; srcX++)
       {
-        Screen.setPixel(7, y, 1, 80);
-        Screen.setPixel(8, y, 1, 80);
+        if (getSpritePixel(MK_LOGO, 0, srcX, y))
+        {
+          canvas->setPixel(7, y, 1, 80);
+          canvas->setPixel(8, y, 1, 80);
+          break;
+        }
       }
     }
   }
@@ -72,9 +58,9 @@ void MortalKombatPlugin::loop()
 
       for (int y = 0; y < 16; y++)
       {
-        if (MK_BITMAP[y] & (0x8000 >> srcX))
+        if (getSpritePixel(MK_LOGO, 0, srcX, y))
         {
-          Screen.setPixel(x, y, 1, brightness);
+          canvas->setPixel(x, y, 1, brightness);
         }
       }
     }
@@ -55,7 +55,7 @@ float PerlinNoisePlugin::noise2d(float x, float y)
 
 void PerlinNoisePlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   time_ = 0.0f;
   initPermutation();
   frameTimer.forceReady();
@@ -74,7 +74,7 @@ void PerlinNoisePlugin::loop()
       float n = noise2d(x * scale + time_, y * scale + time_ * 0.7f);
       // n is approximately in [-1, 1]
       uint8_t brightness = (uint8_t)constrain((int)((n + 1.0f) * 127.5f), 0, 255);
-      Screen.setPixel(x, y, 1, brightness);
+      canvas->setPixel(x, y, 1, brightness);
     }
   }
 
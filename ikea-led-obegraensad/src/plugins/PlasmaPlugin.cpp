@@ -3,7 +3,7 @@
 
 void PlasmaPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   time_ = 0.0f;
   frameTimer.forceReady();
 }
@@ -28,7 +28,7 @@ void PlasmaPlugin::loop()
       // Normalize from [-4,4] to [0,255]
       uint8_t brightness = (uint8_t)((v + 4.0f) * 31.875f);
 
-      Screen.setPixel(x, y, 1, brightness);
+      canvas->setPixel(x, y, 1, brightness);
     }
   }
 
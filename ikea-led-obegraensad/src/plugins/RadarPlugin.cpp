@@ -3,7 +3,7 @@
 
 void RadarPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   sweepAngle = 0;
   sweepSpeed = 0.1;
   
@@ -26,13 +26,13 @@ void RadarPlugin::loop()
   {
     for (uint8_t x = 0; x < WIDTH; x++)
     {
-      uint8_t brightness = Screen.getBufferIndex(y * WIDTH + x);
+      uint8_t brightness = canvas->getBufferIndex(y * WIDTH + x);
       if (brightness > 10)
         brightness -= 10;
       else
         brightness = 0;
       
-      Screen.setPixel(x, y, 1, brightness);
+      canvas->setPixel(x, y, 1, brightness);
     }
   }
 
@@ -46,7 +46,7 @@ void RadarPlugin::loop()
       
       if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
       {
-        Screen.setPixel(x, y, 1, 30);
+        canvas->setPixel(x, y, 1, 30);
       }
     }
   }
@@ -60,7 +60,7 @@ void RadarPlugin::loop()
     if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
     {
       uint8_t brightness = 255 - (r * 20);
-      Screen.setPixel(x, y, 1, brightness);
+      canvas->setPixel(x, y, 1, brightness);
     }
   }
 
@@ -82,13 +82,13 @@ void RadarPlugin::loop()
     // If sweep hits the blip, highlight it
     if (angleDiff < 0.3)
     {
-      Screen.setPixel(blips[i].x, blips[i].y, 1, 255);
+      canvas->setPixel(blips[i].x, blips[i].y, 1, 255);
       blips[i].age = 0;
     }
     else if (blips[i].age < 100)
     {
       uint8_t brightness = 200 - (blips[i].age * 2);
-      Screen.setPixel(blips[i].x, blips[i].y, 1, brightness);
+      canvas->setPixel(blips[i].x, blips[i].y, 1, brightness);
       blips[i].age++;
     }
     else
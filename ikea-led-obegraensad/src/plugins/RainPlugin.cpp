@@ -2,14 +2,11 @@
 
 void RainPlugin::setup()
 {
-  Screen.clear();
-  for (byte i = 0; i < RainPlugin::RainPlugin::NUM_DROPS; i++)
-    for (unsigned char i = 0; i < RainPlugin::RainPlugin::NUM_DROPS; i++)
-    {
-      this->drops[i].x = 0;
-      this->drops[i].y = 0;
-      this->drops[i].visible = false;
-    }
+  canvas->clear();
+  drops.clear();
+  drops.setEdge(EDGE_KILL);
+
+  cloud.vy = PARTICLE_ONE;
 }
 
 void RainPlugin::loop()
@@ -18,50 +15,22 @@ void RainPlugin::loop()
     return;
 
   // dim the trail
-  for (uint8_t x = 0; x < RainPlugin::X_MAX; x++)
-  {
-    for (uint8_t y = 0; y < RainPlugin::Y_MAX; y++)
-    {
-      uint8_t brightness = Screen.getBufferIndex(y * RainPlugin::X_MAX + x);
-
-      if (brightness <= 25)
-        brightness = 0;
-      else if (brightness <= 50)
-        brightness = 16;
-      else if (brightness <= 75)
-        brightness = 32;
-      else
-        brightness = 64;
+  dimScreen(*canvas, 64);
 
-      Screen.setPixel(x, y, 1, brightness);
-    }
-  }
+  drops.update();
 
-  // draw the drops
-  for (unsigned char i = 0; i < RainPlugin::NUM_DROPS; i++)
+  // every free drop starts falling with a chance of 1 in 5
+  Xorshift32 &rng = drops.getRandom();
+  for (uint8_t i = drops.getCount(); i < RainPlugin::NUM_DROPS; i++)
   {
-    if (!drops[i].visible)
-    {
-      if (random(10) > 1)
-        continue;
-
-      this->drops[i].x = random(RainPlugin::X_MAX);
-      this->drops[i].y = 0;
-      this->drops[i].visible = true;
+    if (rng.below(5))
+      continue;
 
-      Screen.setPixel(this->drops[i].x, this->drops[i].y, RainPlugin::LED_TYPE_ON, 255);
-    }
-    else
-    {
-      this->drops[i].y++;
-      if (this->drops[i].y >= (RainPlugin::Y_MAX))
-      {
-        this->drops[i].visible = false;
-        continue;
-      }
-      Screen.setPixel(this->drops[i].x, this->drops[i].y, RainPlugin::LED_TYPE_ON, 255);
-    }
+    cloud.x = rng.below(COLS) * PARTICLE_ONE;
+    drops.emit(cloud);
   }
+
+  drops.draw(*canvas);
 }
 
 const char *RainPlugin::getName() const
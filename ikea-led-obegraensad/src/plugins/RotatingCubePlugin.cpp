@@ -15,7 +15,7 @@ static const int cubeEdges[12][2] = {
 
 void RotatingCubePlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   angleX = 0.3f;
   angleY = 0.5f;
   angleZ = 0.0f;
@@ -27,7 +27,7 @@ void RotatingCubePlugin::loop()
   if (!frameTimer.isReady(50))
     return;
 
-  Screen.clear();
+  canvas->clear();
 
   // Precompute trig values (48 -> 6 calls)
   float cx = cosf(angleX), sx_r = sinf(angleX);
@@ -76,7 +76,7 @@ void RotatingCubePlugin::loop()
   {
     int v0 = cubeEdges[i][0];
     int v1 = cubeEdges[i][1];
-    Screen.drawLine(projected[v0][0], projected[v0][1],
+    canvas->drawLine(projected[v0][0], projected[v0][1],
                     projected[v1][0], projected[v1][1], 1, 200);
   }
 
@@ -87,7 +87,7 @@ void RotatingCubePlugin::loop()
     int py = projected[i][1];
     if (px >= 0 && px < 16 && py >= 0 && py < 16)
     {
-      Screen.setPixel(px, py, 1, 255);
+      canvas->setPixel(px, py, 1, 255);
     }
   }
 
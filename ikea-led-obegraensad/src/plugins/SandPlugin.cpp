@@ -2,7 +2,7 @@
 
 void SandPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   memset(grid, 0, sizeof(grid));
 }
 
@@ -83,19 +83,19 @@ void SandPlugin::loop()
   if (count > 40)
   {
     memset(grid, 0, sizeof(grid));
-    Screen.clear();
+    canvas->clear();
     return;
   }
 
   // Render
-  Screen.clear();
+  canvas->clear();
   for (int y = 0; y < 16; y++)
   {
     for (int x = 0; x < 16; x++)
     {
       if (grid[y][x] > 0)
       {
-        Screen.setPixel(x, y, 1, grid[y][x]);
+        canvas->setPixel(x, y, 1, grid[y][x]);
       }
     }
   }
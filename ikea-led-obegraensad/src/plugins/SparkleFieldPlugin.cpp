@@ -2,8 +2,13 @@
 
 void SparkleFieldPlugin::setup()
 {
-  Screen.clear();
-  memset(sparkles, 0, sizeof(sparkles));
+  canvas->clear();
+
+  sparkles.clear();
+  sparkles.setFade(FADE_LINEAR);
+
+  sparkle.lifeMin = SPARKLE_FRAMES;
+  sparkle.lifeMax = SPARKLE_FRAMES;
 }
 
 void SparkleFieldPlugin::loop()
@@ -13,34 +18,19 @@ void SparkleFieldPlugin::loop()
     return;
   }
 
-  for (uint8_t y = 0; y < 16; y++)
-  {
-    for (uint8_t x = 0; x < 16; x++)
-    {
-      uint8_t value = sparkles[y][x];
-      sparkles[y][x] = (value > 18) ? value - 18 : 0;
-    }
-  }
+  canvas->clear();
 
-  for (uint8_t i = 0; i < 6; i++)
-  {
-    uint8_t x = static_cast<uint8_t>(random(0, 16));
-    uint8_t y = static_cast<uint8_t>(random(0, 16));
-    sparkles[y][x] = 255;
-  }
+  sparkles.update();
 
-  Screen.clear();
-  for (uint8_t y = 0; y < 16; y++)
+  Xorshift32 &rng = sparkles.getRandom();
+  for (uint8_t i = 0; i < SPARKLES_PER_FRAME; i++)
   {
-    for (uint8_t x = 0; x < 16; x++)
-    {
-      uint8_t value = sparkles[y][x];
-      if (value > 0)
-      {
-        Screen.setPixel(x, y, 1, value);
-      }
-    }
+    sparkle.x = rng.below(COLS) * PARTICLE_ONE;
+    sparkle.y = rng.below(ROWS) * PARTICLE_ONE;
+    sparkles.emit(sparkle);
   }
+
+  sparkles.draw(*canvas);
 }
 
 const char *SparkleFieldPlugin::getName() const
@@ -1,17 +1,120 @@
 #include "plugins/SpectrumPlugin.h"
 
+static constexpr uint16_t AUDIO_FRAME_MS = 10;
+static constexpr uint16_t IDLE_FRAME_MS = 40;
+// back to the idle animation when the stream stops for this long
+static constexpr uint16_t AUDIO_TIMEOUT_MS = 1000;
+static constexpr uint16_t PEAK_HOLD_MS = 300;
+
 void SpectrumPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   for (int i = 0; i < 16; i++)
   {
     levels[i] = 0;
     targets[i] = random(2, 14);
     peaks[i] = 0;
+    peakTimes[i] = 0;
+  }
+
+#ifdef ASYNC_UDP_ENABLED
+  audio = new AudioSpectrum();
+  sampleRate = audio->getSampleRate();
+  sequenced = false;
+  lastWritten = audio->getWritten();
+  lastAudio = 0;
+
+  udp = new AsyncUDP();
+  if (udp->listen(AUDIO_PORT))
+  {
+    Serial.printf("[Spectrum] Listening for audio on UDP port %u\n", AUDIO_PORT);
+    udp->onPacket([this](AsyncUDPPacket packet) { receive(packet.data(), packet.length()); });
   }
+#endif
 }
 
-void SpectrumPlugin::loop()
+void SpectrumPlugin::teardown()
+{
+#ifdef ASYNC_UDP_ENABLED
+  // the socket goes first so no packet lands in a deleted ring buffer
+  if (udp)
+  {
+    delete udp;
+    udp = nullptr;
+  }
+  if (audio)
+  {
+    delete audio;
+    audio = nullptr;
+  }
+#endif
+}
+
+#ifdef ASYNC_UDP_ENABLED
+void SpectrumPlugin::receive(const uint8_t *data, size_t length)
+{
+  if (length <= AUDIO_HEADER_SIZE || data[0] != 'A' || data[1] != 'U' || data[2] != 1 ||
+      data[3] != 1)
+  {
+    return;
+  }
+
+  uint32_t rate = data[4] | data[5] << 8 | data[6] << 16 | (uint32_t)data[7] << 24;
+  uint32_t sequence = data[8] | data[9] << 8 | data[10] << 16 | (uint32_t)data[11] << 24;
+
+  // drop packets that arrive after a newer one; a big jump back is a restarted sender
+  int32_t ahead = (int32_t)(sequence - lastSequence);
+  if (sequenced && ahead <= 0 && ahead > -64)
+  {
+    return;
+  }
+  sequenced = true;
+  lastSequence = sequence;
+
+  sampleRate = rate;
+  audio->push(data + AUDIO_HEADER_SIZE, (length - AUDIO_HEADER_SIZE) / 2);
+}
+
+void SpectrumPlugin::showAudio()
+{
+  // the band table belongs to the render side, so rate changes are applied here
+  if (sampleRate != audio->getSampleRate())
+  {
+    audio->setSampleRate(sampleRate);
+  }
+
+  uint8_t bands[AUDIO_BANDS];
+  audio->analyze(bands);
+
+  unsigned long now = millis();
+  for (int i = 0; i < 16; i++)
+  {
+    // bars jump up at once and sink smoothly, peaks hold before they fall
+    targets[i] = bands[i] * 16.0f / 255.0f;
+    if (levels[i] < targets[i])
+      levels[i] = targets[i];
+    else
+      levels[i] += (targets[i] - levels[i]) * 0.12f;
+
+    if (levels[i] >= peaks[i])
+    {
+      peaks[i] = levels[i];
+      peakTimes[i] = now;
+    }
+    else if (now - peakTimes[i] > PEAK_HOLD_MS)
+    {
+      peaks[i] -= 0.08f;
+    }
+
+    if (peaks[i] < 0)
+      peaks[i] = 0;
+  }
+
+  drawBars();
+}
+#endif
+
+void SpectrumPlugin::showIdle()
 {
   // Generate new random targets periodically
   if (targetTimer.isReady(300))
@@ -24,11 +127,9 @@ void SpectrumPlugin::loop()
     }
   }
 
-  if (!frameTimer.isReady(40))
+  if (!frameTimer.isReady(IDLE_FRAME_MS))
     return;
 
-  Screen.clear();
-
   for (int i = 0; i < 16; i++)
   {
     // Smooth approach to target
@@ -45,7 +146,17 @@ void SpectrumPlugin::loop()
 
     if (peaks[i] < 0)
       peaks[i] = 0;
+  }
+
+  drawBars();
+}
 
+void SpectrumPlugin::drawBars()
+{
+  canvas->clear();
+
+  for (int i = 0; i < 16; i++)
+  {
     int barHeight = (int)(levels[i] + 0.5f);
 
     // Draw bar from bottom up
@@ -54,18 +165,41 @@ void SpectrumPlugin::loop()
       int screenY = 15 - y;
       // Gradient: brighter at top
       uint8_t brightness = 80 + (uint8_t)((175.0f * y) / 15.0f);
-      Screen.setPixel(i, screenY, 1, brightness);
+      canvas->setPixel(i, screenY, 1, brightness);
     }
 
     // Draw peak dot
     int peakY = 15 - (int)(peaks[i] + 0.5f);
     if (peakY >= 0 && peakY < 16)
     {
-      Screen.setPixel(i, peakY, 1, 255);
+      canvas->setPixel(i, peakY, 1, 255);
     }
   }
 }
 
+void SpectrumPlugin::loop()
+{
+#ifdef ASYNC_UDP_ENABLED
+  uint32_t written = audio->getWritten();
+  if (written != lastWritten)
+  {
+    lastWritten = written;
+    lastAudio = millis();
+  }
+
+  if (lastAudio && millis() - lastAudio < AUDIO_TIMEOUT_MS)
+  {
+    if (frameTimer.isReady(AUDIO_FRAME_MS))
+    {
+      showAudio();
+    }
+    return;
+  }
+#endif
+
+  showIdle();
+}
+
 const char *SpectrumPlugin::getName() const
 {
   return "Spectrum";
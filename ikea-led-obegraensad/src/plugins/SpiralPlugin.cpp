@@ -3,7 +3,7 @@
 
 void SpiralPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   angle = 0;
   radius = 0;
   expanding = true;
@@ -19,13 +19,13 @@ void SpiralPlugin::loop()
   {
     for (uint8_t y = 0; y < HEIGHT; y++)
     {
-      uint8_t brightness = Screen.getBufferIndex(y * WIDTH + x);
+      uint8_t brightness = canvas->getBufferIndex(y * WIDTH + x);
       if (brightness > 20)
         brightness -= 20;
       else
         brightness = 0;
       
-      Screen.setPixel(x, y, 1, brightness);
+      canvas->setPixel(x, y, 1, brightness);
     }
   }
 
@@ -43,7 +43,7 @@ void SpiralPlugin::loop()
       if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
       {
         uint8_t brightness = 255 - (i * 40);
-        Screen.setPixel(x, y, 1, brightness);
+        canvas->setPixel(x, y, 1, brightness);
       }
     }
   }
@@ -2,56 +2,42 @@
 
 void StarsPlugin::setup()
 {
-  numStars = 25;
-  for (int i = 0; i < numStars; i++)
-  {
-    stars[i].x = random(0, 16);
-    stars[i].y = random(0, 16);
-    stars[i].brightness = random(255);
-    stars[i].lastUpdateTime = millis();
-  }
+  canvas->clear();
+
+  stars.clear();
+  stars.setFade(FADE_LINEAR);
+
+  // a star lights up at a random spot and fades out over 2 to 4 s
+  sky.lifeMin = 32;
+  sky.lifeMax = 64;
+  sky.brightnessMin = 8;
+  timer.forceReady();
 }
 
 void StarsPlugin::loop()
 {
-  for (int fadeStep = 255; fadeStep >= 0; fadeStep -= 4)
+  if (!timer.isReady(64))
+    return;
+
+  canvas->clear();
+
+  stars.update();
+
+  Xorshift32 &rng = stars.getRandom();
+  while (stars.getCount() < NUM_STARS)
   {
-    for (int i = 0; i < numStars; i++)
-    {
-      if (stars[i].brightness > 0)
-      {
-        unsigned long currentTime = millis();
-        if (currentTime - stars[i].lastUpdateTime >= 128)
-        {
-          stars[i].brightness = max(0, stars[i].brightness - 8);
-          Screen.setPixel(stars[i].x, stars[i].y, 1, stars[i].brightness);
-          stars[i].lastUpdateTime = currentTime;
-        }
-      }
-      else
-      {
-        stars[i].x = random(0, 16);
-        stars[i].y = random(0, 16);
-        stars[i].brightness = random(8, 255);
-
-        for (int brightness = 0; brightness <= stars[i].brightness; brightness += 5)
-        {
-          unsigned long currentTime = millis();
-          if (currentTime - stars[i].lastUpdateTime >= 64)
-          {
-            Screen.setPixel(stars[i].x, stars[i].y, 1, brightness);
-            stars[i].lastUpdateTime = currentTime;
-          }
-        }
-      }
-    }
+    sky.x = rng.below(COLS) * PARTICLE_ONE;
+    sky.y = rng.below(ROWS) * PARTICLE_ONE;
+    stars.emit(sky);
   }
+
+  stars.draw(*canvas);
 }
 
 void StarsPlugin::teardown()
 {
-  numStars = 0;
-  Screen.clear();
+  stars.clear();
+  canvas->clear();
 }
 
 const char *StarsPlugin::getName() const
@@ -1,241 +1,118 @@
 #include "plugins/TetrisPlugin.h"
 
-struct TBlock { int8_t x, y; };
-
-// 7 piece types (I,O,T,S,Z,L,J), 4 rotations each, 4 blocks each
-static const TBlock PIECES[7][4][4] = {
-  // I
-  { {{0,0},{1,0},{2,0},{3,0}}, {{0,0},{0,1},{0,2},{0,3}},
-    {{0,0},{1,0},{2,0},{3,0}}, {{0,0},{0,1},{0,2},{0,3}} },
-  // O
-  { {{0,0},{1,0},{0,1},{1,1}}, {{0,0},{1,0},{0,1},{1,1}},
-    {{0,0},{1,0},{0,1},{1,1}}, {{0,0},{1,0},{0,1},{1,1}} },
-  // T
-  { {{0,0},{1,0},{2,0},{1,1}}, {{1,0},{0,1},{1,1},{1,2}},
-    {{1,0},{0,1},{1,1},{2,1}}, {{0,0},{0,1},{1,1},{0,2}} },
-  // S
-  { {{1,0},{2,0},{0,1},{1,1}}, {{0,0},{0,1},{1,1},{1,2}},
-    {{1,0},{2,0},{0,1},{1,1}}, {{0,0},{0,1},{1,1},{1,2}} },
-  // Z
-  { {{0,0},{1,0},{1,1},{2,1}}, {{1,0},{0,1},{1,1},{0,2}},
-    {{0,0},{1,0},{1,1},{2,1}}, {{1,0},{0,1},{1,1},{0,2}} },
-  // L
-  { {{0,0},{0,1},{0,2},{1,2}}, {{0,0},{1,0},{2,0},{0,1}},
-    {{0,0},{1,0},{1,1},{1,2}}, {{2,0},{0,1},{1,1},{2,1}} },
-  // J
-  { {{1,0},{1,1},{0,2},{1,2}}, {{0,0},{0,1},{1,1},{2,1}},
-    {{0,0},{1,0},{0,1},{0,2}}, {{0,0},{1,0},{2,0},{2,1}} },
-};
-
-static const int NUM_ROTATIONS[7] = {2, 1, 4, 2, 2, 4, 4};
 static const uint8_t PIECE_BRIGHT[7] = {255, 230, 210, 190, 170, 200, 180};
 
 void TetrisPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   dropTimer.forceReady();
   newGame();
 }
 
 void TetrisPlugin::newGame()
 {
+  engine.clear();
   memset(board, 0, sizeof(board));
+  pieces = 0;
+  lines = 0;
+  searchMicros = 0;
+  nextType = random(0, 7);
   state = PLAYING;
   spawnPiece();
 }
 
 void TetrisPlugin::spawnPiece()
 {
-  currentType = random(0, 7);
-  chooseBestPlacement(currentType, currentRot, currentX);
-
-  // Start piece so topmost block is at row 0
-  int minY = 3;
-  for (int i = 0; i < 4; i++)
-  {
-    if (PIECES[currentType][currentRot][i].y < minY)
-      minY = PIECES[currentType][currentRot][i].y;
-  }
-  currentY = -minY;
-
-  if (!canPlace(currentType, currentRot, currentX, currentY))
-  {
-    state = GAMEOVER;
-    animCount = 0;
-    gameOverRow = 0;
-  }
+  currentType = nextType;
+  nextType = random(0, 7);
+  // the placement is searched over the next loop() calls, see think()
+  engine.beginSearch(currentType, nextType);
+  thinking = true;
 }
 
-bool TetrisPlugin::canPlace(int type, int rot, int x, int y)
+void TetrisPlugin::think()
 {
-  for (int i = 0; i < 4; i++)
-  {
-    int bx = x + PIECES[type][rot][i].x;
-    int by = y + PIECES[type][rot][i].y;
-    if (bx < 0 || bx >= FIELD_W || by >= FIELD_H)
-      return false;
-    if (by >= 0 && board[by][bx] != 0)
-      return false;
-  }
-  return true;
-}
+  uint16_t maxEvaluations = max<uint32_t>(1, SEARCH_BUDGET_US * 16 / evalCost16);
+  uint32_t evaluationsBefore = engine.getEvaluations();
+  uint32_t start = micros();
+  bool done = engine.searchStep(maxEvaluations);
+  uint32_t elapsed = micros() - start;
+  uint32_t evaluations = engine.getEvaluations() - evaluationsBefore;
 
-int TetrisPlugin::findDropY(int type, int rot, int x)
-{
-  int minY = 3;
-  for (int i = 0; i < 4; i++)
+  searchMicros += elapsed;
+  if (evaluations > 0)
   {
-    if (PIECES[type][rot][i].y < minY)
-      minY = PIECES[type][rot][i].y;
+    // moving average, so the budget follows CPU load and board shape
+    evalCost16 = max<uint32_t>(1, (evalCost16 * 3 + elapsed * 16 / evaluations) / 4);
   }
-  int y = -minY;
-  while (canPlace(type, rot, x, y + 1))
-    y++;
-  return y;
-}
 
-void TetrisPlugin::lockPiece()
-{
-  for (int i = 0; i < 4; i++)
+  if (!done)
   {
-    int bx = currentX + PIECES[currentType][currentRot][i].x;
-    int by = currentY + PIECES[currentType][currentRot][i].y;
-    if (by >= 0 && by < FIELD_H && bx >= 0 && bx < FIELD_W)
-      board[by][bx] = currentType + 1;
+    return;
   }
-}
 
-bool TetrisPlugin::hasCompleteLines()
-{
-  for (int y = 0; y < FIELD_H; y++)
+  thinking = false;
+  TetrisPlacement placement;
+  if (!engine.getBest(placement))
   {
-    bool full = true;
-    for (int x = 0; x < FIELD_W; x++)
-    {
-      if (board[y][x] == 0) { full = false; break; }
-    }
-    if (full) return true;
+    Serial.printf("[Tetris] Game over after %u pieces, %u lines, %u us search per piece\n",
+                  pieces, lines, pieces ? searchMicros / pieces : 0);
+    state = GAMEOVER;
+    animCount = 0;
+    gameOverRow = 0;
+    return;
   }
-  return false;
-}
 
-void TetrisPlugin::removeCompleteLines()
-{
-  for (int y = FIELD_H - 1; y >= 0; y--)
-  {
-    bool full = true;
-    for (int x = 0; x < FIELD_W; x++)
-    {
-      if (board[y][x] == 0) { full = false; break; }
-    }
-    if (full)
-    {
-      for (int row = y; row > 0; row--)
-        memcpy(board[row], board[row - 1], FIELD_W);
-      memset(board[0], 0, FIELD_W);
-      y++; // recheck this row
-    }
-  }
+  currentRot = placement.rotation;
+  currentX = placement.x;
+  currentY = 0;
+  pieces++;
+  drawBoard();
 }
 
-void TetrisPlugin::chooseBestPlacement(int type, int &outRot, int &outX)
+void TetrisPlugin::lockPiece()
 {
-  int bestScore = -99999;
-  outRot = 0;
-  outX = FIELD_W / 2 - 1;
+  engine.lock(currentType, currentRot, currentX, currentY);
 
-  for (int rot = 0; rot < NUM_ROTATIONS[type]; rot++)
+  const TetrisShape &shape = TetrisEngine::getShape(currentType, currentRot);
+  for (int i = 0; i < shape.height; i++)
   {
-    int minBX = 3, maxBX = 0;
-    for (int i = 0; i < 4; i++)
-    {
-      if (PIECES[type][rot][i].x < minBX) minBX = PIECES[type][rot][i].x;
-      if (PIECES[type][rot][i].x > maxBX) maxBX = PIECES[type][rot][i].x;
-    }
-
-    for (int x = -minBX; x <= FIELD_W - 1 - maxBX; x++)
+    for (int x = 0; x < shape.width; x++)
     {
-      int dropY = findDropY(type, rot, x);
-      if (!canPlace(type, rot, x, dropY))
-        continue;
-
-      int score = evaluatePlacement(type, rot, x) + random(-15, 16);
-      if (score > bestScore)
-      {
-        bestScore = score;
-        outRot = rot;
-        outX = x;
-      }
+      if (shape.rows[i] & (1 << x))
+        board[currentY + i][currentX + x] = currentType + 1;
     }
   }
 }
 
-int TetrisPlugin::evaluatePlacement(int type, int rot, int x)
+void TetrisPlugin::removeCompleteLines()
 {
-  int y = findDropY(type, rot, x);
-
-  // Temporarily place piece on a copy
-  uint8_t temp[FIELD_H][FIELD_W];
-  memcpy(temp, board, sizeof(board));
-
-  for (int i = 0; i < 4; i++)
-  {
-    int bx = x + PIECES[type][rot][i].x;
-    int by = y + PIECES[type][rot][i].y;
-    if (by >= 0 && by < FIELD_H && bx >= 0 && bx < FIELD_W)
-      temp[by][bx] = type + 1;
-  }
-
-  // Count complete lines
-  int lines = 0;
-  for (int row = 0; row < FIELD_H; row++)
-  {
-    bool full = true;
-    for (int col = 0; col < FIELD_W; col++)
-    {
-      if (temp[row][col] == 0) { full = false; break; }
-    }
-    if (full) lines++;
-  }
-
-  // Column stats: height, holes, bumpiness
-  int aggHeight = 0;
-  int holes = 0;
-  int bumpiness = 0;
-  int prevH = 0;
-
-  for (int col = 0; col < FIELD_W; col++)
+  uint16_t full = engine.getFullRows();
+  int write = FIELD_H - 1;
+  for (int y = FIELD_H - 1; y >= 0; y--)
   {
-    int h = 0;
-    bool foundBlock = false;
-    for (int row = 0; row < FIELD_H; row++)
+    if (!(full & (1 << y)))
     {
-      if (temp[row][col] != 0)
-      {
-        if (!foundBlock) { h = FIELD_H - row; foundBlock = true; }
-      }
-      else if (foundBlock)
-      {
-        holes++;
-      }
+      if (write != y)
+        memcpy(board[write], board[y], FIELD_W);
+      write--;
     }
-    aggHeight += h;
-    if (col > 0) bumpiness += abs(h - prevH);
-    prevH = h;
   }
+  for (; write >= 0; write--)
+    memset(board[write], 0, FIELD_W);
 
-  return lines * 100 - aggHeight - holes * 40 - bumpiness * 10;
+  lines += engine.removeFullRows();
 }
 
 void TetrisPlugin::drawBoard()
 {
-  Screen.clear();
+  canvas->clear();
 
   // Side borders
   for (int y = 0; y < FIELD_H; y++)
   {
-    Screen.setPixel(OFFSET_X - 1, y, 1, 30);
-    Screen.setPixel(OFFSET_X + FIELD_W, y, 1, 30);
+    canvas->setPixel(OFFSET_X - 1, y, 1, 30);
+    canvas->setPixel(OFFSET_X + FIELD_W, y, 1, 30);
   }
 
   // Placed blocks
@@ -244,25 +121,34 @@ void TetrisPlugin::drawBoard()
     for (int x = 0; x < FIELD_W; x++)
     {
       if (board[y][x] != 0)
-        Screen.setPixel(OFFSET_X + x, y, 1, PIECE_BRIGHT[board[y][x] - 1]);
+        canvas->setPixel(OFFSET_X + x, y, 1, PIECE_BRIGHT[board[y][x] - 1]);
     }
   }
 
   // Falling piece
-  if (state == PLAYING)
+  if (state == PLAYING && !thinking)
   {
-    for (int i = 0; i < 4; i++)
+    const TetrisShape &shape = TetrisEngine::getShape(currentType, currentRot);
+    for (int i = 0; i < shape.height; i++)
     {
-      int bx = currentX + PIECES[currentType][currentRot][i].x;
-      int by = currentY + PIECES[currentType][currentRot][i].y;
-      if (by >= 0 && by < FIELD_H && bx >= 0 && bx < FIELD_W)
-        Screen.setPixel(OFFSET_X + bx, by, 1, PIECE_BRIGHT[currentType]);
+      for (int x = 0; x < shape.width; x++)
+      {
+        if (shape.rows[i] & (1 << x))
+          canvas->setPixel(OFFSET_X + currentX + x, currentY + i, 1, PIECE_BRIGHT[currentType]);
+      }
     }
   }
 }
 
 void TetrisPlugin::loop()
 {
+  // the search is not tied to the drop timer, it finishes within a few calls
+  if (state == PLAYING && thinking)
+  {
+    think();
+    return;
+  }
+
   int interval;
   switch (state)
   {
@@ -277,14 +163,14 @@ void TetrisPlugin::loop()
   switch (state)
   {
   case PLAYING:
-    if (canPlace(currentType, currentRot, currentX, currentY + 1))
+    if (engine.canPlace(currentType, currentRot, currentX, currentY + 1))
     {
       currentY++;
     }
     else
     {
       lockPiece();
-      if (hasCompleteLines())
+      if (engine.getFullRows())
       {
         state = CLEARING;
         animCount = 0;
@@ -298,21 +184,18 @@ void TetrisPlugin::loop()
     break;
 
   case CLEARING:
+  {
     animCount++;
     drawBoard();
     // Flash complete lines
+    uint16_t full = engine.getFullRows();
     for (int y = 0; y < FIELD_H; y++)
     {
-      bool full = true;
-      for (int x = 0; x < FIELD_W; x++)
-      {
-        if (board[y][x] == 0) { full = false; break; }
-      }
-      if (full)
+      if (full & (1 << y))
       {
         uint8_t b = (animCount % 2 == 0) ? 255 : 0;
         for (int x = 0; x < FIELD_W; x++)
-          Screen.setPixel(OFFSET_X + x, y, b ? 1 : 0, b);
+          canvas->setPixel(OFFSET_X + x, y, b ? 1 : 0, b);
       }
     }
     if (animCount >= 6)
@@ -322,6 +205,7 @@ void TetrisPlugin::loop()
       spawnPiece();
     }
     break;
+  }
 
   case GAMEOVER:
     animCount++;
@@ -329,7 +213,7 @@ void TetrisPlugin::loop()
     {
       // Flash board
       if (animCount % 2 == 0) drawBoard();
-      else Screen.clear();
+      else canvas->clear();
     }
     else
     {
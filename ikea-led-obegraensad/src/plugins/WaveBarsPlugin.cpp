@@ -3,7 +3,7 @@
 
 void WaveBarsPlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   phase = 0.0f;
 }
 
@@ -14,7 +14,7 @@ void WaveBarsPlugin::loop()
     return;
   }
 
-  Screen.clear();
+  canvas->clear();
 
   for (uint8_t x = 0; x < 16; x++)
   {
@@ -25,7 +25,7 @@ void WaveBarsPlugin::loop()
       if (y >= 0 && y < 16)
       {
         uint8_t brightness = static_cast<uint8_t>(120 + wave * 120.0f);
-        Screen.setPixel(x, static_cast<uint8_t>(y), 1, brightness);
+        canvas->setPixel(x, static_cast<uint8_t>(y), 1, brightness);
       }
     }
   }
@@ -3,7 +3,7 @@
 
 void WavePlugin::setup()
 {
-  Screen.clear();
+  canvas->clear();
   phase = 0;
   waveSpeed = 0.2;
 }
@@ -29,7 +29,7 @@ void WavePlugin::loop()
       // Convert to brightness (0-255)
       uint8_t brightness = (uint8_t)(((combined + 1.0) / 2.0) * 255);
       
-      Screen.setPixel(x, y, 1, brightness);
+      canvas->setPixel(x, y, 1, brightness);
     }
   }
 
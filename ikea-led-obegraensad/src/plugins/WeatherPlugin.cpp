@@ -1,220 +1,162 @@
 #include "plugins/WeatherPlugin.h"
 #include "config.h"
+#include "fetchservice.h"
 
 // https://github.com/chubin/wttr.in/blob/master/share/translations/en.txt
-#ifdef ESP32
-#include <WiFi.h>
-#endif
-#ifdef ESP8266
-#include <ESP8266WiFi.h>
-WiFiClient wiFiClient;
-#endif
 
 void WeatherPlugin::setup()
 {
-  Screen.clear();
-
-  // If we have cached data and it's still fresh (< 30 minutes old), redraw it
-  if (hasCachedData && lastUpdate > 0 && millis() >= lastUpdate &&
-      millis() - lastUpdate < (1000UL * 60 * 30))
-  {
-    Serial.println("Using cached weather data");
-    drawWeather();
-  }
-  else
-  {
-    // Show loading screen - data needs to be fetched
-    currentStatus = LOADING;
-    Screen.setPixel(4, 7, 1);
-    Screen.setPixel(5, 7, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(8, 7, 1);
-    Screen.setPixel(10, 7, 1);
-    Screen.setPixel(11, 7, 1);
-    currentStatus = NONE;
-
-    // Clear lastUpdate to force immediate fetch on first loop
-    this->lastUpdate = 0;
-  }
+  canvas->clear();
+  shownCode = -1;
+  shownTemperature = INT16_MIN;
+
+  // Show loading screen until the fetch service has data for the location
+  currentStatus = LOADING;
+  canvas->setPixel(4, 7, 1);
+  canvas->setPixel(5, 7, 1);
+  canvas->setPixel(7, 7, 1);
+  canvas->setPixel(8, 7, 1);
+  canvas->setPixel(10, 7, 1);
+  canvas->setPixel(11, 7, 1);
+  currentStatus = NONE;
+
+  update();
 }
 
 void WeatherPlugin::loop()
 {
-  if (this->lastUpdate == 0 || millis() >= this->lastUpdate + (1000 * 60 * 30))
+  if (updateTimer.isReady(1000))
   {
-    this->update();
-    this->lastUpdate = millis();
-    Serial.println("updating weather");
-  };
+    update();
+  }
 }
 
 void WeatherPlugin::update()
 {
-  // Check WiFi connection first
-  if (WiFi.status() != WL_CONNECTED)
-  {
-    Serial.println("WiFi not connected, skipping weather update");
-    return;
-  }
-
-  String weatherLocation = config.getWeatherLocation();
-  Serial.print("[WeatherPlugin] Fetching weather for configured city: ");
-  Serial.println(weatherLocation);
-
   // Use HTTP to save RAM and avoid SSL handshake issues
-  String weatherApiString = "http://wttr.in/" + weatherLocation + "?format=j2&lang=en";
-  Serial.print("[WeatherPlugin] API request: ");
-  Serial.println(weatherApiString);
-
-#ifdef ESP32
-  WiFiClient client;
-  http.begin(client, weatherApiString);
-#endif
-#ifdef ESP8266
-  http.begin(wiFiClient, weatherApiString);
-#endif
-
-  http.setTimeout(20000);
-
-  Serial.println("Sending HTTP GET request...");
-  int code = http.GET();
-  Serial.print("HTTP response code: ");
-  Serial.println(code);
-
-  if (code == HTTP_CODE_OK)
-  {
-    // Check content length to avoid massive allocations if something is wrong
-    int len = http.getSize();
-    Serial.print("Content-Length: ");
-    Serial.println(len);
+  String weatherApiString = "http://wttr.in/" + config.getWeatherLocation() + "?format=j2&lang=en";
 
-    // Stream the response directly to JSON parser to save RAM
-    // instead of loading the whole string into memory
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, http.getStream());
+  WeatherData data;
+  FetchStatus status = FetchService.get(FETCH_WTTR_CURRENT, weatherApiString.c_str(), 1000UL * 60 * 30, data);
 
-    if (error)
+  if (!status.hasData)
+  {
+    if (!status.pending && status.lastHttpCode != 0 && shownCode != -2)
     {
-      Serial.print("JSON parsing failed: ");
-      Serial.println(error.c_str());
-      http.end();
-      return;
+      shownCode = -2;
+      drawError();
     }
+    return;
+  }
 
-    int temperature = round(doc["current_condition"][0]["temp_C"].as<float>());
-    int weatherCode = doc["current_condition"][0]["weatherCode"].as<int>();
-    int weatherIcon = 0;
-    int iconY = 1;
-    int tempY = 10;
-
-    if (std::find(thunderCodes.begin(), thunderCodes.end(), weatherCode) != thunderCodes.end())
-    {
-      weatherIcon = 1;
-    }
-    else if (std::find(rainCodes.begin(), rainCodes.end(), weatherCode) != rainCodes.end())
-    {
-      weatherIcon = 4;
-    }
-    else if (std::find(snowCodes.begin(), snowCodes.end(), weatherCode) != snowCodes.end())
-    {
-      weatherIcon = 5;
-    }
-    else if (std::find(fogCodes.begin(), fogCodes.end(), weatherCode) != fogCodes.end())
-    {
-      weatherIcon = 6;
-      iconY = 2;
-    }
-    else if (std::find(clearCodes.begin(), clearCodes.end(), weatherCode) != clearCodes.end())
-    {
-      weatherIcon = 2;
-      iconY = 1;
-      tempY = 9;
-    }
-    else if (std::find(cloudyCodes.begin(), cloudyCodes.end(), weatherCode) != cloudyCodes.end())
-    {
-      weatherIcon = 0;
-      iconY = 2;
-      tempY = 9;
-    }
-    else if (std::find(partyCloudyCodes.begin(), partyCloudyCodes.end(), weatherCode) !=
-             partyCloudyCodes.end())
-    {
-      weatherIcon = 3;
-      iconY = 2;
-    }
+  int temperature = round(data.temperature);
+  int weatherCode = data.code;
+  if (weatherCode == shownCode && temperature == shownTemperature)
+  {
+    return;
+  }
+  shownCode = weatherCode;
+  shownTemperature = temperature;
 
-    // Cache the weather data
-    hasCachedData = true;
-    cachedTemperature = temperature;
-    cachedWeatherIcon = weatherIcon;
-    cachedIconY = iconY;
-    cachedTempY = tempY;
+  int weatherIcon = 0;
+  int iconY = 1;
+  int tempY = 10;
 
-    // Draw the weather
-    drawWeather();
+  if (std::find(thunderCodes.begin(), thunderCodes.end(), weatherCode) != thunderCodes.end())
+  {
+    weatherIcon = 1;
   }
-  else
+  else if (std::find(rainCodes.begin(), rainCodes.end(), weatherCode) != rainCodes.end())
   {
-    Serial.print("HTTP request failed with code: ");
-    Serial.println(code);
-
-    Screen.clear();
-
-    Screen.setPixel(7, 4, 1);
-    Screen.setPixel(8, 4, 1);
-    Screen.setPixel(7, 5, 1);
-    Screen.setPixel(8, 5, 1);
-    Screen.setPixel(7, 6, 1);
-    Screen.setPixel(8, 6, 1);
-    Screen.setPixel(7, 7, 1);
-    Screen.setPixel(8, 7, 1);
-    Screen.setPixel(7, 8, 1);
-    Screen.setPixel(8, 8, 1);
-
-    Screen.setPixel(7, 10, 1);
-    Screen.setPixel(8, 10, 1);
-    Screen.setPixel(7, 11, 1);
-    Screen.setPixel(8, 11, 1);
+    weatherIcon = 4;
   }
+  else if (std::find(snowCodes.begin(), snowCodes.end(), weatherCode) != snowCodes.end())
+  {
+    weatherIcon = 5;
+  }
+  else if (std::find(fogCodes.begin(), fogCodes.end(), weatherCode) != fogCodes.end())
+  {
+    weatherIcon = 6;
+    iconY = 2;
+  }
+  else if (std::find(clearCodes.begin(), clearCodes.end(), weatherCode) != clearCodes.end())
+  {
+    weatherIcon = 2;
+    iconY = 1;
+    tempY = 9;
+  }
+  else if (std::find(cloudyCodes.begin(), cloudyCodes.end(), weatherCode) != cloudyCodes.end())
+  {
+    weatherIcon = 0;
+    iconY = 2;
+    tempY = 9;
+  }
+  else if (std::find(partyCloudyCodes.begin(), partyCloudyCodes.end(), weatherCode) !=
+           partyCloudyCodes.end())
+  {
+    weatherIcon = 3;
+    iconY = 2;
+  }
+
+  cachedTemperature = temperature;
+  cachedWeatherIcon = weatherIcon;
+  cachedIconY = iconY;
+  cachedTempY = tempY;
 
-  http.end();
+  drawWeather();
 }
 
-void WeatherPlugin::teardown()
+void WeatherPlugin::drawError()
 {
-  http.end();
+  canvas->clear();
+
+  canvas->setPixel(7, 4, 1);
+  canvas->setPixel(8, 4, 1);
+  canvas->setPixel(7, 5, 1);
+  canvas->setPixel(8, 5, 1);
+  canvas->setPixel(7, 6, 1);
+  canvas->setPixel(8, 6, 1);
+  canvas->setPixel(7, 7, 1);
+  canvas->setPixel(8, 7, 1);
+  canvas->setPixel(7, 8, 1);
+  canvas->setPixel(8, 8, 1);
+
+  canvas->setPixel(7, 10, 1);
+  canvas->setPixel(8, 10, 1);
+  canvas->setPixel(7, 11, 1);
+  canvas->setPixel(8, 11, 1);
 }
 
 void WeatherPlugin::drawWeather()
 {
-  Screen.clear();
-  Screen.drawWeather(0, cachedIconY, cachedWeatherIcon, 100);
+  canvas->clear();
+  canvas->drawWeather(0, cachedIconY, cachedWeatherIcon, 100);
 
   int temperature = cachedTemperature;
   int tempY = cachedTempY;
 
   if (temperature >= 10)
   {
-    Screen.drawCharacter(9, tempY, Screen.readBytes(degreeSymbol), 4, 50);
-    Screen.drawNumbers(1, tempY, {(temperature - temperature % 10) / 10, temperature % 10});
+    canvas->drawCharacter(9, tempY, canvas->readBytes(degreeSymbol), 4, 50);
+    canvas->drawNumbers(1, tempY, {(temperature - temperature % 10) / 10, temperature % 10});
   }
   else if (temperature <= -10)
   {
-    Screen.drawCharacter(0, tempY, Screen.readBytes(minusSymbol), 4);
-    Screen.drawCharacter(11, tempY, Screen.readBytes(degreeSymbol), 4, 50);
+    canvas->drawCharacter(0, tempY, canvas->readBytes(minusSymbol), 4);
+    canvas->drawCharacter(11, tempY, canvas->readBytes(degreeSymbol), 4, 50);
     temperature *= -1;
-    Screen.drawNumbers(3, tempY, {(temperature - temperature % 10) / 10, temperature % 10});
+    canvas->drawNumbers(3, tempY, {(temperature - temperature % 10) / 10, temperature % 10});
   }
   else if (temperature >= 0)
   {
-    Screen.drawCharacter(7, tempY, Screen.readBytes(degreeSymbol), 4, 50);
-    Screen.drawNumbers(4, tempY, {temperature});
+    canvas->drawCharacter(7, tempY, canvas->readBytes(degreeSymbol), 4, 50);
+    canvas->drawNumbers(4, tempY, {temperature});
   }
   else
   {
-    Screen.drawCharacter(0, tempY, Screen.readBytes(minusSymbol), 4);
-    Screen.drawCharacter(9, tempY, Screen.readBytes(degreeSymbol), 4, 50);
-    Screen.drawNumbers(3, tempY, {-temperature});
+    canvas->drawCharacter(0, tempY, canvas->readBytes(minusSymbol), 4);
+    canvas->drawCharacter(9, tempY, canvas->readBytes(degreeSymbol), 4, 50);
+    canvas->drawNumbers(3, tempY, {-temperature});
   }
 }
 
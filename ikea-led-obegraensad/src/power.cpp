@@ -0,0 +1,296 @@
+#include "power.h"
+#include "arena.h"
+#include "screen.h"
+#include "settings.h"
+
+#if defined(ENABLE_SERVER) && defined(ESP32)
+#include <WiFi.h>
+#endif
+
+Power_ &Power_::getInstance()
+{
+  static Power_ instance;
+  return instance;
+}
+
+static bool parseTime(const char *text, uint16_t &minutes)
+{
+  int hours = 0;
+  int mins = 0;
+  if (!text || sscanf(text, "%d:%d", &hours, &mins) != 2 || hours < 0 || hours > 23 || mins < 0 ||
+      mins > 59)
+  {
+    return false;
+  }
+  minutes = hours * 60 + mins;
+  return true;
+}
+
+void Power_::begin()
+{
+  String stored = Settings.getString(SETTING_POWER_WINDOWS);
+  if (stored.length() > 0 && !setWindowsByJSONString(stored))
+  {
+    Serial.println("[Power] Stored blanking windows invalid, ignoring them");
+  }
+}
+
+bool Power_::setWindowsByJSONString(const String &json)
+{
+  JsonArena arena;
+  JsonDocument doc(&arena);
+  DeserializationError error = deserializeJson(doc, json);
+  if (error || !doc.is<JsonArray>() || doc.size() > POWER_MAX_WINDOWS)
+  {
+    return false;
+  }
+
+  BlankingWindow parsed[POWER_MAX_WINDOWS];
+  uint8_t count = 0;
+  for (JsonObject item : doc.as<JsonArray>())
+  {
+    BlankingWindow &window = parsed[count];
+    if (!parseTime(item["start"].as<const char *>(), window.start) ||
+        !parseTime(item["end"].as<const char *>(), window.end))
+    {
+      return false;
+    }
+
+    window.days = 0x7f;
+    if (item["days"].is<JsonArray>())
+    {
+      window.days = 0;
+      for (int day : item["days"].as<JsonArray>())
+      {
+        if (day < 0 || day > 6)
+        {
+          return false;
+        }
+        window.days |= 1 << day;
+      }
+    }
+    count++;
+  }
+
+  memcpy(windows, parsed, sizeof(BlankingWindow) * count);
+  windowCount = count;
+  recheck = true;
+  Settings.setString(SETTING_POWER_WINDOWS, json);
+
+  Serial.printf("[Power] %u blanking window(s) set\n", count);
+  return true;
+}
+
+bool Power_::isScheduled(const struct tm &now) const
+{
+  uint16_t minute = now.tm_hour * 60 + now.tm_min;
+  uint8_t today = 1 << now.tm_wday;
+  uint8_t yesterday = 1 << ((now.tm_wday + 6) % 7);
+
+  for (uint8_t i = 0; i < windowCount; i++)
+  {
+    const BlankingWindow &window = windows[i];
+    bool inside;
+    if (window.start == window.end)
+    {
+      // whole day, e.g. weekends
+      inside = window.days & today;
+    }
+    else if (window.start < window.end)
+    {
+      inside = (window.days & today) && minute >= window.start && minute < window.end;
+    }
+    else
+    {
+      // spans midnight, the morning part belongs to the window started yesterday
+      inside = ((window.days & today) && minute >= window.start) ||
+               ((window.days & yesterday) && minute < window.end);
+    }
+
+    if (inside)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Power_::update()
+{
+  unsigned long now = millis();
+
+  if (recheck || now - lastCheck >= POWER_CHECK_INTERVAL_MS)
+  {
+    recheck = false;
+    lastCheck = now;
+
+    struct tm timeinfo;
+    bool wanted = windowCount > 0 && getLocalTime(&timeinfo, 0) &&
+                  timeinfo.tm_year >= (2020 - 1900) && isScheduled(timeinfo);
+    if (wanted != scheduled)
+    {
+      // a window edge ends any manual override
+      scheduled = wanted;
+      manual = POWER_OVERRIDE_NONE;
+    }
+  }
+
+  if (requestAuto)
+  {
+    requestAuto = false;
+    manual = POWER_OVERRIDE_NONE;
+  }
+  PowerOverride request = requested;
+  if (request != POWER_OVERRIDE_NONE)
+  {
+    requested = POWER_OVERRIDE_NONE;
+    manual = request;
+  }
+
+  bool wantStandby = manual == POWER_OVERRIDE_NONE ? scheduled : manual == POWER_OVERRIDE_STANDBY;
+  // OTA progress, streamed frames and the boot screen always stay visible
+  if (currentStatus != NONE)
+  {
+    wantStandby = false;
+  }
+
+  if (wantStandby && !standby)
+  {
+    enterStandby();
+  }
+  else if (!wantStandby && standby)
+  {
+    leaveStandby();
+  }
+}
+
+void Power_::enterStandby()
+{
+  // what the LEDs draw right now is what standby saves on top of the board itself
+  const uint8_t *buffer = Screen.getRenderBuffer();
+  uint32_t sum = 0;
+  for (int i = 0; i < TOTAL_PIXELS; i++)
+  {
+    sum += buffer[i];
+  }
+  uint32_t ledMw = (uint64_t)sum * Screen.getCurrentBrightness() * POWER_LEDS_FULL_MW /
+                   ((uint32_t)MAX_BRIGHTNESS * MAX_BRIGHTNESS * TOTAL_PIXELS);
+  savingMw = POWER_RUN_MW - POWER_STANDBY_MW + ledMw;
+
+  standbySince = millis();
+  standbyCount++;
+  standby = true;
+  Screen.setStandby(true);
+
+#ifdef ESP32
+#ifdef ENABLE_SERVER
+  WiFi.setSleep(WIFI_PS_MAX_MODEM);
+#endif
+  // 80 MHz is the lowest clock WiFi keeps working with
+  cpuMhz = getCpuFrequencyMhz();
+  setCpuFrequencyMhz(80);
+#endif
+
+  Serial.printf("[Power] Standby (%s)\n", manual == POWER_OVERRIDE_NONE ? "scheduled" : "manual");
+}
+
+void Power_::leaveStandby()
+{
+#ifdef ESP32
+  if (cpuMhz)
+  {
+    setCpuFrequencyMhz(cpuMhz);
+  }
+#ifdef ENABLE_SERVER
+  WiFi.setSleep(WIFI_PS_MIN_MODEM);
+#endif
+#endif
+
+  unsigned long duration = millis() - standbySince;
+  standbyMs += duration;
+  savedMwMs += (uint64_t)savingMw * duration;
+  savingMw = 0;
+
+  Screen.setStandby(false);
+  standby = false;
+
+#ifdef ESP32
+  if (renderTask)
+  {
+    xTaskNotifyGive(renderTask);
+  }
+#endif
+
+  Serial.printf("[Power] Awake after %lus\n", duration / 1000);
+}
+
+void Power_::wake()
+{
+  requested = POWER_OVERRIDE_ON;
+}
+
+void Power_::sleep()
+{
+  requested = POWER_OVERRIDE_STANDBY;
+}
+
+void Power_::resumeSchedule()
+{
+  requestAuto = true;
+}
+
+bool Power_::isStandby() const
+{
+  return standby;
+}
+
+void Power_::parkRenderTask()
+{
+#ifdef ESP32
+  renderTask = xTaskGetCurrentTaskHandle();
+  while (standby)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+#endif
+}
+
+void Power_::toJson(JsonObject object)
+{
+  static const char *overrideNames[] = {"auto", "on", "standby"};
+
+  bool inStandby = standby;
+  unsigned long current = inStandby ? millis() - standbySince : 0;
+
+  object["standby"] = inStandby;
+  object["mode"] = overrideNames[manual];
+  object["scheduled"] = scheduled;
+
+  JsonArray windowArray = object["windows"].to<JsonArray>();
+  for (uint8_t i = 0; i < windowCount; i++)
+  {
+    char start[6];
+    char end[6];
+    snprintf(start, sizeof(start), "%02u:%02u", windows[i].start / 60, windows[i].start % 60);
+    snprintf(end, sizeof(end), "%02u:%02u", windows[i].end / 60, windows[i].end % 60);
+
+    JsonObject window = windowArray.add<JsonObject>();
+    window["start"] = start;
+    window["end"] = end;
+    JsonArray days = window["days"].to<JsonArray>();
+    for (uint8_t day = 0; day < 7; day++)
+    {
+      if (windows[i].days & (1 << day))
+      {
+        days.add(day);
+      }
+    }
+  }
+
+  object["standbyCount"] = standbyCount;
+  object["standbySeconds"] = (uint32_t)((standbyMs + current) / 1000);
+  object["skippedRenders"] = Screen.getSkippedRenders();
+  object["estimatedSavedWh"] = (savedMwMs + (uint64_t)savingMw * current) / 3.6e9;
+}
+
+Power_ &Power = Power.getInstance();
@@ -1,4 +1,6 @@
 #include "scheduler.h"
+#include "arena.h"
+#include "settings.h"
 #include "websocket.h"
 
 PluginScheduler &PluginScheduler::getInstance()
@@ -38,21 +40,12 @@ void PluginScheduler::clearSchedule(bool emptyStorage)
   
   currentIndex = 0;
   isActive = false;
-#ifdef ENABLE_STORAGE
-  if (emptyStorage)
-  {
-    schedule.clear();
-    storage.begin("led-wall");
-    storage.putString("schedule", "");
-    storage.putInt("scheduleactive", 0);
-    storage.end();
-  }
-#else
   if (emptyStorage)
   {
     schedule.clear();
+    Settings.setString(SETTING_SCHEDULE, "");
+    Settings.setInt(SETTING_SCHEDULE_ACTIVE, 0);
   }
-#endif
 }
 
 void PluginScheduler::start()
@@ -62,12 +55,7 @@ void PluginScheduler::start()
     currentIndex = 0;
     lastSwitch = millis();
     isActive = true;
-    requestPersist();
-#ifdef ENABLE_STORAGE
-    storage.begin("led-wall", false);
-    storage.putInt("schedidx", 0);
-    storage.end();
-#endif
+    Settings.setInt(SETTING_SCHEDULE_ACTIVE, 1);
     switchToCurrentPlugin();
   }
 }
@@ -75,34 +63,11 @@ void PluginScheduler::start()
 void PluginScheduler::stop()
 {
   isActive = false;
-  requestPersist();
-}
-
-void PluginScheduler::requestPersist()
-{
-  needsPersist = true;
-  lastPersistRequest = millis();
-}
-
-void PluginScheduler::checkAndPersist()
-{
-#ifdef ENABLE_STORAGE
-  if (needsPersist && (millis() - lastPersistRequest >= PERSIST_DELAY_MS))
-  {
-    storage.begin("led-wall", false);
-    storage.putInt("scheduleactive", isActive ? 1 : 0);
-    storage.end();
-    needsPersist = false;
-  }
-#else
-  needsPersist = false;
-#endif
+  Settings.setInt(SETTING_SCHEDULE_ACTIVE, 0);
 }
 
 void PluginScheduler::update()
 {
-  checkAndPersist();
-
   if (!isActive || schedule.empty())
     return;
 
@@ -116,15 +81,83 @@ void PluginScheduler::update()
     return;
   }
   
-  // Check if it's time to switch to next plugin
-  if (currentTime - lastSwitch >= schedule[currentIndex].duration)
+  // Check if it's time to switch to next plugin, a plugin demoted for overrunning its budget
+  // gives up its slot right away
+  bool expired = currentTime - lastSwitch >= schedule[currentIndex].duration;
+  if (expired || pluginManager.isDemoted(schedule[currentIndex].pluginId))
   {
-    currentIndex = (currentIndex + 1) % schedule.size();
-    lastSwitch = currentTime;
-    switchToCurrentPlugin();
+    size_t next = nextRunnableIndex();
+    if (next < schedule.size())
+    {
+      currentIndex = next;
+      lastSwitch = currentTime;
+      switchToCurrentPlugin();
+      return;
+    }
+    if (expired)
+    {
+      // everything is demoted, keep what is on screen
+      lastSwitch = currentTime;
+    }
+  }
+
+  // Let the next plugin fetch and allocate while the current one is still on screen
+  const ScheduleItem *next = getNextItem();
+  if (!nextPrepared && next && getMillisUntilNext() <= SCHEDULER_PREPARE_LEAD_MS)
+  {
+    nextPrepared = true;
+    pluginManager.preparePluginById(next->pluginId);
   }
 }
 
+size_t PluginScheduler::nextRunnableIndex() const
+{
+  for (size_t step = 1; step <= schedule.size(); step++)
+  {
+    size_t index = (currentIndex + step) % schedule.size();
+    if (!pluginManager.isDemoted(schedule[index].pluginId))
+    {
+      return index;
+    }
+  }
+  return schedule.size();
+}
+
+const ScheduleItem *PluginScheduler::getNextItem() const
+{
+  if (!isActive || schedule.empty())
+  {
+    return nullptr;
+  }
+  size_t index = nextRunnableIndex();
+  return index < schedule.size() ? &schedule[index] : nullptr;
+}
+
+unsigned long PluginScheduler::getMillisUntilNext() const
+{
+  if (!isActive || currentIndex >= schedule.size())
+  {
+    return 0;
+  }
+
+  unsigned long elapsed = millis() - lastSwitch;
+  unsigned long duration = schedule[currentIndex].duration;
+  return elapsed >= duration ? 0 : duration - elapsed;
+}
+
+void PluginScheduler::nextToJson(JsonObject object) const
+{
+  const ScheduleItem *next = getNextItem();
+  if (!next)
+  {
+    return;
+  }
+
+  object["index"] = next - schedule.data();
+  object["pluginId"] = next->pluginId;
+  object["inSeconds"] = getMillisUntilNext() / 1000;
+}
+
 void PluginScheduler::switchToCurrentPlugin()
 {
   Serial.print("[Scheduler] Switching to index ");
@@ -137,12 +170,10 @@ void PluginScheduler::switchToCurrentPlugin()
   {
     Serial.println(schedule[currentIndex].pluginId);
 
-    // Save currentIndex to NVS so schedule survives crashes/reboots
-#ifdef ENABLE_STORAGE
-    storage.begin("led-wall", false);
-    storage.putInt("schedidx", (int)currentIndex);
-    storage.end();
-#endif
+    nextPrepared = false;
+
+    // Save currentIndex so schedule survives crashes/reboots (written behind, not per switch)
+    Settings.setInt(SETTING_SCHEDULE_INDEX, (int)currentIndex);
 
     pluginManager.setActivePluginById(schedule[currentIndex].pluginId);
 #ifdef ENABLE_SERVER
@@ -158,13 +189,11 @@ void PluginScheduler::switchToCurrentPlugin()
 void PluginScheduler::init()
 {
 #ifdef ENABLE_STORAGE
-  storage.begin("led-wall", true);
-  int storedActive = storage.getInt("scheduleactive", 0);
-  int storedIndex = storage.getInt("schedidx", 0);
-  bool scheduleIsSet = setScheduleByJSONString(storage.getString("schedule"));
+  int storedActive = Settings.getInt(SETTING_SCHEDULE_ACTIVE);
+  int storedIndex = Settings.getInt(SETTING_SCHEDULE_INDEX);
+  bool scheduleIsSet = setScheduleByJSONString(Settings.getString(SETTING_SCHEDULE));
 
   isActive = (storedActive == 1);
-  storage.end();
 
   if (isActive && !schedule.empty())
   {
@@ -193,7 +222,8 @@ bool PluginScheduler::setScheduleByJSONString(String scheduleJson)
     return false;
   }
   
-  JsonDocument doc;  // Dynamic allocation (ArduinoJson v7)
+  JsonArena arena;
+  JsonDocument doc(&arena);
   DeserializationError error = deserializeJson(doc, scheduleJson);
   
   if (error)
@@ -208,11 +238,7 @@ bool PluginScheduler::setScheduleByJSONString(String scheduleJson)
   isActive = false;
   schedule.clear();
 
-#ifdef ENABLE_STORAGE
-  storage.begin("led-wall");
-  storage.putString("schedule", scheduleJson);
-  storage.end();
-#endif
+  Settings.setString(SETTING_SCHEDULE, scheduleJson);
 
   Serial.print("[Scheduler] Parsing schedule, items: ");
   Serial.println(doc.as<JsonArray>().size());
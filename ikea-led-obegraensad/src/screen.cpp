@@ -1,10 +1,20 @@
 #include "screen.h"
 #include "constants.h"
+#include "framerecorder.h"
+#include "settings.h"
 #include <SPI.h>
 #include <algorithm>
+#include <math.h>
 
 #define TIMER_INTERVAL_US 200
 #define GRAY_LEVELS 64 // must be a power of two
+// sub-tick precision of the level table; the fraction is spread over successive PWM cycles,
+// so a pixel has GRAY_LEVELS << GRAY_FRACTION_BITS (1024) linear steps
+#define GRAY_FRACTION_BITS 4
+#define GAMMA 2.2f
+
+// starting fractions, a 4x4 Bayer matrix over the GRAY_FRACTION_BITS range
+static const uint8_t FRACTION_SEEDS[16] = {0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5};
 
 using namespace std;
 
@@ -16,75 +26,40 @@ uint8_t Screen_::getCurrentBrightness() const
 void Screen_::setBrightness(uint8_t brightness, bool shouldStore)
 {
   brightness_ = brightness;
+  buildLevelTable();
 
 #ifndef ESP8266
-  pinMode(PIN_ENABLE, OUTPUT);
-  digitalWrite(PIN_ENABLE, LOW);
-#endif
-
-#ifdef ENABLE_STORAGE
-  if (shouldStore)
+  if (!standby_)
   {
-    storage.begin("led-wall");
-    storage.putUInt("brightness", brightness);
-    storage.end();
+    pinMode(PIN_ENABLE, OUTPUT);
+    digitalWrite(PIN_ENABLE, LOW);
   }
 #endif
-}
 
-void Screen_::setRenderBuffer(const uint8_t *renderBuffer, bool grays)
-{
-  if (grays)
-  {
-    memcpy(renderBuffer_, renderBuffer, ROWS * COLS);
-  }
-  else
+  if (shouldStore)
   {
-    for (int i = 0; i < ROWS * COLS; i++)
-    {
-      renderBuffer_[i] = renderBuffer[i] * MAX_BRIGHTNESS;
-    }
+    Settings.setInt(SETTING_BRIGHTNESS, brightness);
   }
 }
 
-uint8_t *Screen_::getRenderBuffer()
+// Pixel values and the brightness are perceptual, the LEDs are linear in on time
+void Screen_::buildLevelTable()
 {
-  return renderBuffer_;
-}
-
-uint8_t Screen_::getBufferIndex(int index)
-{
-  return renderBuffer_[index];
-}
-
-void Screen_::clear()
-{
-  memset(renderBuffer_, 0, ROWS * COLS);
-}
+  const float top = GRAY_LEVELS << GRAY_FRACTION_BITS;
+  const float scale = (float)brightness_ / MAX_BRIGHTNESS / MAX_BRIGHTNESS;
 
-void Screen_::clearRect(int x, int y, int width, int height)
-{
-  if (x < 0)
-  {
-    width += x;
-    x = 0;
-  }
-  if (y < 0)
+  levelTable_[0] = 0;
+  for (int value = 1; value < 256; value++)
   {
-    height += y;
-    y = 0;
-  }
-
-  if (x >= COLS || y >= ROWS || width <= 0 || height <= 0)
-  {
-    return;
+    uint16_t level = powf(value * scale, GAMMA) * top + 0.5f;
+    // the faintest values still glow instead of snapping to off
+    levelTable_[value] = level == 0 && brightness_ > 0 ? 1 : level;
   }
+}
 
-  width = std::min(width, COLS - x);
-  for (int row = y; row < y + height; row++)
-  {
-    memset(renderBuffer_ + (row * COLS + x), 0, width);
-  }
+void Screen_::commitFrame()
+{
+  FrameRecorder.capture(renderBuffer_);
 }
 
 // STORAGE START
@@ -95,11 +70,11 @@ void Screen_::loadFromStorage()
 
   clear();
   storage.getBytes("data", renderBuffer_, ROWS * COLS);
-
-  setBrightness(storage.getUInt("brightness", MAX_BRIGHTNESS));
-  setCurrentRotation(storage.getUInt("rotation", 0));
   storage.end();
 #endif
+
+  setBrightness(Settings.getInt(SETTING_BRIGHTNESS));
+  setCurrentRotation(Settings.getInt(SETTING_ROTATION));
 }
 
 void Screen_::persist()
@@ -107,24 +82,27 @@ void Screen_::persist()
 #ifdef ENABLE_STORAGE
   storage.begin("led-wall");
   storage.putBytes("data", renderBuffer_, ROWS * COLS);
-  storage.putUInt("brightness", brightness_);
-  storage.putUInt("rotation", currentRotation);
   storage.end();
 #endif
+
+  Settings.setInt(SETTING_BRIGHTNESS, brightness_);
+  Settings.setInt(SETTING_ROTATION, currentRotation);
 }
 // STORAGE END
 
 void Screen_::setup()
 {
-#ifdef ENABLE_STORAGE
-  storage.begin("led-wall", true);
-  setBrightness(storage.getUInt("brightness", MAX_BRIGHTNESS));
-  Screen.setCurrentRotation(storage.getUInt("rotation", 0));
+  setBrightness(Settings.getInt(SETTING_BRIGHTNESS));
+  Screen.setCurrentRotation(Settings.getInt(SETTING_ROTATION));
 
-  storage.end();
-#else
-  Screen.setCurrentRotation(0);
-#endif
+  // neighbouring pixels carry their fractions in different cycles, so dithered areas shimmer
+  // instead of blinking in step
+  for (int idx = 0; idx < ROWS * COLS; idx++)
+  {
+    uint8_t x = positions[idx] % COLS;
+    uint8_t y = positions[idx] / COLS;
+    residual_[idx] = FRACTION_SEEDS[(y & 3) * 4 + (x & 3)];
+  }
 
   // TODO find proper unused pins for MISO and SS
 #ifdef ESP8266
@@ -151,40 +129,20 @@ void Screen_::setup()
   SPI.begin(PIN_CLOCK, -1, PIN_DATA, -1); // SCLK, MISO, MOSI, SS (-1 for unused pins)
   SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
 
-  hw_timer_t *Screen_timer = timerBegin(1000000);
-  timerAttachInterrupt(Screen_timer, &onScreenTimer);
-  timerAlarm(Screen_timer, TIMER_INTERVAL_US, true, 0);
+  timer_ = timerBegin(1000000);
+  timerAttachInterrupt(timer_, &onScreenTimer);
+  timerAlarm(timer_, TIMER_INTERVAL_US, true, 0);
 #endif
 }
 
-void Screen_::setPixelAtIndex(uint8_t index, uint8_t value, uint8_t brightness)
-{
-  if (index >= COLS * ROWS)
-    return;
-  renderBuffer_[index] =
-      value <= 0 || brightness <= 0 ? 0 : (brightness > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : brightness);
-}
-
-void Screen_::setPixel(uint8_t x, uint8_t y, uint8_t value, uint8_t brightness)
-{
-  if (x >= COLS || y >= ROWS)
-    return;
-  renderBuffer_[y * COLS + x] =
-      value <= 0 || brightness <= 0 ? 0 : (brightness > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : brightness);
-}
-
 void Screen_::setCurrentRotation(int rotation, bool shouldPersist)
 {
   currentRotation = rotation & 0x3;
 
-#ifdef ENABLE_STORAGE
   if (shouldPersist)
   {
-    storage.begin("led-wall", false);
-    storage.putUInt("rotation", Screen.currentRotation);
-    storage.end();
+    Settings.setInt(SETTING_ROTATION, currentRotation);
   }
-#endif
 }
 
 IRAM_ATTR uint8_t *Screen_::getRotatedRenderBuffer()
@@ -249,9 +207,55 @@ IRAM_ATTR void Screen_::onScreenTimer()
   Screen._render();
 }
 
+IRAM_ATTR bool Screen_::isBlank() const
+{
+  const uint32_t *words = (const uint32_t *)renderBuffer_;
+  uint32_t any = 0;
+  for (int i = 0; i < ROWS * COLS / 4; i++)
+  {
+    any |= words[i];
+  }
+  return any == 0;
+}
+
+// Runs at the start of every PWM cycle: latches the frame, looks every pixel up in the level
+// table and adds the fraction it carried over, so the per tick loop is a single compare
+IRAM_ATTR void Screen_::prepareCycle(const uint8_t *buf)
+{
+  const uint8_t mask = (1 << GRAY_FRACTION_BITS) - 1;
+  for (int idx = 0; idx < ROWS * COLS; idx++)
+  {
+    uint16_t level = levelTable_[buf[positions[idx]]];
+    uint8_t residual = residual_[idx] + (level & mask);
+    duty_[idx] = (level >> GRAY_FRACTION_BITS) + (residual >> GRAY_FRACTION_BITS);
+    residual_[idx] = residual & mask;
+  }
+}
+
 IRAM_ATTR void Screen_::_render()
 {
-  const auto buf = (currentStatus == UPDATE) ? renderBuffer_ : getRotatedRenderBuffer();
+  static uint8_t tick = 0;
+  static bool darkFrame = false;
+  static bool outputDark = false;
+
+  if (currentStatus != UPDATE)
+  {
+    // Checked once per PWM cycle. A dark frame has to be shifted out only once, after that the
+    // drivers already hold it and the tick has nothing to do.
+    if (tick == 0)
+    {
+      darkFrame = brightness_ == 0 || isBlank();
+    }
+    if (darkFrame && outputDark)
+    {
+      tick = (tick + 1) & (GRAY_LEVELS - 1);
+      skippedRenders_++;
+#ifdef ESP8266
+      timer1_write(100);
+#endif
+      return;
+    }
+  }
 
   // SPI data needs to be 32-bit aligned, round up before divide
   static unsigned long
@@ -259,13 +263,11 @@ IRAM_ATTR void Screen_::_render()
   unsigned char *bits = (unsigned char *)spi_bits;
   memset(bits, 0, ROWS * COLS / 8);
 
-  static unsigned char counter = 0;
-
   if (currentStatus == UPDATE)
   {
     for (int idx = 0; idx < ROWS * COLS; idx++)
     {
-      if (buf[positions[idx]] > 0)
+      if (renderBuffer_[positions[idx]] > 0)
       {
         bits[idx >> 3] |= (0x80 >> (idx & 7));
       }
@@ -274,124 +276,82 @@ IRAM_ATTR void Screen_::_render()
   else
   {
     // Normal rendering with PWM for grayscale
+    if (tick == 0)
+    {
+      prepareCycle(getRotatedRenderBuffer());
+    }
     for (int idx = 0; idx < ROWS * COLS; idx++)
     {
-      uint16_t scaledValue = ((uint16_t)buf[positions[idx]] * brightness_) / MAX_BRIGHTNESS;
-      bits[idx >> 3] |= (scaledValue > counter ? 0x80 : 0) >> (idx & 7);
+      bits[idx >> 3] |= (duty_[idx] > tick ? 0x80 : 0) >> (idx & 7);
     }
-    counter += ((MAX_BRIGHTNESS + 1) / GRAY_LEVELS);
+    tick = (tick + 1) & (GRAY_LEVELS - 1);
   }
 
   digitalWrite(PIN_LATCH, LOW);
   SPI.writeBytes(bits, sizeof(spi_bits));
   digitalWrite(PIN_LATCH, HIGH);
+  outputDark = darkFrame && currentStatus != UPDATE;
 #ifdef ESP8266
   timer1_write(100);
 #endif
 }
 
-void Screen_::drawLine(int x1, int y1, int x2, int y2, int ledStatus, uint8_t brightness)
+void Screen_::setStandby(bool standby)
 {
-  int dx = abs(x2 - x1);
-  int sx = x1 < x2 ? 1 : -1;
-  int dy = -abs(y2 - y1);
-  int sy = y1 < y2 ? 1 : -1;
-  int error = dx + dy;
-
-  for (;;)
+  if (standby == standby_)
   {
-    setPixel(x1, y1, ledStatus, brightness);
-    if (x1 == x2 && y1 == y2) break;
-    int e2 = 2 * error;
-    if (e2 >= dy)
-    {
-      error += dy;
-      x1 += sx;
-    }
-    if (e2 <= dx)
-    {
-      error += dx;
-      y1 += sy;
-    }
+    return;
   }
-}
+  standby_ = standby;
 
-void Screen_::drawRectangle(int x,
-                            int y,
-                            int width,
-                            int height,
-                            bool fill,
-                            int ledStatus,
-                            uint8_t brightness)
-{
-  if (!fill)
+  if (standby)
   {
-    drawLine(x, y, x + width, y, ledStatus, brightness);
-    drawLine(x, y + 1, x, y + height - 1, ledStatus, brightness);
-    drawLine(x + width, y + 1, x + width, y + height - 1, ledStatus, brightness);
-    drawLine(x, y + height - 1, x + width, y + height - 1, ledStatus, brightness);
-  }
-  else
-  {
-    for (int i = x; i < x + width; i++)
+#ifdef ESP32
+    if (timer_)
     {
-      drawLine(i, y, i, y + height - 1, ledStatus, brightness);
+      timerStop(timer_);
     }
-  }
-};
+#endif
+#ifdef ESP8266
+    timer1_disable();
+#endif
+    // let a tick that was already running finish before taking over the bus
+    delay(1);
 
-void Screen_::drawCharacter(int x,
-                            int y,
-                            const std::vector<int> &bits,
-                            int bitCount,
-                            uint8_t brightness)
-{
-  for (int i = 0; i < bits.size(); i += bitCount)
-  {
-    for (int j = 0; j < bitCount; j++)
-    {
-      setPixel(x + j, (y + (i / bitCount)), bits[i + j], brightness);
-    }
+    const uint8_t dark[ROWS * COLS / 8] = {0};
+    digitalWrite(PIN_LATCH, LOW);
+    SPI.writeBytes(dark, sizeof(dark));
+    digitalWrite(PIN_LATCH, HIGH);
+#ifndef ESP8266
+    digitalWrite(PIN_ENABLE, HIGH);
+#endif
   }
-}
-
-std::vector<int> Screen_::readBytes(const std::vector<int> &bytes)
-{
-  vector<int> bits;
-  int k = 0;
-
-  for (int i = 0; i < bytes.size(); i++)
+  else
   {
-    for (int j = 8 - 1; j >= 0; j--)
+#ifndef ESP8266
+    digitalWrite(PIN_ENABLE, LOW);
+#endif
+#ifdef ESP32
+    if (timer_)
     {
-      int b = (bytes[i] >> j) & 1;
-      bits.push_back(b);
-      k++;
+      timerStart(timer_);
     }
-  }
-
-  return bits;
-}
-
-void Screen_::drawNumbers(int x, int y, const std::vector<int> &numbers, uint8_t brightness)
-{
-  for (int i = 0; i < numbers.size(); i++)
-  {
-    drawCharacter(x + (i * 5), y, readBytes(smallNumbers[numbers.at(i)]), 4, brightness);
+#endif
+#ifdef ESP8266
+    timer1_enable(TIM_DIV256, TIM_EDGE, TIM_SINGLE);
+    timer1_write(100);
+#endif
   }
 }
 
-void Screen_::drawBigNumbers(int x, int y, const std::vector<int> &numbers, uint8_t brightness)
+bool Screen_::isStandby() const
 {
-  for (int i = 0; i < numbers.size(); i++)
-  {
-    drawCharacter(x + (i * 8), y, readBytes(bigNumbers[numbers.at(i)]), 8, brightness);
-  }
+  return standby_;
 }
 
-void Screen_::drawWeather(int x, int y, int weather, uint8_t brightness)
+uint32_t Screen_::getSkippedRenders() const
 {
-  drawCharacter(x, y, readBytes(weatherIcons[weather]), 16, brightness);
+  return skippedRenders_;
 }
 
 void Screen_::scrollText(const std::string &text, int delayTime, uint8_t brightness, uint8_t fontid)
@@ -427,10 +387,7 @@ void Screen_::scrollText(const std::string &text, int delayTime, uint8_t brightn
                                     ? text[strPos]
                                     : currentFont.offset;
 
-          Screen.drawCharacter(xPos,
-                               4,
-                               Screen.readBytes(currentFont.data[currentChar - currentFont.offset]),
-                               8);
+          drawCharacter(xPos, 4, readBytes(currentFont.data[currentChar - currentFont.offset]), 8);
         }
       }
     }
@@ -0,0 +1,457 @@
+#include "settings.h"
+
+#ifdef ENABLE_STORAGE
+#include <Preferences.h>
+#endif
+
+enum SettingType : uint8_t
+{
+  SETTING_TYPE_INT,
+  SETTING_TYPE_UINT,
+  SETTING_TYPE_BOOL,
+  SETTING_TYPE_STRING,
+  SETTING_TYPE_BLOB,
+};
+
+struct SettingDescriptor
+{
+  const char *ns;
+  const char *key;
+  SettingType type;
+  int32_t defaultInt;
+  const char *defaultString;
+};
+
+// Indexed by SettingId
+static const SettingDescriptor descriptors[SETTING_COUNT] = {
+    {"led-wall", "brightness", SETTING_TYPE_UINT, MAX_BRIGHTNESS, nullptr},
+    {"led-wall", "rotation", SETTING_TYPE_UINT, 0, nullptr},
+    {"led-wall", "current-plugin", SETTING_TYPE_INT, -1, nullptr},
+    {"led-wall", "schedule", SETTING_TYPE_STRING, 0, ""},
+    {"led-wall", "scheduleactive", SETTING_TYPE_INT, 0, nullptr},
+    {"led-wall", "schedidx", SETTING_TYPE_INT, 0, nullptr},
+    {"config", "weatherLoc", SETTING_TYPE_STRING, 0, WEATHER_LOCATION},
+    {"config", "ntpServer", SETTING_TYPE_STRING, 0, NTP_SERVER},
+    {"config", "tzInfo", SETTING_TYPE_STRING, 0, TZ_INFO},
+    {"config", "autoSchedule", SETTING_TYPE_BOOL, 0, nullptr},
+    {"cityclock", "cityIdx", SETTING_TYPE_INT, 0, nullptr},
+    {"forecast", "cityIdx", SETTING_TYPE_INT, 0, nullptr},
+    {"led-wall", "powerwindows", SETTING_TYPE_STRING, 0, ""},
+    {"config", "pluginBudget", SETTING_TYPE_UINT, PLUGIN_BUDGET_MS, nullptr},
+    {"config", "tlsReserve", SETTING_TYPE_BOOL, 0, nullptr},
+    {"fetchcache", "slot0", SETTING_TYPE_BLOB, 0, nullptr},
+    {"fetchcache", "slot1", SETTING_TYPE_BLOB, 0, nullptr},
+    {"fetchcache", "slot2", SETTING_TYPE_BLOB, 0, nullptr},
+    {"fetchcache", "slot3", SETTING_TYPE_BLOB, 0, nullptr},
+};
+
+static const char *namespaces[] = {"led-wall", "config", "cityclock", "forecast", "fetchcache"};
+
+Settings_ &Settings_::getInstance()
+{
+  static Settings_ instance;
+  return instance;
+}
+
+void Settings_::lock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+  }
+#endif
+}
+
+void Settings_::unlock()
+{
+#ifdef ESP32
+  if (mutex)
+  {
+    xSemaphoreGive(mutex);
+  }
+#endif
+}
+
+void Settings_::setDefault(SettingId id)
+{
+  const SettingDescriptor &descriptor = descriptors[id];
+  if (descriptor.type == SETTING_TYPE_STRING)
+  {
+    strings[id] = descriptor.defaultString;
+  }
+  else if (descriptor.type == SETTING_TYPE_BLOB)
+  {
+    blobLengths[id - SETTINGS_FIRST_BLOB] = 0;
+  }
+  else
+  {
+    ints[id] = descriptor.defaultInt;
+  }
+}
+
+bool Settings_::begin()
+{
+#ifdef ESP32
+  if (!mutex)
+  {
+    mutex = xSemaphoreCreateMutex();
+    commitMutex = xSemaphoreCreateMutex();
+  }
+#endif
+
+  if (available)
+  {
+    return true;
+  }
+
+  for (uint8_t id = 0; id < SETTING_COUNT; id++)
+  {
+    setDefault((SettingId)id);
+  }
+
+#ifdef ENABLE_STORAGE
+  // one read-only open per namespace for the whole shadow
+  Preferences prefs;
+  for (const char *ns : namespaces)
+  {
+    if (!prefs.begin(ns, true))
+    {
+      // namespace does not exist yet, defaults it is
+      continue;
+    }
+
+    for (uint8_t id = 0; id < SETTING_COUNT; id++)
+    {
+      const SettingDescriptor &descriptor = descriptors[id];
+      if (strcmp(descriptor.ns, ns) != 0 || !prefs.isKey(descriptor.key))
+      {
+        continue;
+      }
+
+      switch (descriptor.type)
+      {
+      case SETTING_TYPE_INT:
+        ints[id] = prefs.getInt(descriptor.key, descriptor.defaultInt);
+        break;
+      case SETTING_TYPE_UINT:
+        ints[id] = prefs.getUInt(descriptor.key, descriptor.defaultInt);
+        break;
+      case SETTING_TYPE_BOOL:
+        ints[id] = prefs.getBool(descriptor.key, descriptor.defaultInt) ? 1 : 0;
+        break;
+      case SETTING_TYPE_STRING:
+        strings[id] = prefs.getString(descriptor.key, descriptor.defaultString);
+        break;
+      case SETTING_TYPE_BLOB:
+      {
+        size_t length = prefs.getBytesLength(descriptor.key);
+        if (length <= SETTINGS_BLOB_BYTES)
+        {
+          uint8_t index = id - SETTINGS_FIRST_BLOB;
+          blobLengths[index] = prefs.getBytes(descriptor.key, blobs[index], length);
+        }
+        break;
+      }
+      }
+    }
+    prefs.end();
+  }
+  available = true;
+#endif
+
+#ifdef ESP32
+  if (!taskHandle)
+  {
+    xTaskCreatePinnedToCore(task, "settingsTask", 3072, NULL, 0, &taskHandle, 1);
+  }
+#endif
+
+  return available;
+}
+
+bool Settings_::isAvailable() const
+{
+  return available;
+}
+
+#ifdef ESP32
+void Settings_::task(void *parameter)
+{
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(500));
+    Settings.update();
+  }
+}
+#endif
+
+int32_t Settings_::getInt(SettingId id)
+{
+  lock();
+  int32_t value = ints[id];
+  unlock();
+  return value;
+}
+
+bool Settings_::getBool(SettingId id)
+{
+  return getInt(id) != 0;
+}
+
+String Settings_::getString(SettingId id)
+{
+  lock();
+  String value = strings[id];
+  unlock();
+  return value;
+}
+
+void Settings_::markDirty(SettingId id)
+{
+  unsigned long now = millis();
+
+  if (dirty[id])
+  {
+    coalesced++;
+  }
+  dirty[id] = true;
+
+  if (!pending)
+  {
+    pending = true;
+    firstChange = now;
+  }
+  lastChange = now;
+}
+
+void Settings_::setInt(SettingId id, int32_t value)
+{
+  lock();
+  if (ints[id] != value)
+  {
+    ints[id] = value;
+    markDirty(id);
+  }
+  unlock();
+}
+
+void Settings_::setBool(SettingId id, bool value)
+{
+  setInt(id, value ? 1 : 0);
+}
+
+void Settings_::setString(SettingId id, const String &value)
+{
+  lock();
+  if (strings[id] != value)
+  {
+    strings[id] = value;
+    markDirty(id);
+  }
+  unlock();
+}
+
+size_t Settings_::getBlob(SettingId id, void *out, size_t maxLen)
+{
+  uint8_t index = id - SETTINGS_FIRST_BLOB;
+
+  lock();
+  size_t length = blobLengths[index];
+  if (length > maxLen)
+  {
+    length = 0;
+  }
+  memcpy(out, blobs[index], length);
+  unlock();
+  return length;
+}
+
+void Settings_::setBlob(SettingId id, const void *data, size_t length)
+{
+  uint8_t index = id - SETTINGS_FIRST_BLOB;
+  length = min(length, SETTINGS_BLOB_BYTES);
+
+  lock();
+  if (blobLengths[index] != length || memcmp(blobs[index], data, length) != 0)
+  {
+    memcpy(blobs[index], data, length);
+    blobLengths[index] = length;
+    markDirty(id);
+  }
+  unlock();
+}
+
+void Settings_::update()
+{
+  lock();
+  unsigned long now = millis();
+  bool due = pending &&
+             (now - lastChange >= SETTINGS_DEBOUNCE_MS || now - firstChange >= SETTINGS_MAX_DELAY_MS);
+  unlock();
+
+  if (due)
+  {
+    commit();
+  }
+}
+
+void Settings_::flush()
+{
+  commit();
+}
+
+void Settings_::commit()
+{
+#ifdef ESP32
+  if (commitMutex)
+  {
+    xSemaphoreTake(commitMutex, portMAX_DELAY);
+  }
+#endif
+
+  // snapshot the dirty entries so setters never wait for flash
+  bool toWrite[SETTING_COUNT] = {false};
+  int32_t intValues[SETTING_COUNT];
+  String stringValues[SETTING_COUNT];
+  uint8_t blobValues[SETTING_COUNT - SETTINGS_FIRST_BLOB][SETTINGS_BLOB_BYTES];
+  uint8_t blobValueLengths[SETTING_COUNT - SETTINGS_FIRST_BLOB];
+  bool any = false;
+
+  lock();
+  for (uint8_t id = 0; id < SETTING_COUNT; id++)
+  {
+    if (!dirty[id])
+    {
+      continue;
+    }
+    toWrite[id] = true;
+    intValues[id] = ints[id];
+    stringValues[id] = strings[id];
+    if (id >= SETTINGS_FIRST_BLOB)
+    {
+      uint8_t index = id - SETTINGS_FIRST_BLOB;
+      blobValueLengths[index] = blobLengths[index];
+      memcpy(blobValues[index], blobs[index], blobLengths[index]);
+    }
+    dirty[id] = false;
+    any = true;
+  }
+  pending = false;
+  unlock();
+
+#ifdef ENABLE_STORAGE
+  if (any && available)
+  {
+    Preferences prefs;
+    for (const char *ns : namespaces)
+    {
+      bool opened = false;
+      for (uint8_t id = 0; id < SETTING_COUNT; id++)
+      {
+        const SettingDescriptor &descriptor = descriptors[id];
+        if (!toWrite[id] || strcmp(descriptor.ns, ns) != 0)
+        {
+          continue;
+        }
+
+        if (!opened)
+        {
+          if (!prefs.begin(ns, false))
+          {
+            Serial.printf("[Settings] Could not open namespace %s, retrying later\n", ns);
+            // the snapshot cleared these flags, set them again so update() retries the values
+            lock();
+            for (uint8_t retry = id; retry < SETTING_COUNT; retry++)
+            {
+              if (toWrite[retry] && !dirty[retry] && strcmp(descriptors[retry].ns, ns) == 0)
+              {
+                markDirty((SettingId)retry);
+              }
+            }
+            unlock();
+            break;
+          }
+          opened = true;
+          commits++;
+        }
+
+        switch (descriptor.type)
+        {
+        case SETTING_TYPE_INT:
+          prefs.putInt(descriptor.key, intValues[id]);
+          break;
+        case SETTING_TYPE_UINT:
+          prefs.putUInt(descriptor.key, (uint32_t)intValues[id]);
+          break;
+        case SETTING_TYPE_BOOL:
+          prefs.putBool(descriptor.key, intValues[id] != 0);
+          break;
+        case SETTING_TYPE_STRING:
+          prefs.putString(descriptor.key, stringValues[id]);
+          break;
+        case SETTING_TYPE_BLOB:
+          prefs.putBytes(descriptor.key,
+                         blobValues[id - SETTINGS_FIRST_BLOB],
+                         blobValueLengths[id - SETTINGS_FIRST_BLOB]);
+          break;
+        }
+        writes++;
+      }
+
+      if (opened)
+      {
+        prefs.end();
+      }
+    }
+  }
+#endif
+
+#ifdef ESP32
+  if (commitMutex)
+  {
+    xSemaphoreGive(commitMutex);
+  }
+#endif
+}
+
+void Settings_::clear(const char *ns)
+{
+  lock();
+  for (uint8_t id = 0; id < SETTING_COUNT; id++)
+  {
+    if (strcmp(descriptors[id].ns, ns) == 0)
+    {
+      dirty[id] = false;
+      setDefault((SettingId)id);
+    }
+  }
+  unlock();
+
+#ifdef ENABLE_STORAGE
+  Preferences prefs;
+  if (prefs.begin(ns, false))
+  {
+    prefs.clear();
+    prefs.end();
+    commits++;
+  }
+#endif
+}
+
+uint32_t Settings_::getCommitCount() const
+{
+  return commits;
+}
+
+uint32_t Settings_::getWriteCount() const
+{
+  return writes;
+}
+
+uint32_t Settings_::getCoalescedCount() const
+{
+  return coalesced;
+}
+
+Settings_ &Settings = Settings.getInstance();
@@ -0,0 +1,295 @@
+#include "snakeengine.h"
+
+#include <string.h>
+
+static constexpr uint8_t UNREACHABLE = 0xff;
+
+SnakeEngine::SnakeEngine()
+{
+  buildCycle();
+  reset();
+}
+
+void SnakeEngine::buildCycle()
+{
+  // Column 0 is the way back: run the rows as a zigzag over columns 1..15, starting right of
+  // (0,0), and return up column 0. Works for any even height.
+  uint16_t position = 0;
+  cycleOrder[position++] = 0;
+  for (uint8_t y = 0; y < SNAKE_HEIGHT; y++)
+  {
+    for (uint8_t i = 1; i < SNAKE_WIDTH; i++)
+    {
+      uint8_t x = y % 2 == 0 ? i : SNAKE_WIDTH - i;
+      cycleOrder[position++] = y * SNAKE_WIDTH + x;
+    }
+  }
+  for (uint8_t y = SNAKE_HEIGHT - 1; y > 0; y--)
+  {
+    cycleOrder[position++] = y * SNAKE_WIDTH;
+  }
+
+  for (uint16_t i = 0; i < SNAKE_CELLS; i++)
+  {
+    cycleIndex[cycleOrder[i]] = i;
+  }
+}
+
+void SnakeEngine::reset()
+{
+  memset(occupied, 0, sizeof(occupied));
+  tailSlot = 0;
+  length = 0;
+
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    body[i] = cycleOrder[i];
+    setBit(occupied, cycleOrder[i], true);
+    length++;
+  }
+
+  food = cycleOrder[SNAKE_CELLS / 2];
+  vacated = body[0];
+}
+
+bool SnakeEngine::isBlocked(const uint32_t *board, uint8_t cell) const
+{
+  return board[cell >> 5] & (1UL << (cell & 31));
+}
+
+void SnakeEngine::setBit(uint32_t *board, uint8_t cell, bool value)
+{
+  if (value)
+  {
+    board[cell >> 5] |= 1UL << (cell & 31);
+  }
+  else
+  {
+    board[cell >> 5] &= ~(1UL << (cell & 31));
+  }
+}
+
+uint8_t SnakeEngine::getNeighbours(uint8_t cell, uint8_t *out) const
+{
+  uint8_t x = cell % SNAKE_WIDTH;
+  uint8_t y = cell / SNAKE_WIDTH;
+  uint8_t count = 0;
+
+  if (y > 0)
+  {
+    out[count++] = cell - SNAKE_WIDTH;
+  }
+  if (x < SNAKE_WIDTH - 1)
+  {
+    out[count++] = cell + 1;
+  }
+  if (y < SNAKE_HEIGHT - 1)
+  {
+    out[count++] = cell + SNAKE_WIDTH;
+  }
+  if (x > 0)
+  {
+    out[count++] = cell - 1;
+  }
+  return count;
+}
+
+uint16_t SnakeEngine::cycleDistance(uint8_t from, uint8_t to) const
+{
+  return (cycleIndex[to] - cycleIndex[from] + SNAKE_CELLS) % SNAKE_CELLS;
+}
+
+uint8_t SnakeEngine::bodyAt(uint16_t i) const
+{
+  return body[(tailSlot + i) % SNAKE_CELLS];
+}
+
+bool SnakeEngine::placeFood(uint32_t random)
+{
+  uint16_t freeCells = SNAKE_CELLS - length;
+  if (freeCells == 0)
+  {
+    return false;
+  }
+
+  uint16_t n = random % freeCells;
+  for (uint16_t cell = 0; cell < SNAKE_CELLS; cell++)
+  {
+    if (!isBlocked(occupied, cell) && n-- == 0)
+    {
+      food = cell;
+      break;
+    }
+  }
+  return true;
+}
+
+void SnakeEngine::computeFoodDistances(uint8_t *distances) const
+{
+  // BFS from the food over free cells; the tail counts as free, it moves away this step
+  uint8_t queue[SNAKE_CELLS];
+  uint16_t head = 0;
+  uint16_t tail = 0;
+  uint8_t tailCell = bodyAt(0);
+
+  memset(distances, UNREACHABLE, SNAKE_CELLS);
+  distances[food] = 0;
+  queue[tail++] = food;
+
+  while (head < tail)
+  {
+    uint8_t cell = queue[head++];
+    uint8_t neighbours[4];
+    uint8_t count = getNeighbours(cell, neighbours);
+    for (uint8_t i = 0; i < count; i++)
+    {
+      uint8_t next = neighbours[i];
+      if (distances[next] != UNREACHABLE)
+      {
+        continue;
+      }
+      distances[next] = distances[cell] + 1;
+      if (!isBlocked(occupied, next) || next == tailCell)
+      {
+        queue[tail++] = next;
+      }
+    }
+  }
+}
+
+bool SnakeEngine::tailReachableAfter(uint8_t next) const
+{
+  bool eats = next == food;
+  if (length == 1 && !eats)
+  {
+    return true;
+  }
+
+  uint32_t board[SNAKE_CELLS / 32];
+  memcpy(board, occupied, sizeof(board));
+  board[next >> 5] |= 1UL << (next & 31);
+  if (!eats)
+  {
+    uint8_t oldTail = bodyAt(0);
+    board[oldTail >> 5] &= ~(1UL << (oldTail & 31));
+  }
+  uint8_t target = eats ? bodyAt(0) : bodyAt(1);
+
+  uint8_t queue[SNAKE_CELLS];
+  uint32_t seen[SNAKE_CELLS / 32] = {0};
+  uint16_t head = 0;
+  uint16_t tail = 0;
+  queue[tail++] = next;
+  seen[next >> 5] |= 1UL << (next & 31);
+
+  while (head < tail)
+  {
+    uint8_t cell = queue[head++];
+    uint8_t neighbours[4];
+    uint8_t count = getNeighbours(cell, neighbours);
+    for (uint8_t i = 0; i < count; i++)
+    {
+      uint8_t neighbour = neighbours[i];
+      if (neighbour == target)
+      {
+        return true;
+      }
+      if (isBlocked(board, neighbour) || isBlocked(seen, neighbour))
+      {
+        continue;
+      }
+      seen[neighbour >> 5] |= 1UL << (neighbour & 31);
+      queue[tail++] = neighbour;
+    }
+  }
+  return false;
+}
+
+bool SnakeEngine::chooseMove(uint8_t &next)
+{
+  uint8_t head = getHead();
+  uint16_t toTail = length > 1 ? cycleDistance(head, bodyAt(0)) : SNAKE_CELLS;
+  uint16_t toFood = cycleDistance(head, food);
+
+  // the plain cycle step is always allowed while the body lies on the cycle behind the head
+  uint8_t cycleNext = cycleOrder[(cycleIndex[head] + 1) % SNAKE_CELLS];
+
+  uint8_t distances[SNAKE_CELLS];
+  computeFoodDistances(distances);
+
+  uint8_t neighbours[4];
+  uint8_t count = getNeighbours(head, neighbours);
+  bool found = false;
+  uint8_t bestDistance = UNREACHABLE;
+  uint16_t bestSkip = 0;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    uint8_t candidate = neighbours[i];
+    uint16_t skip = cycleDistance(head, candidate);
+
+    // Shortcuts may not pass the tail (the skipped cells are then known to be empty) nor the
+    // food (it would take a whole lap to come back). Stepping onto the tail is fine, it moves.
+    if (skip == 0 || skip > toTail || skip > toFood)
+    {
+      continue;
+    }
+
+    uint8_t distance = distances[candidate];
+    if (!found || distance < bestDistance || (distance == bestDistance && skip > bestSkip))
+    {
+      found = true;
+      bestDistance = distance;
+      bestSkip = skip;
+      next = candidate;
+    }
+  }
+
+  if (found && next != cycleNext && !tailReachableAfter(next))
+  {
+    next = cycleNext;
+  }
+  if (!found)
+  {
+    next = cycleNext;
+  }
+
+  // only fails if something outside the engine broke the invariant
+  return !isBlocked(occupied, next) || (next == bodyAt(0) && next != food);
+}
+
+SnakeStep SnakeEngine::step()
+{
+  uint8_t next;
+  if (length == 0 || !chooseMove(next))
+  {
+    return SNAKE_DEAD;
+  }
+
+  if (next == food)
+  {
+    body[(tailSlot + length) % SNAKE_CELLS] = next;
+    length++;
+    setBit(occupied, next, true);
+    return length == SNAKE_CELLS ? SNAKE_WON : SNAKE_ATE;
+  }
+
+  vacated = bodyAt(0);
+  setBit(occupied, vacated, false);
+  tailSlot = (tailSlot + 1) % SNAKE_CELLS;
+  body[(tailSlot + length - 1) % SNAKE_CELLS] = next;
+  setBit(occupied, next, true);
+  return SNAKE_MOVED;
+}
+
+void SnakeEngine::dropTail()
+{
+  if (length == 0)
+  {
+    return;
+  }
+
+  setBit(occupied, bodyAt(0), false);
+  tailSlot = (tailSlot + 1) % SNAKE_CELLS;
+  length--;
+}
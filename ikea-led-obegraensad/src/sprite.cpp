@@ -0,0 +1,183 @@
+#include "sprite.h"
+
+static inline uint8_t getRowBytes(const Sprite &sprite)
+{
+  return (sprite.width * sprite.bpp + 7) / 8;
+}
+
+static inline const uint8_t *getFrameData(const Sprite &sprite, uint8_t frame)
+{
+  return sprite.data + (uint16_t)frame * getRowBytes(sprite) * sprite.height;
+}
+
+uint8_t getSpritePixel(const Sprite &sprite, uint8_t frame, uint8_t x, uint8_t y)
+{
+  if (x >= sprite.width || y >= sprite.height || frame >= sprite.frames)
+  {
+    return 0;
+  }
+
+  const uint8_t *row = getFrameData(sprite, frame) + y * getRowBytes(sprite);
+  uint16_t bit = x * sprite.bpp;
+  uint8_t byte = pgm_read_byte(&row[bit >> 3]);
+  return (byte >> (8 - sprite.bpp - (bit & 7))) & ((1 << sprite.bpp) - 1);
+}
+
+// 1bpp rows are their own opacity mask, so only the set bits inside the visible columns are
+// visited. Deeper rows are decoded a byte at a time over the visible columns only.
+template <uint8_t BPP>
+static void drawRow(const uint8_t *source,
+                    uint8_t *out,
+                    int8_t step,
+                    uint8_t first,
+                    uint8_t last,
+                    const uint8_t *brightness)
+{
+  if (BPP == 1)
+  {
+    uint16_t opaque = pgm_read_byte(&source[0]) << 8;
+    if (last >= 8)
+    {
+      opaque |= pgm_read_byte(&source[1]);
+    }
+    opaque &= (0xffff >> first) & (0xffff << (15 - last));
+
+    while (opaque)
+    {
+      uint8_t column = __builtin_clz((uint32_t)opaque) - 16;
+      opaque &= ~(0x8000 >> column);
+      out[column * step] = brightness[1];
+    }
+    return;
+  }
+
+  constexpr uint8_t PIXELS_PER_BYTE = 8 / BPP;
+  constexpr uint8_t INDEX_MASK = (1 << BPP) - 1;
+
+  // whole bytes, clipping only the first and the last one
+  uint8_t column = first - first % PIXELS_PER_BYTE;
+  source += first / PIXELS_PER_BYTE;
+  out += column * step;
+  while (column <= last)
+  {
+    uint8_t bits = pgm_read_byte(source++);
+    if (!bits)
+    {
+      column += PIXELS_PER_BYTE;
+      out += PIXELS_PER_BYTE * step;
+      continue;
+    }
+    bool clipped = column < first || column + PIXELS_PER_BYTE > last + 1;
+    for (int8_t shift = 8 - BPP; shift >= 0; shift -= BPP, column++, out += step)
+    {
+      uint8_t value = brightness[(bits >> shift) & INDEX_MASK];
+      if (value && (!clipped || (column >= first && column <= last)))
+      {
+        *out = value;
+      }
+    }
+  }
+}
+
+void drawSprite(
+    Canvas &canvas, const Sprite &sprite, uint8_t frame, int x, int y, uint8_t flags, uint8_t scale)
+{
+  if (x >= COLS || y >= ROWS || x + sprite.width <= 0 || y + sprite.height <= 0 ||
+      frame >= sprite.frames || sprite.width > SPRITE_MAX_WIDTH)
+  {
+    return;
+  }
+
+  // palette scaled once per call; 0 stays transparent
+  uint8_t brightness[16];
+  brightness[0] = 0;
+  for (uint8_t i = 1; i < (1 << sprite.bpp); i++)
+  {
+    uint16_t value = pgm_read_byte(&sprite.palette[i]);
+    if (scale != 255)
+    {
+      value = value * scale >> 8;
+    }
+    brightness[i] = value > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : value;
+  }
+
+  // sprite columns first..last land on the screen
+  bool flipX = flags & SPRITE_FLIP_X;
+  int first = flipX ? x + sprite.width - COLS : -x;
+  int last = flipX ? x + sprite.width - 1 : COLS - 1 - x;
+  first = first < 0 ? 0 : first;
+  last = last >= sprite.width ? sprite.width - 1 : last;
+  int8_t step = flipX ? -1 : 1;
+
+  uint8_t *buffer = canvas.getRenderBuffer();
+  uint8_t rowBytes = getRowBytes(sprite);
+  const uint8_t *source = getFrameData(sprite, frame);
+
+  for (uint8_t row = 0; row < sprite.height; row++, source += rowBytes)
+  {
+    int screenY = y + (flags & SPRITE_FLIP_Y ? sprite.height - 1 - row : row);
+    if (screenY < 0 || screenY >= ROWS)
+    {
+      continue;
+    }
+
+    // out points at sprite column 0, possibly off screen; only visible columns are written
+    uint8_t *out = buffer + screenY * COLS + x + (flipX ? sprite.width - 1 : 0);
+    switch (sprite.bpp)
+    {
+    case 1:
+      drawRow<1>(source, out, step, first, last, brightness);
+      break;
+    case 2:
+      drawRow<2>(source, out, step, first, last, brightness);
+      break;
+    default:
+      drawRow<4>(source, out, step, first, last, brightness);
+      break;
+    }
+  }
+}
+
+uint8_t getAnimationFrame(const SpriteAnimation &animation, unsigned long elapsed)
+{
+  return pgm_read_byte(&animation.sequence[(elapsed / animation.frameMs) % animation.length]);
+}
+
+int getTilemapWidth(const Tilemap &tilemap)
+{
+  return tilemap.columns * tilemap.tiles->width;
+}
+
+void drawTilemap(Canvas &canvas, const Tilemap &tilemap, int scrollX, int y, uint8_t scale)
+{
+  uint8_t tileWidth = tilemap.tiles->width;
+  uint8_t tileHeight = tilemap.tiles->height;
+  int width = getTilemapWidth(tilemap);
+  scrollX = ((scrollX % width) + width) % width;
+
+  // only the columns under the screen are read from the map
+  uint16_t column = scrollX / tileWidth;
+  for (int screenX = -(scrollX % tileWidth); screenX < COLS; screenX += tileWidth)
+  {
+    const uint8_t *tiles = tilemap.map + column * tilemap.rows;
+    for (uint8_t row = 0; row < tilemap.rows; row++)
+    {
+      uint8_t tile = pgm_read_byte(&tiles[row]);
+      if (tile)
+      {
+        drawSprite(canvas, *tilemap.tiles, tile, screenX, y + row * tileHeight, 0, scale);
+      }
+    }
+    column = (column + 1) % tilemap.columns;
+  }
+}
+
+int worldToScreenX(int worldX, int scrollX, int worldWidth)
+{
+  int screenX = ((worldX - scrollX) % worldWidth + worldWidth) % worldWidth;
+  if (screenX >= worldWidth - SPRITE_MAX_WIDTH)
+  {
+    screenX -= worldWidth;
+  }
+  return screenX;
+}
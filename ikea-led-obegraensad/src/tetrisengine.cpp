@@ -0,0 +1,287 @@
+#include "tetrisengine.h"
+
+#include <string.h>
+
+// I, O, T, S, Z, L, J; the same four rotations as the blocks the plugin used to draw
+static const TetrisShape SHAPES[TETRIS_PIECE_TYPES][4] = {
+    // I
+    {{{0xf, 0x0, 0x0, 0x0}, 4, 1}, {{0x1, 0x1, 0x1, 0x1}, 1, 4},
+     {{0xf, 0x0, 0x0, 0x0}, 4, 1}, {{0x1, 0x1, 0x1, 0x1}, 1, 4}},
+    // O
+    {{{0x3, 0x3, 0x0, 0x0}, 2, 2}, {{0x3, 0x3, 0x0, 0x0}, 2, 2},
+     {{0x3, 0x3, 0x0, 0x0}, 2, 2}, {{0x3, 0x3, 0x0, 0x0}, 2, 2}},
+    // T
+    {{{0x7, 0x2, 0x0, 0x0}, 3, 2}, {{0x2, 0x3, 0x2, 0x0}, 2, 3},
+     {{0x2, 0x7, 0x0, 0x0}, 3, 2}, {{0x1, 0x3, 0x1, 0x0}, 2, 3}},
+    // S
+    {{{0x6, 0x3, 0x0, 0x0}, 3, 2}, {{0x1, 0x3, 0x2, 0x0}, 2, 3},
+     {{0x6, 0x3, 0x0, 0x0}, 3, 2}, {{0x1, 0x3, 0x2, 0x0}, 2, 3}},
+    // Z
+    {{{0x3, 0x6, 0x0, 0x0}, 3, 2}, {{0x2, 0x3, 0x1, 0x0}, 2, 3},
+     {{0x3, 0x6, 0x0, 0x0}, 3, 2}, {{0x2, 0x3, 0x1, 0x0}, 2, 3}},
+    // L
+    {{{0x1, 0x1, 0x3, 0x0}, 2, 3}, {{0x7, 0x1, 0x0, 0x0}, 3, 2},
+     {{0x3, 0x2, 0x2, 0x0}, 2, 3}, {{0x4, 0x7, 0x0, 0x0}, 3, 2}},
+    // J
+    {{{0x2, 0x2, 0x3, 0x0}, 2, 3}, {{0x1, 0x7, 0x0, 0x0}, 3, 2},
+     {{0x3, 0x1, 0x1, 0x0}, 2, 3}, {{0x7, 0x4, 0x0, 0x0}, 3, 2}},
+};
+
+// distinct rotations, the others repeat them
+static const uint8_t ROTATIONS[TETRIS_PIECE_TYPES] = {2, 1, 4, 2, 2, 4, 4};
+
+// next piece fits nowhere: worse than any field it could have produced
+static constexpr int32_t TOP_OUT_PENALTY = 100000;
+
+const TetrisShape &TetrisEngine::getShape(uint8_t type, uint8_t rotation)
+{
+  return SHAPES[type][rotation & 3];
+}
+
+uint8_t TetrisEngine::getRotations(uint8_t type)
+{
+  return ROTATIONS[type];
+}
+
+void TetrisEngine::clear()
+{
+  memset(rows, 0, sizeof(rows));
+  searching = false;
+  found = false;
+}
+
+bool TetrisEngine::canPlace(const uint16_t *field, uint8_t type, uint8_t rotation, int8_t x, int8_t y) const
+{
+  const TetrisShape &shape = getShape(type, rotation);
+  if (x < 0 || x + shape.width > TETRIS_WIDTH || y < 0 || y + shape.height > TETRIS_HEIGHT)
+  {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < shape.height; i++)
+  {
+    if (field[y + i] & (shape.rows[i] << x))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TetrisEngine::canPlace(uint8_t type, uint8_t rotation, int8_t x, int8_t y) const
+{
+  return canPlace(rows, type, rotation, x, y);
+}
+
+int8_t TetrisEngine::findDropY(const uint16_t *field, uint8_t type, uint8_t rotation, int8_t x) const
+{
+  // pieces enter at the top row, -1 if not even that is free
+  if (!canPlace(field, type, rotation, x, 0))
+  {
+    return -1;
+  }
+
+  int8_t y = 0;
+  while (canPlace(field, type, rotation, x, y + 1))
+  {
+    y++;
+  }
+  return y;
+}
+
+uint8_t TetrisEngine::drop(uint16_t *field, uint8_t type, uint8_t rotation, int8_t x) const
+{
+  int8_t y = findDropY(field, type, rotation, x);
+  const TetrisShape &shape = getShape(type, rotation);
+  for (uint8_t i = 0; i < shape.height; i++)
+  {
+    field[y + i] |= shape.rows[i] << x;
+  }
+
+  // compact the field from the bottom, skipping full rows
+  int8_t write = TETRIS_HEIGHT - 1;
+  for (int8_t read = TETRIS_HEIGHT - 1; read >= 0; read--)
+  {
+    if (field[read] != TETRIS_FULL_ROW)
+    {
+      field[write--] = field[read];
+    }
+  }
+  uint8_t lines = write + 1;
+  while (write >= 0)
+  {
+    field[write--] = 0;
+  }
+  return lines;
+}
+
+int32_t TetrisEngine::evaluate(const uint16_t *field, uint8_t lines) const
+{
+  uint8_t heights[TETRIS_WIDTH] = {0};
+  uint16_t covered = 0;
+  int32_t holes = 0;
+
+  for (uint8_t y = 0; y < TETRIS_HEIGHT; y++)
+  {
+    uint16_t row = field[y];
+    // empty cells below a block of the same column
+    holes += __builtin_popcount(covered & ~row & TETRIS_FULL_ROW);
+    // columns whose topmost block is in this row
+    uint16_t tops = row & ~covered;
+    while (tops)
+    {
+      heights[__builtin_ctz(tops)] = TETRIS_HEIGHT - y;
+      tops &= tops - 1;
+    }
+    covered |= row;
+  }
+
+  int32_t height = 0;
+  int32_t bumpiness = 0;
+  for (uint8_t x = 0; x < TETRIS_WIDTH; x++)
+  {
+    height += heights[x];
+    if (x > 0)
+    {
+      bumpiness += heights[x] > heights[x - 1] ? heights[x] - heights[x - 1] : heights[x - 1] - heights[x];
+    }
+  }
+
+  return lines * weights.lines - height * weights.height - holes * weights.holes - bumpiness * weights.bumpiness;
+}
+
+void TetrisEngine::lock(uint8_t type, uint8_t rotation, int8_t x, int8_t y)
+{
+  const TetrisShape &shape = getShape(type, rotation);
+  for (uint8_t i = 0; i < shape.height; i++)
+  {
+    if (y + i >= 0 && y + i < TETRIS_HEIGHT)
+    {
+      rows[y + i] |= (shape.rows[i] << x) & TETRIS_FULL_ROW;
+    }
+  }
+}
+
+uint16_t TetrisEngine::getFullRows() const
+{
+  uint16_t full = 0;
+  for (uint8_t y = 0; y < TETRIS_HEIGHT; y++)
+  {
+    if (rows[y] == TETRIS_FULL_ROW)
+    {
+      full |= 1 << y;
+    }
+  }
+  return full;
+}
+
+uint8_t TetrisEngine::removeFullRows()
+{
+  int8_t write = TETRIS_HEIGHT - 1;
+  for (int8_t read = TETRIS_HEIGHT - 1; read >= 0; read--)
+  {
+    if (rows[read] != TETRIS_FULL_ROW)
+    {
+      rows[write--] = rows[read];
+    }
+  }
+  uint8_t lines = write + 1;
+  while (write >= 0)
+  {
+    rows[write--] = 0;
+  }
+  return lines;
+}
+
+void TetrisEngine::beginSearch(uint8_t type, uint8_t next)
+{
+  searchType = type;
+  searchNext = next;
+  searchRotation = 0;
+  searchX = 0;
+  searching = true;
+  found = false;
+  bestScore = 0;
+  evaluations = 0;
+}
+
+int32_t TetrisEngine::scorePlacement(uint8_t rotation, int8_t x, uint16_t &cost)
+{
+  uint16_t first[TETRIS_HEIGHT];
+  memcpy(first, rows, sizeof(rows));
+  uint8_t lines = drop(first, searchType, rotation, x);
+
+  // best follow-up with the next piece
+  bool nextFits = false;
+  int32_t score = 0;
+  for (uint8_t nextRotation = 0; nextRotation < ROTATIONS[searchNext]; nextRotation++)
+  {
+    int8_t lastX = TETRIS_WIDTH - getShape(searchNext, nextRotation).width;
+    for (int8_t nextX = 0; nextX <= lastX; nextX++)
+    {
+      if (!canPlace(first, searchNext, nextRotation, nextX, 0))
+      {
+        continue;
+      }
+      uint16_t second[TETRIS_HEIGHT];
+      memcpy(second, first, sizeof(first));
+      uint8_t nextLines = drop(second, searchNext, nextRotation, nextX);
+      int32_t nextScore = evaluate(second, lines + nextLines);
+      cost++;
+      if (!nextFits || nextScore > score)
+      {
+        score = nextScore;
+        nextFits = true;
+      }
+    }
+  }
+
+  if (!nextFits)
+  {
+    cost++;
+    score = evaluate(first, lines) - TOP_OUT_PENALTY;
+  }
+  return score;
+}
+
+bool TetrisEngine::advance()
+{
+  searchX++;
+  if (searchX > TETRIS_WIDTH - getShape(searchType, searchRotation).width)
+  {
+    searchX = 0;
+    searchRotation++;
+    if (searchRotation >= ROTATIONS[searchType])
+    {
+      searching = false;
+    }
+  }
+  return !searching;
+}
+
+bool TetrisEngine::searchStep(uint16_t maxEvaluations)
+{
+  uint16_t cost = 0;
+  while (searching && cost < maxEvaluations)
+  {
+    if (canPlace(rows, searchType, searchRotation, searchX, 0))
+    {
+      int32_t score = scorePlacement(searchRotation, searchX, cost);
+      if (!found || score > bestScore)
+      {
+        found = true;
+        bestScore = score;
+        best = {searchRotation, searchX};
+      }
+    }
+    advance();
+  }
+  evaluations += cost;
+  return !searching;
+}
+
+bool TetrisEngine::getBest(TetrisPlacement &placement) const
+{
+  placement = best;
+  return found && !searching;
+}
@@ -1,8 +1,19 @@
 #include "webhandler.h"
+#include "animationupload.h"
+#include "arena.h"
+#include "bootprofile.h"
 #include "config.h"
+#include "connection.h"
+#include "fetchservice.h"
+#include "framerecorder.h"
+#include "heapstats.h"
+#include "imageupload.h"
 #include "messages.h"
+#include "power.h"
 #include "scheduler.h"
+#include "settings.h"
 #include "websocket.h"
+#include <memory>
 #ifdef ESP32
 #include <WiFi.h>
 #else
@@ -11,24 +22,22 @@
 
 void sendJsonSuccess(AsyncWebServerRequest *request, const char *message)
 {
-  JsonDocument jsonResponse;
+  JsonArena arena;
+  JsonDocument jsonResponse(&arena);
   jsonResponse["status"] = "success";
   jsonResponse["message"] = message;
 
-  String output;
-  serializeJson(jsonResponse, output);
-  request->send(200, "application/json", output);
+  request->send(200, "application/json", arena.serialize(jsonResponse));
 }
 
 void sendJsonError(AsyncWebServerRequest *request, int statusCode, const char *error)
 {
-  JsonDocument jsonResponse;
+  JsonArena arena;
+  JsonDocument jsonResponse(&arena);
   jsonResponse["error"] = true;
   jsonResponse["message"] = error;
 
-  String output;
-  serializeJson(jsonResponse, output);
-  request->send(statusCode, "application/json", output);
+  request->send(statusCode, "application/json", arena.serialize(jsonResponse));
 }
 
 // http://your-server/message?text=Hello&repeat=3&id=42&graph=1,2,3,4
@@ -136,7 +145,8 @@ void handleGetData(AsyncWebServerRequest *request)
 
 void handleGetInfo(AsyncWebServerRequest *request)
 {
-  JsonDocument jsonDocument;
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
   jsonDocument["rows"] = ROWS;
   jsonDocument["cols"] = COLS;
   jsonDocument["status"] = currentStatus;
@@ -144,11 +154,21 @@ void handleGetInfo(AsyncWebServerRequest *request)
   jsonDocument["rotation"] = Screen.currentRotation;
   jsonDocument["brightness"] = Screen.getCurrentBrightness();
   jsonDocument["scheduleActive"] = Scheduler.isActive;
+  Scheduler.nextToJson(jsonDocument["scheduleNext"].to<JsonObject>());
   jsonDocument["rssi"] = WiFi.RSSI();
   jsonDocument["uptime"] = millis() / 1000;
   jsonDocument["freeHeap"] = ESP.getFreeHeap();
   jsonDocument["ipAddress"] = WiFi.localIP().toString();
   jsonDocument["macAddress"] = WiFi.macAddress();
+  jsonDocument["fetch"]["requests"] = FetchService.getRequestCount();
+  jsonDocument["fetch"]["failures"] = FetchService.getFailureCount();
+  jsonDocument["fetch"]["peakJsonBytes"] = FetchService.getPeakJsonBytes();
+  jsonDocument["settings"]["commits"] = Settings.getCommitCount();
+  jsonDocument["settings"]["writes"] = Settings.getWriteCount();
+  jsonDocument["settings"]["coalesced"] = Settings.getCoalescedCount();
+  Connection.toJson(jsonDocument["wifi"].to<JsonObject>());
+  jsonDocument["standby"] = Power.isStandby();
+  HeapStats.summaryToJson(jsonDocument["heap"].to<JsonObject>());
 
   JsonArray scheduleArray = jsonDocument["schedule"].to<JsonArray>();
   for (const auto &item : Scheduler.schedule)
@@ -167,13 +187,109 @@ void handleGetInfo(AsyncWebServerRequest *request)
     JsonObject object = plugins.add<JsonObject>();
     object["id"] = plugin->getId();
     object["name"] = plugin->getName();
+    pluginManager.healthToJson(plugin, object);
   }
 
-  String output;
-  serializeJson(jsonDocument, output);
-  jsonDocument.clear();
+  request->send(200, "application/json", arena.serialize(jsonDocument));
+}
+
+void handleGetBoot(AsyncWebServerRequest *request)
+{
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
+  bootProfileToJson(jsonDocument["stages"].to<JsonArray>());
+
+  request->send(200, "application/json", arena.serialize(jsonDocument));
+}
+
+void handleGetHeap(AsyncWebServerRequest *request)
+{
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
+  HeapStats.toJson(jsonDocument.to<JsonObject>());
+  JsonArena::statsToJson(jsonDocument["arena"].to<JsonObject>());
+#ifdef ESP32
+  TlsReserve.toJson(jsonDocument["tls"].to<JsonObject>());
+#endif
+
+  request->send(200, "application/json", arena.serialize(jsonDocument));
+}
+
+void handleGetRecorder(AsyncWebServerRequest *request)
+{
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
+  FrameRecorder.toJson(jsonDocument.to<JsonObject>());
 
-  request->send(200, "application/json", output);
+  request->send(200, "application/json", arena.serialize(jsonDocument));
+}
+
+// http://your-server/api/recorder/capture?format=gif
+void handleGetRecorderCapture(AsyncWebServerRequest *request)
+{
+  bool gif = request->hasParam("format") && request->getParam("format")->value() == "gif";
+
+  // owned by the response, recording resumes when it is done or the client went away
+  auto capture = std::make_shared<FrameCapture>(gif ? FrameCapture::GIF : FrameCapture::BINARY);
+  if (!capture->isOpen())
+  {
+    sendJsonError(request, 409, "Another capture download is running");
+    return;
+  }
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      gif ? "image/gif" : "application/octet-stream",
+      [capture](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        return capture->read(buffer, maxLen);
+      });
+  response->addHeader("Content-Disposition",
+                      gif ? "attachment; filename=capture.gif" : "attachment; filename=capture.obrc");
+  request->send(response);
+}
+
+void handleWifiPortal(AsyncWebServerRequest *request)
+{
+  Connection.requestPortal();
+  sendJsonSuccess(request, "Opening WiFi setup portal " WIFI_MANAGER_SSID);
+}
+
+void handleGetPower(AsyncWebServerRequest *request)
+{
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
+  Power.toJson(jsonDocument.to<JsonObject>());
+
+  request->send(200, "application/json", arena.serialize(jsonDocument));
+}
+
+void handleSetPower(AsyncWebServerRequest *request)
+{
+  if (request->hasArg("windows") && !Power.setWindowsByJSONString(request->arg("windows")))
+  {
+    sendJsonError(request, 422, "Invalid windows, expected an array of start/end times");
+    return;
+  }
+
+  String mode = request->arg("mode");
+  if (mode == "on")
+  {
+    Power.wake();
+  }
+  else if (mode == "standby")
+  {
+    Power.sleep();
+  }
+  else if (mode == "auto")
+  {
+    Power.resumeSchedule();
+  }
+  else if (mode.length() > 0)
+  {
+    sendJsonError(request, 422, "Invalid mode, use on, standby or auto");
+    return;
+  }
+
+  sendJsonSuccess(request, "Power settings updated");
 }
 
 void handleSetSchedule(AsyncWebServerRequest *request)
@@ -231,9 +347,7 @@ void handleStartSchedule(AsyncWebServerRequest *request)
 void handleClearStorage(AsyncWebServerRequest *request)
 {
 #ifdef ENABLE_STORAGE
-  storage.begin("led-wall", false);
-  storage.clear();
-  storage.end();
+  Settings.clear("led-wall");
 
   sendJsonSuccess(request, "Storage cleared");
 #endif
@@ -359,3 +473,421 @@ void handleResetConfig(AsyncWebServerRequest *request)
     sendJsonError(request, 500, "Error resetting configuration");
   }
 }
+
+void handleGetAnimation(AsyncWebServerRequest *request)
+{
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
+  jsonDocument["stored"] = AnimationStore.hasAnimation();
+  jsonDocument["size"] = AnimationStore.getFileSize();
+
+  JsonObject upload = jsonDocument["upload"].to<JsonObject>();
+  upload["active"] = AnimationUpload.isActive();
+  upload["received"] = AnimationUpload.getReceived();
+  upload["size"] = AnimationUpload.getTotalSize();
+  upload["maxChunk"] = UPLOAD_MAX_CHUNK;
+
+  request->send(200, "application/json", arena.serialize(jsonDocument));
+}
+
+void handleDeleteAnimation(AsyncWebServerRequest *request)
+{
+  if (AnimationStore.remove())
+  {
+    sendJsonSuccess(request, "Animation removed");
+  }
+  else
+  {
+    sendJsonError(request, 404, "No animation stored");
+  }
+}
+
+// One upload protocol message per request body, see animationupload.h
+void handleAnimationUploadBody(AsyncWebServerRequest *request,
+                               uint8_t *data,
+                               size_t len,
+                               size_t index,
+                               size_t total)
+{
+  if (total > UPLOAD_MAX_MESSAGE)
+  {
+    if (index == 0)
+    {
+      sendJsonError(request, 413, "Message too large");
+    }
+    return;
+  }
+
+  // malloc'd, not new'd: the request free()s _tempObject when the client goes away mid-body
+  if (index == 0)
+  {
+    request->_tempObject = malloc(total);
+  }
+
+  uint8_t *body = static_cast<uint8_t *>(request->_tempObject);
+  if (!body)
+  {
+    if (index == 0)
+    {
+      sendJsonError(request, 500, "Internal buffer error");
+    }
+    return;
+  }
+
+  memcpy(body + index, data, len);
+
+  if (index + len != total)
+  {
+    return;
+  }
+
+  JsonArena arena;
+  JsonDocument reply(&arena);
+  AnimationUpload.handleMessage(body, total, reply);
+
+  request->send(reply["status"] == "error" ? 400 : 200, "application/json",
+                arena.serialize(reply));
+
+  free(body);
+  request->_tempObject = nullptr;
+}
+
+// http://your-server/api/animation/image?bpp=4&dither=ordered&delay=100 with a GIF or PNG body
+void handleImageUploadBody(AsyncWebServerRequest *request,
+                           uint8_t *data,
+                           size_t len,
+                           size_t index,
+                           size_t total)
+{
+  if (index == 0)
+  {
+    int bitsPerPixel = request->hasArg("bpp") ? request->arg("bpp").toInt() : 4;
+    int delay = request->hasArg("delay") ? request->arg("delay").toInt() : 100;
+    String ditherName = request->arg("dither");
+
+    // ordered dithering keeps still areas still between frames, so it is the default
+    ImageDither dither = bitsPerPixel == 8 ? DITHER_NONE : DITHER_ORDERED;
+    if (ditherName == "none")
+    {
+      dither = DITHER_NONE;
+    }
+    else if (ditherName == "diffusion")
+    {
+      dither = DITHER_DIFFUSION;
+    }
+    else if (ditherName.length() && ditherName != "ordered")
+    {
+      sendJsonError(request, 400, "dither must be none, ordered or diffusion");
+      return;
+    }
+
+    if ((bitsPerPixel != 1 && bitsPerPixel != 4 && bitsPerPixel != 8) || delay < 10 ||
+        delay > UINT16_MAX)
+    {
+      sendJsonError(request, 400, "bpp must be 1, 4 or 8 and delay 10-65535 ms");
+      return;
+    }
+
+    if (!ImageUpload.begin(request, bitsPerPixel, dither, delay))
+    {
+      sendJsonError(request, ImageUpload.isActive() ? 409 : 503, ImageUpload.getError());
+      return;
+    }
+    request->onDisconnect([request]() { ImageUpload.abort(request); });
+  }
+
+  // an error was already sent for this request, the rest of the body is dropped
+  if (!ImageUpload.isOwner(request))
+  {
+    return;
+  }
+
+  if (!ImageUpload.write(request, data, len))
+  {
+    sendJsonError(request, 422, ImageUpload.getError());
+    return;
+  }
+
+  if (index + len != total)
+  {
+    return;
+  }
+
+  if (!ImageUpload.finish(request))
+  {
+    sendJsonError(request, 422, ImageUpload.getError());
+    return;
+  }
+
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
+  jsonDocument["status"] = "success";
+  jsonDocument["format"] = ImageUpload.getFormat();
+  jsonDocument["width"] = ImageUpload.getWidth();
+  jsonDocument["height"] = ImageUpload.getHeight();
+  jsonDocument["frames"] = ImageUpload.getFrameCount();
+
+  request->send(200, "application/json", arena.serialize(jsonDocument));
+}
+
+static bool pluginExists(int id)
+{
+  for (Plugin *plugin : pluginManager.getAllPlugins())
+  {
+    if (plugin->getId() == id)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Checks one batch operation without touching any state. scheduleSet tracks whether a schedule
+// exists at this point of the batch, so "schedule/start" may follow a "schedule" op.
+static const char *validateBatchOp(JsonObject op, bool &scheduleSet)
+{
+  const char *name = op["op"] | "";
+
+  if (!strcmp(name, "brightness"))
+  {
+    int value = op["value"] | -1;
+    return value >= 0 && value <= 255 ? nullptr : "value must be between 0 and 255";
+  }
+  if (!strcmp(name, "plugin"))
+  {
+    return op["id"].is<int>() && pluginExists(op["id"]) ? nullptr : "Unknown plugin id";
+  }
+  if (!strcmp(name, "schedule"))
+  {
+    JsonArray items = op["schedule"];
+    if (items.isNull() || items.size() == 0)
+    {
+      return "schedule must be a non-empty array";
+    }
+    for (JsonObject item : items)
+    {
+      if (!item["pluginId"].is<int>() || !pluginExists(item["pluginId"]) ||
+          !item["duration"].is<unsigned long>() || item["duration"].as<unsigned long>() == 0)
+      {
+        return "Every schedule item needs a known pluginId and a duration in seconds";
+      }
+    }
+    scheduleSet = true;
+    return nullptr;
+  }
+  if (!strcmp(name, "schedule/start") || !strcmp(name, "schedule/stop"))
+  {
+    return scheduleSet ? nullptr : "No schedule found";
+  }
+  if (!strcmp(name, "schedule/clear"))
+  {
+    scheduleSet = false;
+    return nullptr;
+  }
+  if (!strcmp(name, "message"))
+  {
+    return op["text"].is<const char *>() ? nullptr : "text is required";
+  }
+  if (!strcmp(name, "removemessage"))
+  {
+    return nullptr;
+  }
+  if (!strcmp(name, "power"))
+  {
+    const char *mode = op["mode"] | "";
+    return !strcmp(mode, "on") || !strcmp(mode, "standby") || !strcmp(mode, "auto")
+               ? nullptr
+               : "mode must be on, standby or auto";
+  }
+  return "Unknown op";
+}
+
+// Applies a validated operation like its own endpoint would, returns true if it switched plugins
+static bool applyBatchOp(JsonObject op)
+{
+  const char *name = op["op"];
+
+  if (!strcmp(name, "brightness"))
+  {
+    Screen.setBrightness(op["value"].as<int>(), true);
+  }
+  else if (!strcmp(name, "plugin"))
+  {
+    pluginManager.setActivePluginById(op["id"]);
+    return true;
+  }
+  else if (!strcmp(name, "schedule"))
+  {
+    String schedule;
+    serializeJson(op["schedule"], schedule);
+    Scheduler.setScheduleByJSONString(schedule);
+    Scheduler.start();
+    return true;
+  }
+  else if (!strcmp(name, "schedule/start"))
+  {
+    Scheduler.start();
+    return true;
+  }
+  else if (!strcmp(name, "schedule/stop"))
+  {
+    Scheduler.stop();
+  }
+  else if (!strcmp(name, "schedule/clear"))
+  {
+    Scheduler.clearSchedule(true);
+  }
+  else if (!strcmp(name, "message"))
+  {
+    std::vector<int> graph;
+    for (int value : op["graph"].as<JsonArray>())
+    {
+      graph.push_back(value);
+    }
+    int delay = op["delay"] | 50;
+    int maxy = op["maxy"] | 15;
+    Messages.add(op["text"].as<const char *>(),
+                 op["repeat"] | 0,
+                 op["id"] | 0,
+                 delay > 0 ? delay : 50,
+                 graph,
+                 op["miny"] | 0,
+                 maxy != 0 ? maxy : 15);
+  }
+  else if (!strcmp(name, "removemessage"))
+  {
+    Messages.remove(op["id"] | 0);
+  }
+  else if (!strcmp(name, "power"))
+  {
+    const char *mode = op["mode"];
+    if (!strcmp(mode, "on"))
+    {
+      Power.wake();
+    }
+    else if (!strcmp(mode, "standby"))
+    {
+      Power.sleep();
+    }
+    else
+    {
+      Power.resumeSchedule();
+    }
+  }
+  return false;
+}
+
+// POST /api/batch with a JSON array of operations, see README. Nothing is applied unless every
+// operation is valid; then they run in order with the render task held off and a single info
+// broadcast at the end.
+void handleBatchBody(AsyncWebServerRequest *request,
+                     uint8_t *data,
+                     size_t len,
+                     size_t index,
+                     size_t total)
+{
+  if (total > BATCH_MAX_BODY)
+  {
+    if (index == 0)
+    {
+      sendJsonError(request, 413, "Batch too large");
+    }
+    return;
+  }
+
+  // malloc'd like the animation upload body, the request free()s it on an aborted upload
+  if (index == 0)
+  {
+    request->_tempObject = malloc(total);
+  }
+
+  char *body = static_cast<char *>(request->_tempObject);
+  if (!body)
+  {
+    if (index == 0)
+    {
+      sendJsonError(request, 500, "Internal buffer error");
+    }
+    return;
+  }
+
+  memcpy(body + index, data, len);
+  if (index + len != total)
+  {
+    return;
+  }
+
+  JsonArena arena;
+  JsonDocument batch(&arena);
+  DeserializationError parseError = deserializeJson(batch, static_cast<const char *>(body), total);
+  free(body);
+  request->_tempObject = nullptr;
+
+  if (parseError || !batch.is<JsonArray>() || batch.size() == 0)
+  {
+    sendJsonError(request, 400, "Expected a JSON array of operations");
+    return;
+  }
+  JsonArray ops = batch.as<JsonArray>();
+  if (ops.size() > BATCH_MAX_OPS)
+  {
+    sendJsonError(request, 413, "Too many operations");
+    return;
+  }
+
+  JsonDocument reply(&arena);
+  JsonArray results = reply["results"].to<JsonArray>();
+
+  bool scheduleSet = !Scheduler.schedule.empty();
+  int failed = -1;
+  for (size_t i = 0; i < ops.size(); i++)
+  {
+    JsonObject op = ops[i];
+    const char *problem =
+        op.isNull() ? "Operation must be an object" : validateBatchOp(op, scheduleSet);
+
+    JsonObject result = results.add<JsonObject>();
+    result["op"] = op["op"];
+    result["status"] = problem ? "invalid" : "valid";
+    if (problem)
+    {
+      result["message"] = problem;
+      failed = failed < 0 ? (int)i : failed;
+    }
+  }
+
+  if (failed >= 0)
+  {
+    reply["error"] = true;
+    reply["message"] = "Batch rejected, nothing was applied";
+    reply["failed"] = failed;
+
+    request->send(422, "application/json", arena.serialize(reply));
+    return;
+  }
+
+  SYSTEM_STATUS previous = currentStatus;
+  if (previous == UPDATE || previous == LOADING)
+  {
+    sendJsonError(request, 409, "Device is busy, try again");
+    return;
+  }
+
+  holdInfo();
+  bool switched = false;
+  for (size_t i = 0; i < ops.size(); i++)
+  {
+    // a plugin switch hands the screen back when it is done, so take it again for the next op
+    currentStatus = LOADING;
+    switched |= applyBatchOp(ops[i]);
+    results[i]["status"] = "applied";
+  }
+  currentStatus = switched ? NONE : previous;
+  sendInfo();
+  releaseInfo();
+
+  reply["status"] = "success";
+  reply["applied"] = ops.size();
+
+  request->send(200, "application/json", arena.serialize(reply));
+}
@@ -1,13 +1,44 @@
 #include "PluginManager.h"
+#include "animationupload.h"
+#include "arena.h"
 #include "scheduler.h"
+#include "wsframe.h"
+#include <algorithm>
 
 #ifdef ENABLE_SERVER
 
 AsyncWebSocket ws("/ws");
 
+// reassembly cap for split binary messages: the largest upload chunk or frame message
+constexpr size_t WS_MAX_BINARY_MESSAGE = std::max<size_t>(UPLOAD_MAX_MESSAGE, FRAME_MAX_MESSAGE);
+
+static volatile uint8_t infoHolds = 0;
+static volatile bool infoPending = false;
+
+void holdInfo()
+{
+  infoHolds++;
+}
+
+void releaseInfo()
+{
+  if (infoHolds > 0 && --infoHolds == 0 && infoPending)
+  {
+    infoPending = false;
+    sendInfo();
+  }
+}
+
 void sendInfo()
 {
-  JsonDocument jsonDocument;
+  if (infoHolds > 0)
+  {
+    infoPending = true;
+    return;
+  }
+
+  JsonArena arena;
+  JsonDocument jsonDocument(&arena);
   if (currentStatus == NONE)
   {
     for (int j = 0; j < ROWS * COLS; j++)
@@ -23,6 +54,7 @@ void sendInfo()
   jsonDocument["rotation"] = Screen.currentRotation;
   jsonDocument["brightness"] = Screen.getCurrentBrightness();
   jsonDocument["scheduleActive"] = Scheduler.isActive;
+  Scheduler.nextToJson(jsonDocument["scheduleNext"].to<JsonObject>());
 
   JsonArray scheduleArray = jsonDocument["schedule"].to<JsonArray>();
   for (const auto &item : Scheduler.schedule)
@@ -42,10 +74,99 @@ void sendInfo()
     object["id"] = plugin->getId();
     object["name"] = plugin->getName();
   }
-  String output;
-  serializeJson(jsonDocument, output);
-  ws.textAll(output);
-  jsonDocument.clear();
+  ws.textAll(arena.serialize(jsonDocument));
+}
+
+void onBinaryMessage(AsyncWebSocketClient *client, const uint8_t *data, size_t len)
+{
+  if (currentStatus == WSBINARY && len == ROWS * COLS)
+  {
+    Screen.setRenderBuffer(data, true);
+  }
+  else if (isFrameMessage(data, len))
+  {
+    static WsFrame frame;
+    if (!decodeFrameMessage(data, len, frame))
+    {
+      Serial.println(F("[WebSocket] Invalid frame message"));
+    }
+    else if (currentStatus == WSBINARY)
+    {
+      drawFrame(frame, Screen);
+    }
+    else if (Plugin *activePlugin = pluginManager.getActivePlugin())
+    {
+      activePlugin->websocketFrameHook(frame);
+    }
+  }
+  else if (AnimationUpload_::isUploadMessage(data, len))
+  {
+    JsonArena arena;
+    JsonDocument reply(&arena);
+    AnimationUpload.handleMessage(data, len, reply);
+
+    client->text(arena.serialize(reply));
+  }
+}
+
+// Binary messages may arrive split over several TCP packets or WS continuation frames
+void onBinaryFragment(AsyncWebSocketClient *client, AwsFrameInfo *info, uint8_t *data, size_t len)
+{
+  static std::vector<uint8_t> message;
+  static uint32_t messageClient = 0;
+
+  if (info->final && info->num == 0 && info->index == 0 && info->len == len)
+  {
+    onBinaryMessage(client, data, len);
+    return;
+  }
+
+  if (info->num == 0 && info->index == 0)
+  {
+    message.clear();
+    messageClient = client->id();
+  }
+
+  if (client->id() != messageClient || message.size() + len > WS_MAX_BINARY_MESSAGE)
+  {
+    // oversized or interleaved, drop the rest of this message
+    message.clear();
+    messageClient = 0;
+    return;
+  }
+
+  message.insert(message.end(), data, data + len);
+
+  if (info->final && info->index + len == info->len)
+  {
+    onBinaryMessage(client, message.data(), message.size());
+    message.clear();
+    messageClient = 0;
+  }
+}
+
+// Events handled by a plugin's websocketHook() alone, passed to whichever plugin is active
+static const char *const pluginEvents[] = {
+    "upload",     // Animation
+    "clear-animation",
+    "goldelay",   // Game of Life
+    "golspeed",
+    "golrule",
+    "golsize",
+    "golview",
+    "snakedelay", // Snake
+};
+
+static bool isPluginEvent(const char *event)
+{
+  for (const char *pluginEvent : pluginEvents)
+  {
+    if (!strcmp(event, pluginEvent))
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
 void onWsEvent(AsyncWebSocket *server,
@@ -63,17 +184,18 @@ void onWsEvent(AsyncWebSocket *server,
   if (type == WS_EVT_DATA)
   {
     AwsFrameInfo *info = (AwsFrameInfo *)arg;
-    if (info->final && info->index == 0 && info->len == len)
+    if (info->message_opcode == WS_BINARY)
     {
-      if (info->opcode == WS_BINARY && currentStatus == WSBINARY && info->len == 256)
-      {
-        Screen.setRenderBuffer(data, true);
-      }
-      else if (info->opcode == WS_TEXT)
+      onBinaryFragment(client, info, data, len);
+    }
+    else if (info->final && info->index == 0 && info->len == len)
+    {
+      if (info->opcode == WS_TEXT)
       {
         data[len] = 0;
 
-        JsonDocument wsRequest;
+        JsonArena arena;
+        JsonDocument wsRequest(&arena);
         DeserializationError error = deserializeJson(wsRequest, data);
 
         if (error)
@@ -160,6 +282,10 @@ void onWsEvent(AsyncWebSocket *server,
             Serial.println(F("[WebSocket] ERROR: No active plugin!"));
           }
         }
+        else if (activePlugin && isPluginEvent(event))
+        {
+          activePlugin->websocketHook(wsRequest);
+        }
       }
     }
   }
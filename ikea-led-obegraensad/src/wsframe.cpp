@@ -0,0 +1,107 @@
+#include "wsframe.h"
+#include "animationstore.h"
+
+bool isFrameMessage(const uint8_t *data, size_t len)
+{
+  return len >= FRAME_HEADER_SIZE && data[0] == FRAME_MAGIC;
+}
+
+bool decodeFrameMessage(const uint8_t *data, size_t len, WsFrame &frame)
+{
+  if (!isFrameMessage(data, len))
+  {
+    return false;
+  }
+
+  const uint8_t format = data[1];
+  const uint8_t bitsPerPixel = format & 0x0F;
+  if ((bitsPerPixel != 1 && bitsPerPixel != 4 && bitsPerPixel != 8) ||
+      (format & ~(FRAME_RECT | FRAME_RLE | 0x0F)))
+  {
+    return false;
+  }
+
+  size_t offset = FRAME_HEADER_SIZE;
+  frame.x = 0;
+  frame.y = 0;
+  frame.width = COLS;
+  frame.height = ROWS;
+
+  if (format & FRAME_RECT)
+  {
+    if (len < FRAME_RECT_HEADER_SIZE)
+    {
+      return false;
+    }
+    frame.x = data[2];
+    frame.y = data[3];
+    frame.width = data[4];
+    frame.height = data[5];
+    offset = FRAME_RECT_HEADER_SIZE;
+
+    if (frame.width == 0 || frame.height == 0 || frame.x + frame.width > COLS ||
+        frame.y + frame.height > ROWS)
+    {
+      return false;
+    }
+  }
+
+  const uint16_t count = frame.width * frame.height;
+  const uint16_t packedSize = (count * bitsPerPixel + 7) / 8;
+  const uint8_t *packed = data + offset;
+  // the packed bytes sit at the end of the pixel buffer, unpacking front to back never
+  // overwrites a byte that is still to be read
+  uint8_t *plane = frame.pixels + count - packedSize;
+
+  if (format & FRAME_RLE)
+  {
+    if (packBitsDecode(packed, len - offset, plane, packedSize) != packedSize)
+    {
+      return false;
+    }
+  }
+  else
+  {
+    if (len - offset != packedSize)
+    {
+      return false;
+    }
+    memmove(plane, packed, packedSize);
+  }
+
+  if (bitsPerPixel == 4)
+  {
+    for (uint16_t i = 0; i < count; i++)
+    {
+      uint8_t byte = plane[i >> 1];
+      frame.pixels[i] = ((i & 1) ? byte & 0x0F : byte >> 4) * 17;
+    }
+  }
+  else if (bitsPerPixel == 1)
+  {
+    for (uint16_t i = 0; i < count; i++)
+    {
+      frame.pixels[i] = (plane[i >> 3] & (0x80 >> (i & 7))) ? MAX_BRIGHTNESS : 0;
+    }
+  }
+
+  return true;
+}
+
+void drawFrame(const WsFrame &frame, Canvas &canvas)
+{
+  if (frame.width == COLS && frame.height == ROWS)
+  {
+    canvas.setRenderBuffer(frame.pixels, true);
+    return;
+  }
+
+  const uint8_t *pixel = frame.pixels;
+  for (uint8_t y = frame.y; y < frame.y + frame.height; y++)
+  {
+    for (uint8_t x = frame.x; x < frame.x + frame.width; x++)
+    {
+      canvas.setPixel(x, y, 1, *pixel++);
+    }
+  }
+}